@@ -72,3 +72,6 @@
 
 /* Define to 1 if you have the MPI library */
 /* #undef HAVE_MPI */
+
+/* Define to 1 to use 64-bit array lengths and indices */
+/* #undef EAVL_64BIT_INDICES */
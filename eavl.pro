@@ -23,7 +23,9 @@ INCLUDEPATH += config-simple
 
 SOURCES += \
     src/common/eavlArray.cpp \
+    src/common/eavlArrayResidency.cpp \
     src/common/eavlAtomicProperties.cpp \
+    src/common/eavlBondFinder.cpp \
     src/common/eavlCUDA.cpp \
     src/common/eavlCellComponents.cpp \
     src/common/eavlCellSet.cpp \
@@ -33,22 +35,27 @@ SOURCES += \
     src/common/eavlExecutor.cpp \
     src/common/eavlFlatArray.cpp \
     src/common/eavlLogicalStructure.cpp \
+    src/common/eavlMemoryPool.cpp \
     src/common/eavlNewIsoTables.cpp \
     src/common/eavlOperation.cpp \
+    src/common/eavlThreadPool.cpp \
     src/common/eavlTimer.cpp \
+    src/common/eavlTrace.cpp \
     src/common/eavlUtility.cpp \
     src/exporters/eavlPNMExporter.cpp \
+    src/exporters/eavlSnapshotExporter.cpp \
     src/exporters/eavlVTKExporter.cpp \
+    src/exporters/eavlVTKXMLExporter.cpp \
     src/filters/eavl3X3AverageMutator.cu \
     src/filters/eavlBinaryMathMutator.cu \
     src/filters/eavlCellToNodeRecenterMutator.cu \
     src/filters/eavlElevateMutator.cpp \
-    src/filters/eavlExternalFaceMutator.cpp \
+    src/filters/eavlExternalFaceMutator.cu \
     src/filters/eavlIsosurfaceFilter.cu \
     src/filters/eavlScalarBinFilter.cu \
     src/filters/eavlSurfaceNormalMutator.cu \
     src/filters/eavlTesselate2DFilter.cpp \
-    src/filters/eavlThresholdMutator.cpp \
+    src/filters/eavlThresholdMutator.cu \
     src/filters/eavlTransformMutator.cu \
     src/filters/eavlUnaryMathMutator.cu \
     src/fonts/Liberation2Mono.cpp \
@@ -62,6 +69,7 @@ SOURCES += \
     src/importers/eavlMADNESSImporter.cpp \
     src/importers/eavlPDBImporter.cpp \
     src/importers/eavlPNGImporter.cpp \
+    src/importers/eavlSnapshotImporter.cpp \
     src/importers/eavlVTKImporter.cpp \
     src/math/eavlMatrix4x4.cpp \
     src/math/eavlPoint3.cpp \
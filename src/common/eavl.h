@@ -20,6 +20,15 @@
 
 typedef unsigned char byte;
 
+// Array lengths and element indices.  These are 32-bit unless the
+// library is configured with 64-bit indices (EAVL_64BIT_INDICES), which
+// allows arrays of more than 2^31 values at some cost in memory traffic.
+#ifdef EAVL_64BIT_INDICES
+typedef long long eavlIndex;
+#else
+typedef int eavlIndex;
+#endif
+
 struct nulltype { };
 #ifdef __CUDACC__
 EAVL_HOSTDEVICE const nulltype cnull() { return nulltype(); }
@@ -7,6 +7,8 @@
 #include "eavlException.h"
 #include "eavlCUDA.h"
 #include "eavlSerialize.h"
+#include "eavlArrayResidency.h"
+#include "eavlMemoryPool.h"
 
 #ifdef HAVE_CUDA
 #include <cuda.h>
@@ -17,7 +19,6 @@
 #include <cfloat>
 #include <cmath>
 
-//#define DEBUG_ARRAY_TRANSFERS
 
 // ****************************************************************************
 // Class:  eavlArray
@@ -34,6 +35,14 @@
 // Creation:    February 14, 2011
 //
 // Modifications:
+//   Added ReleaseDeviceMemory so device copies can be evicted.
+//
+//   Tuple counts and indices are eavlIndex, which is 64-bit in builds
+//   configured with EAVL_64BIT_INDICES.
+//
+//   Added GetBasicTypeSize, and host storage deferred until first use
+//   (ALLOCATE_ON_FIRST_USE), which lets eavlExecutor elide intermediates.
+//
 // ****************************************************************************
 class eavlArray
 {
@@ -68,27 +77,36 @@ class eavlArray
     {
         name = n;
     }
-    virtual eavlArray *Create(const string &n, int nc = 1, int nt = 0) = 0;
+    virtual eavlArray *Create(const string &n, int nc = 1, eavlIndex nt = 0) = 0;
     virtual const char *GetBasicType() const = 0;
-    virtual void   SetNumberOfTuples(int) = 0;
-    virtual int    GetNumberOfTuples() const = 0;
+    virtual int    GetBasicTypeSize() const = 0;
+    virtual void   SetNumberOfTuples(eavlIndex) = 0;
+    virtual eavlIndex GetNumberOfTuples() const = 0;
     virtual double GetComponentAsDouble(
-                                      int i,  ///< tuple index
-                                      int c   ///< component index
+                                      eavlIndex i, ///< tuple index
+                                      int c        ///< component index
                                       ) = 0;
-    virtual void   SetComponentFromDouble(int i, int c, double v) = 0;
+    virtual void   SetComponentFromDouble(eavlIndex i, int c, double v) = 0;
 
     enum Location { HOST, DEVICE };
-#ifdef HAVE_CUDA
+    /// When host storage for the tuples given at construction is made.
+    enum Allocation { ALLOCATE_NOW, ALLOCATE_ON_FIRST_USE };
     virtual void *GetCUDAArray() = 0;
-#else
-    virtual void *GetCUDAArray() {THROW(eavlException,"CUDA not available");}
-#endif
     virtual void *GetHostArray() = 0;
     ///\todo: Refresh is a little odd; we're using it for CUDA-based
     /// in situ where we need some way of forcing it to assume the 
     /// device data has been updated and force new data back to the host.
     virtual void MarkAsDirty(Location) = 0;
+    /// Drop any device copy, bringing the host copy up to date first.
+    /// Used by eavlArrayResidency to evict arrays from the device.
+    virtual void ReleaseDeviceMemory() { }
+    /// True while an array created with ALLOCATE_ON_FIRST_USE has not
+    /// yet allocated its host storage.
+    virtual bool IsHostStorageDeferred() const { return false; }
+    /// Lend an array whose host storage is deferred memory for
+    /// GetHostArray to return instead of allocating its own, or end the
+    /// loan with NULL.  Used by eavlExecutor for elided intermediates.
+    virtual void SetHostScratch(void *) { }
     void *GetRawPointer(Location loc)
     {
         if (loc == HOST)
@@ -102,7 +120,7 @@ class eavlArray
         return sizeof(string) + name.size()*sizeof(char) + sizeof(int);
     }
     int GetNumberOfComponents() const {return ncomponents;}
-    double GetTupleMin(int index)
+    double GetTupleMin(eavlIndex index)
     {
         double mymin = +DBL_MAX;
         for (int j=0; j<ncomponents; j++)
@@ -113,7 +131,7 @@ class eavlArray
         }
         return mymin;
     }
-    double GetTupleMax(int index)
+    double GetTupleMax(eavlIndex index)
     {
         double mymax = -DBL_MAX;
         for (int j=0; j<ncomponents; j++)
@@ -124,7 +142,7 @@ class eavlArray
         }
         return mymax;
     }
-    double GetTupleMagnitude(int index)
+    double GetTupleMagnitude(eavlIndex index)
     {
         double mymag = 0;
         for (int j=0; j<ncomponents; j++)
@@ -137,9 +155,9 @@ class eavlArray
 
     double GetComponentWiseMin()
     {
-        int nt = GetNumberOfTuples();
+        eavlIndex nt = GetNumberOfTuples();
         double mymin = +DBL_MAX;
-        for (int i=0; i<nt; i++)
+        for (eavlIndex i=0; i<nt; i++)
         {
             double v = GetTupleMin(i);
             if (v < mymin)
@@ -149,9 +167,9 @@ class eavlArray
     }
     double GetComponentWiseMax()
     {
-        int nt = GetNumberOfTuples();
+        eavlIndex nt = GetNumberOfTuples();
         double mymax = -DBL_MAX;
-        for (int i=0; i<nt; i++)
+        for (eavlIndex i=0; i<nt; i++)
         {
             double v = GetTupleMax(i);
             if (v > mymax)
@@ -162,9 +180,9 @@ class eavlArray
 
     double GetMagnitudeMin()
     {
-        int nt = GetNumberOfTuples();
+        eavlIndex nt = GetNumberOfTuples();
         double mymin = +DBL_MAX;
-        for (int i=0; i<nt; i++)
+        for (eavlIndex i=0; i<nt; i++)
         {
             double v = GetTupleMagnitude(i);
             if (v < mymin)
@@ -174,9 +192,9 @@ class eavlArray
     }
     double GetMagnitudeMax()
     {
-        int nt = GetNumberOfTuples();
+        eavlIndex nt = GetNumberOfTuples();
         double mymax = 0;
-        for (int i=0; i<nt; i++)
+        for (eavlIndex i=0; i<nt; i++)
         {
             double v = GetTupleMagnitude(i);
             if (v > mymax)
@@ -187,7 +205,7 @@ class eavlArray
 
     void PrintSummary(ostream &out)
     {
-        int n = GetNumberOfTuples() * GetNumberOfComponents();
+        eavlIndex n = GetNumberOfTuples() * GetNumberOfComponents();
         out << GetBasicType() <<" "
             << GetName()
             <<"["<< GetNumberOfTuples() <<"]"
@@ -195,7 +213,7 @@ class eavlArray
         if (n == 0)
             out << "(empty)";
         const int NV=11;
-        for (int i=0; i<n; i++)
+        for (eavlIndex i=0; i<n; i++)
         {
             if (n <= NV)
                 out << GetComponentAsDouble(i/ncomponents,i%ncomponents) << "  ";
@@ -244,6 +262,23 @@ class eavlArray
 //   Allow externally-provided device arrays, for tightly-coupled in situ for
 //   CUDA-based codes.  Changed method signature to specify the location.
 //
+//   Device copies are now managed through eavlArrayResidency, which
+//   records every transfer in eavlTransferLedger and applies a pluggable
+//   residency policy.  Host and device validity are tracked separately,
+//   so read-only host access no longer forces a transfer back to the
+//   device, and the device side can be simulated in builds without CUDA.
+//
+//   Host storage is drawn from eavlMemoryPool, so temporaries created
+//   on every filter execution reuse memory instead of reallocating it.
+//
+//   Tuple counts and indices are eavlIndex.
+//
+//   Written to an eavlSnapshotStream, only a reference to the values is
+//   serialized, and reading one back wraps the mapped values.
+//
+//   Created with ALLOCATE_ON_FIRST_USE, host storage is allocated by the
+//   first access needing it; until then only the tuple count is kept.
+//
 // ****************************************************************************
 template<class T>
 class eavlConcreteArray : public eavlArray
@@ -251,154 +286,174 @@ class eavlConcreteArray : public eavlArray
   public:
     typedef T type;
   protected:
-    vector<T> host_values_self;
+    vector<T, eavlPoolAllocator<T> > host_values_self;
     T *host_values_external;
-    int provided_ntuples;
+    eavlIndex provided_ntuples;
     bool host_provided; ///< we don't own the host array, it was given to us, and we cannot write to it
-#ifdef HAVE_CUDA
     bool device_provided; ///< we don't own the dev array, it was given to us, and we cannot write to it
-    bool host_dirty;
-    bool device_dirty;
+    bool host_valid; ///< the host copy holds the current values
+    bool device_valid; ///< the device copy (if allocated) holds the current values
     T *device_values;
-    void NeedToUseOnHost()
+    eavlIndex deferred_ntuples; ///< tuples still to allocate on the host, or -1
+    T *host_scratch; ///< lent by SetHostScratch while storage is deferred
+
+    long long GetNumberOfBytes() const
+    {
+        return (long long)GetNumberOfTuples() * ncomponents * sizeof(T);
+    }
+    T *HostPointer()
     {
         if (host_provided)
-        {
-            // nothing to do
+            return host_values_external;
+        return host_values_self.empty() ? NULL : &(host_values_self[0]);
+    }
+    void AllocateDeferredHostStorage()
+    {
+        if (deferred_ntuples < 0)
             return;
-        }
-        if (device_dirty)
-        {
-            CUDA_CHECK_ERROR();
-            if (device_provided && host_values_self.size() == 0)
-            {
-                // first time we need the device-provided array on the
-                // host, we need to allocate the host array spacee.
-                host_values_self.resize(ncomponents * provided_ntuples);
-            }
-#ifdef DEBUG_ARRAY_TRANSFERS
-            cerr << "Transferring "<<name<<" array to host\n";
-#endif
-            int nbytes = host_values_self.size() * sizeof(T);
-            cudaMemcpy(&(host_values_self[0]), device_values,
-                       nbytes, cudaMemcpyDeviceToHost);
-            CUDA_CHECK_ERROR();
-        }
-        device_dirty = false;
-        host_dirty = true;
+        eavlIndex nt = deferred_ntuples;
+        deferred_ntuples = -1;
+        host_values_self.resize(ncomponents * nt);
     }
-    void NeedToUseOnDevice()
+    void CopyDeviceToHost(const char *method)
     {
-        if (device_provided)
+        AllocateDeferredHostStorage();
+        if (device_provided && host_values_self.size() == 0)
         {
-            // nothing to do
-            return;
+            // first time we need the device-provided array on the
+            // host, we need to allocate the host array spacee.
+            host_values_self.resize(ncomponents * provided_ntuples);
         }
-        int nbytes = host_values_self.size() * sizeof(T);
-        if (device_values == NULL)
+        long long nbytes = GetNumberOfBytes();
+        if (nbytes > 0)
+            eavlArrayResidency::CopyToHost(this, HostPointer(), device_values,
+                                           nbytes, method);
+        host_valid = true;
+    }
+    // Accesses which may modify the values must pass write=true, so the
+    // device copy is refreshed before its next use; read-only accesses
+    // leave it valid, avoiding a transfer back to the device.
+    void NeedToUseOnHost(bool write, const char *method)
+    {
+        AllocateDeferredHostStorage();
+        if (!host_valid)
+            CopyDeviceToHost(method);
+        if (write && device_valid && !host_provided)
+            device_valid = false;
+        if (device_values && !device_provided &&
+            eavlArrayResidency::HostUsed(this))
+            ReleaseDeviceMemory();
+    }
+    void NeedToUseOnDevice(const char *method)
+    {
+        if (!device_values)
         {
-            CUDA_CHECK_ERROR();
-#ifdef DEBUG_ARRAY_TRANSFERS
-            cerr << "Allocating "<<nbytes<<" device bytes ("<<host_values_self.size()<<" vals) for array "<<name<<endl;
-#endif
-            cudaMalloc((void**)&device_values, nbytes);
-            //cudaThreadSynchronize();
-            CUDA_CHECK_ERROR();
-            // Set to zero for debugging purposes:
-            //cudaMemset((void*)device_values, 0, nbytes);
-            //cudaThreadSynchronize();
-            //CUDA_CHECK_ERROR();
+            device_values = (T*)eavlArrayResidency::Allocate(this, GetNumberOfBytes());
         }
-        if (host_dirty)
+        if (!device_valid)
         {
-            CUDA_CHECK_ERROR();
-#ifdef DEBUG_ARRAY_TRANSFERS
-            cerr << "Transferring "<<name<<" array to device\n";
-#endif
-            cudaMemcpy(device_values, &(host_values_self[0]),
-                       nbytes, cudaMemcpyHostToDevice);
-            CUDA_CHECK_ERROR();
+            AllocateDeferredHostStorage();
+            long long nbytes = GetNumberOfBytes();
+            if (nbytes > 0)
+                eavlArrayResidency::CopyToDevice(this, device_values,
+                                                 HostPointer(), nbytes, method);
         }
-        host_dirty = false;
-        device_dirty = true;
+        eavlArrayResidency::Touch(this);
+        // the caller may write through the device pointer
+        device_valid = true;
+        if (!host_provided)
+            host_valid = false;
+    }
+    void FreeDeviceMemory()
+    {
+        if (device_values && !device_provided)
+            eavlArrayResidency::Free(this, device_values);
+        if (!device_provided)
+            device_values = NULL;
     }
+  public:
     void MarkAsDirty(eavlArray::Location loc)
     {
         if (loc == eavlArray::DEVICE)
         {
-            device_dirty = true;
-            //NeedToUseOnHost();
+            device_valid = true;
+            if (device_values && !host_provided)
+                host_valid = false;
         }
         else  // loc == eavlArray::HOST
         {
-            host_dirty = true;
-            //NeedToUseOnDevice();
+            host_valid = true;
+            device_valid = false;
         }
     }
+    virtual void ReleaseDeviceMemory()
+    {
+        if (!device_values || device_provided)
+            return;
+        if (!host_valid)
+            CopyDeviceToHost("ReleaseDeviceMemory");
+        FreeDeviceMemory();
+        device_valid = false;
+    }
 
-#else
-    void NeedToUseOnHost() const {}
-    void NeedToUseOnDevice() const {}
-    void MarkAsDirty(eavlArray::Location) {}
-#endif
   public:
-    eavlConcreteArray(const string &n, int nc = 1, int nt = 0) : eavlArray(n,nc)
+    eavlConcreteArray(const string &n, int nc = 1, eavlIndex nt = 0,
+                      eavlArray::Allocation alloc = eavlArray::ALLOCATE_NOW)
+        : eavlArray(n,nc)
     {
         host_values_external = NULL;
         provided_ntuples = -1;
         host_provided = false;
-#ifdef HAVE_CUDA
         device_provided = false;
-        // the _dirty values are initialized to false because
-        // the user might start writing on either host or
-        // device memory; either one is a valid option.
-        host_dirty = false;
-        device_dirty = false;
+        // both copies start out valid because the user might start
+        // writing on either host or device memory; either one is a
+        // valid option, and neither needs a transfer first.
+        host_valid = true;
+        device_valid = true;
         device_values = NULL;
-#endif
-        if (nt > 0)
+        deferred_ntuples = -1;
+        host_scratch = NULL;
+        if (nt > 0 && alloc == eavlArray::ALLOCATE_ON_FIRST_USE)
+            deferred_ntuples = nt;
+        else if (nt > 0)
             host_values_self.resize(ncomponents * nt);
     }
     eavlConcreteArray(eavlArray::Location loc, T *extarray,
-                      const string &n, int nc, int nt) : eavlArray(n,nc)
+                      const string &n, int nc, eavlIndex nt) : eavlArray(n,nc)
     {
         provided_ntuples = nt;
+        deferred_ntuples = -1;
+        host_scratch = NULL;
 
         if (loc == eavlArray::HOST)
         {
             host_values_external = extarray;
             host_provided = true;
-#ifdef HAVE_CUDA
             device_provided = false;
-            // assume host array is filled with valid data; set its _dirty flag to true
-            host_dirty = true;
-            device_dirty = false;
+            // assume host array is filled with valid data
+            host_valid = true;
+            device_valid = false;
             device_values = NULL;
-#endif
         }
         else // loc == eavlArray::DEVICE
         {
-#ifdef HAVE_CUDA
+#ifndef HAVE_CUDA
+            THROW(eavlException, "Cannot provide device values without CUDA support.");
+#endif
             device_values = extarray;
             host_provided = false;
             device_provided = true;
-            // assume device array is filled with valid data; set its _dirty flag to true
-            host_dirty = false;
-            device_dirty = true;
+            // assume device array is filled with valid data
+            host_valid = false;
+            device_valid = true;
             host_values_external = NULL;
-#else
-            THROW(eavlException, "Cannot provide device values without CUDA support.");
-#endif
         }
     }
     virtual ~eavlConcreteArray()
     {
-#ifdef HAVE_CUDA
-        if (device_values)
-            cudaFree(device_values);
-#endif
+        FreeDeviceMemory();
     }
-    virtual eavlArray *Create(const string &n, int nc = 1, int nt = 0)
+    virtual eavlArray *Create(const string &n, int nc = 1, eavlIndex nt = 0)
     {
         return new eavlConcreteArray<T>(n, nc, nt);
     }
@@ -406,8 +461,22 @@ class eavlConcreteArray : public eavlArray
     virtual string className() const {return string("eavlConcreteArray<")+GetBasicType()+">";}
     virtual eavlStream& serialize(eavlStream &s) const
     {
+	const_cast<eavlConcreteArray<T>*>(this)->AllocateDeferredHostStorage();
 	s << className();
 	eavlArray::serialize(s);
+	eavlSnapshotStream *snap = dynamic_cast<eavlSnapshotStream*>(&s);
+	if (snap)
+	{
+	    // the values go in the payload section; only their offset is
+	    // written here
+	    if (!host_valid)
+	        const_cast<eavlConcreteArray<T>*>(this)->CopyDeviceToHost("serialize");
+	    const T *values = host_provided ? host_values_external :
+	        (host_values_self.empty() ? NULL : &(host_values_self[0]));
+	    eavlIndex nt = GetNumberOfTuples();
+	    s << nt << snap->AddPayload(values, GetNumberOfBytes());
+	    return s;
+	}
 	s << provided_ntuples << host_provided;
 	s << host_values_self;
 	return s;
@@ -415,78 +484,114 @@ class eavlConcreteArray : public eavlArray
     virtual eavlStream& deserialize(eavlStream &s)
     {
 	eavlArray::deserialize(s);
+	deferred_ntuples = -1;
+	eavlSnapshotStream *snap = dynamic_cast<eavlSnapshotStream*>(&s);
+	if (snap)
+	{
+	    // wrap the mapped values as an external host array
+	    size_t offset;
+	    s >> provided_ntuples >> offset;
+	    host_values_self.clear();
+	    host_provided = true;
+	    host_values_external = (T*)snap->GetPayload(offset, GetNumberOfBytes());
+	    host_valid = true;
+	    device_valid = false;
+	    return s;
+	}
 	s >> provided_ntuples >> host_provided;
 	s >> host_values_self;
 	return s;
     }
     virtual const char *GetBasicType() const;
+    virtual int GetBasicTypeSize() const
+    {
+        return sizeof(T);
+    }
+    virtual bool IsHostStorageDeferred() const
+    {
+        return deferred_ntuples >= 0;
+    }
+    virtual void SetHostScratch(void *p)
+    {
+        host_scratch = (T*)p;
+    }
     virtual void *GetHostArray() ///\todo: we might like to make this return const
     {
-        NeedToUseOnHost();
+        if (host_scratch && deferred_ntuples >= 0)
+            return host_scratch;
+        NeedToUseOnHost(true, "GetHostArray");
         if (host_provided)
             return host_values_external;
         else
             return &(host_values_self[0]);
     }
-    virtual void SetNumberOfTuples(int n)
+    virtual void SetNumberOfTuples(eavlIndex n)
     {
         if (host_provided)
             THROW(eavlException, "Cannot resize externally-provided array");
-        NeedToUseOnHost();
+        if (deferred_ntuples >= 0 && !device_values)
+        {
+            deferred_ntuples = n;
+            return;
+        }
+        NeedToUseOnHost(false, "SetNumberOfTuples");
+        if (device_values && (eavlIndex)host_values_self.size() != ncomponents * n)
+        {
+            FreeDeviceMemory();
+            device_valid = false;
+        }
         host_values_self.resize(ncomponents * n);
     }
-    virtual int GetNumberOfTuples() const
+    virtual eavlIndex GetNumberOfTuples() const
     {
         //NeedToUseOnHost();
         if (ncomponents == 0)
             return 0;
-        if (host_provided
-#ifdef HAVE_CUDA
-            || device_provided
-#endif
-            )
+        if (host_provided || device_provided)
             return provided_ntuples;
+        else if (deferred_ntuples >= 0)
+            return deferred_ntuples;
         else
             return host_values_self.size() / ncomponents;
     }
-    void SetTuple(int index, T *v)
+    void SetTuple(eavlIndex index, T *v)
     {
         if (host_provided)
             THROW(eavlException, "Cannot write to externally-provided array");
-        NeedToUseOnHost();
+        NeedToUseOnHost(true, "SetTuple");
         for (int c=0; c<ncomponents; c++)
             host_values_self[index*ncomponents+c] = v[c];
     }
-    const T *GetTuple(int index) // can't make this method const
+    const T *GetTuple(eavlIndex index) // can't make this method const
     {
-        NeedToUseOnHost();
+        NeedToUseOnHost(false, "GetTuple");
         if (host_provided)
             return &(host_values_external[index*ncomponents]);
         else
             return &(host_values_self[index*ncomponents]);
     }
-    T *GetTupleWritable(int index)
+    T *GetTupleWritable(eavlIndex index)
     {
         if (host_provided)
             THROW(eavlException, "Cannot write to externally-provided array");
-        NeedToUseOnHost();
+        NeedToUseOnHost(true, "GetTupleWritable");
         return &(host_values_self[index*ncomponents]);
     }
-    T GetValue(int index)
+    T GetValue(eavlIndex index)
     {
         // assert ncomponents==1?
-        NeedToUseOnHost();
+        NeedToUseOnHost(false, "GetValue");
         if (host_provided)
             return host_values_external[index*ncomponents+0];
         else
             return host_values_self[index*ncomponents+0];
     }
-    void SetValue(int index, T v)
+    void SetValue(eavlIndex index, T v)
     {
         if (host_provided)
             THROW(eavlException, "Cannot write to externally-provided array");
         // assert ncomponents==1?
-        NeedToUseOnHost();
+        NeedToUseOnHost(true, "SetValue");
         host_values_self[index*ncomponents+0] = v;
     }
     void AddValue(T v)
@@ -494,28 +599,25 @@ class eavlConcreteArray : public eavlArray
         if (host_provided)
             THROW(eavlException, "Cannot write to externally-provided array");
         // assert ncomponents==1?
-        NeedToUseOnHost();
+        NeedToUseOnHost(true, "AddValue");
+        FreeDeviceMemory();
         host_values_self.push_back(v);
     }
-    virtual double GetComponentAsDouble(int i, int c)
+    virtual double GetComponentAsDouble(eavlIndex i, int c)
     {
-        NeedToUseOnHost();
         return GetTuple(i)[c];
     }
-    virtual void SetComponentFromDouble(int i, int c, double v)
+    virtual void SetComponentFromDouble(eavlIndex i, int c, double v)
     {
-        NeedToUseOnHost();
         GetTupleWritable(i)[c] = v;
     }
-#ifdef HAVE_CUDA
     ///\todo: can we make this return const? we kind of want that
     /// if we were handed the device memory pointer.
     virtual void *GetCUDAArray()
     {
-        NeedToUseOnDevice();
+        NeedToUseOnDevice("GetCUDAArray");
         return (void*)(device_values);
     }
-#endif
     virtual long long GetMemoryUsage()
     {
         ///\todo: ignores device memory; is that right??
@@ -524,11 +626,9 @@ class eavlConcreteArray : public eavlArray
         mem += sizeof(vector<T>);
         mem += host_values_self.size() * sizeof(T);
 
-#ifdef HAVE_CUDA
         mem += sizeof(bool);
         mem += sizeof(bool);
         mem += sizeof(T*);
-#endif
         return mem + eavlArray::GetMemoryUsage();
     }
 };
@@ -0,0 +1,701 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlArrayResidency.h"
+#include "eavlArray.h"
+#include "eavlTrace.h"
+#include "eavlThreadPool.h"
+#include <string.h>
+
+using std::string;
+using std::vector;
+using std::map;
+
+bool                  eavlTransferLedger::verbose = false;
+vector<eavlTransferLedger::Entry> eavlTransferLedger::entries;
+map<string, int>      eavlTransferLedger::entryIndex;
+
+static eavlResidencyPolicy defaultPolicy;
+
+eavlResidencyPolicy  *eavlArrayResidency::policy = &defaultPolicy;
+bool                  eavlArrayResidency::simulated = false;
+long long             eavlArrayResidency::bytesInUse = 0;
+long long             eavlArrayResidency::bytesHighWater = 0;
+long long             eavlArrayResidency::useCounter = 0;
+int                   eavlArrayResidency::operationCounter = 0;
+vector<eavlArrayResidency::ThreadState> eavlArrayResidency::threads;
+map<eavlArray*, eavlArrayResidency::Resident> eavlArrayResidency::resident;
+
+// guards the ledger
+static eavlMutex &
+LedgerMutex()
+{
+    static eavlMutex mutex;
+    return mutex;
+}
+
+// guards all eavlArrayResidency state but the policy
+static eavlMutex &
+ResidencyMutex()
+{
+    static eavlMutex mutex;
+    return mutex;
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::Record
+//
+// Purpose:
+///   Tally a transfer of "nbytes" of the named array, attributed to the
+///   calling thread's call site.  "method" is the array method which
+///   needed the data on the other side.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTransferLedger::Record(const string &array, long long nbytes,
+                           bool toDevice, const char *method)
+{
+    string site = eavlArrayResidency::GetCallSite();
+    if (site.empty())
+        site = "unnamed host code";
+
+    eavlMutexLocker lock(LedgerMutex());
+    if (verbose)
+    {
+        cerr << "Transferring " << array << " array ("<<nbytes<<" bytes) to "
+             << (toDevice ? "device" : "host") << " for '" << site
+             << "' through " << method << endl;
+    }
+
+    string key = array + '\n' + site + '\n' + method + (toDevice ? "\nD" : "\nH");
+    map<string, int>::iterator it = entryIndex.find(key);
+    if (it == entryIndex.end())
+    {
+        Entry e;
+        e.array = array;
+        e.site = site;
+        e.method = method;
+        e.toDevice = toDevice;
+        e.count = 0;
+        e.bytes = 0;
+        it = entryIndex.insert(make_pair(key, (int)entries.size())).first;
+        entries.push_back(e);
+    }
+    Entry &e = entries[it->second];
+    e.count++;
+    e.bytes += nbytes;
+
+    if (eavlTrace::IsEnabled())
+        eavlTrace::AddTransfer(array, nbytes, toDevice);
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::Clear
+//
+// Purpose:
+///   Forget all recorded transfers.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTransferLedger::Clear()
+{
+    eavlMutexLocker lock(LedgerMutex());
+    entries.clear();
+    entryIndex.clear();
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::GetNumberOfTransfers
+//
+// Purpose:
+///   Total number of transfers recorded in the given direction.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+int
+eavlTransferLedger::GetNumberOfTransfers(bool toDevice)
+{
+    eavlMutexLocker lock(LedgerMutex());
+    int n = 0;
+    for (size_t i=0; i<entries.size(); i++)
+        if (entries[i].toDevice == toDevice)
+            n += entries[i].count;
+    return n;
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::GetNumberOfBytes
+//
+// Purpose:
+///   Total number of bytes transferred in the given direction.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+long long
+eavlTransferLedger::GetNumberOfBytes(bool toDevice)
+{
+    eavlMutexLocker lock(LedgerMutex());
+    long long n = 0;
+    for (size_t i=0; i<entries.size(); i++)
+        if (entries[i].toDevice == toDevice)
+            n += entries[i].bytes;
+    return n;
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::GetEntries
+//
+// Purpose:
+///   A copy of the recorded transfers.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+vector<eavlTransferLedger::Entry>
+eavlTransferLedger::GetEntries()
+{
+    eavlMutexLocker lock(LedgerMutex());
+    return entries;
+}
+
+// ****************************************************************************
+// Method:  eavlTransferLedger::Dump
+//
+// Purpose:
+///   Print the recorded transfers, one line per array, direction, call
+///   site, and array method.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTransferLedger::Dump(std::ostream &out)
+{
+    vector<Entry> e = GetEntries();
+    out << "\nTransfers\n---------\n";
+    for (size_t i=0; i<e.size(); i++)
+    {
+        out << e[i].array << (e[i].toDevice ? " to device" : " to host")
+            << " for '" << e[i].site << "' through " << e[i].method
+            << ": " << e[i].count << " transfers, " << e[i].bytes << " bytes\n";
+    }
+    out << "total to device: " << GetNumberOfTransfers(true) << " transfers, "
+        << GetNumberOfBytes(true) << " bytes\n";
+    out << "total to host:   " << GetNumberOfTransfers(false) << " transfers, "
+        << GetNumberOfBytes(false) << " bytes\n";
+}
+
+// ****************************************************************************
+// Method:  eavlTransferSite constructor
+//
+// Purpose:
+///   Name the calling thread's host code until destroyed.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlTransferSite::eavlTransferSite(const string &caller)
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    eavlArrayResidency::CurrentThread().callers.push_back(caller);
+}
+
+eavlTransferSite::~eavlTransferSite()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    eavlArrayResidency::CurrentThread().callers.pop_back();
+}
+
+// ****************************************************************************
+// Method:  eavlDeviceMemoryCapPolicy::MakeRoom
+//
+// Purpose:
+///   Evict least recently used arrays until "nbytes" more fit in the cap,
+///   or until nothing more may be evicted.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlDeviceMemoryCapPolicy::MakeRoom(long long nbytes)
+{
+    while (eavlArrayResidency::GetDeviceBytesInUse() + nbytes > cap)
+    {
+        if (!eavlArrayResidency::EvictLeastRecentlyUsed())
+            break;
+    }
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::SetPolicy
+//
+// Purpose:
+///   Set the residency policy.  The caller keeps ownership of the policy,
+///   and must keep it alive while it is set; NULL restores the default.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::SetPolicy(eavlResidencyPolicy *p)
+{
+    policy = p ? p : &defaultPolicy;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::SetSimulatedDevice
+//
+// Purpose:
+///   Choose between the real device and the host-backed simulated device.
+///   This may only be changed while no array has a device copy.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::SetSimulatedDevice(bool sim)
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    if (sim != simulated && !resident.empty())
+        THROW(eavlException, "Cannot switch devices while arrays are resident on the device");
+    simulated = sim;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::DeviceAvailable
+//
+// Purpose:
+///   True if arrays can be given device copies.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlArrayResidency::DeviceAvailable()
+{
+#ifdef HAVE_CUDA
+    return true;
+#else
+    return simulated;
+#endif
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::GetDeviceBytesInUse
+//
+// Purpose:
+///   Device memory currently held by array copies.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+long long
+eavlArrayResidency::GetDeviceBytesInUse()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    return bytesInUse;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::GetDeviceBytesHighWater
+//
+// Purpose:
+///   The most device memory ever held by array copies at once.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+long long
+eavlArrayResidency::GetDeviceBytesHighWater()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    return bytesHighWater;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::GetNumberOfResidentArrays
+//
+// Purpose:
+///   The number of arrays which currently have a device copy.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+int
+eavlArrayResidency::GetNumberOfResidentArrays()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    return resident.size();
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::IsResident
+//
+// Purpose:
+///   True if the array currently has a device copy.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlArrayResidency::IsResident(const eavlArray *a)
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    return resident.count(const_cast<eavlArray*>(a)) > 0;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::CurrentThread
+//
+// Purpose:
+///   The operation state of the calling thread: one for each pool worker,
+///   and one shared by all other threads.  Call with the mutex held.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlArrayResidency::ThreadState &
+eavlArrayResidency::CurrentThread()
+{
+    size_t index = eavlThreadPool::GetCurrentWorker() + 1;
+    if (index >= threads.size())
+        threads.resize(index + 1);
+    return threads[index];
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::InActiveOperation
+//
+// Purpose:
+///   True if "id" is the operation running on any thread.  Call with the
+///   mutex held.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlArrayResidency::InActiveOperation(int id)
+{
+    if (id == 0)
+        return false;
+    for (size_t i=0; i<threads.size(); i++)
+        if (threads[i].operationId == id)
+            return true;
+    return false;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::BeginOperation
+//
+// Purpose:
+///   Note that an executor operation is starting on the calling thread.
+///   Transfers there are attributed to it, and arrays it uses are
+///   protected from eviction until EndOperation.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::BeginOperation(const string &name)
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    ThreadState &t = CurrentThread();
+    t.operation = name;
+    t.operationId = ++operationCounter;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::EndOperation
+//
+// Purpose:
+///   Note that the calling thread's executor operation has finished.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::EndOperation()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    ThreadState &t = CurrentThread();
+    t.operation = "";
+    t.operationId = 0;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::GetCurrentOperation
+//
+// Purpose:
+///   The executor operation running on the calling thread, if any.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+string
+eavlArrayResidency::GetCurrentOperation()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    return CurrentThread().operation;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::GetCallSite
+//
+// Purpose:
+///   What transfers on the calling thread are attributed to: its running
+///   operation, else its innermost eavlTransferSite, else nothing.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+string
+eavlArrayResidency::GetCallSite()
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    const ThreadState &t = CurrentThread();
+    if (!t.operation.empty())
+        return t.operation;
+    if (!t.callers.empty())
+        return t.callers.back();
+    return "";
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::EvictLeastRecentlyUsed
+//
+// Purpose:
+///   Evict the least recently used device copy which is not in use by an
+///   operation running on any thread.  Returns false if there was none.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlArrayResidency::EvictLeastRecentlyUsed()
+{
+    eavlArray *victim = NULL;
+    {
+        eavlMutexLocker lock(ResidencyMutex());
+        long long oldest = 0;
+        for (map<eavlArray*, Resident>::iterator it = resident.begin();
+             it != resident.end(); ++it)
+        {
+            const Resident &r = it->second;
+            if (r.evicting || InActiveOperation(r.lastOperation))
+                continue;
+            if (!victim || r.lastUse < oldest)
+            {
+                victim = it->first;
+                oldest = r.lastUse;
+            }
+        }
+        if (victim)
+            resident[victim].evicting = true;
+    }
+    if (!victim)
+        return false;
+    // unlocked, as releasing may copy back to the host and calls Free
+    victim->ReleaseDeviceMemory();
+    return true;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::Evict
+//
+// Purpose:
+///   Release the device copy of an array, first bringing the host copy up
+///   to date if needed.  Does nothing if another thread is already
+///   evicting it.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::Evict(eavlArray *a)
+{
+    {
+        eavlMutexLocker lock(ResidencyMutex());
+        map<eavlArray*, Resident>::iterator it = resident.find(a);
+        if (it == resident.end() || it->second.evicting)
+            return;
+        it->second.evicting = true;
+    }
+    a->ReleaseDeviceMemory();
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::Allocate
+//
+// Purpose:
+///   Allocate a device copy for an array, after letting the policy make
+///   room for it.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void *
+eavlArrayResidency::Allocate(eavlArray *a, long long nbytes)
+{
+    if (!DeviceAvailable())
+        THROW(eavlException,"CUDA not available");
+
+    policy->MakeRoom(nbytes);
+
+    void *ptr = NULL;
+    if (simulated)
+    {
+        ptr = new char[nbytes > 0 ? nbytes : 1];
+    }
+    else
+    {
+#ifdef HAVE_CUDA
+        CUDA_CHECK_ERROR();
+        cudaMalloc(&ptr, nbytes);
+        CUDA_CHECK_ERROR();
+#endif
+    }
+
+    eavlMutexLocker lock(ResidencyMutex());
+    Resident r;
+    r.bytes = nbytes;
+    r.lastUse = ++useCounter;
+    r.lastOperation = CurrentThread().operationId;
+    r.evicting = false;
+    resident[a] = r;
+    bytesInUse += nbytes;
+    if (bytesInUse > bytesHighWater)
+        bytesHighWater = bytesInUse;
+    return ptr;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::Free
+//
+// Purpose:
+///   Free the device copy of an array.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::Free(eavlArray *a, void *ptr)
+{
+    {
+        eavlMutexLocker lock(ResidencyMutex());
+        map<eavlArray*, Resident>::iterator it = resident.find(a);
+        if (it != resident.end())
+        {
+            bytesInUse -= it->second.bytes;
+            resident.erase(it);
+        }
+    }
+
+    if (simulated)
+    {
+        delete[] (char*)ptr;
+    }
+    else
+    {
+#ifdef HAVE_CUDA
+        cudaFree(ptr);
+#endif
+    }
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::Touch
+//
+// Purpose:
+///   Note that an array's device copy is being used.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::Touch(eavlArray *a)
+{
+    eavlMutexLocker lock(ResidencyMutex());
+    map<eavlArray*, Resident>::iterator it = resident.find(a);
+    if (it == resident.end())
+        return;
+    it->second.lastUse = ++useCounter;
+    it->second.lastOperation = CurrentThread().operationId;
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::HostUsed
+//
+// Purpose:
+///   Called when an array with a device copy is used on the host; returns
+///   true if the policy wants the device copy released.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlArrayResidency::HostUsed(eavlArray *a)
+{
+    return policy->ReleaseAfterHostUse(a);
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::CopyToDevice
+//
+// Purpose:
+///   Copy array values from the host to the device, recording the transfer.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::CopyToDevice(const eavlArray *a, void *dst,
+                                 const void *src, long long nbytes,
+                                 const char *method)
+{
+    if (simulated)
+    {
+        memcpy(dst, src, nbytes);
+    }
+    else
+    {
+#ifdef HAVE_CUDA
+        CUDA_CHECK_ERROR();
+        cudaMemcpy(dst, src, nbytes, cudaMemcpyHostToDevice);
+        CUDA_CHECK_ERROR();
+#endif
+    }
+    eavlTransferLedger::Record(a->GetName(), nbytes, true, method);
+}
+
+// ****************************************************************************
+// Method:  eavlArrayResidency::CopyToHost
+//
+// Purpose:
+///   Copy array values from the device to the host, recording the transfer.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlArrayResidency::CopyToHost(const eavlArray *a, void *dst,
+                               const void *src, long long nbytes,
+                               const char *method)
+{
+    if (simulated)
+    {
+        memcpy(dst, src, nbytes);
+    }
+    else
+    {
+#ifdef HAVE_CUDA
+        CUDA_CHECK_ERROR();
+        cudaMemcpy(dst, src, nbytes, cudaMemcpyDeviceToHost);
+        CUDA_CHECK_ERROR();
+#endif
+    }
+    eavlTransferLedger::Record(a->GetName(), nbytes, false, method);
+}
@@ -0,0 +1,248 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_ARRAY_RESIDENCY_H
+#define EAVL_ARRAY_RESIDENCY_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <set>
+#include <iostream>
+
+class eavlArray;
+
+// ****************************************************************************
+// Class:  eavlTransferLedger
+//
+// Purpose:
+///   Runtime accounting of host<->device array transfers.  Every transfer
+///   is tallied by array name, direction, the call site which triggered
+///   it, and the array method through which it did.  The call site is the
+///   executor operation running on the calling thread, or else the
+///   innermost eavlTransferSite on that thread.  If verbose, each
+///   transfer is also reported on cerr as it happens.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   Transfers may be recorded from several threads at once, so the
+//   ledger is guarded by a mutex and GetEntries returns a copy.
+// ****************************************************************************
+class eavlTransferLedger
+{
+  public:
+    struct Entry
+    {
+        std::string array;
+        std::string site;
+        std::string method;
+        bool        toDevice;
+        int         count;
+        long long   bytes;
+    };
+
+    static void      Record(const std::string &array, long long nbytes,
+                            bool toDevice, const char *method);
+    static void      Clear();
+    static void      SetVerbose(bool v) { verbose = v; }
+
+    static int       GetNumberOfTransfers(bool toDevice);
+    static long long GetNumberOfBytes(bool toDevice);
+    static std::vector<Entry> GetEntries();
+    static void      Dump(std::ostream&);
+
+  private:
+    static bool                       verbose;
+    static std::vector<Entry>         entries;
+    static std::map<std::string, int> entryIndex;
+};
+
+// ****************************************************************************
+// Class:  eavlTransferSite
+//
+// Purpose:
+///   Names the host code responsible for transfers triggered on the
+///   calling thread for as long as it exists, outside of any executor
+///   operation.  Sites nest; the innermost one is recorded.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlTransferSite
+{
+  public:
+    eavlTransferSite(const std::string &caller);
+    ~eavlTransferSite();
+  private:
+    eavlTransferSite(const eavlTransferSite &);
+    void operator=(const eavlTransferSite &);
+};
+
+// ****************************************************************************
+// Class:  eavlResidencyPolicy
+//
+// Purpose:
+///   Decides where arrays live when they are used on both the host and
+///   the device.  This base class keeps a device copy for as long as its
+///   array exists, so an array alternately read on the host and used on
+///   the device is only transferred when one side modifies it.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlResidencyPolicy
+{
+  public:
+    virtual ~eavlResidencyPolicy() { }
+    virtual std::string GetName() const { return "prefer device"; }
+    /// Called before "nbytes" of device memory are allocated for an
+    /// array; may release other arrays with eavlArrayResidency::Evict.
+    virtual void MakeRoom(long long) { }
+    /// Whether an array should release its device copy after it has
+    /// been brought up to date on the host.
+    virtual bool ReleaseAfterHostUse(const eavlArray *) { return false; }
+};
+
+// ****************************************************************************
+// Class:  eavlPinOnHostPolicy
+//
+// Purpose:
+///   Keeps the given arrays (or all arrays) resident on the host: they
+///   are copied to the device when an operation needs them there, but
+///   the device copy is released as soon as they are used on the host.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlPinOnHostPolicy : public eavlResidencyPolicy
+{
+  protected:
+    bool                       pinAll;
+    std::set<const eavlArray*> pinned;
+  public:
+    eavlPinOnHostPolicy(bool all = true) : pinAll(all) { }
+    void Pin(const eavlArray *a)   { pinned.insert(a); }
+    void Unpin(const eavlArray *a) { pinned.erase(a); }
+    virtual std::string GetName() const { return "pin on host"; }
+    virtual bool ReleaseAfterHostUse(const eavlArray *a)
+    {
+        return pinAll || pinned.count(a) > 0;
+    }
+};
+
+// ****************************************************************************
+// Class:  eavlDeviceMemoryCapPolicy
+//
+// Purpose:
+///   Bounds the device memory used by array copies.  Before allocating,
+///   the least recently used device copies are evicted (copied back to
+///   the host if they were modified on the device) until the allocation
+///   fits.  Arrays used by the operation currently being executed are
+///   never evicted, so the cap may be exceeded by a single operation
+///   whose arrays do not fit at once.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlDeviceMemoryCapPolicy : public eavlResidencyPolicy
+{
+  protected:
+    long long cap;
+  public:
+    eavlDeviceMemoryCapPolicy(long long capBytes) : cap(capBytes) { }
+    virtual std::string GetName() const { return "evict LRU under cap"; }
+    virtual void MakeRoom(long long nbytes);
+};
+
+// ****************************************************************************
+// Class:  eavlArrayResidency
+//
+// Purpose:
+///   Owns the device copies of eavlConcreteArrays: allocation, transfers
+///   (recorded in eavlTransferLedger and eavlTrace), least-recently-used
+///   bookkeeping, and the active eavlResidencyPolicy.
+///
+///   The device is normally the CUDA device.  A simulated device, backed
+///   by host memory, can be selected instead, which lets residency and
+///   transfer behavior be exercised without a GPU (and in builds without
+///   CUDA) by calling GetCUDAArray directly.  Device kernels cannot run
+///   on simulated device memory.
+///
+///   All of this state is shared by every thread.  It is guarded by a
+///   mutex, except for the policy itself; the running operation is kept
+///   per thread, so operations run concurrently are each attributed
+///   their own transfers and each protect their own arrays.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlArrayResidency
+{
+  public:
+    static void SetPolicy(eavlResidencyPolicy *p);
+    static eavlResidencyPolicy *GetPolicy() { return policy; }
+
+    static void SetSimulatedDevice(bool sim);
+    static bool GetSimulatedDevice() { return simulated; }
+    static bool DeviceAvailable();
+
+    static long long GetDeviceBytesInUse();
+    static long long GetDeviceBytesHighWater();
+    static int       GetNumberOfResidentArrays();
+    static bool      IsResident(const eavlArray *a);
+
+    static void BeginOperation(const std::string &name);
+    static void EndOperation();
+    static std::string GetCurrentOperation();
+    static std::string GetCallSite();
+
+    static bool EvictLeastRecentlyUsed();
+    static void Evict(eavlArray *a);
+
+    // used by eavlConcreteArray
+    static void *Allocate(eavlArray *a, long long nbytes);
+    static void  Free(eavlArray *a, void *ptr);
+    static void  Touch(eavlArray *a);
+    static bool  HostUsed(eavlArray *a);
+    static void  CopyToDevice(const eavlArray *a, void *dst, const void *src,
+                              long long nbytes, const char *method);
+    static void  CopyToHost(const eavlArray *a, void *dst, const void *src,
+                            long long nbytes, const char *method);
+
+  private:
+    friend class eavlTransferSite;
+
+    struct Resident
+    {
+        long long bytes;
+        long long lastUse;
+        int       lastOperation;
+        bool      evicting;
+    };
+
+    struct ThreadState
+    {
+        std::string              operation;
+        int                      operationId;
+        std::vector<std::string> callers;
+        ThreadState() : operationId(0) { }
+    };
+
+    static ThreadState &CurrentThread();
+    static bool         InActiveOperation(int id);
+
+    static eavlResidencyPolicy              *policy;
+    static bool                              simulated;
+    static long long                         bytesInUse;
+    static long long                         bytesHighWater;
+    static long long                         useCounter;
+    static int                               operationCounter;
+    static std::vector<ThreadState>          threads;
+    static std::map<eavlArray*, Resident>    resident;
+};
+
+#endif
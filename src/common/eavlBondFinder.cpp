@@ -0,0 +1,271 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlBondFinder.h"
+#include "eavlAtomicProperties.h"
+#include "eavlException.h"
+#include <algorithm>
+#include <climits>
+
+// The atoms binned into a uniform grid of cells, with the atoms of each
+// cell held contiguously along with their positions and radii.
+struct eavlBondCellList
+{
+    struct Atom
+    {
+        float x, y, z, r;
+    };
+
+    int          dims[3];
+    vector<int>  cellStart;
+    vector<int>  ids;
+    vector<Atom> atoms;
+
+    int CellIndex(int i, int j, int k) const
+    {
+        return i + dims[0]*(j + dims[1]*k);
+    }
+};
+
+// Test the atom in slot s of the cell list, whose cell is at the given
+// logical index, against the atoms with higher indices in its own and
+// neighboring cells.
+// Returns the number of bonds, and writes the partners when given room.
+static int SearchAtom(const eavlBondCellList &cl, int s, const int *cell,
+                      float tolerance, float minDistance2, int *partners)
+{
+    int a = cl.ids[s];
+    const eavlBondCellList::Atom &atom = cl.atoms[s];
+    int n = 0;
+    int ilo = std::max(cell[0]-1,0), ihi = std::min(cell[0]+1,cl.dims[0]-1);
+    for (int k=std::max(cell[2]-1,0); k<=std::min(cell[2]+1,cl.dims[2]-1); k++)
+    {
+        for (int j=std::max(cell[1]-1,0); j<=std::min(cell[1]+1,cl.dims[1]-1); j++)
+        {
+            // the neighboring cells along a row hold a contiguous run of
+            // atoms
+            int begin = cl.cellStart[cl.CellIndex(ilo, j, k)];
+            int end = cl.cellStart[cl.CellIndex(ihi, j, k) + 1];
+            for (int t=begin; t<end; t++)
+            {
+                int b = cl.ids[t];
+                if (b <= a)
+                    continue;
+                const eavlBondCellList::Atom &other = cl.atoms[t];
+                float dx = other.x - atom.x;
+                float dy = other.y - atom.y;
+                float dz = other.z - atom.z;
+                float dist2 = dx*dx + dy*dy + dz*dz;
+                float maxDist = atom.r + other.r + tolerance;
+                if (dist2 > minDistance2 && dist2 < maxDist*maxDist)
+                {
+                    if (partners)
+                        partners[n] = b;
+                    ++n;
+                }
+            }
+        }
+    }
+    return n;
+}
+
+eavlBondFinder::eavlBondFinder() : tolerance(0.45f), minDistance(0.4f)
+{
+}
+
+void
+eavlBondFinder::FindBonds(int natoms, const float *x, const float *y,
+                          const float *z, const int *atomicNumbers)
+{
+    bondAtoms.clear();
+    if (natoms <= 0)
+        return;
+
+    // the radius of each atom bounds the longest bond, and so the width
+    // of the cells
+    vector<float> radius(natoms);
+    float maxRadius = 0;
+    for (int a=0; a<natoms; a++)
+    {
+        int e = atomicNumbers[a];
+        if (e < 0 || e > MAX_ELEMENT_NUMBER)
+            e = 0;
+        radius[a] = covalent_radius[e];
+        maxRadius = std::max(maxRadius, radius[a]);
+    }
+    float cutoff = 2*maxRadius + tolerance;
+    if (cutoff <= 0 || cutoff <= minDistance)
+        return;
+
+    const float *pos[3] = {x, y, z};
+    double lo[3], extent[3];
+    for (int d=0; d<3; d++)
+    {
+        float mn = pos[d][0], mx = pos[d][0];
+        for (int a=1; a<natoms; a++)
+        {
+            mn = std::min(mn, pos[d][a]);
+            mx = std::max(mx, pos[d][a]);
+        }
+        lo[d] = mn;
+        extent[d] = double(mx) - double(mn);
+    }
+
+    // cells a little wider than the cutoff, so atoms in bond range are
+    // never more than one cell apart after rounding; sparse atoms get
+    // wider cells so the grid doesn't outgrow them
+    eavlBondCellList cl;
+    double width = cutoff * 1.0001;
+    double maxCells = 8. * natoms + 64.;
+    long long ncells;
+    for (;;)
+    {
+        ncells = 1;
+        for (int d=0; d<3; d++)
+        {
+            cl.dims[d] = int(std::max(1., std::min(extent[d] / width, 1024.)));
+            ncells *= cl.dims[d];
+        }
+        if (ncells <= maxCells)
+            break;
+        width *= 1.25;
+    }
+    double invwidth[3];
+    for (int d=0; d<3; d++)
+        invwidth[d] = (extent[d] > 0) ? cl.dims[d] / extent[d] : 0;
+
+    vector<int> cellOf(natoms);
+#pragma omp parallel for
+    for (int a=0; a<natoms; a++)
+    {
+        int c[3];
+        for (int d=0; d<3; d++)
+        {
+            c[d] = int((pos[d][a] - lo[d]) * invwidth[d]);
+            c[d] = std::max(0, std::min(c[d], cl.dims[d]-1));
+        }
+        cellOf[a] = cl.CellIndex(c[0], c[1], c[2]);
+    }
+
+    // counting sort of the atoms by cell, in index order within each cell
+    cl.cellStart.assign(ncells+1, 0);
+    for (int a=0; a<natoms; a++)
+        ++cl.cellStart[cellOf[a]+1];
+    for (long long c=0; c<ncells; c++)
+        cl.cellStart[c+1] += cl.cellStart[c];
+    vector<int> slotOf(natoms);
+    {
+        vector<int> next(cl.cellStart.begin(), cl.cellStart.end()-1);
+        for (int a=0; a<natoms; a++)
+            slotOf[a] = next[cellOf[a]]++;
+    }
+    cl.ids.resize(natoms);
+    cl.atoms.resize(natoms);
+#pragma omp parallel for
+    for (int a=0; a<natoms; a++)
+    {
+        int s = slotOf[a];
+        cl.ids[s] = a;
+        cl.atoms[s].x = x[a];
+        cl.atoms[s].y = y[a];
+        cl.atoms[s].z = z[a];
+        cl.atoms[s].r = radius[a];
+    }
+
+    // count the bonds of each atom to higher atoms, then place them; the
+    // atoms are visited cell by cell so neighboring cells stay in cache
+    float minDistance2 = minDistance * minDistance;
+    int nc = int(ncells);
+    vector<int> count(natoms);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (int c=0; c<nc; c++)
+    {
+        int cell[3] = {c % cl.dims[0], (c / cl.dims[0]) % cl.dims[1],
+                       c / (cl.dims[0] * cl.dims[1])};
+        for (int s=cl.cellStart[c]; s<cl.cellStart[c+1]; s++)
+            count[cl.ids[s]] = SearchAtom(cl, s, cell, tolerance,
+                                          minDistance2, NULL);
+    }
+
+    vector<long long> start(natoms+1, 0);
+    for (int a=0; a<natoms; a++)
+        start[a+1] = start[a] + count[a];
+    // the bond cell set holds three values per bond
+    if (sizeof(eavlIndex) < sizeof(long long) && start[natoms] > INT_MAX / 3)
+        THROW(eavlException, "Too many bonds for 32-bit indices");
+    bondAtoms.resize(start[natoms] * 2);
+
+#pragma omp parallel
+    {
+        vector<int> partners;
+#pragma omp for schedule(dynamic, 256)
+        for (int c=0; c<nc; c++)
+        {
+            int cell[3] = {c % cl.dims[0], (c / cl.dims[0]) % cl.dims[1],
+                           c / (cl.dims[0] * cl.dims[1])};
+            for (int s=cl.cellStart[c]; s<cl.cellStart[c+1]; s++)
+            {
+                int a = cl.ids[s];
+                if (count[a] == 0)
+                    continue;
+                partners.resize(count[a]);
+                SearchAtom(cl, s, cell, tolerance, minDistance2, &partners[0]);
+                std::sort(partners.begin(), partners.end());
+                for (int i=0; i<count[a]; i++)
+                {
+                    bondAtoms[(start[a]+i)*2 + 0] = a;
+                    bondAtoms[(start[a]+i)*2 + 1] = partners[i];
+                }
+            }
+        }
+    }
+}
+
+void
+eavlBondFinder::FindBonds(eavlDataSet *data, const string &fieldName,
+                          const vector<int> &typeToElement)
+{
+    eavlField *field = data->GetField(fieldName);
+    int natoms = data->GetNumPoints();
+    if (field->GetAssociation() != eavlField::ASSOC_POINTS ||
+        field->GetArray()->GetNumberOfTuples() != natoms)
+        THROW(eavlException, "Bond finding needs a point field for the elements");
+
+    eavlArray *arr = field->GetArray();
+    vector<float> x(natoms), y(natoms), z(natoms);
+    vector<int> elements(natoms);
+    int ntypes = int(typeToElement.size());
+#pragma omp parallel for
+    for (int a=0; a<natoms; a++)
+    {
+        x[a] = float(data->GetPoint(a, 0));
+        y[a] = float(data->GetPoint(a, 1));
+        z[a] = float(data->GetPoint(a, 2));
+        int e = int(arr->GetComponentAsDouble(a, 0));
+        if (ntypes > 0)
+            e = (e >= 0 && e < ntypes) ? typeToElement[e] : 0;
+        elements[a] = e;
+    }
+    if (natoms > 0)
+        FindBonds(natoms, &x[0], &y[0], &z[0], &elements[0]);
+    else
+        bondAtoms.clear();
+}
+
+eavlCellSetExplicit *
+eavlBondFinder::CreateCellSet(const string &name) const
+{
+    eavlIndex nbonds = GetNumBonds();
+    eavlExplicitConnectivity conn;
+    conn.shapetype.resize(nbonds);
+    conn.connectivity.resize(nbonds * 3);
+#pragma omp parallel for
+    for (eavlIndex b=0; b<nbonds; b++)
+    {
+        conn.shapetype[b] = int(EAVL_BEAM);
+        conn.connectivity[b*3 + 0] = 2;
+        conn.connectivity[b*3 + 1] = bondAtoms[b*2 + 0];
+        conn.connectivity[b*3 + 2] = bondAtoms[b*2 + 1];
+    }
+    eavlCellSetExplicit *cells = new eavlCellSetExplicit(name, 1);
+    cells->SetCellNodeConnectivity(conn);
+    return cells;
+}
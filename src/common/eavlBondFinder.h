@@ -0,0 +1,62 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_BOND_FINDER_H
+#define EAVL_BOND_FINDER_H
+
+#include "STL.h"
+#include "eavlDataSet.h"
+#include "eavlCellSetExplicit.h"
+
+// ****************************************************************************
+// Class:  eavlBondFinder
+//
+// Purpose:
+///   Find the bonds between atoms from their covalent radii.  Two atoms
+///   are bonded when their distance d satisfies
+///       minimum distance < d < radius1 + radius2 + tolerance,
+///   with the radii from covalent_radius in eavlAtomicProperties.  The
+///   atoms are binned into a uniform cell list with cells at least as
+///   wide as the longest possible bond, so each atom is tested only
+///   against the atoms of its own and its 26 neighboring cells; the
+///   atoms are searched in parallel, first counting then writing their
+///   bonds.  Bonds are ordered by their lower atom index, then by the
+///   higher one, the same as a search over all pairs in order.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlBondFinder
+{
+  public:
+    eavlBondFinder();
+
+    void SetTolerance(float t)          { tolerance = t; }
+    void SetMinimumDistance(float d)    { minDistance = d; }
+
+    /// Find the bonds between natoms atoms with the given positions and
+    /// atomic numbers; numbers outside the table use the radius of
+    /// element zero.
+    void FindBonds(int natoms, const float *x, const float *y,
+                   const float *z, const int *atomicNumbers);
+
+    /// Find the bonds between the points of a data set, taking the atomic
+    /// number of each point from a point field.  If typeToElement is not
+    /// empty, the field holds a species type instead (as in a LAMMPS
+    /// dump), and typeToElement maps each type to its atomic number.
+    void FindBonds(eavlDataSet *data, const string &fieldName,
+                   const vector<int> &typeToElement = vector<int>());
+
+    eavlIndex GetNumBonds() const { return eavlIndex(bondAtoms.size() / 2); }
+    /// The lower (end 0) or higher (end 1) atom index of a bond.
+    int GetBondAtom(eavlIndex bond, int end) const { return bondAtoms[bond*2 + end]; }
+
+    /// A new cell set holding each bond as a line segment.
+    eavlCellSetExplicit *CreateCellSet(const string &name) const;
+
+  protected:
+    float       tolerance;
+    float       minDistance;
+    vector<int> bondAtoms;
+};
+
+#endif
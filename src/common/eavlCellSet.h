@@ -19,6 +19,8 @@
 //   Jeremy Meredith, Fri Oct 19 16:54:36 EDT 2012
 //   Added reverse connectivity (i.e. get cells attached to a node).
 //
+//   Cell, face, edge and point counts and cell indices are eavlIndex.
+//
 // ****************************************************************************
 
 class eavlCellSet
@@ -27,7 +29,7 @@ class eavlCellSet
     string              name;           ///< e.g. atoms, cells, nodes, faces
     int                 dimensionality; ///< e.g. 0, 1, 2, 3, (more?)
 
-    int                 dataset_numpoints; ///< the number of points in the container data set
+    eavlIndex           dataset_numpoints; ///< the number of points in the container data set
   public:
     eavlCellSet(const string &n, int d) : name(n), dimensionality(d), dataset_numpoints(0) { }
     virtual ~eavlCellSet() { }
@@ -36,25 +38,25 @@ class eavlCellSet
     virtual eavlStream& deserialize(eavlStream &s);
     virtual string GetName() { return name; }
     virtual int GetDimensionality() { return dimensionality; }
-    virtual int GetNumCells() = 0;
-    virtual int GetNumFaces() { return 0; }
-    virtual int GetNumEdges() { return 0; }
-    virtual eavlCell GetCellNodes(int i) = 0;
-    virtual eavlCell GetCellFaces(int)
+    virtual eavlIndex GetNumCells() = 0;
+    virtual eavlIndex GetNumFaces() { return 0; }
+    virtual eavlIndex GetNumEdges() { return 0; }
+    virtual eavlCell GetCellNodes(eavlIndex i) = 0;
+    virtual eavlCell GetCellFaces(eavlIndex)
     {
         eavlCell c;
         c.type=EAVL_OTHER;
         c.numIndices = 0;
         return c;
     }
-    virtual eavlCell GetCellEdges(int)
+    virtual eavlCell GetCellEdges(eavlIndex)
     {
         eavlCell c;
         c.type=EAVL_OTHER;
         c.numIndices = 0;
         return c;
     }
-    virtual eavlCell GetNodeCells(int)
+    virtual eavlCell GetNodeCells(eavlIndex)
     {
         eavlCell c;
         c.type=EAVL_OTHER;
@@ -91,7 +93,7 @@ class eavlCellSet
     /// is to create an empty entry for that extra point (as we
     /// have to do for other missing points already if they don't
     /// happen to be at the tail end of the list).
-    virtual void SetDSNumPoints(int n)
+    virtual void SetDSNumPoints(eavlIndex n)
     {
         dataset_numpoints = n;
     }
@@ -56,11 +56,11 @@ class eavlCellSetAllEdgesOfExplicit : public eavlCellSet
 	return s;
     }
 
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return parent->GetNumEdges();
     }
-    virtual eavlCell GetCellNodes(int edgeindex)
+    virtual eavlCell GetCellNodes(eavlIndex edgeindex)
     {
         const eavlExplicitConnectivity &conn = 
             parent->GetConnectivity(EAVL_NODES_OF_EDGES);
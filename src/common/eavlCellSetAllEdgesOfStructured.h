@@ -52,11 +52,11 @@ class eavlCellSetAllEdgesOfStructured : public eavlCellSet
         PrintVectorSummary(out, regularStructure.cellDims, dimensionality);
         out << endl;
     }
-    virtual int GetNumCells() const
+    virtual eavlIndex GetNumCells() const
     {
         return regularStructure.GetNumEdges();
     }
-    virtual eavlCell GetCellNodes(int edgeindex)
+    virtual eavlCell GetCellNodes(eavlIndex edgeindex)
     {
         eavlCell e;
         e.type = (eavlCellShape)regularStructure.GetEdgeNodes(edgeindex,
@@ -59,11 +59,11 @@ class eavlCellSetAllFacesOfExplicit : public eavlCellSet
 	return s;
     }
 
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return parent->GetNumFaces();
     }
-    virtual eavlCell GetCellNodes(int faceindex)
+    virtual eavlCell GetCellNodes(eavlIndex faceindex)
     {
         const eavlExplicitConnectivity &conn = 
             parent->GetConnectivity(EAVL_NODES_OF_FACES);
@@ -57,11 +57,11 @@ class eavlCellSetAllFacesOfStructured : public eavlCellSet
         PrintVectorSummary(out, regularStructure.cellDims, dimensionality);
         out << endl;
     }
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return regularStructure.GetNumFaces();
     }
-    virtual eavlCell GetCellNodes(int faceindex)
+    virtual eavlCell GetCellNodes(eavlIndex faceindex)
     {
         eavlCell e;
         e.type = (eavlCellShape)regularStructure.GetFaceNodes(faceindex,
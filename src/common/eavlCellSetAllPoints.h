@@ -40,7 +40,7 @@ class eavlCellSetAllPoints : public eavlCellSet
         out << "        dimensionality = "<<dimensionality<<endl;
         out << "        nCells = "<<GetNumCells()<<endl;
     }
-    virtual eavlCell GetCellNodes(int i)
+    virtual eavlCell GetCellNodes(eavlIndex i)
     {
         eavlCell cell;
         cell.type = EAVL_POINT;
@@ -48,7 +48,7 @@ class eavlCellSetAllPoints : public eavlCellSet
         cell.indices[0] = i;
         return cell;
     }
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return dataset_numpoints;
     }
@@ -39,11 +39,11 @@ class eavlCellSetAllQuadTree : public eavlCellSet
 	log->deserialize(s);
 	return s;
     }
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return log->root.GetNumCells(true);
     }
-    virtual eavlCell GetCellNodes(int index)
+    virtual eavlCell GetCellNodes(eavlIndex index)
     {
         //cerr << "ASKING FOR CELL "<<index<<endl;
         eavlCell cell;
@@ -55,19 +55,19 @@ class eavlCellSetAllStructured : public eavlCellSet
         PrintVectorSummary(out, regularStructure.cellDims, dimensionality);
         out << endl;
     }
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return regularStructure.GetNumCells();
     }
-    virtual int GetNumFaces()
+    virtual eavlIndex GetNumFaces()
     {
         return regularStructure.GetNumFaces();
     }
-    virtual int GetNumEdges()
+    virtual eavlIndex GetNumEdges()
     {
         return regularStructure.GetNumEdges();
     }
-    virtual eavlCell GetCellEdges(int index)
+    virtual eavlCell GetCellEdges(eavlIndex index)
     {
         eavlCell c;
         c.type = (eavlCellShape)regularStructure.GetCellEdges(index,
@@ -75,7 +75,7 @@ class eavlCellSetAllStructured : public eavlCellSet
                                                               c.indices);
         return c;
     }
-    virtual eavlCell GetCellFaces(int index)
+    virtual eavlCell GetCellFaces(eavlIndex index)
     {
         eavlCell c;
         c.type = (eavlCellShape)regularStructure.GetCellFaces(index,
@@ -83,7 +83,7 @@ class eavlCellSetAllStructured : public eavlCellSet
                                                               c.indices);
         return c;
     }
-    virtual eavlCell GetCellNodes(int index)
+    virtual eavlCell GetCellNodes(eavlIndex index)
     {
         eavlCell c;
         c.type = (eavlCellShape)regularStructure.GetCellNodes(index,
@@ -91,7 +91,7 @@ class eavlCellSetAllStructured : public eavlCellSet
                                                               c.indices);
         return c;
     }
-    virtual eavlCell GetNodeCells(int index)
+    virtual eavlCell GetNodeCells(eavlIndex index)
     {
         eavlCell c;
         c.type = (eavlCellShape)regularStructure.GetNodeCells(index,
@@ -1,7 +1,195 @@
 // Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
 #include "eavlCellSetExplicit.h"
+#include "eavlRadixSortOp.h"
+#include "eavlThreadPool.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+#include <algorithm>
+#include <climits>
 
-using std::multimap;
+// The edge, face and node-cell connectivity are built by sorting: each
+// cell writes a canonical key for each of its edges (or faces, or nodes)
+// into a slot, the slots are sorted by key, and runs of equal keys are
+// numbered.  The builders are called lazily from inside other operations,
+// so they call the CPU radix sort kernels of eavlRadixSortOp and OpenMP
+// loops directly instead of going through the executor.
+
+static int NumScanBlocks()
+{
+#ifdef HAVE_OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// exclusive scan of n values, which may be done in place; returns the sum
+static long long ExclusiveScan(int n, const int *in, int *out)
+{
+    int nblocks = std::max(1, std::min(NumScanBlocks(), n));
+    vector<long long> partial(nblocks+1, 0);
+#pragma omp parallel for
+    for (int b=0; b<nblocks; b++)
+    {
+        int begin = int((long long)n * b / nblocks);
+        int end = int((long long)n * (b+1) / nblocks);
+        long long sum = 0;
+        for (int i=begin; i<end; i++)
+            sum += in[i];
+        partial[b+1] = sum;
+    }
+    for (int b=0; b<nblocks; b++)
+        partial[b+1] += partial[b];
+#pragma omp parallel for
+    for (int b=0; b<nblocks; b++)
+    {
+        int begin = int((long long)n * b / nblocks);
+        int end = int((long long)n * (b+1) / nblocks);
+        long long running = partial[b];
+        for (int i=begin; i<end; i++)
+        {
+            int v = in[i];
+            out[i] = int(running);
+            running += v;
+        }
+    }
+    return partial[nblocks];
+}
+
+// the builders number cells, slots, nodes, edges and faces with ints even in
+// 64-bit index builds, so they refuse counts past what an int can hold
+static int CheckSlotCount(long long n)
+{
+    if (n > INT_MAX)
+        THROW(eavlException, "Too many entries for the 32-bit "
+                             "derived connectivity builders");
+    return int(n);
+}
+
+// orders slots with the same primary key by their other keys, then by
+// slot, so the first slot of each run of equal keys is the earliest one
+struct eavlSlotLess
+{
+    const int *key1, *key2;
+    eavlSlotLess(const int *k1, const int *k2) : key1(k1), key2(k2) { }
+    bool operator()(unsigned int x, unsigned int y) const
+    {
+        if (key1 && key1[x] != key1[y])
+            return key1[x] < key1[y];
+        if (key2 && key2[x] != key2[y])
+            return key2[x] < key2[y];
+        return x < y;
+    }
+};
+
+// sorts the slots by (key0, key1, key2, slot); key1 and key2 may be NULL.
+// on return, sortedKey0 holds the primary keys in sorted order and
+// perm[i] is the slot in sorted position i.
+static void SortSlots(int n, const unsigned int *key0,
+                      const int *key1, const int *key2,
+                      vector<unsigned int> &sortedKey0,
+                      vector<unsigned int> &perm)
+{
+    sortedKey0.assign(key0, key0 + n);
+    perm.resize(n);
+    if (n == 0)
+        return;
+#pragma omp parallel for
+    for (int i=0; i<n; i++)
+        perm[i] = i;
+
+    // radix sort on the primary key, as eavlRadixSortOp does on the CPU
+    unsigned int *keys = &sortedKey0[0];
+    unsigned int *values = &perm[0];
+#ifdef HAVE_OPENMP
+    int threads = omp_get_max_threads();
+    threads = int(pow(2., floor(log(double(threads))/log(2.))));
+    vector<eavlIndex> index(threads+1);
+    for (int i=0; i<threads; i++)
+        index[i] = eavlIndex((long long)i * n / threads);
+    index[threads] = n;
+#pragma omp parallel for
+    for (int i=0; i<threads; i++)
+        radix_sort(keys, values, index[i], index[i+1], 24);
+    if (threads > 1)
+        keysmerge(keys, values, n, &index[0], threads);
+#else
+    radix_sort(keys, values, 0, n, 24);
+#endif
+
+    // the primary key sort is not stable, so order each run of equal
+    // primary keys by the rest of the key
+    eavlSlotLess less(key1, key2);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i=0; i<n; i++)
+    {
+        if (i > 0 && keys[i] == keys[i-1])
+            continue;
+        int end = i+1;
+        while (end < n && keys[end] == keys[i])
+            ++end;
+        if (end - i > 1)
+            std::sort(values + i, values + end, less);
+    }
+}
+
+// numbers the distinct keys of n slots in the order they first appear;
+// on return itemOfSlot[s] is the number of slot s's key and
+// firstSlotOfItem[i] is the first slot with key number i
+static int NumberUniqueKeys(int n, const unsigned int *key0,
+                            const int *key1, const int *key2,
+                            vector<int> &itemOfSlot,
+                            vector<int> &firstSlotOfItem)
+{
+    vector<unsigned int> sortedKey0, perm;
+    SortSlots(n, key0, key1, key2, sortedKey0, perm);
+
+    // point each slot at the first slot with its key
+    vector<int> owner(n);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i=0; i<n; i++)
+    {
+        int s = perm[i];
+        if (i > 0)
+        {
+            int t = perm[i-1];
+            if (sortedKey0[i] == sortedKey0[i-1] &&
+                (!key1 || key1[s] == key1[t]) &&
+                (!key2 || key2[s] == key2[t]))
+                continue;
+        }
+        int end = i+1;
+        while (end < n && sortedKey0[end] == sortedKey0[i] &&
+               (!key1 || key1[perm[end]] == key1[s]) &&
+               (!key2 || key2[perm[end]] == key2[s]))
+            ++end;
+        for (int j=i; j<end; j++)
+            owner[perm[j]] = s;
+    }
+
+    // number the first slots of each key in slot order
+    itemOfSlot.resize(n);
+#pragma omp parallel for
+    for (int s=0; s<n; s++)
+        itemOfSlot[s] = (owner[s] == s) ? 1 : 0;
+    int nitems = (n > 0) ? ExclusiveScan(n, &itemOfSlot[0], &itemOfSlot[0]) : 0;
+
+    firstSlotOfItem.resize(nitems);
+#pragma omp parallel for
+    for (int s=0; s<n; s++)
+    {
+        if (owner[s] == s)
+            firstSlotOfItem[itemOfSlot[s]] = s;
+    }
+#pragma omp parallel for
+    for (int s=0; s<n; s++)
+    {
+        if (owner[s] != s)
+            itemOfSlot[s] = itemOfSlot[owner[s]];
+    }
+    return nitems;
+}
 
 class eavlEdge
 {
@@ -36,90 +224,165 @@ class eavlEdge
 };
 
 
+static int GetEdgeTable(int shape, signed char (*&edges)[2])
+{
+    switch (shape)
+    {
+      case EAVL_TET:
+        edges = eavlTetEdges;
+        return 6;
+      case EAVL_PYRAMID:
+        edges = eavlPyramidEdges;
+        return 8;
+      case EAVL_WEDGE:
+        edges = eavlWedgeEdges;
+        return 9;
+      case EAVL_HEX:
+        edges = eavlHexEdges;
+        return 12;
+      case EAVL_VOXEL:
+        edges = eavlVoxEdges;
+        return 12;
+      case EAVL_TRI:
+        edges = eavlTriEdges;
+        return 3;
+      case EAVL_QUAD:
+        edges = eavlQuadEdges;
+        return 4;
+      case EAVL_PIXEL:
+        edges = eavlPixelEdges;
+        return 4;
+      default:
+        edges = NULL;
+        return 0;
+    }
+}
+
+// guards the lazy connectivity builds
+static eavlMutex &
+BuildMutex()
+{
+    static eavlMutex mutex;
+    return mutex;
+}
+
+// orders a build's results before the flag announcing them, and the
+// flag before the results are read
+static inline void BuildBarrier()
+{
+#if defined(__GNUC__)
+    __sync_synchronize();
+#endif
+}
+
 void eavlCellSetExplicit::BuildEdgeConnectivity()
 {
-    if (numEdges >= 0)
-        return; // already done!
+    if (!edgesBuilt)
+    {
+        eavlMutexLocker lock(BuildMutex());
+        if (!edgesBuilt)
+        {
+            real_BuildEdgeConnectivity();
+            BuildBarrier();
+            edgesBuilt = true;
+        }
+    }
+    BuildBarrier();
+}
 
-    numEdges = 0;
+void eavlCellSetExplicit::BuildFaceConnectivity()
+{
+    if (!facesBuilt)
+    {
+        eavlMutexLocker lock(BuildMutex());
+        if (!facesBuilt)
+        {
+            real_BuildFaceConnectivity();
+            BuildBarrier();
+            facesBuilt = true;
+        }
+    }
+    BuildBarrier();
+}
 
-    map<eavlEdge,int> mapEdgesToEdgeIDs; ///<\todo: horribly inefficient
+void eavlCellSetExplicit::BuildNodeCellConnectivity()
+{
+    if (!nodeCellsBuilt)
+    {
+        eavlMutexLocker lock(BuildMutex());
+        if (!nodeCellsBuilt)
+        {
+            real_BuildNodeCellConnectivity();
+            BuildBarrier();
+            nodeCellsBuilt = true;
+        }
+    }
+    BuildBarrier();
+}
 
-    cellEdgeConnectivity.shapetype.clear();
-    cellEdgeConnectivity.connectivity.clear();
-    edgeNodeConnectivity.shapetype.clear();
-    edgeNodeConnectivity.connectivity.clear();
+void eavlCellSetExplicit::real_BuildEdgeConnectivity()
+{
+    // one slot per edge of each cell, keyed by its sorted node pair
+    int nCells = CheckSlotCount(GetNumCells());
+    vector<int> cellStart(nCells+1, 0);
+#pragma omp parallel for
+    for (int i=0; i<nCells; i++)
+    {
+        signed char (*edges)[2];
+        cellStart[i] = GetEdgeTable(cellNodeConnectivity.shapetype[i], edges);
+    }
+    int nSlots = CheckSlotCount(ExclusiveScan(nCells, &cellStart[0],
+                                              &cellStart[0]));
+    cellStart[nCells] = nSlots;
 
-    int nCells = GetNumCells();
+    vector<unsigned int> key0(nSlots);
+    vector<int> key1(nSlots);
+#pragma omp parallel for
     for (int i=0; i<nCells; i++)
     {
         eavlCell el = GetCellNodes(i);
-
-        int nedges = 0;
         signed char (*edges)[2];
-        switch (el.type)
-        {
-          case EAVL_TET:
-            edges = eavlTetEdges;
-            nedges = 6;
-            break;
-          case EAVL_PYRAMID:
-            edges = eavlPyramidEdges;
-            nedges = 8;
-            break;
-          case EAVL_WEDGE:
-            edges = eavlWedgeEdges;
-            nedges = 9;
-            break;
-          case EAVL_HEX:
-            edges = eavlHexEdges;
-            nedges = 12;
-            break;
-          case EAVL_VOXEL:
-            edges = eavlVoxEdges;
-            nedges = 12;
-            break;
-          case EAVL_TRI:
-            edges = eavlTriEdges;
-            nedges = 3;
-            break;
-          case EAVL_QUAD:
-            edges = eavlQuadEdges;
-            nedges = 4;
-            break;
-          case EAVL_PIXEL:
-            edges = eavlPixelEdges;
-            nedges = 4;
-            break;
-                
-          default:
-            edges = NULL;
-            break;
-        }
-        cellEdgeConnectivity.shapetype.push_back(cellNodeConnectivity.shapetype[i]);
-        cellEdgeConnectivity.connectivity.push_back(nedges);
+        int nedges = GetEdgeTable(el.type, edges);
         for (int j=0; j<nedges; j++)
         {
             eavlEdge edge(el.indices[edges[j][0]],
                           el.indices[edges[j][1]]);
-            int index = numEdges;
-            if (mapEdgesToEdgeIDs.count(edge) == 0)
-            {
-                mapEdgesToEdgeIDs[edge] = index;
-                numEdges++;
-                edgeNodeConnectivity.shapetype.push_back(EAVL_BEAM);
-                edgeNodeConnectivity.connectivity.push_back(2);
-                edgeNodeConnectivity.connectivity.push_back(edge.a);
-                edgeNodeConnectivity.connectivity.push_back(edge.b);
-            }
-            else
-            {
-                index = mapEdgesToEdgeIDs[edge];
-            }
-            cellEdgeConnectivity.connectivity.push_back(index);
+            key0[cellStart[i]+j] = edge.a;
+            key1[cellStart[i]+j] = edge.b;
         }
     }
 
+    vector<int> edgeOfSlot, firstSlotOfEdge;
+    numEdges = NumberUniqueKeys(nSlots, nSlots ? &key0[0] : NULL,
+                                nSlots ? &key1[0] : NULL, NULL,
+                                edgeOfSlot, firstSlotOfEdge);
+
+    // each cell's edge count followed by its edges
+    cellEdgeConnectivity.shapetype.resize(nCells);
+    cellEdgeConnectivity.connectivity.resize(nSlots + nCells);
+#pragma omp parallel for
+    for (int i=0; i<nCells; i++)
+    {
+        cellEdgeConnectivity.shapetype[i] = cellNodeConnectivity.shapetype[i];
+        int nedges = cellStart[i+1] - cellStart[i];
+        int index = cellStart[i] + i;
+        cellEdgeConnectivity.connectivity[index] = nedges;
+        for (int j=0; j<nedges; j++)
+            cellEdgeConnectivity.connectivity[index+1+j] = edgeOfSlot[cellStart[i]+j];
+    }
+
+    edgeNodeConnectivity.shapetype.resize(numEdges);
+    edgeNodeConnectivity.connectivity.resize(3 * numEdges);
+#pragma omp parallel for
+    for (int e=0; e<numEdges; e++)
+    {
+        int slot = firstSlotOfEdge[e];
+        edgeNodeConnectivity.shapetype[e] = EAVL_BEAM;
+        edgeNodeConnectivity.connectivity[3*e+0] = 2;
+        edgeNodeConnectivity.connectivity[3*e+1] = key0[slot];
+        edgeNodeConnectivity.connectivity[3*e+2] = key1[slot];
+    }
+
     cellEdgeConnectivity.CreateReverseIndex();
     edgeNodeConnectivity.CreateReverseIndex();
 
@@ -226,109 +489,131 @@ class eavlFace
     }
 };
 
-void eavlCellSetExplicit::BuildFaceConnectivity()
+static void GetFaceTables(int shape,
+                          int &ntris, signed char (*&tris)[3],
+                          int &nquads, signed char (*&quads)[4])
 {
-    if (numFaces >= 0)
-        return; // already done!
-
-    numFaces = 0;
-
-    map<eavlFace,int> mapFacesToFaceIDs; ///<\todo: horribly inefficient
+    ntris = 0;
+    tris = NULL;
+    nquads = 0;
+    quads = NULL;
+    switch (shape)
+    {
+      case EAVL_HEX:
+        nquads = 6;
+        quads = eavlHexQuadFaces;
+        break;
+      case EAVL_VOXEL:
+        nquads = 6;
+        quads = eavlVoxQuadFaces;
+        break;
+      case EAVL_TET:
+        ntris = 4;
+        tris = eavlTetTriangleFaces;
+        break;
+      case EAVL_PYRAMID:
+        ntris = 4;
+        tris = eavlPyramidTriangleFaces;
+        nquads = 1;
+        quads = eavlPyramidQuadFaces;
+        break;
+      case EAVL_WEDGE:
+        ntris = 2;
+        tris = eavlWedgeTriangleFaces;
+        nquads = 3;
+        quads = eavlWedgeQuadFaces;
+        break;
+      default:
+        break; // do nothing
+    }
+}
 
-    cellFaceConnectivity.shapetype.clear();
-    cellFaceConnectivity.connectivity.clear();
-    faceNodeConnectivity.shapetype.clear();
-    faceNodeConnectivity.connectivity.clear();
+void eavlCellSetExplicit::real_BuildFaceConnectivity()
+{
+    // one slot per face of each cell, keyed by its three lowest nodes
+    int nCells = CheckSlotCount(GetNumCells());
+    vector<int> cellStart(nCells+1, 0);
+#pragma omp parallel for
+    for (int i=0; i<nCells; i++)
+    {
+        int ntris, nquads;
+        signed char (*tris)[3];
+        signed char (*quads)[4];
+        GetFaceTables(cellNodeConnectivity.shapetype[i],
+                      ntris, tris, nquads, quads);
+        cellStart[i] = ntris + nquads;
+    }
+    int nSlots = CheckSlotCount(ExclusiveScan(nCells, &cellStart[0],
+                                              &cellStart[0]));
+    cellStart[nCells] = nSlots;
 
-    int nCells = GetNumCells();
+    vector<unsigned int> key0(nSlots);
+    vector<int> key1(nSlots), key2(nSlots);
+    vector<eavlFace> faces(nSlots);
+#pragma omp parallel for
     for (int i=0; i<nCells; i++)
     {
         eavlCell el = GetCellNodes(i);
-
-        int ntris = 0;
-        signed char (*tris)[3] = NULL;
-        int nquads = 0;
-        signed char (*quads)[4] = NULL;
-        switch (el.type)
+        int ntris, nquads;
+        signed char (*tris)[3];
+        signed char (*quads)[4];
+        GetFaceTables(el.type, ntris, tris, nquads, quads);
+        for (int f=0; f<ntris+nquads; f++)
         {
-          case EAVL_HEX:
-            nquads = 6;
-            quads = eavlHexQuadFaces;
-            break;
-          case EAVL_VOXEL:
-            nquads = 6;
-            quads = eavlVoxQuadFaces;
-            break;
-          case EAVL_TET:
-            ntris = 4;
-            tris = eavlTetTriangleFaces;
-            break;
-          case EAVL_PYRAMID:
-            ntris = 4;
-            tris = eavlPyramidTriangleFaces;
-            nquads = 1;
-            quads = eavlPyramidQuadFaces;
-            break;
-          case EAVL_WEDGE:
-            ntris = 2;
-            tris = eavlWedgeTriangleFaces;
-            nquads = 3;
-            quads = eavlWedgeQuadFaces;
-            break;
-          default:
-            break; // do nothing
+            int slot = cellStart[i] + f;
+            if (f < ntris)
+                faces[slot] = eavlFace(el.indices[tris[f][0]],
+                                       el.indices[tris[f][1]],
+                                       el.indices[tris[f][2]]);
+            else
+                faces[slot] = eavlFace(el.indices[quads[f-ntris][0]],
+                                       el.indices[quads[f-ntris][1]],
+                                       el.indices[quads[f-ntris][2]],
+                                       el.indices[quads[f-ntris][3]]);
+            key0[slot] = faces[slot].a;
+            key1[slot] = faces[slot].b;
+            key2[slot] = faces[slot].c;
         }
+    }
 
-        cellFaceConnectivity.shapetype.push_back(cellNodeConnectivity.shapetype[i]);
-        cellFaceConnectivity.connectivity.push_back(ntris + nquads);
-        for (int f=0; f<ntris; f++)
-        {
-            eavlFace face(el.indices[tris[f][0]],
-                          el.indices[tris[f][1]],
-                          el.indices[tris[f][2]]);
+    vector<int> faceOfSlot, firstSlotOfFace;
+    numFaces = NumberUniqueKeys(nSlots, nSlots ? &key0[0] : NULL,
+                                nSlots ? &key1[0] : NULL,
+                                nSlots ? &key2[0] : NULL,
+                                faceOfSlot, firstSlotOfFace);
 
-            int index = numFaces;
-            if (mapFacesToFaceIDs.count(face) == 0)
-            {
-                mapFacesToFaceIDs[face] = index;
-                numFaces++;
-                faceNodeConnectivity.shapetype.push_back(EAVL_TRI);
-                faceNodeConnectivity.connectivity.push_back(3);
-                faceNodeConnectivity.connectivity.push_back(face.ids[0]);
-                faceNodeConnectivity.connectivity.push_back(face.ids[1]);
-                faceNodeConnectivity.connectivity.push_back(face.ids[2]);
-            }
-            else
-            {
-                index = mapFacesToFaceIDs[face];
-            }
-            cellFaceConnectivity.connectivity.push_back(index);
-        }
-        for (int f=0; f<nquads; f++)
-        {
-            eavlFace face(el.indices[quads[f][0]],
-                          el.indices[quads[f][1]],
-                          el.indices[quads[f][2]],
-                          el.indices[quads[f][3]]);
+    // each cell's face count followed by its faces
+    cellFaceConnectivity.shapetype.resize(nCells);
+    cellFaceConnectivity.connectivity.resize(nSlots + nCells);
+#pragma omp parallel for
+    for (int i=0; i<nCells; i++)
+    {
+        cellFaceConnectivity.shapetype[i] = cellNodeConnectivity.shapetype[i];
+        int nfaces = cellStart[i+1] - cellStart[i];
+        int index = cellStart[i] + i;
+        cellFaceConnectivity.connectivity[index] = nfaces;
+        for (int f=0; f<nfaces; f++)
+            cellFaceConnectivity.connectivity[index+1+f] = faceOfSlot[cellStart[i]+f];
+    }
 
-            int index = numFaces;
-            if (mapFacesToFaceIDs.count(face) == 0)
-            {
-                mapFacesToFaceIDs[face] = index;
-                numFaces++;
-                faceNodeConnectivity.shapetype.push_back(EAVL_QUAD);
-                faceNodeConnectivity.connectivity.push_back(4);
-                faceNodeConnectivity.connectivity.push_back(face.ids[0]);
-                faceNodeConnectivity.connectivity.push_back(face.ids[1]);
-                faceNodeConnectivity.connectivity.push_back(face.ids[2]);
-                faceNodeConnectivity.connectivity.push_back(face.ids[3]);
-            }
-            else
-            {
-                index = mapFacesToFaceIDs[face];
-            }
-            cellFaceConnectivity.connectivity.push_back(index);
-        }
+    // each face's nodes as ordered by the first cell that has it
+    vector<int> faceStart(numFaces+1, 0);
+#pragma omp parallel for
+    for (int e=0; e<numFaces; e++)
+        faceStart[e] = faces[firstSlotOfFace[e]].n + 1;
+    int faceConnSize = CheckSlotCount(ExclusiveScan(numFaces, &faceStart[0],
+                                                    &faceStart[0]));
+
+    faceNodeConnectivity.shapetype.resize(numFaces);
+    faceNodeConnectivity.connectivity.resize(faceConnSize);
+#pragma omp parallel for
+    for (int e=0; e<numFaces; e++)
+    {
+        const eavlFace &face = faces[firstSlotOfFace[e]];
+        faceNodeConnectivity.shapetype[e] = (face.n == 3) ? EAVL_TRI : EAVL_QUAD;
+        faceNodeConnectivity.connectivity[faceStart[e]] = face.n;
+        for (int j=0; j<face.n; j++)
+            faceNodeConnectivity.connectivity[faceStart[e]+1+j] = face.ids[j];
     }
 
     cellFaceConnectivity.CreateReverseIndex();
@@ -341,54 +626,65 @@ void eavlCellSetExplicit::BuildFaceConnectivity()
     //faceNodeConnectivity.PrintSummary(cout);
 }
 
-void eavlCellSetExplicit::BuildNodeCellConnectivity()
+void eavlCellSetExplicit::real_BuildNodeCellConnectivity()
 {
-    nodeCellConnectivity.shapetype.clear();
-    nodeCellConnectivity.connectivity.clear();
-
-    multimap<int,int> cells_of_nodes;
-
-    int maxNodeID = 0;
-    int numCells = GetNumCells();
-    for (int cell = 0, cindex = 0; cell < numCells; ++cell)
+    // one slot per node of each cell, keyed by the node
+    int numCells = CheckSlotCount(GetNumCells());
+    int nSlots = CheckSlotCount(
+        (long long)cellNodeConnectivity.connectivity.size() - numCells);
+    vector<unsigned int> key0(nSlots);
+    vector<int> cellOfSlot(nSlots);
+    int maxNodeID = -1;
+#pragma omp parallel for reduction(max:maxNodeID)
+    for (int cell = 0; cell < numCells; ++cell)
     {
-        int npts = cellNodeConnectivity.connectivity[cindex++];
+        int cindex = cellNodeConnectivity.mapCellToIndex[cell];
+        int npts = cellNodeConnectivity.connectivity[cindex];
+        int slot = cindex - cell;
         for (int pt=0; pt<npts; ++pt)
         {
-            int index = cellNodeConnectivity.connectivity[cindex++];
+            int index = cellNodeConnectivity.connectivity[cindex + 1 + pt];
             if (index > maxNodeID)
                 maxNodeID = index;
-            cells_of_nodes.insert(pair<int,int>(index,cell));
+            key0[slot + pt] = index;
+            cellOfSlot[slot + pt] = cell;
         }
     }
 
-    int filled_array_to_node = 0;
-    int cur_node_connstart = 0;
-    for (multimap<int,int>::iterator iter = cells_of_nodes.begin();
-         iter != cells_of_nodes.end(); iter++)
+    // sorting by node, then slot, lists the cells of each node in order
+    vector<unsigned int> sortedNodes, perm;
+    SortSlots(nSlots, nSlots ? &key0[0] : NULL, NULL, NULL,
+              sortedNodes, perm);
+
+    // nodes not referenced by our cells get an empty list
+    int numNodes = std::max(maxNodeID + 1, CheckSlotCount(dataset_numpoints));
+    vector<int> nodeStart(numNodes+1, 0);
+#pragma omp parallel for schedule(dynamic, 4096)
+    for (int i=0; i<nSlots; i++)
     {
-        int node = iter->first;
-        while (filled_array_to_node <= node)
-        {
-            // add empty spots to skip nodes not referenced by our cells
-            // but also create an empty one that we can start adding
-            // connectivity items to for ones that are referenced.
-            ++filled_array_to_node;
-            nodeCellConnectivity.shapetype.push_back(EAVL_POINT);
-            cur_node_connstart = nodeCellConnectivity.connectivity.size();
-            nodeCellConnectivity.connectivity.push_back(0);
-        }
-        int cell = iter->second;
-        nodeCellConnectivity.connectivity.push_back(cell);
-        ++nodeCellConnectivity.connectivity[cur_node_connstart];
+        if (i > 0 && sortedNodes[i] == sortedNodes[i-1])
+            continue;
+        int end = i+1;
+        while (end < nSlots && sortedNodes[end] == sortedNodes[i])
+            ++end;
+        nodeStart[sortedNodes[i]] = end - i;
     }
-    while (filled_array_to_node < dataset_numpoints)
+    ExclusiveScan(numNodes, &nodeStart[0], &nodeStart[0]);
+    nodeStart[numNodes] = nSlots;
+
+    // each node's cell count followed by its cells
+    nodeCellConnectivity.shapetype.resize(numNodes);
+    nodeCellConnectivity.connectivity.resize(nSlots + numNodes);
+#pragma omp parallel for
+    for (int node = 0; node < numNodes; ++node)
     {
-        // add empty spots for tail nodes not referenced by our cells
-        ++filled_array_to_node;
-        nodeCellConnectivity.shapetype.push_back(EAVL_POINT);
-        cur_node_connstart = nodeCellConnectivity.connectivity.size();
-        nodeCellConnectivity.connectivity.push_back(0);
+        nodeCellConnectivity.shapetype[node] = EAVL_POINT;
+        int ncells = nodeStart[node+1] - nodeStart[node];
+        int index = nodeStart[node] + node;
+        nodeCellConnectivity.connectivity[index] = ncells;
+        for (int c=0; c<ncells; ++c)
+            nodeCellConnectivity.connectivity[index+1+c] =
+                cellOfSlot[perm[nodeStart[node] + c]];
     }
 
     nodeCellConnectivity.CreateReverseIndex();
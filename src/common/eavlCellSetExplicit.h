@@ -22,6 +22,16 @@
 //   Jeremy Meredith, Fri Oct 19 16:54:36 EDT 2012
 //   Added reverse connectivity (i.e. get cells attached to a node).
 //
+//   Build the edge, face and node-cell connectivity by sorting canonical
+//   keys for every cell's edges, faces or nodes in parallel and numbering
+//   the runs of equal keys, instead of inserting them into std::maps.
+//   The numbering is unchanged: edges and faces are numbered in the order
+//   cells first use them, and each node lists its cells in order.
+//
+//   The lazy builds are serialized, and each is done once until the cell
+//   node connectivity is replaced, since operations running concurrently
+//   may both ask for the same connectivity.
+//
 // ****************************************************************************
 
 class eavlCellSetExplicit : public eavlCellSet
@@ -42,23 +52,41 @@ class eavlCellSetExplicit : public eavlCellSet
     int numEdges;
     int numFaces;
 
+    volatile bool edgesBuilt;
+    volatile bool facesBuilt;
+    volatile bool nodeCellsBuilt;
+
     void BuildEdgeConnectivity();
     void BuildFaceConnectivity();
     void BuildNodeCellConnectivity();
+    void real_BuildEdgeConnectivity();
+    void real_BuildFaceConnectivity();
+    void real_BuildNodeCellConnectivity();
   public:
-    eavlCellSetExplicit() : eavlCellSet("", 0) {}
+    eavlCellSetExplicit()
+        : eavlCellSet("", 0),
+          numEdges(-1),
+          numFaces(-1),
+          edgesBuilt(false),
+          facesBuilt(false),
+          nodeCellsBuilt(false)
+    {
+    }
     eavlCellSetExplicit(const string &n, int d)
         : eavlCellSet(n,d),
           numEdges(-1),
-          numFaces(-1)
+          numFaces(-1),
+          edgesBuilt(false),
+          facesBuilt(false),
+          nodeCellsBuilt(false)
     {
     }
     virtual string className() const {return "eavlCellSetExplicit";}
     virtual eavlStream& serialize(eavlStream &s) const;
     virtual eavlStream& deserialize(eavlStream &s);
-    virtual int GetNumCells() { return cellNodeConnectivity.shapetype.size(); }
-    virtual int GetNumEdges() { BuildEdgeConnectivity(); return numEdges; }
-    virtual int GetNumFaces() { BuildFaceConnectivity(); return numFaces; }
+    virtual eavlIndex GetNumCells() { return cellNodeConnectivity.shapetype.size(); }
+    virtual eavlIndex GetNumEdges() { BuildEdgeConnectivity(); return numEdges; }
+    virtual eavlIndex GetNumFaces() { BuildFaceConnectivity(); return numFaces; }
     virtual void PrintSummary(ostream &out)
     {
         out << "    eavlCellSetExplicit:\n";
@@ -77,6 +105,9 @@ class eavlCellSetExplicit : public eavlCellSet
         cellNodeConnectivity.CreateReverseIndex();
         numEdges = -1;
         numFaces = -1;
+        edgesBuilt = false;
+        facesBuilt = false;
+        nodeCellsBuilt = false;
     }
     eavlExplicitConnectivity &GetConnectivity(eavlTopology topology)
     {
@@ -109,43 +140,43 @@ class eavlCellSetExplicit : public eavlCellSet
         }
         THROW(eavlException,"unexpected topology type in GetConnectivity");
     }
-    virtual eavlCell GetCellNodes(int i)
+    virtual eavlCell GetCellNodes(eavlIndex i)
     {
         eavlCell cell;
-        int index = cellNodeConnectivity.mapCellToIndex[i];
+        eavlIndex index = cellNodeConnectivity.mapCellToIndex[i];
         cell.type = (eavlCellShape)cellNodeConnectivity.shapetype[i];
         cell.numIndices = cellNodeConnectivity.connectivity[index];
         for (int n=0; n<cell.numIndices; n++)
             cell.indices[n] = cellNodeConnectivity.connectivity[index + 1 + n];
         return cell;
     }
-    virtual eavlCell GetNodeCells(int i)
+    virtual eavlCell GetNodeCells(eavlIndex i)
     {
         BuildNodeCellConnectivity();
         eavlCell cell;
-        int index = nodeCellConnectivity.mapCellToIndex[i];
+        eavlIndex index = nodeCellConnectivity.mapCellToIndex[i];
         cell.type = (eavlCellShape)nodeCellConnectivity.shapetype[i];
         cell.numIndices = nodeCellConnectivity.connectivity[index];
         for (int n=0; n<cell.numIndices; n++)
             cell.indices[n] = nodeCellConnectivity.connectivity[index + 1 + n];
         return cell;
     }
-    virtual eavlCell GetCellEdges(int i)
+    virtual eavlCell GetCellEdges(eavlIndex i)
     {
         BuildEdgeConnectivity();
         eavlCell cell;
-        int index = cellEdgeConnectivity.mapCellToIndex[i];
+        eavlIndex index = cellEdgeConnectivity.mapCellToIndex[i];
         cell.type = (eavlCellShape)cellEdgeConnectivity.shapetype[i];
         cell.numIndices = cellEdgeConnectivity.connectivity[index];
         for (int n=0; n<cell.numIndices; n++)
             cell.indices[n] = cellEdgeConnectivity.connectivity[index + 1 + n];
         return cell;
     }
-    virtual eavlCell GetCellFaces(int i)
+    virtual eavlCell GetCellFaces(eavlIndex i)
     {
         BuildFaceConnectivity();
         eavlCell cell;
-        int index = cellFaceConnectivity.mapCellToIndex[i];
+        eavlIndex index = cellFaceConnectivity.mapCellToIndex[i];
         cell.type = (eavlCellShape)cellFaceConnectivity.shapetype[i];
         cell.numIndices = cellFaceConnectivity.connectivity[index];
         for (int n=0; n<cell.numIndices; n++)
@@ -160,7 +191,7 @@ class eavlCellSetExplicit : public eavlCellSet
         mem += sizeof(vector<int>);
         mem += cellNodeConnectivity.connectivity.size() * sizeof(int);
         mem += sizeof(vector<int>);
-        mem += cellNodeConnectivity.mapCellToIndex.size() * sizeof(int);
+        mem += cellNodeConnectivity.mapCellToIndex.size() * sizeof(eavlIndex);
         ///\todo: update this (e.g. with edge, face connectivity)
         return mem + eavlCellSet::GetMemoryUsage();
     }
@@ -190,6 +221,9 @@ inline eavlStream& eavlCellSetExplicit::deserialize(eavlStream &s)
     edgeNodeConnectivity.deserialize(s);
     cellFaceConnectivity.deserialize(s);
     faceNodeConnectivity.deserialize(s);
+    edgesBuilt = numEdges >= 0;
+    facesBuilt = numFaces >= 0;
+    nodeCellsBuilt = false;
     return s;
 }
 
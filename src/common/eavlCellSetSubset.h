@@ -68,11 +68,11 @@ class eavlCellSetSubset : public eavlCellSet
         PrintVectorSummary(out, subset);
         out << endl;
     }
-    virtual int GetNumCells()
+    virtual eavlIndex GetNumCells()
     {
         return subset.size();
     }
-    virtual eavlCell GetCellNodes(int index)
+    virtual eavlCell GetCellNodes(eavlIndex index)
     {
         return parent->GetCellNodes(subset[index]);
     }
@@ -1,10 +1,68 @@
 // Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
 // This file contains code from VisIt, (c) 2000-2012 LLNS.  See COPYRIGHT.txt.
 #include "eavlCompositor.h"
+#include "eavlException.h"
 
 #include "STL.h"
+#include <string.h>
 
 #ifdef HAVE_MPI
+
+eavlCompositor::Algorithm eavlCompositor::algorithm = eavlCompositor::Reduce;
+int  eavlCompositor::radix = 4;
+bool eavlCompositor::backgroundEncoding = false;
+bool eavlCompositor::blending = false;
+
+void
+eavlCompositor::SetAlgorithm(Algorithm a)
+{
+    algorithm = a;
+}
+
+eavlCompositor::Algorithm
+eavlCompositor::GetAlgorithm()
+{
+    return algorithm;
+}
+
+void
+eavlCompositor::SetRadix(int k)
+{
+    if (k < 2)
+        THROW(eavlException, "Radix-k compositing needs a radix of at least 2.");
+    radix = k;
+}
+
+int
+eavlCompositor::GetRadix()
+{
+    return radix;
+}
+
+void
+eavlCompositor::SetBackgroundEncoding(bool e)
+{
+    backgroundEncoding = e;
+}
+
+bool
+eavlCompositor::GetBackgroundEncoding()
+{
+    return backgroundEncoding;
+}
+
+void
+eavlCompositor::SetBlending(bool b)
+{
+    blending = b;
+}
+
+bool
+eavlCompositor::GetBlending()
+{
+    return blending;
+}
+
 // ****************************************************************************
 // Method:  ParallelZComposite
 //
@@ -21,6 +79,9 @@
 // Creation:    January 24, 2013
 //
 // Modifications:
+//   Added the binary-swap and radix-k algorithms, run-length encoding of
+//   background pixels, and depth-ordered alpha blending, selected through
+//   eavlCompositor.
 // ****************************************************************************
 
 struct Pixel
@@ -34,61 +95,120 @@ struct Pixel
 
 static MPI_Datatype  mpiTypePixel;
 static MPI_Op        mpiOpMergePixelBuffers;
+static MPI_Op        mpiOpBlendPixelBuffers;
 static unsigned char local_bg[3];
 
+// message tags for folding ranks into the others, and for the first of
+// the binary-swap and radix-k rounds (later rounds add their index)
+static const int compositeFoldTag = 4700;
+static const int compositeRoundTag = 4701;
 
-static void
-MergePixelBuffersOp(void *ibuf, void *iobuf, int *count, MPI_Datatype *)
+static inline void
+MergePixel(const Pixel &in, Pixel &inout)
 {
-    Pixel *in_pixels    = (Pixel *) ibuf;
-    Pixel *inout_pixels = (Pixel *) iobuf;
-
-    const int amount = *count;
     const unsigned char local_bg_r = local_bg[0];
     const unsigned char local_bg_g = local_bg[1];
     const unsigned char local_bg_b = local_bg[2];
 
-    for (int i = 0; i < amount; i++)
+    if ( in.z < inout.z )
+    {
+        inout = in;
+    }
+    else if (in.z == inout.z)
     {
-        ///\todo: since we have alpha, do we want to do some
-        /// smarter sort of blending based on Z values?
-        /// this code assumes full opacity.
-        if ( in_pixels[i].z < inout_pixels[i].z )
+        if ((inout.r == local_bg_r) &&
+            (inout.g == local_bg_g) &&
+            (inout.b == local_bg_b))
         {
-            inout_pixels[i] = in_pixels[i];
+            // Since 'inout' is background color, take whatever
+            // is in 'in' even if it too is background color
+            inout.r = in.r;
+            inout.g = in.g;
+            inout.b = in.b;
+            inout.a = in.a;
         }
-        else if (in_pixels[i].z == inout_pixels[i].z)
+        else if ((in.r != local_bg_r) || 
+                 (in.g != local_bg_g) || 
+                 (in.b != local_bg_b))
         {
-            if ((inout_pixels[i].r == local_bg_r) &&
-                (inout_pixels[i].g == local_bg_g) &&
-                (inout_pixels[i].b == local_bg_b))
-            {
-                // Since 'inout' is background color, take whatever
-                // is in 'in' even if it too is background color
-                inout_pixels[i].r = in_pixels[i].r;
-                inout_pixels[i].g = in_pixels[i].g;
-                inout_pixels[i].b = in_pixels[i].b;
-                inout_pixels[i].a = in_pixels[i].a;
-            }
-            else if ((in_pixels[i].r != local_bg_r) || 
-                     (in_pixels[i].g != local_bg_g) || 
-                     (in_pixels[i].b != local_bg_b))
-            {
-                // Neither 'inout' nor 'in' is the background color.
-                // So, average them.
-                float newr = float(in_pixels[i].r) + float(inout_pixels[i].r); 
-                float newg = float(in_pixels[i].g) + float(inout_pixels[i].g); 
-                float newb = float(in_pixels[i].b) + float(inout_pixels[i].b); 
-                float newa = float(in_pixels[i].a) + float(inout_pixels[i].a); 
-                inout_pixels[i].r = (unsigned char) (newr * 0.5); 
-                inout_pixels[i].g = (unsigned char) (newg * 0.5);
-                inout_pixels[i].b = (unsigned char) (newb * 0.5); 
-                inout_pixels[i].a = (unsigned char) (newa * 0.5); 
-            }
+            // Neither 'inout' nor 'in' is the background color.
+            // So, average them.
+            float newr = float(in.r) + float(inout.r); 
+            float newg = float(in.g) + float(inout.g); 
+            float newb = float(in.b) + float(inout.b); 
+            float newa = float(in.a) + float(inout.a); 
+            inout.r = (unsigned char) (newr * 0.5); 
+            inout.g = (unsigned char) (newg * 0.5);
+            inout.b = (unsigned char) (newb * 0.5); 
+            inout.a = (unsigned char) (newa * 0.5); 
         }
     }
 }
 
+// blend the nearer pixel over the farther one; fully transparent pixels
+// don't contribute, even their depth
+static inline void
+BlendPixel(const Pixel &in, Pixel &inout)
+{
+    Pixel front = in, back = inout;
+    if (inout.z < in.z)
+    {
+        front = inout;
+        back = in;
+    }
+    if (front.a == 0)
+    {
+        inout = back;
+        return;
+    }
+    if (back.a == 0)
+    {
+        inout = front;
+        return;
+    }
+    float af = front.a / 255.f;
+    float ab = back.a / 255.f * (1.f - af);
+    float a = af + ab;
+    inout.z = front.z;
+    inout.r = (unsigned char)((front.r * af + back.r * ab) / a + 0.5f);
+    inout.g = (unsigned char)((front.g * af + back.g * ab) / a + 0.5f);
+    inout.b = (unsigned char)((front.b * af + back.b * ab) / a + 0.5f);
+    inout.a = (unsigned char)(a * 255.f + 0.5f);
+}
+
+// pixels which merging or blending into another leaves it unchanged
+// (apart, when not blending, from the alpha of a background pixel)
+static inline bool
+IsBackgroundPixel(const Pixel &p, bool blend)
+{
+    if (blend)
+        return p.a == 0;
+    return p.z >= 1.f &&
+           p.r == local_bg[0] && p.g == local_bg[1] && p.b == local_bg[2];
+}
+
+static void
+MergePixelBuffersOp(void *ibuf, void *iobuf, int *count, MPI_Datatype *)
+{
+    Pixel *in_pixels    = (Pixel *) ibuf;
+    Pixel *inout_pixels = (Pixel *) iobuf;
+
+    const int amount = *count;
+    for (int i = 0; i < amount; i++)
+        MergePixel(in_pixels[i], inout_pixels[i]);
+}
+
+static void
+BlendPixelBuffersOp(void *ibuf, void *iobuf, int *count, MPI_Datatype *)
+{
+    Pixel *in_pixels    = (Pixel *) ibuf;
+    Pixel *inout_pixels = (Pixel *) iobuf;
+
+    const int amount = *count;
+    for (int i = 0; i < amount; i++)
+        BlendPixel(in_pixels[i], inout_pixels[i]);
+}
+
 
 static void 
 InitializeMPIStuff(void)
@@ -104,29 +224,332 @@ InitializeMPIStuff(void)
 
     // create the MPI data type for Pixel
     Pixel onePixel;
-    MPI_Address(&onePixel.z, &displacements[0]);
-    MPI_Address(&onePixel.r, &displacements[1]);
-    MPI_Address(&onePixel.g, &displacements[2]);
-    MPI_Address(&onePixel.b, &displacements[3]);
-    MPI_Address(&onePixel.a, &displacements[4]);
+    MPI_Get_address(&onePixel.z, &displacements[0]);
+    MPI_Get_address(&onePixel.r, &displacements[1]);
+    MPI_Get_address(&onePixel.g, &displacements[2]);
+    MPI_Get_address(&onePixel.b, &displacements[3]);
+    MPI_Get_address(&onePixel.a, &displacements[4]);
     for (int i = n-1; i >= 0; i--)
         displacements[i] -= displacements[0];
-    MPI_Type_struct(n, lengths, displacements, types,
-                    &mpiTypePixel);
+    MPI_Type_create_struct(n, lengths, displacements, types,
+                           &mpiTypePixel);
     MPI_Type_commit(&mpiTypePixel);
 
     // and the merge operation for a reduction
     MPI_Op_create((MPI_User_function *)MergePixelBuffersOp, 1,
                   &mpiOpMergePixelBuffers);
+    // blending is not commutative across ranks; it is only correct when
+    // contiguous ranges of ranks are combined, which MPI guarantees for
+    // a non-commutative operation
+    MPI_Op_create((MPI_User_function *)BlendPixelBuffersOp, 0,
+                  &mpiOpBlendPixelBuffers);
 }
 
 static void
 FinalizeMPIStuff(void)
 {
+    MPI_Op_free(&mpiOpBlendPixelBuffers);
     MPI_Op_free(&mpiOpMergePixelBuffers);
     MPI_Type_free(&mpiTypePixel);
 }
 
+static void
+CheckMPIError(int err)
+{
+    if (err == MPI_SUCCESS)
+        return;
+    char err_buffer[MPI_MAX_ERROR_STRING];
+    int resultlen;
+    MPI_Error_string(err, err_buffer, &resultlen);
+    THROW(eavlException, std::string("Compositing failed: ") + err_buffer);
+}
+
+// ****************************************************************************
+// Function:  EncodePixels
+//
+// Purpose:
+///   Pack "n" pixels into a message.  With run-length encoding, the message
+///   is a sequence of runs, each a count of background pixels to skip and
+///   a count of pixels which follow; otherwise it is the raw pixels.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+static void
+EncodePixels(const Pixel *pixels, int n, bool encode, bool blend,
+             std::vector<char> &msg)
+{
+    if (!encode)
+    {
+        msg.resize(n * sizeof(Pixel));
+        if (n > 0)
+            memcpy(&msg[0], pixels, n * sizeof(Pixel));
+        return;
+    }
+
+    msg.clear();
+    int i = 0;
+    while (i < n)
+    {
+        int skip = 0;
+        while (i < n && IsBackgroundPixel(pixels[i], blend))
+        {
+            ++skip;
+            ++i;
+        }
+        int count = 0;
+        while (i + count < n && !IsBackgroundPixel(pixels[i + count], blend))
+            ++count;
+        size_t pos = msg.size();
+        msg.resize(pos + 2 * sizeof(int) + count * sizeof(Pixel));
+        memcpy(&msg[pos], &skip, sizeof(int));
+        memcpy(&msg[pos + sizeof(int)], &count, sizeof(int));
+        if (count > 0)
+            memcpy(&msg[pos + 2 * sizeof(int)], pixels + i,
+                   count * sizeof(Pixel));
+        i += count;
+    }
+}
+
+// ****************************************************************************
+// Function:  MergeEncodedPixels
+//
+// Purpose:
+///   Merge (or blend) a message from EncodePixels into "n" pixels.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+static void
+MergeEncodedPixels(const std::vector<char> &msg, bool encoded, bool blend,
+                   Pixel *pixels, int n)
+{
+    const char *ptr = msg.empty() ? NULL : &msg[0];
+    const char *msgend = ptr + msg.size();
+    int i = 0;
+    while (ptr < msgend)
+    {
+        int count;
+        if (encoded)
+        {
+            int skip;
+            memcpy(&skip, ptr, sizeof(int));
+            memcpy(&count, ptr + sizeof(int), sizeof(int));
+            ptr += 2 * sizeof(int);
+            i += skip;
+        }
+        else
+        {
+            count = (msgend - ptr) / sizeof(Pixel);
+        }
+        if (i + count > n)
+            THROW(eavlException, "Compositing message overruns its region.");
+        const Pixel *in = (const Pixel *)ptr;
+        if (blend)
+        {
+            for (int j = 0; j < count; j++)
+                BlendPixel(in[j], pixels[i + j]);
+        }
+        else
+        {
+            for (int j = 0; j < count; j++)
+                MergePixel(in[j], pixels[i + j]);
+        }
+        ptr += count * sizeof(Pixel);
+        i += count;
+    }
+}
+
+// piece "j" of "k" nearly equal pieces of [lo,hi)
+static void
+SplitRegion(int lo, int hi, int k, int j, int &plo, int &phi)
+{
+    long long n = hi - lo;
+    plo = lo + int(n * j / k);
+    phi = lo + int(n * (j + 1) / k);
+}
+
+// the part of the image a rank composites after every round
+static void
+FinalRegion(int rank, int npixels, const std::vector<int> &factors,
+            int &lo, int &hi)
+{
+    lo = 0;
+    hi = npixels;
+    int stride = 1;
+    for (size_t r = 0; r < factors.size(); r++)
+    {
+        int k = factors[r];
+        SplitRegion(lo, hi, k, (rank / stride) % k, lo, hi);
+        stride *= k;
+    }
+}
+
+// Factor "n" into as few rounds as possible, each with at most "radix"
+// ranks per group.  A prime factor larger than the radix is its own round.
+static std::vector<int>
+RadixKFactors(int n, int radix)
+{
+    std::vector<int> primes;
+    for (int p = 2; p * p <= n; p++)
+    {
+        while (n % p == 0)
+        {
+            primes.push_back(p);
+            n /= p;
+        }
+    }
+    if (n > 1)
+        primes.push_back(n);
+
+    std::vector<int> factors;
+    for (int i = (int)primes.size() - 1; i >= 0; i--)
+    {
+        size_t f = 0;
+        while (f < factors.size() && factors[f] * primes[i] > radix)
+            ++f;
+        if (f < factors.size())
+            factors[f] *= primes[i];
+        else
+            factors.push_back(primes[i]);
+    }
+    return factors;
+}
+
+static inline int
+ParticipantRank(int participant, int extra)
+{
+    return (participant < extra) ? 2 * participant : participant + extra;
+}
+
+// ****************************************************************************
+// Function:  ExchangeComposite
+//
+// Purpose:
+///   Composite "pixels" (the whole image on every rank) in rounds.  In
+///   each round, ranks form groups of factors[r]; each splits the part of
+///   the image its group shares into one piece per member, sends every
+///   other member its piece, and merges the pieces it receives into its
+///   own.  Groups are always contiguous ranges of ranks.  When there are
+///   more ranks than product(factors) (for binary swap), the extra ranks
+///   first fold their images into their lower neighbors, so each of the
+///   remaining participants still stands for a contiguous range.
+///   Afterward the pieces are gathered so every rank has the composited
+///   image.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+static void
+ExchangeComposite(const MPI_Comm &comm, std::vector<Pixel> &pixels,
+                  const std::vector<int> &factors, bool encode, bool blend)
+{
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    int npixels = pixels.size();
+    int nparticipants = 1;
+    for (size_t r = 0; r < factors.size(); r++)
+        nparticipants *= factors[r];
+
+    // the first 2*extra ranks fold pairwise; participant p is rank 2p
+    // for p < extra, and rank p+extra after that
+    int extra = size - nparticipants;
+    int participant = -1;
+    if (rank >= 2 * extra)
+        participant = rank - extra;
+    else if (rank % 2 == 0)
+        participant = rank / 2;
+
+    std::vector<char> sendmsg, recvmsg;
+    if (participant < 0)
+    {
+        EncodePixels(&pixels[0], npixels, encode, blend, sendmsg);
+        CheckMPIError(MPI_Send(sendmsg.empty() ? NULL : &sendmsg[0],
+                               sendmsg.size(), MPI_BYTE,
+                               rank - 1, compositeFoldTag, comm));
+    }
+    else if (rank < 2 * extra)
+    {
+        MPI_Status status;
+        int nbytes;
+        CheckMPIError(MPI_Probe(rank + 1, compositeFoldTag, comm, &status));
+        MPI_Get_count(&status, MPI_BYTE, &nbytes);
+        recvmsg.resize(nbytes);
+        CheckMPIError(MPI_Recv(nbytes ? &recvmsg[0] : NULL, nbytes, MPI_BYTE,
+                               rank + 1, compositeFoldTag, comm, &status));
+        MergeEncodedPixels(recvmsg, encode, blend, &pixels[0], npixels);
+    }
+
+    if (participant >= 0)
+    {
+        int lo = 0, hi = npixels, stride = 1;
+        for (size_t r = 0; r < factors.size(); r++)
+        {
+            int k = factors[r];
+            int digit = (participant / stride) % k;
+            int first = participant - digit * stride;
+
+            std::vector< std::vector<char> > sendmsgs(k);
+            std::vector<MPI_Request> requests;
+            for (int j = 0; j < k; j++)
+            {
+                if (j == digit)
+                    continue;
+                int plo, phi;
+                SplitRegion(lo, hi, k, j, plo, phi);
+                EncodePixels(&pixels[0] + plo, phi - plo, encode, blend,
+                             sendmsgs[j]);
+                MPI_Request req;
+                CheckMPIError(MPI_Isend(sendmsgs[j].empty() ? NULL : &sendmsgs[j][0],
+                                        sendmsgs[j].size(), MPI_BYTE,
+                                        ParticipantRank(first + j * stride, extra),
+                                        compositeRoundTag + (int)r, comm, &req));
+                requests.push_back(req);
+            }
+
+            // merge outward from our own digit, so the ranks merged so far
+            // are always a contiguous range
+            int mylo, myhi;
+            SplitRegion(lo, hi, k, digit, mylo, myhi);
+            for (int step = 1; step < k; step++)
+            {
+                int j = (step <= digit) ? digit - step : step;
+                MPI_Status status;
+                int nbytes;
+                int source = ParticipantRank(first + j * stride, extra);
+                CheckMPIError(MPI_Probe(source, compositeRoundTag + (int)r,
+                                        comm, &status));
+                MPI_Get_count(&status, MPI_BYTE, &nbytes);
+                recvmsg.resize(nbytes);
+                CheckMPIError(MPI_Recv(nbytes ? &recvmsg[0] : NULL, nbytes,
+                                       MPI_BYTE, source, compositeRoundTag + (int)r,
+                                       comm, &status));
+                MergeEncodedPixels(recvmsg, encode, blend,
+                                   &pixels[0] + mylo, myhi - mylo);
+            }
+            if (!requests.empty())
+                CheckMPIError(MPI_Waitall(requests.size(), &requests[0],
+                                          MPI_STATUSES_IGNORE));
+            lo = mylo;
+            hi = myhi;
+            stride *= k;
+        }
+    }
+
+    std::vector<int> counts(size, 0), displs(size, 0);
+    for (int p = 0; p < nparticipants; p++)
+    {
+        int lo, hi;
+        FinalRegion(p, npixels, factors, lo, hi);
+        counts[ParticipantRank(p, extra)] = (hi - lo) * sizeof(Pixel);
+        displs[ParticipantRank(p, extra)] = lo * sizeof(Pixel);
+    }
+    CheckMPIError(MPI_Allgatherv(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                                 &pixels[0], &counts[0], &displs[0],
+                                 MPI_BYTE, comm));
+}
+
 void
 ParallelZComposite(const MPI_Comm &comm,
                    int npixels,
@@ -149,6 +572,47 @@ ParallelZComposite(const MPI_Comm &comm,
     local_bg[1] = bgg;
     local_bg[2] = bgb;
 
+    bool blend = eavlCompositor::GetBlending();
+    eavlCompositor::Algorithm algorithm = eavlCompositor::GetAlgorithm();
+    if (algorithm != eavlCompositor::Reduce && npixels > 0)
+    {
+        int size;
+        MPI_Comm_size(comm, &size);
+        std::vector<int> factors;
+        if (algorithm == eavlCompositor::BinarySwap)
+        {
+            for (int n = 2; n <= size; n *= 2)
+                factors.push_back(2);
+        }
+        else
+        {
+            factors = RadixKFactors(size, eavlCompositor::GetRadix());
+        }
+
+        std::vector<Pixel> pixels(npixels);
+        for (int i=0; i<npixels; ++i)
+        {
+            pixels[i].z = inz[i];
+            pixels[i].r = inrgba[i*4 + 0];
+            pixels[i].g = inrgba[i*4 + 1];
+            pixels[i].b = inrgba[i*4 + 2];
+            pixels[i].a = inrgba[i*4 + 3];
+        }
+
+        ExchangeComposite(comm, pixels, factors,
+                          eavlCompositor::GetBackgroundEncoding(), blend);
+
+        for (int i=0; i<npixels; ++i)
+        {
+            outz[i]          = pixels[i].z;
+            outrgba[i*4 + 0] = pixels[i].r;
+            outrgba[i*4 + 1] = pixels[i].g;
+            outrgba[i*4 + 2] = pixels[i].b;
+            outrgba[i*4 + 3] = pixels[i].a;
+        }
+        return;
+    }
+
     //cerr << "merging "<<npixels<<" pixels, bg="<<int(bgr)<<","<<int(bgg)<<","<<int(bgb)<<"\n";
     //cerr << "inpixel[0] = "<<int(inrgba[0])<<","<<int(inrgba[1])<<","<<int(inrgba[2])<<","<<int(inrgba[3])<<"\n";
     //cerr << "inzbuff[0] = "<<inz[0]<<endl;
@@ -168,7 +632,10 @@ ParallelZComposite(const MPI_Comm &comm,
         }
 
         int err = MPI_Allreduce(&inpixels[0],  &outpixels[0], chunk,
-                                mpiTypePixel, mpiOpMergePixelBuffers, comm);
+                                mpiTypePixel,
+                                blend ? mpiOpBlendPixelBuffers
+                                      : mpiOpMergePixelBuffers,
+                                comm);
         if (err != MPI_SUCCESS)
         {
             int errclass;
@@ -6,13 +6,73 @@
 #ifdef HAVE_MPI
 #include "mpi.h"
 
+// ****************************************************************************
+// Class:  eavlCompositor
+//
+// Purpose:
+///   Settings for ParallelZComposite.
+///
+///   The Reduce algorithm merges the images with an MPI_Allreduce.  The
+///   BinarySwap and RadixK algorithms instead split the image among the
+///   ranks over a few rounds, in which each group of ranks exchanges
+///   pieces of its part of the image (two ranks per group for binary
+///   swap, and up to the radix for radix-k), so every rank composites
+///   only 1/P of the pixels, and then gather the pieces on every rank.
+///   Binary swap first folds the ranks beyond the largest power of two
+///   into the others.
+///
+///   With background encoding, the pieces exchanged are run-length
+///   encoded so background pixels are not sent.  Background pixels are
+///   those at the far depth (1) with the background color, or, when
+///   blending, fully transparent ones.
+///
+///   With blending, pixels are alpha blended (colors are not premultiplied)
+///   in depth order instead of keeping the nearest one, for volume
+///   rendering.  Each pixel's depth should be where its ray entered the
+///   rank's data.  Since the images of contiguous ranges of ranks are
+///   blended together, this gives the correct visibility order as long as
+///   each contiguous range of ranks holds a convex, non-overlapping part
+///   of the data, as when blocks are assigned to ranks in the order of a
+///   k-d tree or in slabs.  The blended pixels are not composited over the
+///   background color.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlCompositor
+{
+  public:
+    enum Algorithm
+    {
+        Reduce,
+        BinarySwap,
+        RadixK
+    };
+  public:
+    static void      SetAlgorithm(Algorithm a);
+    static Algorithm GetAlgorithm();
+    static void      SetRadix(int k);
+    static int       GetRadix();
+    static void      SetBackgroundEncoding(bool e);
+    static bool      GetBackgroundEncoding();
+    static void      SetBlending(bool b);
+    static bool      GetBlending();
+
+  protected:
+    static Algorithm algorithm;
+    static int       radix;
+    static bool      backgroundEncoding;
+    static bool      blending;
+};
+
 void ParallelZComposite(const MPI_Comm &comm,
                         int npixels,
                         const float *inz, const unsigned char *inrgba,
                         float *outz, unsigned char *outrgba,
                         unsigned char bgr, unsigned char bgg, unsigned char bgb);
 
- 
+
 #endif
 
 #endif
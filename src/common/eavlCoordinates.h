@@ -19,7 +19,7 @@ class eavlCoordinateAxis
     virtual eavlStream& deserialize(eavlStream &s) = 0;
     static eavlCoordinateAxis* CreateObjFromName(const string &nm);
 
-    virtual double GetValue(int pointIndex,
+    virtual double GetValue(eavlIndex pointIndex,
                             vector<int> &indexDivs,
                             vector<int> &indexMods,
                             vector<eavlField*>&fd) = 0;
@@ -67,7 +67,7 @@ class eavlCoordinateAxisField : public eavlCoordinateAxis
     }
     ///\todo: it's a weird mismatch here; can't we just pass down the
     /// REAL index into this array, instead of both and basing it off the assoc?
-    virtual double GetValue(int pointIndex,
+    virtual double GetValue(eavlIndex pointIndex,
                             vector<int> &indexDivs,
                             vector<int> &indexMods,
                             vector<eavlField*>&fd)
@@ -100,7 +100,7 @@ class eavlCoordinateAxisField : public eavlCoordinateAxis
             {
             int div = indexDivs[fieldPointer->GetAssocLogicalDim()];
             int mod = indexMods[fieldPointer->GetAssocLogicalDim()];
-            int logicalIndex = (pointIndex / div) % mod;
+            eavlIndex logicalIndex = (pointIndex / div) % mod;
             return fieldPointer->GetArray()->GetComponentAsDouble(logicalIndex, component);
             }
           default:
@@ -159,14 +159,14 @@ class eavlCoordinateAxisRegular : public eavlCoordinateAxis
     {
         out << "          eavlCoordinateAxisRegular origin='"<<origin<<"' delta="<<delta<<endl;
     }
-    virtual double GetValue(int pointIndex,
+    virtual double GetValue(eavlIndex pointIndex,
                             vector<int> &indexDivs,
                             vector<int> &indexMods,
                             vector<eavlField*>&)
     {
         int div = indexDivs[logicaldim];
         int mod = indexMods[logicaldim];
-        int logicalIndex = (pointIndex / div) % mod;
+        eavlIndex logicalIndex = (pointIndex / div) % mod;
         return origin + logicalIndex*delta;
     }
     virtual long long GetMemoryUsage()
@@ -254,7 +254,7 @@ class eavlCoordinates
     {
         return axes[i];
     }
-    virtual double GetRawPoint(int i, int c,
+    virtual double GetRawPoint(eavlIndex i, int c,
                                vector<eavlField*>&fd)
     {
         if (c >= (int)axes.size())
@@ -264,7 +264,7 @@ class eavlCoordinates
                                  indexMods,
                                  fd);
     }
-    virtual double GetCartesianPoint(int i,int c,
+    virtual double GetCartesianPoint(eavlIndex i, int c,
                                      eavlLogicalStructure *log,
                                      vector<eavlField*>&fd)=0;
     virtual void PrintSummary(ostream &out)
@@ -366,7 +366,7 @@ class eavlCoordinatesCartesian : public eavlCoordinates
 	return s;
     }
 
-    virtual double GetCartesianPoint(int i, int c,
+    virtual double GetCartesianPoint(eavlIndex i, int c,
                                      eavlLogicalStructure *,
                                      vector<eavlField*>&fd)
     {
@@ -446,7 +446,7 @@ class eavlCoordinatesCartesianWithTransform : public eavlCoordinatesCartesian
     // per-component fashion. I suppose that's because individual axes could
     // come from different eavl fields. I could cache the last point "i" but
     // that would make it non-threadsafe, though that may not matter.
-    virtual double GetCartesianPoint(int i, int c,
+    virtual double GetCartesianPoint(eavlIndex i, int c,
                                      eavlLogicalStructure *,
                                      vector<eavlField*>&fd)
     {
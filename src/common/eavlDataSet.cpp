@@ -108,7 +108,7 @@ AddRectilinearMesh(eavlDataSet *data,
     int dims[3];
     int ctr = 0;
     eavlCoordinatesCartesian::CartesianAxisType axes[3];
-    int npoints = 1;
+    eavlIndex npoints = 1;
     for (unsigned int d = 0; d < coordinates.size(); d++)
     {
         int n = coordinates[d].size();
@@ -223,7 +223,7 @@ AddCurvilinearMesh(eavlDataSet *data,
     int meshIndex = -1;
     int dimension = coordinateNames.size();
 
-    int npoints = 1;
+    eavlIndex npoints = 1;
     eavlCoordinatesCartesian::CartesianAxisType axes[3];
     int ctr = 0;
     for (unsigned int d = 0; d < coordinates.size(); d++)
@@ -322,7 +322,7 @@ AddCurvilinearMesh_SepCoords(eavlDataSet *data,
     int meshIndex = -1;
     int dimension = coordinateNames.size();
 
-    int npoints = 1;
+    eavlIndex npoints = 1;
     eavlCoordinatesCartesian::CartesianAxisType axes[3];
     int ctr = 0;
     for (int d = 0; d < dimension; d++)
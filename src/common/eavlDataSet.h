@@ -29,11 +29,15 @@
 // Programmer:  Jeremy Meredith, Dave Pugmire, Sean Ahern
 // Creation:    February 15, 2011
 //
+// Modifications:
+//   The point count is an eavlIndex, so it can pass 2^31 in builds
+//   configured with EAVL_64BIT_INDICES.
+//
 // ****************************************************************************
 class eavlDataSet
 {
   protected:
-    int                          npoints;
+    eavlIndex                    npoints;
     vector<eavlCoordinateValue>  discreteCoordinates;
     vector<eavlField*>           fields;
     vector<eavlCellSet*>         cellsets;
@@ -120,12 +124,12 @@ class eavlDataSet
         return data;
     }
     
-    int GetNumPoints()
+    eavlIndex GetNumPoints()
     {
         return npoints;
     }
 
-    void SetNumPoints(int n)
+    void SetNumPoints(eavlIndex n)
     {
         npoints = n;
         for (unsigned int i=0; i<cellsets.size(); i++)
@@ -134,7 +138,7 @@ class eavlDataSet
         }
     }
 
-    double GetPoint(int i, int c, int whichCoordSystem=0)
+    double GetPoint(eavlIndex i, int c, int whichCoordSystem=0)
     {
         assert(whichCoordSystem >= 0 && whichCoordSystem <= (int)coordinateSystems.size());
         /// \todo: this assumes you have at least one coordinate system
@@ -147,7 +151,7 @@ class eavlDataSet
     long long GetMemoryUsage()
     {
         long long mem = 0;
-        mem += sizeof(int); //npoints;
+        mem += sizeof(eavlIndex); //npoints;
 
         mem += sizeof(vector<eavlCoordinateValue>);
         for (size_t i=0; i<discreteCoordinates.size(); i++)
@@ -1,75 +1,466 @@
 // Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
 #include "eavlExecutor.h"
+#include "eavlThreadPool.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
 
 eavlExecutor::ExecutionMode eavlExecutor::executionMode = PreferGPU;
 eavlExecutor *eavlExecutor::instance = NULL;
 
+// Number of items each fused group processes per block.  This is chosen
+// so that a block of every array touched by a typical group of operations
+// stays resident in a per-core cache between consecutive operations.
+static const int fusionBlockSize = 4096;
+
+// Check whether an operation with the given array accesses can be
+// appended to a fusion group whose operations made the accesses in
+// "group".  When blocks of the group run in parallel and each block
+// runs its operations in plan order, an array produced within the group
+// may only be consumed at the exact same locations it was written (or at
+// locations disjoint from them, like another component), and writes
+// must hit a distinct location for every item in the domain (so
+// a write with mul == 0, where every item writes the same location, is
+// never fused).  Arrays a functor holds itself rather than receiving
+// through its op's arguments are not among the accesses, so conflicts on
+// them are not detected here.
+static bool
+CanJoinFusionGroup(const vector<eavlFusionAccess> &group,
+                   const vector<eavlFusionAccess> &op,
+                   eavlIndex domain)
+{
+    for (size_t i=0; i<op.size(); i++)
+    {
+        const eavlFusionAccess &a = op[i];
+        if (a.mode == eavlFusionAccess::SPARSE_WRITE)
+            return false;
+        if (a.mode == eavlFusionAccess::ELEMENT_WRITE &&
+            (a.indexer.div != 1 || a.indexer.mod < domain ||
+             a.indexer.mul == 0))
+            return false;
+
+        for (size_t j=0; j<group.size(); j++)
+        {
+            const eavlFusionAccess &g = group[j];
+            if (g.array != a.array)
+                continue;
+            if (g.mode != eavlFusionAccess::ELEMENT_WRITE &&
+                a.mode != eavlFusionAccess::ELEMENT_WRITE)
+                continue;
+            if (g.mode == eavlFusionAccess::SPARSE_READ ||
+                a.mode == eavlFusionAccess::SPARSE_READ)
+                return false;
+            if (!g.SameIndexing(a) && !g.Disjoint(a))
+                return false;
+        }
+    }
+    return true;
+}
 
 void
 eavlExecutor::real_Go()
 {
-    for (unsigned int i=0; i<plan.size(); i++)
+    bool fuse = planFusion && RunningOnCPU();
+    if (concurrentExecution && !fuse)
+    {
+        real_GoAsync().Wait();
+        return;
+    }
+
+    int nops = plan.size();
+    int start = 0;
+    while (start < nops)
     {
-        //cerr << "Executing "<<opnames[i]<<endl;
-        int th = eavlTimer::Start();
+        int end = fuse ? FindFusionGroupEnd(start) : start+1;
+        if (end - start > 1)
+            ExecuteFusionGroup(start, end);
+        else
+            ExecuteOperation(start);
+        start = end;
+    }
+
+    for (unsigned int i=0; i<plan.size(); i++)
+        delete plan[i];
+
+    plan.clear();
+    opnames.clear();
+    intermediates.clear();
+}
+
+void
+eavlExecutor::ExecuteOperation(int i)
+{
+    //cerr << "Executing "<<opnames[i]<<endl;
+    int th = eavlTimer::Start();
+    if (eavlTrace::IsEnabled())
+        BeginTrace(opnames[i], &plan[i], 1);
+    eavlArrayResidency::BeginOperation(opnames[i]);
+    RunOperation(plan[i]);
+    eavlArrayResidency::EndOperation();
+    eavlTimer::Stop(th, opnames[i]);
+    eavlTrace::EndOperation();
+}
+
+void
+eavlExecutor::RunOperation(eavlOperation *op)
+{
 #ifdef HAVE_CUDA
-        switch (executionMode)
+    switch (executionMode)
+    {
+      case PreferGPU:
+        try {
+            op->GoGPU();
+        }
+        catch (eavlException &e)
         {
-          case PreferGPU:
+            cerr << "Warning: failed GPU, trying CPU, error was "<<e.GetErrorText()<<"\n";
             try {
-                plan[i]->GoGPU();
+                op->GoCPU();
             }
-            catch (eavlException &e)
+            catch (eavlException &e2)
             {
-                cerr << "Warning: failed GPU, trying CPU, error was "<<e.GetErrorText()<<"\n";
-                try {
-                    plan[i]->GoCPU();
-                }
-                catch (eavlException &e2)
-                {
-                    cerr << "Error: both GPU and CPU ops failed\n";
-                    cerr << "   GPU error was: " << e.GetErrorText() << endl;
-                    cerr << "   CPU error was: " << e2.GetErrorText() << endl;
-                }
+                cerr << "Error: both GPU and CPU ops failed\n";
+                cerr << "   GPU error was: " << e.GetErrorText() << endl;
+                cerr << "   CPU error was: " << e2.GetErrorText() << endl;
             }
-            break;
-          case ForceGPU:
-            plan[i]->GoGPU();
-            break;
-          case ForceCPU:
-            plan[i]->GoCPU();
-            break;
         }
+        break;
+      case ForceGPU:
+        op->GoGPU();
+        break;
+      case ForceCPU:
+        op->GoCPU();
+        break;
+      case ForceCPUThreadPool:
+        op->GoCPUThreadPool();
+        break;
+    }
 #else
-        switch (executionMode)
+    switch (executionMode)
+    {
+      case PreferGPU:
+        try {
+            op->GoCPU();
+        }
+        catch (eavlException &e)
         {
-          case PreferGPU:
-            try {
-                plan[i]->GoCPU();
-            }
-            catch (eavlException &e)
-            {
-                cerr << "Error: no GPU implementation, and CPU op failed\n";
-                cerr << "   CPU error was: " << e.GetErrorText() << endl;
-            }
-            break;
-          case ForceGPU:
-            THROW(eavlException, "GPU support was not compiled in.");
-          case ForceCPU:
-            plan[i]->GoCPU();
-            break;
+            cerr << "Error: no GPU implementation, and CPU op failed\n";
+            cerr << "   CPU error was: " << e.GetErrorText() << endl;
         }
+        break;
+      case ForceGPU:
+        THROW(eavlException, "GPU support was not compiled in.");
+      case ForceCPU:
+        op->GoCPU();
+        break;
+      case ForceCPUThreadPool:
+        op->GoCPUThreadPool();
+        break;
+    }
 #endif
-        eavlTimer::Stop(th, opnames[i]);
+}
+
+void
+eavlExecutor::BeginTrace(const std::string &name,
+                         eavlOperation *const *ops, int nops)
+{
+    eavlTrace::BeginOperation(name);
+    vector<eavlFusionAccess> accesses;
+    for (int i=0; i<nops; i++)
+        ops[i]->GetFusionAccesses(accesses);
+    for (size_t i=0; i<accesses.size(); i++)
+    {
+        eavlFusionAccess::Mode m = accesses[i].mode;
+        bool write = (m == eavlFusionAccess::ELEMENT_WRITE ||
+                      m == eavlFusionAccess::SPARSE_WRITE);
+        eavlTrace::DeclareAccess(accesses[i].array, !write, write);
     }
+}
 
-    for (unsigned int i=0; i<plan.size(); i++)
-        delete plan[i];
+bool
+eavlExecutor::RunningOnCPU()
+{
+#ifdef HAVE_CUDA
+    return executionMode == ForceCPU || executionMode == ForceCPUThreadPool;
+#else
+    return executionMode != ForceGPU;
+#endif
+}
 
-    plan.clear();
-    opnames.clear();
+int
+eavlExecutor::FindFusionGroupEnd(int start)
+{
+    eavlIndex domain = plan[start]->GetFusionDomain();
+    if (domain <= 0)
+        return start+1;
+
+    vector<eavlFusionAccess> group;
+    vector<eavlFusionAccess> accesses;
+    plan[start]->GetFusionAccesses(accesses);
+    if (!CanJoinFusionGroup(group, accesses, domain))
+        return start+1;
+    group.insert(group.end(), accesses.begin(), accesses.end());
+
+    int end = start+1;
+    while (end < (int)plan.size() && plan[end]->GetFusionDomain() == domain)
+    {
+        accesses.clear();
+        plan[end]->GetFusionAccesses(accesses);
+        if (!CanJoinFusionGroup(group, accesses, domain))
+            break;
+        group.insert(group.end(), accesses.begin(), accesses.end());
+        ++end;
+    }
+    return end;
+}
+
+// Find the arrays marked with MarkIntermediate which the fused group
+// [start,end) can elide, along with the stride between their items.
+// Every operation of the plan using one must be in the group, the first
+// must only write it, and each access must be to the same slot of every
+// item, so each block of items touches its own contiguous part of the
+// array.  Its host storage must not have been allocated yet.
+void
+eavlExecutor::FindElidableIntermediates(int start, int end, eavlIndex domain,
+                                        map<eavlArray*,int> &elidable)
+{
+    if (intermediates.empty())
+        return;
+
+    std::set<eavlArray*> rejected;
+    map<eavlArray*,int> firstOp;
+    for (int i=0; i<(int)plan.size(); i++)
+    {
+        vector<eavlFusionAccess> accesses;
+        plan[i]->GetFusionAccesses(accesses);
+        for (size_t j=0; j<accesses.size(); j++)
+        {
+            const eavlFusionAccess &a = accesses[j];
+            if (!intermediates.count(a.array))
+                continue;
+            if (!firstOp.count(a.array))
+            {
+                firstOp[a.array] = i;
+                elidable[a.array] = a.indexer.mul;
+            }
+            const eavlArrayIndexer &x = a.indexer;
+            bool ok = (i >= start && i < end &&
+                       (a.mode == eavlFusionAccess::ELEMENT_WRITE ||
+                        (a.mode == eavlFusionAccess::ELEMENT_READ &&
+                         firstOp[a.array] != i)) &&
+                       x.div == 1 && x.mod >= domain &&
+                       x.mul == elidable[a.array] &&
+                       x.add >= 0 && x.add < x.mul &&
+                       a.array->IsHostStorageDeferred());
+            if (!ok)
+                rejected.insert(a.array);
+        }
+    }
+    for (std::set<eavlArray*>::iterator r = rejected.begin();
+         r != rejected.end(); ++r)
+        elidable.erase(*r);
 }
 
+// ****************************************************************************
+// Class:  eavlElidedIntermediates
+//
+// Purpose:
+///   Stands in for the intermediates a fused group elides.  Each is lent
+///   scratch address space from an anonymous mapping, and a page of it is
+///   handed back to the system once every block of items touching the
+///   page has finished, so only the pages of blocks in flight are ever
+///   resident.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlElidedIntermediates
+{
+  protected:
+    struct Scratch
+    {
+        eavlArray *array;
+        char      *base;
+        size_t     mapped;     ///< bytes mapped, whole pages
+        size_t     blockBytes; ///< bytes each block of items touches
+    };
+    vector<Scratch> scratch;
+    vector<char>    done;
+    eavlIndex       blockSize;
+    size_t          pageSize;
+    eavlMutex       mutex;
+
+    // true if every block in [first,last) has finished
+    bool BlocksDone(eavlIndex first, eavlIndex last)
+    {
+        last = std::min(last, (eavlIndex)done.size());
+        for (eavlIndex b = first; b < last; ++b)
+        {
+            if (!done[b])
+                return false;
+        }
+        return true;
+    }
+  public:
+    eavlElidedIntermediates(eavlIndex n, eavlIndex bs)
+        : done((n + bs - 1) / bs, 0), blockSize(bs)
+    {
+        pageSize = sysconf(_SC_PAGESIZE);
+    }
+    ~eavlElidedIntermediates()
+    {
+        Release();
+    }
+    void Add(eavlArray *a, int mul)
+    {
+        size_t elementBytes = a->GetBasicTypeSize();
+        size_t bytes = (size_t)a->GetNumberOfTuples() *
+                       a->GetNumberOfComponents() * elementBytes;
+        if (bytes == 0)
+            return;
+        Scratch s;
+        s.array = a;
+        s.mapped = (bytes + pageSize - 1) / pageSize * pageSize;
+        s.blockBytes = (size_t)blockSize * mul * elementBytes;
+        void *p = mmap(NULL, s.mapped, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (p == MAP_FAILED)
+            return;
+        s.base = (char*)p;
+        a->SetHostScratch(p);
+        scratch.push_back(s);
+    }
+    void Release()
+    {
+        for (size_t i=0; i<scratch.size(); i++)
+        {
+            scratch[i].array->SetHostScratch(NULL);
+            munmap(scratch[i].base, scratch[i].mapped);
+        }
+        scratch.clear();
+    }
+    // discard the pages of every scratch array no unfinished block uses
+    void BlockDone(eavlIndex b)
+    {
+        if (scratch.empty())
+            return;
+        eavlMutexLocker lock(mutex);
+        done[b] = 1;
+        for (size_t i=0; i<scratch.size(); i++)
+        {
+            const Scratch &s = scratch[i];
+            size_t bb = s.blockBytes;
+            size_t first = b * bb / pageSize * pageSize;
+            size_t last = std::min(s.mapped,
+                                   ((b+1) * bb + pageSize - 1) / pageSize * pageSize);
+            if (last <= first)
+                continue;
+            // the pages at either end may be shared with other blocks
+            if (!BlocksDone(first / bb, b))
+                first += pageSize;
+            if (!BlocksDone(b+1, (last - 1) / bb + 1))
+                last -= pageSize;
+            if (last > first)
+                madvise(s.base + first, last - first, MADV_DONTNEED);
+        }
+    }
+};
+
+// runs every kernel of a fused group over each block in turn
+class eavlFusionGroupBody : public eavlParallelForBody
+{
+  protected:
+    const vector<eavlFusedKernel*> &kernels;
+    eavlElidedIntermediates        &elided;
+  public:
+    eavlFusionGroupBody(const vector<eavlFusedKernel*> &k,
+                        eavlElidedIntermediates &e) : kernels(k), elided(e) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (size_t k = 0; k < kernels.size(); ++k)
+            kernels[k]->Run(begin, end);
+        elided.BlockDone(begin / fusionBlockSize);
+    }
+};
+
+void
+eavlExecutor::ExecuteFusionGroup(int start, int end)
+{
+    string name = opnames[start];
+    for (int i=start+1; i<end; i++)
+        name += "+" + opnames[i];
+
+    int th = eavlTimer::Start();
+    if (eavlTrace::IsEnabled())
+        BeginTrace(name, &plan[start], end - start);
+    eavlArrayResidency::BeginOperation(name);
+
+    // lend scratch space to the intermediates the group can elide,
+    // before binding the kernels to their host pointers
+    eavlIndex n = plan[start]->GetFusionDomain();
+    eavlElidedIntermediates elided(n, fusionBlockSize);
+    map<eavlArray*,int> elidable;
+    FindElidableIntermediates(start, end, n, elidable);
+    for (map<eavlArray*,int>::iterator e = elidable.begin();
+         e != elidable.end(); ++e)
+        elided.Add(e->first, e->second);
+
+    // resolve every array to a host pointer up front, so no transfers
+    // are triggered from inside the parallel region
+    vector<eavlFusedKernel*> kernels;
+    for (int i=start; i<end; i++)
+    {
+        eavlFusedKernel *kernel = plan[i]->BindFusedKernelCPU();
+        if (!kernel)
+        {
+            for (size_t k=0; k<kernels.size(); k++)
+                delete kernels[k];
+            elided.Release();
+            eavlArrayResidency::EndOperation();
+            eavlTimer::Stop(th, name);
+            eavlTrace::CancelOperation();
+            for (int j=start; j<end; j++)
+                ExecuteOperation(j);
+            return;
+        }
+        kernels.push_back(kernel);
+    }
+
+    int nkernels = kernels.size();
+    if (executionMode == ForceCPUThreadPool)
+    {
+        // ParallelFor chunks are whole multiples of the grain, so each
+        // is exactly one block
+        eavlFusionGroupBody body(kernels, elided);
+        eavlThreadPool::ParallelFor(n, body, fusionBlockSize);
+    }
+    else
+    {
+        eavlIndex nblocks = (n + fusionBlockSize - 1) / fusionBlockSize;
+#pragma omp parallel for schedule(dynamic)
+        for (eavlIndex b = 0; b < nblocks; ++b)
+        {
+            eavlIndex begin = b * fusionBlockSize;
+            eavlIndex blockend = std::min(n, begin + fusionBlockSize);
+            for (int k = 0; k < nkernels; ++k)
+                kernels[k]->Run(begin, blockend);
+            elided.BlockDone(b);
+        }
+    }
+
+    for (int k=0; k<nkernels; k++)
+        delete kernels[k];
+    elided.Release();
+
+    eavlArrayResidency::EndOperation();
+    eavlTimer::Stop(th, name);
+    eavlTrace::EndOperation();
+}
 
 void
 eavlExecutor::real_AddOperation(eavlOperation *op, const std::string &name)
@@ -77,3 +468,381 @@ eavlExecutor::real_AddOperation(eavlOperation *op, const std::string &name)
     plan.push_back(op);
     opnames.push_back(name);
 }
+
+// ****************************************************************************
+// Class:  eavlPlanExecution
+//
+// Purpose:
+///   The state of a plan started by eavlExecutor::GoAsync: its operations,
+///   the dependencies between them, and their progress.  It is shared by
+///   the plan's futures and the tasks running its operations, and deleted
+///   along with the last of them.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlPlanExecution
+{
+  public:
+    vector<eavlOperation*> ops;
+    vector<string>         names;
+    vector<int>            waitingOn;  ///< unfinished dependencies per op
+    vector<vector<int> >   dependents; ///< ops depending on each op
+    bool                   concurrent;
+    int                    ompThreads;
+    int                    running;
+    int                    remaining;
+    bool                   failed;
+    string                 error;
+    int                    refs;
+    int                    futures;    ///< eavlPlanFutures sharing it
+    eavlMutex              mutex;
+    eavlCondition          finished;
+
+    eavlPlanExecution()
+        : concurrent(false), ompThreads(1), running(0), remaining(0),
+          failed(false), refs(0), futures(0)
+    {
+    }
+    ~eavlPlanExecution()
+    {
+        for (size_t i=0; i<ops.size(); i++)
+            delete ops[i];
+    }
+    void Ref()
+    {
+        eavlMutexLocker lock(mutex);
+        ++refs;
+    }
+    void Unref()
+    {
+        mutex.Lock();
+        bool last = (--refs == 0);
+        mutex.Unlock();
+        if (last)
+            delete this;
+    }
+};
+
+// ****************************************************************************
+// Class:  eavlPlanTask
+//
+// Purpose:
+///   Runs one operation of an asynchronous plan, then submits each of its
+///   dependents whose dependencies have all finished.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlPlanTask : public eavlTask
+{
+  protected:
+    eavlPlanExecution *exec;
+    int                op;
+  public:
+    eavlPlanTask(eavlPlanExecution *e, int i) : exec(e), op(i)
+    {
+        exec->Ref();
+    }
+    virtual ~eavlPlanTask()
+    {
+        exec->Unref();
+    }
+    virtual void Run()
+    {
+        // operations running side by side split the OpenMP threads
+        exec->mutex.Lock();
+        bool skip = exec->failed;
+        int nthreads = std::max(1, exec->ompThreads / ++exec->running);
+        exec->mutex.Unlock();
+
+        string error;
+        if (!skip)
+        {
+            try
+            {
+                eavlExecutor::ExecuteAsyncOperation(exec, op, nthreads);
+            }
+            catch (const eavlException &e)
+            {
+                error = e.GetErrorText();
+            }
+            catch (const std::exception &e)
+            {
+                error = exec->names[op] + ": " + e.what();
+            }
+            catch (...)
+            {
+                error = exec->names[op] + ": unknown error";
+            }
+        }
+
+        vector<int> ready;
+        exec->mutex.Lock();
+        --exec->running;
+        if (!error.empty() && !exec->failed)
+        {
+            exec->failed = true;
+            exec->error = error;
+        }
+        const vector<int> &deps = exec->dependents[op];
+        for (size_t i=0; i<deps.size(); i++)
+        {
+            if (--exec->waitingOn[deps[i]] == 0)
+                ready.push_back(deps[i]);
+        }
+        if (--exec->remaining == 0)
+            exec->finished.Broadcast();
+        exec->mutex.Unlock();
+
+        for (size_t i=0; i<ready.size(); i++)
+            eavlThreadPool::Submit(new eavlPlanTask(exec, ready[i]));
+    }
+};
+
+// the operations which last wrote an array, and have read it since
+struct eavlPlanArrayUse
+{
+    int         lastWriter;
+    vector<int> readers;
+    eavlPlanArrayUse() : lastWriter(-1) { }
+};
+
+// Order the operations of a plan.  Each operation depends on the last
+// earlier operation writing an array it reads or writes, and an operation
+// writing an array also depends on every operation reading it since that
+// write.  Operations which declare no array accesses are barriers,
+// ordered after everything before them and before everything after them.
+// Arrays a functor holds itself are not among the declared accesses, so
+// operations communicating only through them are not ordered.  If the
+// plan will not run concurrently, it is simply a chain.
+void
+eavlExecutor::BuildDependencies(eavlPlanExecution *exec)
+{
+    int nops = exec->ops.size();
+    exec->waitingOn.assign(nops, 0);
+    exec->dependents.assign(nops, vector<int>());
+
+    map<eavlArray*, eavlPlanArrayUse> uses;
+    int lastBarrier = -1;
+    vector<int> sinceBarrier;
+
+    for (int i=0; i<nops; i++)
+    {
+        std::set<int> deps;
+        vector<eavlFusionAccess> accesses;
+        if (exec->concurrent)
+            exec->ops[i]->GetFusionAccesses(accesses);
+
+        if (!exec->concurrent)
+        {
+            if (i > 0)
+                deps.insert(i-1);
+        }
+        else if (accesses.empty())
+        {
+            deps.insert(sinceBarrier.begin(), sinceBarrier.end());
+            deps.insert(lastBarrier);
+            lastBarrier = i;
+            sinceBarrier.clear();
+            uses.clear();
+        }
+        else
+        {
+            deps.insert(lastBarrier);
+            for (size_t a=0; a<accesses.size(); a++)
+            {
+                eavlPlanArrayUse &u = uses[accesses[a].array];
+                deps.insert(u.lastWriter);
+                if (accesses[a].mode == eavlFusionAccess::ELEMENT_WRITE ||
+                    accesses[a].mode == eavlFusionAccess::SPARSE_WRITE)
+                    deps.insert(u.readers.begin(), u.readers.end());
+            }
+            for (size_t a=0; a<accesses.size(); a++)
+            {
+                eavlPlanArrayUse &u = uses[accesses[a].array];
+                if (accesses[a].mode == eavlFusionAccess::ELEMENT_WRITE ||
+                    accesses[a].mode == eavlFusionAccess::SPARSE_WRITE)
+                {
+                    u.lastWriter = i;
+                    u.readers.clear();
+                }
+                else if (u.lastWriter != i)
+                {
+                    u.readers.push_back(i);
+                }
+            }
+            sinceBarrier.push_back(i);
+        }
+
+        deps.erase(-1);
+        deps.erase(i);
+        for (std::set<int>::iterator d = deps.begin(); d != deps.end(); ++d)
+        {
+            exec->dependents[*d].push_back(i);
+            exec->waitingOn[i]++;
+        }
+    }
+}
+
+eavlPlanFuture
+eavlExecutor::real_GoAsync()
+{
+    eavlPlanExecution *exec = new eavlPlanExecution;
+    exec->ops.swap(plan);
+    exec->names.swap(opnames);
+    intermediates.clear();
+    exec->concurrent = RunningOnCPU();
+#ifdef HAVE_OPENMP
+    exec->ompThreads = omp_get_max_threads();
+#endif
+    exec->remaining = exec->ops.size();
+    BuildDependencies(exec);
+
+    // Concurrent operations must not transfer arrays, which is not
+    // thread safe, so bring every declared array up to date on the host
+    // now.  Operations declaring no arrays run alone anyway.
+    if (exec->concurrent)
+    {
+        for (size_t i=0; i<exec->ops.size(); i++)
+        {
+            vector<eavlFusionAccess> accesses;
+            exec->ops[i]->GetFusionAccesses(accesses);
+            eavlArrayResidency::BeginOperation(exec->names[i]);
+            for (size_t a=0; a<accesses.size(); a++)
+                accesses[a].array->GetHostArray();
+            eavlArrayResidency::EndOperation();
+        }
+    }
+
+    // find every initially ready operation before submitting any, as
+    // running ones will start readying others
+    vector<int> ready;
+    for (size_t i=0; i<exec->ops.size(); i++)
+    {
+        if (exec->waitingOn[i] == 0)
+            ready.push_back(i);
+    }
+    eavlPlanFuture future(exec);
+    for (size_t i=0; i<ready.size(); i++)
+        eavlThreadPool::Submit(new eavlPlanTask(exec, ready[i]));
+    return future;
+}
+
+void
+eavlExecutor::ExecuteAsyncOperation(eavlPlanExecution *exec, int i,
+                                    int nthreads)
+{
+#ifdef HAVE_OPENMP
+    omp_set_num_threads(nthreads);
+#else
+    (void)nthreads;
+#endif
+    // eavlTimer keeps a single nested stack of timers, so operations run
+    // asynchronously are only timed by eavlTrace, per worker thread.
+    if (eavlTrace::IsEnabled())
+        BeginTrace(exec->names[i], &exec->ops[i], 1);
+    eavlArrayResidency::BeginOperation(exec->names[i]);
+    try
+    {
+        RunOperation(exec->ops[i]);
+    }
+    catch (...)
+    {
+        eavlArrayResidency::EndOperation();
+        eavlTrace::CancelOperation();
+        throw;
+    }
+    eavlArrayResidency::EndOperation();
+    eavlTrace::EndOperation();
+}
+
+eavlPlanFuture::eavlPlanFuture() : execution(NULL)
+{
+}
+
+eavlPlanFuture::eavlPlanFuture(eavlPlanExecution *e) : execution(e)
+{
+    execution->Ref();
+    eavlMutexLocker lock(execution->mutex);
+    execution->futures++;
+}
+
+eavlPlanFuture::eavlPlanFuture(const eavlPlanFuture &f)
+    : execution(f.execution)
+{
+    if (!execution)
+        return;
+    execution->Ref();
+    eavlMutexLocker lock(execution->mutex);
+    execution->futures++;
+}
+
+eavlPlanFuture::~eavlPlanFuture()
+{
+    if (!execution)
+        return;
+    execution->mutex.Lock();
+    if (--execution->futures == 0)
+    {
+        while (execution->remaining > 0)
+            execution->finished.Wait(execution->mutex);
+    }
+    execution->mutex.Unlock();
+    execution->Unref();
+}
+
+eavlPlanFuture &
+eavlPlanFuture::operator=(const eavlPlanFuture &f)
+{
+    // the old plan is released (and maybe waited for) with the copy
+    eavlPlanFuture copy(f);
+    std::swap(execution, copy.execution);
+    return *this;
+}
+
+// ****************************************************************************
+// Method:  eavlPlanFuture::IsDone
+//
+// Purpose:
+///   True once every operation of the plan has finished (or been skipped
+///   after a failure).  A default-constructed future is always done.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlPlanFuture::IsDone() const
+{
+    if (!execution)
+        return true;
+    eavlMutexLocker lock(execution->mutex);
+    return execution->remaining == 0;
+}
+
+// ****************************************************************************
+// Method:  eavlPlanFuture::Wait
+//
+// Purpose:
+///   Block until the plan has finished.  Throws if an operation failed.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlPlanFuture::Wait()
+{
+    if (!execution)
+        return;
+    string error;
+    execution->mutex.Lock();
+    while (execution->remaining > 0)
+        execution->finished.Wait(execution->mutex);
+    if (execution->failed)
+        error = execution->error;
+    execution->mutex.Unlock();
+    if (!error.empty())
+        THROW(eavlException, error);
+}
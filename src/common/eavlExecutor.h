@@ -14,6 +14,42 @@
 // Programmer:  Jeremy Meredith, Dave Pugmire, Sean Ahern, Rob Sisneros
 // Creation:    August 29, 2011
 //
+// Modifications:
+//   Added an optional plan fusion mode.  When enabled and the plan is
+//   running on the CPU, runs of adjacent fusable operations (currently
+//   map, gather, and source/info topology map ops) with the same iteration
+//   domain and no conflicting array accesses are executed as a single
+//   blocked traversal, so that intermediate arrays are consumed while
+//   still resident in cache instead of being streamed through memory
+//   once per operation.
+//
+//   Arrays marked with MarkIntermediate whose host storage is deferred
+//   are elided from the fused groups which alone write and read them:
+//   they get scratch address space whose pages are discarded as the
+//   blocks using them finish, and are never allocated themselves.
+//
+//   When eavlTrace is enabled, each operation or fused group is recorded
+//   as a trace event, with the array accesses it declares used to
+//   classify its dispatched bytes as reads or writes.
+//
+//   Each operation is reported to eavlArrayResidency, so transfers are
+//   attributed to it and its arrays are not evicted from the device
+//   while it runs.
+//
+//   Added GoAsync, which runs the plan on eavlThreadPool and returns an
+//   eavlPlanFuture immediately.  On the CPU, operations are ordered only
+//   by the arrays they declare they read and write, so independent ones
+//   (e.g. gathers of separate coordinate components) run concurrently.
+//   With concurrent execution enabled, Go does the same and waits, which
+//   gives filters calling Go the same concurrency (fusion, when enabled,
+//   takes precedence).
+//
+//   Added the ForceCPUThreadPool mode, which runs CPU operations on
+//   eavlThreadPool::ParallelFor instead of OpenMP's static loops.  Chunks
+//   are balanced by work stealing, which evens out explicit cell sets
+//   whose cells vary in cost, and loops started from several threads at
+//   once share one set of workers instead of nesting thread teams.
+//
 // ****************************************************************************
 
 #include "STL.h"
@@ -21,6 +57,41 @@
 #include "eavlConfig.h"
 #include "eavlException.h"
 #include "eavlTimer.h"
+#include "eavlTrace.h"
+
+class eavlPlanExecution;
+
+// ****************************************************************************
+// Class:  eavlPlanFuture
+//
+// Purpose:
+///   A handle to a plan started with eavlExecutor::GoAsync.  Wait blocks
+///   until every operation of the plan has finished, and throws an
+///   eavlException if one of them failed (operations after a failure are
+///   skipped).  Copies share the same plan.  Destroying the last handle
+///   to an unfinished plan waits for it, as its operations may still be
+///   using arrays the caller is about to free.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlPlanFuture
+{
+    friend class eavlExecutor;
+  public:
+    eavlPlanFuture();
+    eavlPlanFuture(const eavlPlanFuture &f);
+    ~eavlPlanFuture();
+    eavlPlanFuture &operator=(const eavlPlanFuture &f);
+
+    bool IsDone() const;
+    void Wait();
+
+  protected:
+    eavlPlanFuture(eavlPlanExecution *e);
+    eavlPlanExecution *execution;
+};
 
 class eavlExecutor
 {
@@ -29,7 +100,8 @@ class eavlExecutor
     {
         PreferGPU,
         ForceGPU,
-        ForceCPU
+        ForceCPU,
+        ForceCPUThreadPool
     };
   public:
     static void SetExecutionMode(ExecutionMode em)
@@ -40,18 +112,75 @@ class eavlExecutor
     {
         return Instance()->executionMode;
     }
+    /// True for either of the modes which run only on the CPU.
+    static bool ForcingCPU()
+    {
+        ExecutionMode em = GetExecutionMode();
+        return em == ForceCPU || em == ForceCPUThreadPool;
+    }
+    /// Fuse runs of adjacent operations when running on the CPU.  Whether
+    /// operations may share a fused group is decided only from the arrays
+    /// they pass through eavlOpArgs: arrays a functor reaches directly,
+    /// like an eavlConstTexArray or a raw pointer it holds, are not seen,
+    /// so a plan where one operation reads such an array written by an
+    /// earlier one in the same plan must not be run with fusion enabled.
+    static void SetPlanFusion(bool fuse)
+    {
+        Instance()->planFusion = fuse;
+    }
+    static bool GetPlanFusion()
+    {
+        return Instance()->planFusion;
+    }
+    /// Have Go run the plan like GoAsync and wait for it.  This reorders
+    /// the operations of every plan run through Go, by the arrays they
+    /// pass through eavlOpArgs alone: an operation reading an array its
+    /// functor holds directly (an eavlConstTexArray, a raw pointer) may
+    /// run before an earlier one in the same plan which writes it.  Only
+    /// enable it when no filter used builds plans like that, or run such
+    /// an operation in a plan of its own.
+    static void SetConcurrentExecution(bool c)
+    {
+        Instance()->concurrentExecution = c;
+    }
+    static bool GetConcurrentExecution()
+    {
+        return Instance()->concurrentExecution;
+    }
     static void Go()
     {
         Instance()->real_Go();
     }
+    /// Start executing the plan in the background.  The arrays used by
+    /// the plan must not be touched by the caller until it has finished.
+    /// On the CPU, operations are ordered as for SetConcurrentExecution,
+    /// with the same limit on arrays their functors hold directly.
+    static eavlPlanFuture GoAsync()
+    {
+        return Instance()->real_GoAsync();
+    }
     static void AddOperation(eavlOperation *op,
                              const std::string &name)
     {
         Instance()->real_AddOperation(op,name);
     }
+    /// Declare that the plan about to run writes the array's values
+    /// before reading them, and the caller will not read them after the
+    /// plan has run.  If it was created with ALLOCATE_ON_FIRST_USE and
+    /// every operation using it is in the same fused group, it is then
+    /// never allocated.  Every operation of the plan using the array must
+    /// report it among its fusion accesses.
+    static void MarkIntermediate(eavlArray *a)
+    {
+        Instance()->intermediates.insert(a);
+    }
 
 
   protected:
+    friend class eavlPlanTask;
+    eavlExecutor() : planFusion(false), concurrentExecution(false)
+    {
+    }
     static eavlExecutor *Instance()
     {
         if (!instance)
@@ -59,13 +188,29 @@ class eavlExecutor
         return instance;
     }
     void real_Go();
+    eavlPlanFuture real_GoAsync();
     void real_AddOperation(eavlOperation *op, const std::string &name);
-    
+    void ExecuteOperation(int i);
+    static void RunOperation(eavlOperation *op);
+    static void BuildDependencies(eavlPlanExecution *exec);
+    static void ExecuteAsyncOperation(eavlPlanExecution *exec, int i,
+                                      int nthreads);
+    bool RunningOnCPU();
+    int  FindFusionGroupEnd(int start);
+    void ExecuteFusionGroup(int start, int end);
+    void FindElidableIntermediates(int start, int end, eavlIndex domain,
+                                   map<eavlArray*,int> &elidable);
+    static void BeginTrace(const std::string &name,
+                           eavlOperation *const *ops, int nops);
+
   protected:
     static eavlExecutor    *instance;
     static ExecutionMode    executionMode;
     vector<eavlOperation *> plan;
     vector<string>          opnames;
+    std::set<eavlArray*>    intermediates;
+    bool                    planFusion;
+    bool                    concurrentExecution;
 };
 
 #endif
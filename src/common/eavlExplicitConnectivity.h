@@ -36,12 +36,15 @@ struct eavlExplicitConnectivity_device
 // Creation:    July 25, 2012
 //
 // Modifications:
+//   The offsets of the elements into the connectivity are eavlIndex, so
+//   the connectivity may outgrow 2^31 entries with 64-bit indices.
+//
 // ****************************************************************************
 struct eavlExplicitConnectivity
 {
     eavlFlatArray<int> shapetype;
     eavlFlatArray<int> connectivity;
-    eavlFlatArray<int> mapCellToIndex;
+    eavlFlatArray<eavlIndex> mapCellToIndex;
 
     eavlExplicitConnectivity()
     {
@@ -92,7 +95,7 @@ struct eavlExplicitConnectivity
     }
     */
     
-    int GetNumElements() const { return shapetype.size(); }
+    eavlIndex GetNumElements() const { return shapetype.size(); }
     void AddElement(eavlCellShape shape, int npts, int *conn)
     {
         connectivity.push_back(npts);
@@ -116,13 +119,13 @@ struct eavlExplicitConnectivity
     }
     /// \todo: surface normal only needs 3 nodes; can we improve its
     /// performance by only having it return three values in that case?
-    EAVL_HOSTDEVICE int GetShapeType(int index) const
+    EAVL_HOSTDEVICE int GetShapeType(eavlIndex index) const
     {
         return shapetype[index];
     }
-    EAVL_HOSTDEVICE int GetElementComponents(int index, int &npts, int *pts) const
+    EAVL_HOSTDEVICE int GetElementComponents(eavlIndex index, int &npts, int *pts) const
     {
-        int ci = mapCellToIndex[index];
+        eavlIndex ci = mapCellToIndex[index];
         npts = connectivity[ci];
         for (int i=0; i<npts; ++i)
             pts[i] = connectivity[ci + 1 + i];
@@ -130,10 +133,10 @@ struct eavlExplicitConnectivity
     }
     EAVL_HOSTONLY void CreateReverseIndex()
     {
-        int nCells = shapetype.size();
+        eavlIndex nCells = shapetype.size();
         mapCellToIndex.resize(nCells);
-        int index = 0;
-        for (int e=0; e<nCells; e++)
+        eavlIndex index = 0;
+        for (eavlIndex e=0; e<nCells; e++)
         {
             mapCellToIndex[e] = index;
             int npts = connectivity[index];
@@ -146,14 +149,14 @@ struct eavlExplicitConnectivity
         // because managing the CUDA device memory is tricky --
         // we need a way to replace this connectivity with a new 
         // one, without using the assignment op or copy constructor.
-        int ns = e.shapetype.size();
+        eavlIndex ns = e.shapetype.size();
         shapetype.resize(ns);
-        for (int i=0; i<ns; i++)
+        for (eavlIndex i=0; i<ns; i++)
             shapetype[i] = e.shapetype[i];
 
-        int nc = e.connectivity.size();
+        eavlIndex nc = e.connectivity.size();
         connectivity.resize(nc);
-        for (int i=0; i<nc; i++)
+        for (eavlIndex i=0; i<nc; i++)
             connectivity[i] = e.connectivity[i];
 
         mapCellToIndex.clear();
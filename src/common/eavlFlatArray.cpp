@@ -3,6 +3,9 @@
 #include "eavlFlatArray.h"
 
 template<> const char *eavlFlatArray<int>::GetBasicType() const {return "int";}
+#ifdef EAVL_64BIT_INDICES
+template<> const char *eavlFlatArray<long long>::GetBasicType() const {return "long long";}
+#endif
 
 template <class T> eavlFlatArray<T> *
 eavlFlatArray<T>::CreateObjFromName(const string &nm)
@@ -13,6 +16,10 @@ eavlFlatArray<T>::CreateObjFromName(const string &nm)
 	return new eavlFlatArray<float>();
     if (nm == "eavlFlatArray<bool>")
 	return new eavlFlatArray<bool>();
+#ifdef EAVL_64BIT_INDICES
+    if (nm == "eavlFlatArray<long long>")
+	return new eavlFlatArray<long long>();
+#endif
     else
 	throw;
 }
@@ -35,6 +35,9 @@
 // Creation:    July 26, 2012
 //
 // Modifications:
+//   Lengths and indices are eavlIndex, so connectivity may hold more than
+//   2^31 entries in builds configured with EAVL_64BIT_INDICES.
+//
 // ****************************************************************************
 template <class T>
 class eavlFlatArray
@@ -51,8 +54,8 @@ class eavlFlatArray
     T           *device; ///< \todo: device memory is currently allocated of size capacity, not length; is that right?
 #endif
 
-    int          length;
-    int          capacity;
+    eavlIndex    length;
+    eavlIndex    capacity;
     T           *host;
     bool         copied; ///< if this flag is set
 
@@ -86,7 +89,7 @@ class eavlFlatArray
         host   = NULL;
         copied = true;
     }
-    eavlFlatArray(int len = 0)
+    eavlFlatArray(eavlIndex len = 0)
     {
         if (len > 0)
         {
@@ -157,7 +160,7 @@ class eavlFlatArray
 
         // copy old to new
         T *newhost = new T[newcap];
-        for (int i=0; i<length; ++i)
+        for (eavlIndex i=0; i<length; ++i)
             newhost[i] = host[i];
 
         // make new old
@@ -208,7 +211,7 @@ class eavlFlatArray
             THROW(eavlException,"eavlFlatArray was copied by value");
         if (state == LAST_MODIFIED_HOST)
         {
-            int nbytes = length * sizeof(T);
+            size_t nbytes = length * sizeof(T);
             if (!device)
             {
                 cudaMalloc((void**)&device, nbytes);
@@ -226,7 +229,7 @@ class eavlFlatArray
             THROW(eavlException,"eavlFlatArray was copied by value");
         if (state == LAST_MODIFIED_DEV)
         {
-            int nbytes = length * sizeof(T);
+            size_t nbytes = length * sizeof(T);
             // assert(device != NULL)
             cudaMemcpy(&(host[0]), device,
                        nbytes, cudaMemcpyDeviceToHost);
@@ -245,13 +248,13 @@ class eavlFlatArray
     /// we have to ifdef out one of the two.  Check if newer CUDA versions
     /// fix this.
 #ifdef __CUDA_ARCH__
-    EAVL_DEVICEONLY const T &operator[](int index) const
+    EAVL_DEVICEONLY const T &operator[](eavlIndex index) const
     {
         //printf("const-accessor on device, copied=%d index=%d\n",int(copied),index);
         return device[index];
     }
 #else
-    EAVL_HOSTONLY const inline T &operator[](int index) const
+    EAVL_HOSTONLY const inline T &operator[](eavlIndex index) const
     {
         // disabled for performance temporarily;
         //if (copied)
@@ -262,13 +265,13 @@ class eavlFlatArray
 #endif
 
 #ifdef __CUDA_ARCH__
-    EAVL_DEVICEONLY T &operator[](int index)
+    EAVL_DEVICEONLY T &operator[](eavlIndex index)
     {
         //printf("non-const-accessor on device, copied=%d index=%d\n",int(copied),index);
         return device[index];
     }
 #else
-    EAVL_HOSTONLY inline T &operator[](int index)
+    EAVL_HOSTONLY inline T &operator[](eavlIndex index)
     {
         ///\todo: do we call NeedOnHost here?
         ///       I'd say let's force clients to call it manually,
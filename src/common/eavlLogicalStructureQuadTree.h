@@ -96,7 +96,7 @@ class eavlCoordinatesQuadTree : public eavlCoordinates
         SetAxis(0, new eavlCoordinateAxisRegular(0, 0.0, 1.0));
         SetAxis(1, new eavlCoordinateAxisRegular(1, 0.0, 1.0));
     }
-    virtual double GetCartesianPoint(int i, int c,
+    virtual double GetCartesianPoint(eavlIndex i, int c,
                                      eavlLogicalStructure *log,
                                      vector<eavlField*>&fd)
     {
@@ -0,0 +1,355 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlMemoryPool.h"
+#include <stdlib.h>
+
+using std::vector;
+using std::endl;
+
+eavlMemoryPool *eavlMemoryPool::instance = NULL;
+const size_t    eavlMemoryPool::minimumPooledBytes;
+const int       eavlMemoryPool::classesPerDoubling;
+
+// by default, keep up to this many freed bytes around for reuse
+static const long long defaultMaxCachedBytes = 1LL << 30;
+
+// ****************************************************************************
+// Constructor:  eavlMemoryPool::eavlMemoryPool
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlMemoryPool::eavlMemoryPool()
+{
+    enabled = true;
+    maxCachedBytes = defaultMaxCachedBytes;
+    freeBlocks.resize(classesPerDoubling * (8*sizeof(size_t) + 1));
+    stats.requests = 0;
+    stats.hits = 0;
+    stats.misses = 0;
+    stats.unpooled = 0;
+    stats.returns = 0;
+    stats.releases = 0;
+    stats.bytesInUse = 0;
+    stats.peakBytesInUse = 0;
+    stats.bytesCached = 0;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::Instance
+//
+// Purpose:
+///   Return the pool singleton.  It is never destroyed, so arrays which
+///   outlive other static objects can still return their storage.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlMemoryPool *
+eavlMemoryPool::Instance()
+{
+    if (!instance)
+        instance = new eavlMemoryPool;
+    return instance;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::GetSizeClass
+//
+// Purpose:
+///   Return the size class for a request of at least minimumPooledBytes.
+///   Class sizes are 2^k * (1 + j/classesPerDoubling).
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+int
+eavlMemoryPool::GetSizeClass(size_t nbytes)
+{
+    int k = 0;
+    while ((nbytes >> (k+1)) != 0)
+        ++k;
+    size_t base = size_t(1) << k;
+    size_t step = base / classesPerDoubling;
+    int j = (int)((nbytes - base + step - 1) / step);
+    return k * classesPerDoubling + j;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::GetSizeClassBytes
+//
+// Purpose:
+///   The number of bytes actually allocated for a request of "nbytes".
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+size_t
+eavlMemoryPool::GetSizeClassBytes(size_t nbytes)
+{
+    if (nbytes < minimumPooledBytes)
+        return nbytes;
+    int c = GetSizeClass(nbytes);
+    int k = c / classesPerDoubling;
+    int j = c % classesPerDoubling;
+    size_t base = size_t(1) << k;
+    return base + j * (base / classesPerDoubling);
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::Allocate
+//
+// Purpose:
+///   Allocate at least "nbytes", from the cache if possible.  Throws
+///   std::bad_alloc on failure.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void *
+eavlMemoryPool::Allocate(size_t nbytes)
+{
+    eavlMemoryPool *pool = Instance();
+    if (nbytes < minimumPooledBytes)
+    {
+        pool->mutex.Lock();
+        pool->stats.unpooled++;
+        pool->mutex.Unlock();
+        void *ptr = malloc(nbytes > 0 ? nbytes : 1);
+        if (!ptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+
+    int c = GetSizeClass(nbytes);
+    long long classbytes = GetSizeClassBytes(nbytes);
+
+    // only the free lists and counters are locked, never the system
+    // allocator, so threads missing the cache allocate concurrently
+    void *ptr = NULL;
+    {
+        eavlMutexLocker lock(pool->mutex);
+        pool->stats.requests++;
+        vector<void*> &blocks = pool->freeBlocks[c];
+        if (pool->enabled && !blocks.empty())
+        {
+            ptr = blocks.back();
+            blocks.pop_back();
+            pool->stats.hits++;
+            pool->stats.bytesCached -= classbytes;
+            pool->AddBytesInUse(classbytes);
+            return ptr;
+        }
+    }
+
+    ptr = malloc(classbytes);
+    if (!ptr)
+    {
+        // give the cached memory back and try again
+        Trim();
+        ptr = malloc(classbytes);
+        if (!ptr)
+            throw std::bad_alloc();
+    }
+
+    eavlMutexLocker lock(pool->mutex);
+    pool->stats.misses++;
+    pool->AddBytesInUse(classbytes);
+    return ptr;
+}
+
+void
+eavlMemoryPool::AddBytesInUse(long long nbytes)
+{
+    stats.bytesInUse += nbytes;
+    if (stats.bytesInUse > stats.peakBytesInUse)
+        stats.peakBytesInUse = stats.bytesInUse;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::Deallocate
+//
+// Purpose:
+///   Return a block obtained from Allocate("nbytes") to the pool.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::Deallocate(void *ptr, size_t nbytes)
+{
+    if (!ptr)
+        return;
+    if (nbytes < minimumPooledBytes)
+    {
+        free(ptr);
+        return;
+    }
+
+    eavlMemoryPool *pool = Instance();
+    long long classbytes = GetSizeClassBytes(nbytes);
+    {
+        eavlMutexLocker lock(pool->mutex);
+        pool->stats.bytesInUse -= classbytes;
+        if (pool->enabled &&
+            pool->stats.bytesCached + classbytes <= pool->maxCachedBytes)
+        {
+            pool->freeBlocks[GetSizeClass(nbytes)].push_back(ptr);
+            pool->stats.bytesCached += classbytes;
+            pool->stats.returns++;
+            return;
+        }
+        pool->stats.releases++;
+    }
+    free(ptr);
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::SetEnabled
+//
+// Purpose:
+///   Turn caching on or off.  Turning it off releases the cache.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::SetEnabled(bool e)
+{
+    eavlMemoryPool *pool = Instance();
+    {
+        eavlMutexLocker lock(pool->mutex);
+        pool->enabled = e;
+    }
+    if (!e)
+        Trim();
+}
+
+bool
+eavlMemoryPool::GetEnabled()
+{
+    eavlMemoryPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    return pool->enabled;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::SetMaxCachedBytes
+//
+// Purpose:
+///   Bound the number of freed bytes kept for reuse.  Lowering the bound
+///   does not release blocks already cached; call Trim for that.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::SetMaxCachedBytes(long long n)
+{
+    eavlMemoryPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    pool->maxCachedBytes = n;
+}
+
+long long
+eavlMemoryPool::GetMaxCachedBytes()
+{
+    eavlMemoryPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    return pool->maxCachedBytes;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::Trim
+//
+// Purpose:
+///   Release every cached block back to the system.  The blocks are taken
+///   off the free lists under the lock, but freed after releasing it.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::Trim()
+{
+    eavlMemoryPool *pool = Instance();
+    vector<void*> released;
+    {
+        eavlMutexLocker lock(pool->mutex);
+        for (size_t c=0; c<pool->freeBlocks.size(); c++)
+        {
+            vector<void*> &blocks = pool->freeBlocks[c];
+            released.insert(released.end(), blocks.begin(), blocks.end());
+            blocks.clear();
+        }
+        pool->stats.releases += released.size();
+        pool->stats.bytesCached = 0;
+    }
+    for (size_t i=0; i<released.size(); i++)
+        free(released[i]);
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::GetStatistics
+//
+// Purpose:
+///   Return a snapshot of the pool counters.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlMemoryPoolStatistics
+eavlMemoryPool::GetStatistics()
+{
+    eavlMemoryPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    return pool->stats;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::ResetStatistics
+//
+// Purpose:
+///   Zero the event counters.  The byte counts describe the current state
+///   of the pool and are kept, with the peak reset to the current usage.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::ResetStatistics()
+{
+    eavlMemoryPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    eavlMemoryPoolStatistics &s = pool->stats;
+    s.requests = 0;
+    s.hits = 0;
+    s.misses = 0;
+    s.unpooled = 0;
+    s.returns = 0;
+    s.releases = 0;
+    s.peakBytesInUse = s.bytesInUse;
+}
+
+// ****************************************************************************
+// Method:  eavlMemoryPool::PrintStatistics
+//
+// Purpose:
+///   Print the pool counters.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlMemoryPool::PrintStatistics(std::ostream &out)
+{
+    eavlMemoryPoolStatistics s = GetStatistics();
+    out << "\nMemory pool\n-----------\n";
+    out << "pooled requests:   " << s.requests
+        << " (" << s.hits << " hits, " << s.misses << " misses)" << endl;
+    out << "unpooled requests: " << s.unpooled << endl;
+    out << "blocks cached:     " << s.returns << endl;
+    out << "blocks released:   " << s.releases << endl;
+    out << "bytes in use:      " << s.bytesInUse
+        << " (peak " << s.peakBytesInUse << ")" << endl;
+    out << "bytes cached:      " << s.bytesCached << endl;
+}
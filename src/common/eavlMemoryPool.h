@@ -0,0 +1,153 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_MEMORY_POOL_H
+#define EAVL_MEMORY_POOL_H
+
+#include <vector>
+#include <iostream>
+#include <cstddef>
+#include <new>
+#include "eavlThreadPool.h"
+
+// ****************************************************************************
+// Struct:  eavlMemoryPoolStatistics
+//
+// Purpose:
+///   Counters describing the activity of eavlMemoryPool.  Byte counts are
+///   in terms of size-class bytes, i.e. after rounding requests up.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+struct eavlMemoryPoolStatistics
+{
+    long long requests;       ///< allocations large enough to be pooled
+    long long hits;           ///< ... which were satisfied from the cache
+    long long misses;         ///< ... which needed a new system allocation
+    long long unpooled;       ///< allocations too small to be pooled
+    long long returns;        ///< blocks kept in the cache when freed
+    long long releases;       ///< blocks freed back to the system
+    long long bytesInUse;     ///< pooled bytes currently handed out
+    long long peakBytesInUse; ///< high water mark of bytesInUse
+    long long bytesCached;    ///< bytes held in the cache for reuse
+};
+
+// ****************************************************************************
+// Class:  eavlMemoryPool
+//
+// Purpose:
+///   A size-class pool for the host storage of eavlConcreteArrays.
+///   Requests of at least GetMinimumPooledBytes are rounded up to one of
+///   four size classes per power of two, and freed blocks are cached per
+///   class instead of being returned to the system.  Filters which create
+///   and destroy the same temporary arrays on every execution therefore
+///   reuse memory that is already mapped, rather than paying for fresh
+///   allocations and page faults each time.
+///
+///   The cache is bounded by SetMaxCachedBytes; blocks freed beyond that
+///   are released to the system.  Disabling the pool stops caching (and
+///   releases the cache), but blocks are still sized by class so that
+///   they may be freed in either state.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   Guard the pool with an eavlMutex rather than an OpenMP critical
+//   section, so arrays may also be created and destroyed concurrently by
+//   eavlThreadPool tasks in builds without OpenMP.
+//
+//   The mutex covers only the free lists, settings, and counters; the
+//   system allocator is called outside it.
+// ****************************************************************************
+class eavlMemoryPool
+{
+  public:
+    static void *Allocate(size_t nbytes);
+    static void  Deallocate(void *ptr, size_t nbytes);
+
+    static void  SetEnabled(bool e);
+    static bool  GetEnabled();
+    static void  SetMaxCachedBytes(long long n);
+    static long long GetMaxCachedBytes();
+    static size_t GetMinimumPooledBytes() { return minimumPooledBytes; }
+    static size_t GetSizeClassBytes(size_t nbytes);
+
+    static void  Trim();
+    static eavlMemoryPoolStatistics GetStatistics();
+    static void  ResetStatistics();
+    static void  PrintStatistics(std::ostream &);
+
+  private:
+    static eavlMemoryPool *Instance();
+    eavlMemoryPool();
+
+    static int   GetSizeClass(size_t nbytes);
+    void         AddBytesInUse(long long nbytes);
+
+    static const size_t minimumPooledBytes = 4096;
+    static const int    classesPerDoubling = 4;
+
+    static eavlMemoryPool *instance;
+
+    eavlMutex                        mutex;
+    bool                             enabled;
+    long long                        maxCachedBytes;
+    std::vector<std::vector<void*> > freeBlocks;
+    eavlMemoryPoolStatistics         stats;
+};
+
+// ****************************************************************************
+// Class:  eavlPoolAllocator
+//
+// Purpose:
+///   Standard-library allocator drawing from eavlMemoryPool, so vectors
+///   (in particular eavlConcreteArray storage) can use the pool.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+template <class T>
+class eavlPoolAllocator
+{
+  public:
+    typedef T              value_type;
+    typedef T             *pointer;
+    typedef const T       *const_pointer;
+    typedef T             &reference;
+    typedef const T       &const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+    template <class U> struct rebind { typedef eavlPoolAllocator<U> other; };
+
+    eavlPoolAllocator() { }
+    template <class U> eavlPoolAllocator(const eavlPoolAllocator<U> &) { }
+
+    pointer       address(reference x) const { return &x; }
+    const_pointer address(const_reference x) const { return &x; }
+    pointer allocate(size_type n, const void * = 0)
+    {
+        return (pointer)eavlMemoryPool::Allocate(n * sizeof(T));
+    }
+    void deallocate(pointer p, size_type n)
+    {
+        eavlMemoryPool::Deallocate(p, n * sizeof(T));
+    }
+    size_type max_size() const { return size_type(-1) / sizeof(T); }
+    void construct(pointer p, const T &v) { new((void*)p) T(v); }
+    void destroy(pointer p) { p->~T(); }
+};
+
+template <class T, class U>
+inline bool operator==(const eavlPoolAllocator<T> &, const eavlPoolAllocator<U> &)
+{
+    return true;
+}
+
+template <class T, class U>
+inline bool operator!=(const eavlPoolAllocator<T> &, const eavlPoolAllocator<U> &)
+{
+    return false;
+}
+
+#endif
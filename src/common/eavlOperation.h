@@ -16,6 +16,7 @@
 #include "eavlRefTuple.h"
 #include "eavlTupleTraits.h"
 #include "eavlCollect.h"
+#include "eavlThreadPool.h"
 
 
 // Create a tuple of indexable arrays.  This style is called if your inputs are all eavlIndexable<> types already.
@@ -203,6 +204,11 @@ struct eavlArrayWithLinearIndex
 // Programmer:  Jeremy Meredith, Dave Pugmire, Sean Ahern, Rob Sisneros
 // Creation:    September 2, 2011
 //
+// Modifications:
+//   Added GoCPUThreadPool, used by the executor's ForceCPUThreadPool mode.
+//   By default it runs the operation's fused kernel, if it has one, on
+//   eavlThreadPool::ParallelFor, and otherwise falls back to GoCPU.
+//
 // ****************************************************************************
 
 // Note:
@@ -369,8 +375,112 @@ struct DummyFunctor
     void operator()(void) { }
 };
 
+// ****************************************************************************
+// Class:  eavlFusionAccess
+//
+// Purpose:
+///   Describes how an operation touches one of its arrays, so the executor
+///   can decide whether adjacent operations may be fused into a single
+///   traversal.  ELEMENT accesses touch only the location computed by the
+///   indexer for the current item; SPARSE accesses may touch any location.
+///   The same descriptions let eavlTrace split traced array traffic into
+///   bytes read and bytes written, and let the executor find which
+///   operations of an asynchronous plan may run concurrently.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+struct eavlFusionAccess
+{
+    enum Mode { ELEMENT_READ, SPARSE_READ, ELEMENT_WRITE, SPARSE_WRITE };
+    eavlArray        *array;
+    eavlArrayIndexer  indexer;
+    Mode              mode;
+    eavlFusionAccess(eavlArray *a, const eavlArrayIndexer &i, Mode m)
+        : array(a), indexer(i), mode(m)
+    {
+    }
+    eavlFusionAccess(const eavlArrayWithLinearIndex &a, Mode m)
+        : array(a.array), indexer(a.div, a.mod, a.mul, a.add), mode(m)
+    {
+    }
+    bool SameIndexing(const eavlFusionAccess &f) const
+    {
+        return indexer.div == f.indexer.div &&
+               indexer.mod == f.indexer.mod &&
+               indexer.mul == f.indexer.mul &&
+               indexer.add == f.indexer.add;
+    }
+    /// True if the two never touch the same location, e.g. separate
+    /// components of the same array.
+    bool Disjoint(const eavlFusionAccess &f) const
+    {
+        return indexer.mul == f.indexer.mul &&
+               indexer.add != f.indexer.add &&
+               indexer.add >= 0 && indexer.add < indexer.mul &&
+               f.indexer.add >= 0 && f.indexer.add < f.indexer.mul;
+    }
+};
+
+// collect the fusion accesses for a tuple of eavlIndexable arrays
+inline void eavlCollectFusionAccesses(const nulltype &, eavlFusionAccess::Mode,
+                                      vector<eavlFusionAccess> &)
+{
+}
+
+template <class FT>
+inline void eavlCollectFusionAccesses(const cons<FT,nulltype> &t,
+                                      eavlFusionAccess::Mode mode,
+                                      vector<eavlFusionAccess> &accesses)
+{
+    accesses.push_back(eavlFusionAccess(t.first.array, t.first.indexer, mode));
+}
+
+template <class FT, class RT>
+inline void eavlCollectFusionAccesses(const cons<FT,RT> &t,
+                                      eavlFusionAccess::Mode mode,
+                                      vector<eavlFusionAccess> &accesses)
+{
+    accesses.push_back(eavlFusionAccess(t.first.array, t.first.indexer, mode));
+    eavlCollectFusionAccesses(t.rest, mode, accesses);
+}
+
+// ****************************************************************************
+// Class:  eavlFusedKernel
+//
+// Purpose:
+///   A CPU kernel whose arrays have already been resolved to raw host
+///   pointers, and which can be run over any sub-range of its iteration
+///   domain.  The executor interleaves these across several operations
+///   one block of items at a time when it fuses a plan, and runs them
+///   alone on eavlThreadPool::ParallelFor in the ForceCPUThreadPool mode.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlFusedKernel : public eavlParallelForBody
+{
+  public:
+    virtual ~eavlFusedKernel() { }
+    virtual void Run(eavlIndex begin, eavlIndex end) = 0;
+};
+
+// dispatch state for binding a fused kernel of a topology map; the
+// connectivity is held by reference for explicit cell sets
+template <class CONN>
+struct eavlFusedTopologyBinding
+{
+    CONN             conn;
+    eavlFusedKernel *kernel;
+    eavlFusedTopologyBinding(CONN c) : conn(c), kernel(NULL)
+    {
+    }
+};
+
 
-class eavlOperation 
+class eavlOperation
 {
     friend class eavlExecutor;
   public:
@@ -378,6 +488,42 @@ class eavlOperation
   protected:
     virtual void GoCPU() = 0;
     virtual void GoGPU() = 0;
+    virtual void GoCPUThreadPool()
+    {
+        eavlIndex n = GetFusionDomain();
+        eavlFusedKernel *kernel = (n > 0) ? BindFusedKernelCPU() : NULL;
+        if (!kernel)
+        {
+            GoCPU();
+            return;
+        }
+        try
+        {
+            eavlThreadPool::ParallelFor(n, *kernel);
+        }
+        catch (...)
+        {
+            delete kernel;
+            throw;
+        }
+        delete kernel;
+    }
+
+    // Optional interface for plan fusion.  Operations which return a
+    // non-negative fusion domain must also report every array access
+    // and be able to bind a range-based CPU kernel.  Reporting accesses
+    // alone is still useful; the executor's trace mode uses them.
+    virtual eavlIndex GetFusionDomain()
+    {
+        return -1;
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &)
+    {
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        return NULL;
+    }
 };
 
 #endif
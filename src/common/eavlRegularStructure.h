@@ -20,6 +20,9 @@
 //   Jeremy Meredith, Fri Oct 19 16:54:36 EDT 2012
 //   Added reverse connectivity (i.e. get cells attached to a node).
 //
+//   Entity counts and linear cell and node indices are eavlIndex, and
+//   are computed without overflowing an int in 64-bit index builds.
+//
 // ****************************************************************************
 struct eavlRegularStructure
 {
@@ -138,110 +141,110 @@ struct eavlRegularStructure
     }
 
     //
-    EAVL_HOSTDEVICE int CalculateCellIndex1D(int i)
+    EAVL_HOSTDEVICE eavlIndex CalculateCellIndex1D(int i)
     {
         return i;
     }
-    EAVL_HOSTDEVICE int CalculateCellIndex2D(int i, int j)
+    EAVL_HOSTDEVICE eavlIndex CalculateCellIndex2D(int i, int j)
     {
-        return j * cellDims[0] + i;
+        return eavlIndex(j) * cellDims[0] + i;
     }
-    EAVL_HOSTDEVICE int CalculateCellIndex3D(int i, int j, int k)
+    EAVL_HOSTDEVICE eavlIndex CalculateCellIndex3D(int i, int j, int k)
     {
-        return (k * cellDims[1] + j) * cellDims[0] + i;
+        return (eavlIndex(k) * cellDims[1] + j) * cellDims[0] + i;
     }
 
     //
-    EAVL_HOSTDEVICE int CalculateNodeIndex1D(int i)
+    EAVL_HOSTDEVICE eavlIndex CalculateNodeIndex1D(int i)
     {
         return i;
     }
-    EAVL_HOSTDEVICE int CalculateNodeIndex2D(int i, int j)
+    EAVL_HOSTDEVICE eavlIndex CalculateNodeIndex2D(int i, int j)
     {
-        return j * nodeDims[0] + i;
+        return eavlIndex(j) * nodeDims[0] + i;
     }
-    EAVL_HOSTDEVICE int CalculateNodeIndex3D(int i, int j, int k)
+    EAVL_HOSTDEVICE eavlIndex CalculateNodeIndex3D(int i, int j, int k)
     {
-        return (k * nodeDims[1] + j) * nodeDims[0] + i;
+        return (eavlIndex(k) * nodeDims[1] + j) * nodeDims[0] + i;
     }
 
     //
-    EAVL_HOSTDEVICE void CalculateLogicalCellIndices1D(int index, int &i)
+    EAVL_HOSTDEVICE void CalculateLogicalCellIndices1D(eavlIndex index, int &i)
     {
         i = index;
     }
-    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices1D(int index, int &i)
+    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices1D(eavlIndex index, int &i)
     {
         i = index;
     }
 
-    EAVL_HOSTDEVICE void CalculateLogicalCellIndices2D(int index,
+    EAVL_HOSTDEVICE void CalculateLogicalCellIndices2D(eavlIndex index,
                                                            int &i, int &j)
     {
         j = index / cellDims[0];
         i = index % cellDims[0];
     }
-    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices2D(int index,
+    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices2D(eavlIndex index,
                                                            int &i, int &j)
     {
         j = index / nodeDims[0];
         i = index % nodeDims[0];
     }
 
-    EAVL_HOSTDEVICE void CalculateLogicalCellIndices3D(int index,
+    EAVL_HOSTDEVICE void CalculateLogicalCellIndices3D(eavlIndex index,
                                                         int &i, int &j, int &k)
     {
-        int cellDims01 = cellDims[0] * cellDims[1];
+        eavlIndex cellDims01 = eavlIndex(cellDims[0]) * cellDims[1];
         k = index / cellDims01;
-        int indexij = index % cellDims01;
+        eavlIndex indexij = index % cellDims01;
         j = indexij / cellDims[0];
         i = indexij % cellDims[0];
     }
-    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices3D(int index,
+    EAVL_HOSTDEVICE void CalculateLogicalNodeIndices3D(eavlIndex index,
                                                         int &i, int &j, int &k)
     {
-        int nodeDims01 = nodeDims[0] * nodeDims[1];
+        eavlIndex nodeDims01 = eavlIndex(nodeDims[0]) * nodeDims[1];
         k = index / nodeDims01;
-        int indexij = index % nodeDims01;
+        eavlIndex indexij = index % nodeDims01;
         j = indexij / nodeDims[0];
         i = indexij % nodeDims[0];
     }
 
 
-    EAVL_HOSTDEVICE int GetNumCells()
+    EAVL_HOSTDEVICE eavlIndex GetNumCells()
     {
         if (dimension == 1)
             return cellDims[0];
         else if (dimension == 2)
-            return cellDims[0]*cellDims[1];
+            return eavlIndex(cellDims[0])*cellDims[1];
         else if (dimension == 3)
-            return cellDims[0]*cellDims[1]*cellDims[2];
+            return eavlIndex(cellDims[0])*cellDims[1]*cellDims[2];
         else
             return 0;
     }
-    EAVL_HOSTDEVICE int GetNumNodes()
+    EAVL_HOSTDEVICE eavlIndex GetNumNodes()
     {
         if (dimension == 1)
             return nodeDims[0];
         else if (dimension == 2)
-            return nodeDims[0]*nodeDims[1];
+            return eavlIndex(nodeDims[0])*nodeDims[1];
         else if (dimension == 3)
-            return nodeDims[0]*nodeDims[1]*nodeDims[2];
+            return eavlIndex(nodeDims[0])*nodeDims[1]*nodeDims[2];
         else
             return 0;
     }
-    EAVL_HOSTDEVICE int GetNumFaces()
+    EAVL_HOSTDEVICE eavlIndex GetNumFaces()
     {
         if (dimension == 3)
         {
-            int numXY = cellDims[0] * cellDims[1] * nodeDims[2];
-            int numXZ = cellDims[0] * nodeDims[1] * cellDims[2];
-            int numYZ = nodeDims[0] * cellDims[1] * cellDims[2];
+            eavlIndex numXY = eavlIndex(cellDims[0]) * cellDims[1] * nodeDims[2];
+            eavlIndex numXZ = eavlIndex(cellDims[0]) * nodeDims[1] * cellDims[2];
+            eavlIndex numYZ = eavlIndex(nodeDims[0]) * cellDims[1] * cellDims[2];
             return numXY + numXZ + numYZ;
         }
         return 0;
     }
-    EAVL_HOSTDEVICE int GetNumEdges()
+    EAVL_HOSTDEVICE eavlIndex GetNumEdges()
     {
         if (dimension == 1)
         {
@@ -249,15 +252,15 @@ struct eavlRegularStructure
         }
         if (dimension == 2)
         {
-            int numX = cellDims[0] * nodeDims[1];
-            int numY = nodeDims[0] * cellDims[1];
+            eavlIndex numX = eavlIndex(cellDims[0]) * nodeDims[1];
+            eavlIndex numY = eavlIndex(nodeDims[0]) * cellDims[1];
             return numX + numY;
         }
         else if (dimension == 3)
         {
-            int numX = cellDims[0] * nodeDims[1] * nodeDims[2];
-            int numY = nodeDims[0] * cellDims[1] * nodeDims[2];
-            int numZ = nodeDims[0] * nodeDims[1] * cellDims[2];
+            eavlIndex numX = eavlIndex(cellDims[0]) * nodeDims[1] * nodeDims[2];
+            eavlIndex numY = eavlIndex(nodeDims[0]) * cellDims[1] * nodeDims[2];
+            eavlIndex numZ = eavlIndex(nodeDims[0]) * nodeDims[1] * cellDims[2];
             return numX + numY + numZ;
         }
         return 0;
@@ -3,6 +3,7 @@
 #define EAVL_SERIALIZE_H
 
 #include "STL.h"
+#include "eavlException.h"
 #include <string.h>
 
 class eavlStream : public std::basic_iostream<char, std::char_traits<char> >
@@ -20,8 +21,8 @@ inline eavlStream& operator<<(eavlStream &s, const T &v)
     return s;
 }
 
-template <class T>
-inline eavlStream& operator<<(eavlStream &s, const vector<T> &a)
+template <class T, class A>
+inline eavlStream& operator<<(eavlStream &s, const vector<T,A> &a)
 {
     size_t sz = a.size();
     s.write((const char*)&sz, sizeof(sz));
@@ -71,8 +72,8 @@ inline eavlStream& operator>>(eavlStream &s, string &str)
     return s;
 }
 
-template <class T>
-inline eavlStream& operator>>(eavlStream &s, vector<T> &a)
+template <class T, class A>
+inline eavlStream& operator>>(eavlStream &s, vector<T,A> &a)
 {
     size_t sz;
     s.read((char*)&sz, sizeof(sz));
@@ -87,4 +88,107 @@ inline eavlStream& operator>>(eavlStream &s, vector<T> &a)
     return s;
 }
 
+// ****************************************************************************
+// Class:  eavlSnapshotHeader
+//
+// Purpose:
+///   The fixed-size header at the start of a snapshot file.  The
+///   serialized data set follows it, and after that the array values at
+///   page-aligned offsets.  Readers reject files of a newer version or
+///   written with a different byte order or size_t or index width.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+struct eavlSnapshotHeader
+{
+    enum { CurrentVersion = 1, ByteOrderMark = 0x01020304 };
+
+    char               magic[8];       ///< "EAVLSNAP"
+    unsigned int       version;
+    unsigned int       byteOrder;      ///< ByteOrderMark, as written
+    unsigned int       sizeofSize;     ///< sizeof(size_t) of the writer
+    unsigned int       sizeofIndex;    ///< sizeof(eavlIndex) of the writer
+    unsigned long long alignment;      ///< of the array values
+    unsigned long long metadataOffset;
+    unsigned long long metadataBytes;
+    unsigned long long payloadOffset;
+    unsigned long long payloadBytes;
+
+    static bool HasMagic(const char *buff)
+    {
+        return memcmp(buff, "EAVLSNAP", 8) == 0;
+    }
+};
+
+// ****************************************************************************
+// Class:  eavlSnapshotStream
+//
+// Purpose:
+///   An eavlStream for the memory-mapped snapshot format written by
+///   eavlSnapshotExporter.  Arrays which can wrap external host memory
+///   write only a reference to their values through AddPayload, and the
+///   exporter lays the values out after the metadata at page-aligned
+///   offsets.  When reading, GetPayload returns the mapped values, so
+///   those arrays are wrapped rather than copied.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+class eavlSnapshotStream : public eavlStream
+{
+  public:
+    struct Payload
+    {
+        const char *values;
+        size_t      nbytes;
+        size_t      offset; ///< from the start of the payload section
+    };
+
+  protected:
+    size_t          alignment;
+    size_t          payloadBytes;
+    vector<Payload> payloads;
+    char           *payloadBase;
+
+  public:
+    eavlSnapshotStream(ostream &os, size_t align)
+        : eavlStream(os), alignment(align), payloadBytes(0), payloadBase(NULL)
+    {
+    }
+    eavlSnapshotStream(istream &is, char *base, size_t nbytes)
+        : eavlStream(is), alignment(1), payloadBytes(nbytes), payloadBase(base)
+    {
+    }
+
+    /// Records nbytes of values to be written to the payload section and
+    /// returns their offset in it.  The values must stay valid until the
+    /// payloads have been written.
+    size_t AddPayload(const void *values, size_t nbytes)
+    {
+        Payload p;
+        p.values = (const char*)values;
+        p.nbytes = nbytes;
+        p.offset = payloadBytes;
+        payloads.push_back(p);
+        payloadBytes += (nbytes + alignment - 1) / alignment * alignment;
+        return p.offset;
+    }
+    const vector<Payload> &GetPayloads() const
+    {
+        return payloads;
+    }
+    size_t GetPayloadBytes() const
+    {
+        return payloadBytes;
+    }
+
+    char *GetPayload(size_t offset, size_t nbytes)
+    {
+        if (offset > payloadBytes || nbytes > payloadBytes - offset)
+            THROW(eavlException, "Snapshot array extends past the end of the file");
+        return payloadBase + offset;
+    }
+};
+
 #endif
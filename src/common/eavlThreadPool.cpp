@@ -0,0 +1,588 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlThreadPool.h"
+#include "eavlConfig.h"
+#include "eavlException.h"
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+#ifdef EAVL_HAVE_THREADS
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <string>
+#include <exception>
+
+eavlThreadPool *eavlThreadPool::instance = NULL;
+
+// ParallelFor aims for this many chunks per participating thread, so
+// threads finishing early have work left to steal, but never makes
+// chunks smaller than the minimum, to bound the scheduling overhead.
+static const int parallelForChunksPerThread = 8;
+static const int parallelForMinimumGrain = 256;
+
+#ifdef EAVL_HAVE_THREADS
+
+// holds (index + 1) of the worker running on each pool thread
+static pthread_key_t workerKey;
+static pthread_once_t workerKeyOnce = PTHREAD_ONCE_INIT;
+
+static void
+CreateWorkerKey()
+{
+    pthread_key_create(&workerKey, NULL);
+}
+
+struct eavlThreadPoolWorkerArgs
+{
+    eavlThreadPool *pool;
+    int             index;
+};
+
+eavlMutex::eavlMutex()
+{
+    pthread_mutex_init(&mutex, NULL);
+}
+
+eavlMutex::~eavlMutex()
+{
+    pthread_mutex_destroy(&mutex);
+}
+
+void
+eavlMutex::Lock()
+{
+    pthread_mutex_lock(&mutex);
+}
+
+void
+eavlMutex::Unlock()
+{
+    pthread_mutex_unlock(&mutex);
+}
+
+eavlCondition::eavlCondition()
+{
+    pthread_cond_init(&cond, NULL);
+}
+
+eavlCondition::~eavlCondition()
+{
+    pthread_cond_destroy(&cond);
+}
+
+void
+eavlCondition::Wait(eavlMutex &m)
+{
+    pthread_cond_wait(&cond, &m.mutex);
+}
+
+void
+eavlCondition::Signal()
+{
+    pthread_cond_signal(&cond);
+}
+
+void
+eavlCondition::Broadcast()
+{
+    pthread_cond_broadcast(&cond);
+}
+
+#else
+
+eavlMutex::eavlMutex() { }
+eavlMutex::~eavlMutex() { }
+void eavlMutex::Lock() { }
+void eavlMutex::Unlock() { }
+
+eavlCondition::eavlCondition() { }
+eavlCondition::~eavlCondition() { }
+void eavlCondition::Wait(eavlMutex &) { }
+void eavlCondition::Signal() { }
+void eavlCondition::Broadcast() { }
+
+#endif
+
+// ****************************************************************************
+// Constructor:  eavlThreadPool::eavlThreadPool
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlThreadPool::eavlThreadPool()
+{
+#ifdef HAVE_OPENMP
+    nthreads = omp_get_max_threads();
+#elif defined(EAVL_HAVE_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+    nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#else
+    nthreads = 1;
+#endif
+    if (nthreads < 2)
+        nthreads = 2;
+    running = false;
+    stopping = false;
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::Instance
+//
+// Purpose:
+///   Return the pool singleton.  It is never destroyed; idle workers
+///   simply wait until the process exits.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlThreadPool *
+eavlThreadPool::Instance()
+{
+    if (!instance)
+        instance = new eavlThreadPool;
+    return instance;
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::Submit
+//
+// Purpose:
+///   Queue a task to be run by the next free worker.  The pool takes
+///   ownership of the task.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::Submit(eavlTask *task)
+{
+#ifdef EAVL_HAVE_THREADS
+    eavlThreadPool *pool = Instance();
+    eavlMutexLocker lock(pool->mutex);
+    if (!pool->running)
+        pool->Start();
+    pool->queue.push_back(task);
+    pool->wake.Signal();
+#else
+    task->Run();
+    delete task;
+#endif
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::SetNumberOfThreads
+//
+// Purpose:
+///   Change the number of workers.  Tasks already submitted are finished
+///   by the current workers first.  Must not be called from a task.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::SetNumberOfThreads(int n)
+{
+    if (n < 1)
+        THROW(eavlException, "eavlThreadPool needs at least one thread.");
+    if (GetCurrentWorker() >= 0)
+        THROW(eavlException, "eavlThreadPool resized from one of its tasks.");
+    eavlThreadPool *pool = Instance();
+    pool->Stop();
+    pool->nthreads = n;
+}
+
+int
+eavlThreadPool::GetNumberOfThreads()
+{
+    return Instance()->nthreads;
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::GetCurrentWorker
+//
+// Purpose:
+///   Return the index of the worker calling this method, or -1 if the
+///   caller is not one of the pool's threads.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+int
+eavlThreadPool::GetCurrentWorker()
+{
+#ifdef EAVL_HAVE_THREADS
+    pthread_once(&workerKeyOnce, CreateWorkerKey);
+    return (int)(long)pthread_getspecific(workerKey) - 1;
+#else
+    return -1;
+#endif
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::Start
+//
+// Purpose:
+///   Launch the workers.  Called with the pool mutex held.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::Start()
+{
+#ifdef EAVL_HAVE_THREADS
+    pthread_once(&workerKeyOnce, CreateWorkerKey);
+    stopping = false;
+    threads.resize(nthreads);
+    for (int i=0; i<nthreads; i++)
+    {
+        eavlThreadPoolWorkerArgs *args = new eavlThreadPoolWorkerArgs;
+        args->pool = this;
+        args->index = i;
+        if (pthread_create(&threads[i], NULL, WorkerMain, args) != 0)
+        {
+            delete args;
+            THROW(eavlException, "eavlThreadPool could not create a thread.");
+        }
+    }
+    running = true;
+#endif
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::Stop
+//
+// Purpose:
+///   Let the workers drain the queue, then join them.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::Stop()
+{
+#ifdef EAVL_HAVE_THREADS
+    mutex.Lock();
+    if (!running)
+    {
+        mutex.Unlock();
+        return;
+    }
+    stopping = true;
+    wake.Broadcast();
+    mutex.Unlock();
+
+    for (size_t i=0; i<threads.size(); i++)
+        pthread_join(threads[i], NULL);
+
+    mutex.Lock();
+    threads.clear();
+    running = false;
+    stopping = false;
+    mutex.Unlock();
+#endif
+}
+
+#ifdef EAVL_HAVE_THREADS
+
+void *
+eavlThreadPool::WorkerMain(void *arg)
+{
+    eavlThreadPoolWorkerArgs *args = (eavlThreadPoolWorkerArgs*)arg;
+    eavlThreadPool *pool = args->pool;
+    int index = args->index;
+    delete args;
+    pthread_setspecific(workerKey, (void*)(long)(index + 1));
+    pool->RunWorker(index);
+    return NULL;
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::RunWorker
+//
+// Purpose:
+///   The worker loop: run queued tasks until the pool is stopped and the
+///   queue is empty.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::RunWorker(int)
+{
+    mutex.Lock();
+    while (true)
+    {
+        while (queue.empty() && !stopping)
+            wake.Wait(mutex);
+        if (queue.empty())
+            break;
+        eavlTask *task = queue.front();
+        queue.pop_front();
+        mutex.Unlock();
+        task->Run();
+        delete task;
+        mutex.Lock();
+    }
+    mutex.Unlock();
+}
+
+#endif
+
+// ****************************************************************************
+// Class:  eavlParallelForJob
+//
+// Purpose:
+///   The shared state of one ParallelFor.  Each participating thread owns
+///   a slot holding a range of chunk indices.  It takes chunks from the
+///   front of its own range, and when that is empty, steals the back half
+///   of the largest remaining range.  All chunks start in the caller's
+///   slot, so work spreads to helpers by successive halving.
+///
+///   Helpers are pool tasks, and may only start after the loop is done
+///   (when the pool is busy); they then find the job closed and return.
+///   The job is reference counted so such late helpers can still look.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlParallelForJob
+{
+  public:
+    struct Slot
+    {
+        eavlMutex mutex;
+        eavlIndex begin;
+        eavlIndex end;
+        Slot() : begin(0), end(0) { }
+    };
+
+    eavlParallelForBody *body;
+    eavlIndex            n;
+    eavlIndex            grain;
+    int                  nslots;
+    Slot                *slots;
+    eavlMutex            mutex;
+    eavlCondition        done;
+    int                  nextSlot;
+    int                  joined;
+    bool                 closed;
+    int                  refs;
+    std::string          error;
+
+    eavlParallelForJob(eavlParallelForBody *b, eavlIndex n_, eavlIndex g, int ns)
+        : body(b), n(n_), grain(g), nslots(ns), nextSlot(1), joined(0),
+          closed(false), refs(0)
+    {
+        slots = new Slot[nslots];
+        slots[0].end = (n + grain - 1) / grain;
+    }
+    ~eavlParallelForJob()
+    {
+        delete[] slots;
+    }
+    void Ref()
+    {
+        eavlMutexLocker lock(mutex);
+        ++refs;
+    }
+    void Unref()
+    {
+        mutex.Lock();
+        bool last = (--refs == 0);
+        mutex.Unlock();
+        if (last)
+            delete this;
+    }
+
+    bool Steal(int slot)
+    {
+        while (true)
+        {
+            int victim = -1;
+            eavlIndex most = 0;
+            for (int v=0; v<nslots; v++)
+            {
+                if (v == slot)
+                    continue;
+                slots[v].mutex.Lock();
+                eavlIndex remaining = slots[v].end - slots[v].begin;
+                slots[v].mutex.Unlock();
+                if (remaining > most)
+                {
+                    victim = v;
+                    most = remaining;
+                }
+            }
+            if (victim < 0)
+                return false;
+
+            Slot &vs = slots[victim];
+            vs.mutex.Lock();
+            eavlIndex remaining = vs.end - vs.begin;
+            eavlIndex begin = vs.end - (remaining + 1) / 2;
+            eavlIndex end = vs.end;
+            if (remaining > 0)
+                vs.end = begin;
+            vs.mutex.Unlock();
+            if (remaining <= 0)
+                continue;
+
+            Slot &own = slots[slot];
+            own.mutex.Lock();
+            own.begin = begin;
+            own.end = end;
+            own.mutex.Unlock();
+            return true;
+        }
+    }
+
+    void Work(int slot)
+    {
+        Slot &own = slots[slot];
+        while (true)
+        {
+            own.mutex.Lock();
+            eavlIndex chunk = (own.begin < own.end) ? own.begin++ : -1;
+            own.mutex.Unlock();
+            if (chunk >= 0)
+                body->Run(chunk * grain, std::min(n, (chunk + 1) * grain));
+            else if (!Steal(slot))
+                return;
+        }
+    }
+
+    // run a slot, keeping the first error to be thrown by the caller
+    void SafeWork(int slot)
+    {
+        std::string err;
+        try
+        {
+            Work(slot);
+        }
+        catch (const eavlException &e)
+        {
+            err = e.GetErrorText();
+        }
+        catch (const std::exception &e)
+        {
+            err = e.what();
+        }
+        catch (...)
+        {
+            err = "unknown error in eavlThreadPool::ParallelFor";
+        }
+        if (!err.empty())
+        {
+            eavlMutexLocker lock(mutex);
+            if (error.empty())
+                error = err;
+        }
+    }
+};
+
+class eavlParallelForTask : public eavlTask
+{
+  protected:
+    eavlParallelForJob *job;
+  public:
+    eavlParallelForTask(eavlParallelForJob *j) : job(j)
+    {
+        job->Ref();
+    }
+    virtual ~eavlParallelForTask()
+    {
+        job->Unref();
+    }
+    virtual void Run()
+    {
+        job->mutex.Lock();
+        if (job->closed || job->nextSlot >= job->nslots)
+        {
+            job->mutex.Unlock();
+            return;
+        }
+        int slot = job->nextSlot++;
+        job->joined++;
+        job->mutex.Unlock();
+
+        job->SafeWork(slot);
+
+        job->mutex.Lock();
+        if (--job->joined == 0)
+            job->done.Broadcast();
+        job->mutex.Unlock();
+    }
+};
+
+// ****************************************************************************
+// Method:  eavlThreadPool::GetParallelForGrain
+//
+// Purpose:
+///   The default number of items per chunk for a ParallelFor over "n".
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlIndex
+eavlThreadPool::GetParallelForGrain(eavlIndex n)
+{
+    int participants = GetNumberOfThreads() + 1;
+    eavlIndex grain = n / (participants * parallelForChunksPerThread);
+    grain = std::max(grain, eavlIndex(parallelForMinimumGrain));
+    return std::max(eavlIndex(1), std::min(grain, n));
+}
+
+// ****************************************************************************
+// Method:  eavlThreadPool::ParallelFor
+//
+// Purpose:
+///   Run "body" over [0,n) in chunks of "grain" items (by default, from
+///   GetParallelForGrain), on the calling thread and any pool workers
+///   free to help, balancing the load by work stealing.  Returns once
+///   every chunk has run.  If the body throws, the first error is thrown
+///   here as an eavlException after the other threads have stopped.
+///   May be called from pool tasks, including other ParallelFor bodies.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlThreadPool::ParallelFor(eavlIndex n, eavlParallelForBody &body, eavlIndex grain)
+{
+    if (n <= 0)
+        return;
+    if (grain <= 0)
+        grain = GetParallelForGrain(n);
+    eavlIndex nchunks = (n + grain - 1) / grain;
+    int nhelpers = 0;
+#ifdef EAVL_HAVE_THREADS
+    nhelpers = int(std::min(eavlIndex(GetNumberOfThreads()), nchunks - 1));
+#endif
+    if (nhelpers <= 0)
+    {
+        for (eavlIndex c=0; c<nchunks; c++)
+            body.Run(c * grain, std::min(n, (c + 1) * grain));
+        return;
+    }
+
+    eavlParallelForJob *job = new eavlParallelForJob(&body, n, grain,
+                                                     nhelpers + 1);
+    job->Ref();
+    for (int h=0; h<nhelpers; h++)
+        Submit(new eavlParallelForTask(job));
+
+    job->SafeWork(0);
+
+    job->mutex.Lock();
+    job->closed = true;
+    while (job->joined > 0)
+        job->done.Wait(job->mutex);
+    std::string error = job->error;
+    job->mutex.Unlock();
+    job->Unref();
+
+    if (!error.empty())
+        THROW(eavlException, error);
+}
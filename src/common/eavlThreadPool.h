@@ -0,0 +1,182 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_THREAD_POOL_H
+#define EAVL_THREAD_POOL_H
+
+#include "eavl.h"
+#include <vector>
+#include <deque>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#define EAVL_HAVE_THREADS
+#endif
+
+// ****************************************************************************
+// Class:  eavlMutex
+//
+// Purpose:
+///   A mutual exclusion lock for state shared between eavlThreadPool
+///   workers and other threads.  In builds without thread support it
+///   does nothing.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlMutex
+{
+    friend class eavlCondition;
+  public:
+    eavlMutex();
+    ~eavlMutex();
+    void Lock();
+    void Unlock();
+  private:
+    eavlMutex(const eavlMutex &);
+    void operator=(const eavlMutex &);
+#ifdef EAVL_HAVE_THREADS
+    pthread_mutex_t mutex;
+#endif
+};
+
+// ****************************************************************************
+// Class:  eavlMutexLocker
+//
+// Purpose:
+///   Holds an eavlMutex for the lifetime of the locker.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlMutexLocker
+{
+  public:
+    eavlMutexLocker(eavlMutex &m) : mutex(m) { mutex.Lock(); }
+    ~eavlMutexLocker() { mutex.Unlock(); }
+  private:
+    eavlMutexLocker(const eavlMutexLocker &);
+    void operator=(const eavlMutexLocker &);
+    eavlMutex &mutex;
+};
+
+// ****************************************************************************
+// Class:  eavlCondition
+//
+// Purpose:
+///   A condition variable, waited on with its eavlMutex held.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlCondition
+{
+  public:
+    eavlCondition();
+    ~eavlCondition();
+    void Wait(eavlMutex &m);
+    void Signal();
+    void Broadcast();
+  private:
+    eavlCondition(const eavlCondition &);
+    void operator=(const eavlCondition &);
+#ifdef EAVL_HAVE_THREADS
+    pthread_cond_t cond;
+#endif
+};
+
+// ****************************************************************************
+// Class:  eavlTask
+//
+// Purpose:
+///   A unit of work for eavlThreadPool.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlTask
+{
+  public:
+    virtual ~eavlTask() { }
+    virtual void Run() = 0;
+};
+
+// ****************************************************************************
+// Class:  eavlParallelForBody
+//
+// Purpose:
+///   The loop body for eavlThreadPool::ParallelFor, run over one chunk
+///   of the iteration range at a time.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlParallelForBody
+{
+  public:
+    virtual ~eavlParallelForBody() { }
+    virtual void Run(eavlIndex begin, eavlIndex end) = 0;
+};
+
+// ****************************************************************************
+// Class:  eavlThreadPool
+//
+// Purpose:
+///   A fixed set of worker threads running submitted eavlTasks in the
+///   order they were submitted.  The pool owns each task and deletes it
+///   after it runs.  Tasks must not throw; a task which can fail should
+///   record its error for whoever waits on it.
+///
+///   Workers are started on the first submission.  By default there are
+///   as many as there are OpenMP threads (or processors, without OpenMP),
+///   but at least two, so a single long task never keeps the pool from
+///   making progress on others.  In builds without thread support, tasks
+///   run synchronously inside Submit.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   Added ParallelFor, a work-stealing loop over chunks of a range.
+// ****************************************************************************
+class eavlThreadPool
+{
+  public:
+    static void Submit(eavlTask *task);
+    static void SetNumberOfThreads(int n);
+    static int  GetNumberOfThreads();
+    /// The index of the calling worker, or -1 if called from a thread
+    /// which does not belong to the pool.
+    static int  GetCurrentWorker();
+
+    static void ParallelFor(eavlIndex n, eavlParallelForBody &body,
+                            eavlIndex grain = 0);
+    static eavlIndex GetParallelForGrain(eavlIndex n);
+
+  private:
+    static eavlThreadPool *Instance();
+    eavlThreadPool();
+
+    void Start();
+    void Stop();
+#ifdef EAVL_HAVE_THREADS
+    static void *WorkerMain(void *arg);
+    void         RunWorker(int index);
+#endif
+
+    static eavlThreadPool *instance;
+
+    int                     nthreads;
+    bool                    running;
+    bool                    stopping;
+    eavlMutex               mutex;
+    eavlCondition           wake;
+    std::deque<eavlTask*>   queue;
+#ifdef EAVL_HAVE_THREADS
+    std::vector<pthread_t>  threads;
+#endif
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "eavl.h"
 #include "eavlException.h"
 #include "eavlExecutor.h"
+#include "eavlTrace.h"
 #include "eavlCUDA.h"
 
 #ifdef HAVE_CUDA
@@ -206,7 +207,7 @@ int eavlTimer::real_Start()
 
 #pragma omp barrier
 #ifdef HAVE_CUDA
-    if (eavlExecutor::GetExecutionMode() != eavlExecutor::ForceCPU)
+    if (!eavlExecutor::ForcingCPU())
     {
         cudaThreadSynchronize();
         CUDA_CHECK_ERROR();
@@ -236,6 +237,9 @@ int eavlTimer::real_Start()
 //  Programmer:  Jeremy Meredith
 //  Creation:    August  9, 2004
 //
+//  Modifications:
+//    Report the timed region to eavlTrace when tracing is enabled.
+//
 // ****************************************************************************
 double eavlTimer::real_Stop(int handle, const std::string &description)
 {
@@ -244,7 +248,7 @@ double eavlTimer::real_Stop(int handle, const std::string &description)
 
 #pragma omp barrier
 #ifdef HAVE_CUDA
-    if (eavlExecutor::GetExecutionMode() != eavlExecutor::ForceCPU)
+    if (!eavlExecutor::ForcingCPU())
     {
         cudaThreadSynchronize();
         CUDA_CHECK_ERROR();
@@ -262,6 +266,9 @@ double eavlTimer::real_Stop(int handle, const std::string &description)
     double length = DiffTime(startTimes[handle], t);
     timeLengths.push_back(length);
 
+    if (eavlTrace::IsEnabled())
+        eavlTrace::AddRegion(description, eavlTrace::Now() - length, length);
+
     char str[2048];
     sprintf(str, "%*s%s", currentActiveTimers*3, " ", description.c_str());
     descriptions.push_back(str);
@@ -0,0 +1,451 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlTrace.h"
+#include "eavl.h"
+#include "eavlThreadPool.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+#include <sys/timeb.h>
+#else
+#include <sys/time.h>
+#endif
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+using std::string;
+using std::vector;
+using std::map;
+
+bool                              eavlTrace::enabled = false;
+double                            eavlTrace::origin = 0;
+vector<eavlTrace::Event>          eavlTrace::events;
+vector<eavlTrace::Open>           eavlTrace::open;
+
+static const int declaredRead  = 1;
+static const int declaredWrite = 2;
+
+// guards all of the recorded state
+static eavlMutex &
+TraceMutex()
+{
+    static eavlMutex mutex;
+    return mutex;
+}
+
+// ----------------------------------------------------------------------------
+static void
+WriteJSONString(std::ostream &out, const string &s)
+{
+    out << '"';
+    for (size_t i=0; i<s.length(); i++)
+    {
+        char c = s[i];
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if ((unsigned char)c < 0x20)
+        {
+            char buf[8];
+            sprintf(buf, "\\u%04x", (int)c);
+            out << buf;
+        }
+        else
+            out << c;
+    }
+    out << '"';
+}
+
+eavlTrace::Event::Event(const string &n, const string &c, char p, double s)
+    : name(n), category(c), phase(p), start(s), duration(0), items(0),
+      bytesRead(0), bytesWritten(0), bytesUnclassified(0),
+      toDeviceCount(0), toDeviceBytes(0), toHostCount(0), toHostBytes(0),
+      threads(1), thread(eavlThreadPool::GetCurrentWorker() + 1)
+{
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::CurrentThread
+//
+// Purpose:
+///   The operation state of the calling thread: one for each pool worker,
+///   and one shared by all other threads.  Call with the mutex held.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+eavlTrace::Open &
+eavlTrace::CurrentThread()
+{
+    size_t index = eavlThreadPool::GetCurrentWorker() + 1;
+    if (index >= open.size())
+        open.resize(index + 1);
+    return open[index];
+}
+
+void
+eavlTrace::Close(Open &o)
+{
+    o.event = -1;
+    o.dispatches.clear();
+    o.declared.clear();
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::Enable
+//
+// Purpose:
+///   Start recording events.  Event times are relative to the first
+///   time tracing was enabled since the last Clear.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::Enable()
+{
+    eavlMutexLocker lock(TraceMutex());
+    if (events.empty())
+        origin = Now();
+    enabled = true;
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::Disable
+//
+// Purpose:
+///   Stop recording events.  Events recorded so far are kept for Dump.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::Disable()
+{
+    enabled = false;
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::Clear
+//
+// Purpose:
+///   Discard all recorded events.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::Clear()
+{
+    eavlMutexLocker lock(TraceMutex());
+    events.clear();
+    open.clear();
+    origin = Now();
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::BeginOperation
+//
+// Purpose:
+///   Open an event for an operation (or fused group of operations) about
+///   to be executed.  Dispatches and transfers until the matching
+///   EndOperation are attributed to it.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::BeginOperation(const string &name)
+{
+    if (!enabled)
+        return;
+    Event e(name, "operation", 'X', Now());
+#ifdef HAVE_OPENMP
+    e.threads = omp_get_max_threads();
+#endif
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    Close(o);
+    o.event = events.size();
+    events.push_back(e);
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::DeclareAccess
+//
+// Purpose:
+///   Note that the current operation reads and/or writes the given array,
+///   which is how dispatched bytes are classified as read or written.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::DeclareAccess(const eavlArray *array, bool read, bool write)
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    if (o.event < 0)
+        return;
+    int &flags = o.declared[array];
+    if (read)
+        flags |= declaredRead;
+    if (write)
+        flags |= declaredWrite;
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::EndOperation
+//
+// Purpose:
+///   Close the event for the current operation, classifying the bytes
+///   which were dispatched while it ran.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::EndOperation()
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    if (o.event < 0)
+        return;
+    Event &e = events[o.event];
+    e.duration = Now() - e.start;
+    for (size_t i=0; i<o.dispatches.size(); i++)
+    {
+        const Dispatch &d = o.dispatches[i];
+        int flags = 0;
+        if (d.kind == READ)
+            flags = declaredRead;
+        else if (d.kind == WRITE)
+            flags = declaredWrite;
+        else if (o.declared.count(d.array))
+            flags = o.declared[d.array];
+
+        if (flags & declaredRead)
+            e.bytesRead += d.nbytes;
+        if (flags & declaredWrite)
+            e.bytesWritten += d.nbytes;
+        if (flags == 0)
+            e.bytesUnclassified += d.nbytes;
+    }
+    Close(o);
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::CancelOperation
+//
+// Purpose:
+///   Discard the event for the current operation, e.g. when the executor
+///   falls back to running a fused group one operation at a time.  Other
+///   threads may have recorded events since, so it is only marked as
+///   discarded.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::CancelOperation()
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    if (o.event < 0)
+        return;
+    events[o.event].phase = 0;
+    Close(o);
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::InOperation
+//
+// Purpose:
+///   True if an operation event is currently open on the calling thread.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+bool
+eavlTrace::InOperation()
+{
+    eavlMutexLocker lock(TraceMutex());
+    return CurrentThread().event >= 0;
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::AddDispatch
+//
+// Purpose:
+///   Record that an array was resolved to a raw pointer for a kernel
+///   processing "nitems" items.  "nbytes" is the traffic that kernel
+///   causes in the array, assuming one value per item.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::AddDispatch(const eavlArray *array, eavlIndex nitems,
+                       long long nbytes, AccessKind kind)
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    if (o.event < 0)
+        return;
+    Event &e = events[o.event];
+    if (nitems > e.items)
+        e.items = nitems;
+    Dispatch d;
+    d.array = array;
+    d.nbytes = nbytes;
+    d.kind = kind;
+    o.dispatches.push_back(d);
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::AddTransfer
+//
+// Purpose:
+///   Record a host/device array transfer.  Transfers inside an operation
+///   are counted in its event; others become instant events of their own.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::AddTransfer(const string &arrayname, long long nbytes,
+                       bool toDevice)
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    Open &o = CurrentThread();
+    int index = o.event;
+    if (index < 0)
+    {
+        index = events.size();
+        events.push_back(Event((toDevice ? "to device: " : "to host: ") +
+                               arrayname, "transfer", 'i', Now()));
+    }
+    Event &e = events[index];
+    if (toDevice)
+    {
+        e.toDeviceCount++;
+        e.toDeviceBytes += nbytes;
+    }
+    else
+    {
+        e.toHostCount++;
+        e.toHostBytes += nbytes;
+    }
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::AddRegion
+//
+// Purpose:
+///   Record a region timed with eavlTimer.  Regions which are themselves
+///   operations are already recorded, so those are skipped.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::AddRegion(const string &name, double start, double duration)
+{
+    if (!enabled)
+        return;
+    eavlMutexLocker lock(TraceMutex());
+    if (CurrentThread().event >= 0)
+        return;
+    Event e(name, "region", 'X', start);
+    e.duration = duration;
+#ifdef HAVE_OPENMP
+    e.threads = omp_get_max_threads();
+#endif
+    events.push_back(e);
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::Now
+//
+// Purpose:
+///   Current wall clock time in seconds.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+double
+eavlTrace::Now()
+{
+#if defined(_WIN32)
+    struct _timeb t;
+    _ftime(&t);
+    return double(t.time) + double(t.millitm) / 1000.;
+#else
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return double(t.tv_sec) + double(t.tv_usec) / 1000000.;
+#endif
+}
+
+// ****************************************************************************
+// Method:  eavlTrace::Dump
+//
+// Purpose:
+///   Write the recorded events as Chrome trace-event JSON.  Times are in
+///   microseconds, as the format requires.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+void
+eavlTrace::Dump(std::ostream &out)
+{
+    eavlMutexLocker lock(TraceMutex());
+    char buf[256];
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (size_t i=0; i<events.size(); i++)
+    {
+        const Event &e = events[i];
+        if (e.phase == 0)
+            continue;
+        out << (first ? "\n" : ",\n") << "{\"name\":";
+        first = false;
+        WriteJSONString(out, e.name);
+        out << ",\"cat\":\"" << e.category << "\""
+            << ",\"ph\":\"" << e.phase << "\"";
+        sprintf(buf, ",\"ts\":%.3f", (e.start - origin) * 1.e6);
+        out << buf;
+        if (e.phase == 'X')
+        {
+            sprintf(buf, ",\"dur\":%.3f", e.duration * 1.e6);
+            out << buf;
+        }
+        else
+        {
+            out << ",\"s\":\"g\"";
+        }
+        out << ",\"pid\":0,\"tid\":" << e.thread << ",\"args\":{"
+            << "\"items\":" << e.items
+            << ",\"bytes_read\":" << e.bytesRead
+            << ",\"bytes_written\":" << e.bytesWritten
+            << ",\"bytes_unclassified\":" << e.bytesUnclassified
+            << ",\"host_to_device_transfers\":" << e.toDeviceCount
+            << ",\"host_to_device_bytes\":" << e.toDeviceBytes
+            << ",\"device_to_host_transfers\":" << e.toHostCount
+            << ",\"device_to_host_bytes\":" << e.toHostBytes
+            << ",\"threads\":" << e.threads
+            << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
@@ -0,0 +1,103 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_TRACE_H
+#define EAVL_TRACE_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <iostream>
+#include "eavl.h"
+
+class eavlArray;
+
+// ****************************************************************************
+// Class:  eavlTrace
+//
+// Purpose:
+///   Structured per-operation profiling.  While enabled, every operation
+///   run by eavlExecutor is recorded with its wall time, item count, the
+///   bytes read and written through eavlOpDispatch, any host/device
+///   transfers it triggered, and the number of threads available to it.
+///   eavlTimer regions stopped outside an operation (e.g. whole filter
+///   stages) are recorded as well, so they enclose their operations.
+///   Dump writes the events in Chrome trace-event JSON format, which can
+///   be loaded by chrome://tracing or other timeline viewers.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   Operations may be open on several threads at once (e.g. when the
+//   executor runs a plan asynchronously); each eavlThreadPool worker
+//   records its own events, which appear as separate trace threads.
+// ****************************************************************************
+class eavlTrace
+{
+  public:
+    enum AccessKind { UNKNOWN, READ, WRITE };
+
+    static void   Enable();
+    static void   Disable();
+    static bool   IsEnabled() { return enabled; }
+    static void   Clear();
+
+    static void   BeginOperation(const std::string &name);
+    static void   DeclareAccess(const eavlArray *array, bool read, bool write);
+    static void   EndOperation();
+    static void   CancelOperation();
+    static bool   InOperation();
+
+    static void   AddDispatch(const eavlArray *array, eavlIndex nitems,
+                              long long nbytes, AccessKind kind);
+    static void   AddTransfer(const std::string &arrayname,
+                              long long nbytes, bool toDevice);
+    static void   AddRegion(const std::string &name, double start,
+                            double duration);
+
+    static double Now();
+    static void   Dump(std::ostream&);
+
+  private:
+    struct Event
+    {
+        std::string name;
+        std::string category;
+        char        phase;
+        double      start;
+        double      duration;
+        eavlIndex   items;
+        long long   bytesRead;
+        long long   bytesWritten;
+        long long   bytesUnclassified;
+        int         toDeviceCount;
+        long long   toDeviceBytes;
+        int         toHostCount;
+        long long   toHostBytes;
+        int         threads;
+        int         thread;
+        Event(const std::string &n, const std::string &c, char p, double s);
+    };
+    struct Dispatch
+    {
+        const eavlArray *array;
+        long long        nbytes;
+        AccessKind       kind;
+    };
+
+    struct Open
+    {
+        int                             event;
+        std::vector<Dispatch>           dispatches;
+        std::map<const eavlArray*, int> declared;
+        Open() : event(-1) { }
+    };
+
+    static Open &CurrentThread();
+    static void  Close(Open &o);
+
+    static bool                 enabled;
+    static double               origin;
+    static std::vector<Event>   events;
+    static std::vector<Open>    open;
+};
+
+#endif
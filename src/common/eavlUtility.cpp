@@ -1,6 +1,7 @@
 // Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
 #include "eavlUtility.h"
 #include <cmath>
+#include <cstdlib>
 
 // ****************************************************************************
 // Method:  CalculateTicks
@@ -233,3 +234,94 @@ void CalculateTicksLogarithmic(double lower, double upper, bool minor,
         }
     }
 }
+
+// ****************************************************************************
+// Method:  ParseNumber
+//
+// Purpose:
+///   Convert the ASCII number in [s,e) to a double, returning false if it
+///   isn't a number.  Decimal numbers with at most 15 significant digits
+///   and a power of ten within 1e22 of them are exact doubles scaled by
+///   an exact power of ten, so one multiply or divide rounds them
+///   correctly; anything else (long mantissas, big exponents, nan, inf)
+///   goes through strtod.  Either way the result is the double istream
+///   extraction would give.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+bool ParseNumber(const char *s, const char *e, double &v)
+{
+    static const double pow10[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10,
+        1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+        1e22
+    };
+
+    const char *p = s;
+    bool neg = false;
+    if (p < e && (*p == '-' || *p == '+'))
+        neg = (*p++ == '-');
+
+    unsigned long long m = 0;
+    int sig = 0;     // significant digits seen
+    int exp10 = 0;
+    bool digits = false;
+    for (; p < e && *p >= '0' && *p <= '9'; p++)
+    {
+        digits = true;
+        if (m != 0 || *p != '0')
+            sig++;
+        if (sig <= 19)
+            m = m * 10 + (*p - '0');
+        else
+            exp10++;
+    }
+    if (p < e && *p == '.')
+    {
+        for (p++; p < e && *p >= '0' && *p <= '9'; p++)
+        {
+            digits = true;
+            if (m != 0 || *p != '0')
+                sig++;
+            if (sig <= 19)
+            {
+                m = m * 10 + (*p - '0');
+                exp10--;
+            }
+        }
+    }
+    if (digits && p < e && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool eneg = false;
+        if (p < e && (*p == '-' || *p == '+'))
+            eneg = (*p++ == '-');
+        int x = 0;
+        bool xdigits = false;
+        for (; p < e && *p >= '0' && *p <= '9'; p++)
+        {
+            xdigits = true;
+            if (x < 10000)
+                x = x * 10 + (*p - '0');
+        }
+        if (!xdigits)
+            digits = false;
+        exp10 += eneg ? -x : x;
+    }
+
+    if (digits && p == e && sig <= 15 && exp10 >= -22 && exp10 <= 22)
+    {
+        v = double(m);
+        v = (exp10 < 0) ? v / pow10[-exp10] : v * pow10[exp10];
+        if (neg)
+            v = -v;
+        return true;
+    }
+
+    string token(s, e);
+    char *end;
+    v = strtod(token.c_str(), &end);
+    return end != token.c_str() && *end == '\0';
+}
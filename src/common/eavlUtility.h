@@ -15,6 +15,8 @@ void CalculateTicksLogarithmic(double lower, double upper, bool minor,
                                vector<double> &proportions,
                                int modifyTickQuantity=0); ///< -1 for less, +1 for more
 
+bool ParseNumber(const char *s, const char *e, double &v);
+
 template <class T>
 string VecPrint(T *const v, unsigned int n, unsigned int nmax, unsigned int group=1e9)
 {
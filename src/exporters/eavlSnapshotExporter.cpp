@@ -0,0 +1,63 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlSnapshotExporter.h"
+#include "eavlException.h"
+
+#include <string.h>
+
+void
+eavlSnapshotExporter::Export(ostream &out)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        THROW(eavlException, "Snapshot alignment must be a power of two");
+
+    // serialize the data set first; the field arrays only add their
+    // values to the payload list
+    ostringstream meta(ios::out | ios::binary);
+    eavlSnapshotStream s(meta, alignment);
+    data->serialize(s);
+    string metadata = meta.str();
+
+    eavlSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "EAVLSNAP", 8);
+    header.version = eavlSnapshotHeader::CurrentVersion;
+    header.byteOrder = eavlSnapshotHeader::ByteOrderMark;
+    header.sizeofSize = sizeof(size_t);
+    header.sizeofIndex = sizeof(eavlIndex);
+    header.alignment = alignment;
+    header.metadataOffset = sizeof(header);
+    header.metadataBytes = metadata.size();
+    header.payloadOffset = (sizeof(header) + metadata.size() + alignment - 1) /
+                           alignment * alignment;
+    header.payloadBytes = s.GetPayloadBytes();
+
+    out.write((const char*)&header, sizeof(header));
+    out.write(metadata.data(), metadata.size());
+    Pad(out, header.payloadOffset - sizeof(header) - metadata.size());
+
+    const vector<eavlSnapshotStream::Payload> &payloads = s.GetPayloads();
+    size_t written = 0;
+    for (size_t i = 0; i < payloads.size(); i++)
+    {
+        Pad(out, payloads[i].offset - written);
+        if (payloads[i].nbytes > 0)
+            out.write(payloads[i].values, payloads[i].nbytes);
+        written = payloads[i].offset + payloads[i].nbytes;
+    }
+    Pad(out, header.payloadBytes - written);
+
+    if (!out)
+        THROW(eavlException, "Error writing snapshot");
+}
+
+void
+eavlSnapshotExporter::Pad(ostream &out, size_t nbytes)
+{
+    static const char zeros[4096] = { 0 };
+    while (nbytes > 0)
+    {
+        size_t n = std::min(nbytes, sizeof(zeros));
+        out.write(zeros, n);
+        nbytes -= n;
+    }
+}
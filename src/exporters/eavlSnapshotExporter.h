@@ -0,0 +1,39 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_SNAPSHOT_EXPORTER_H
+#define EAVL_SNAPSHOT_EXPORTER_H
+
+#include "STL.h"
+#include "eavlExporter.h"
+#include "eavlDataSet.h"
+
+// ****************************************************************************
+// Class :  eavlSnapshotExporter
+//
+// Purpose:
+///   Write a data set as a binary snapshot which eavlSnapshotImporter can
+///   open by mapping the file instead of reading it.  The layout is an
+///   eavlSnapshotHeader, the serialized data set, and then the values of
+///   each field array starting on a multiple of the alignment, which
+///   should be a multiple of the page size.  Offsets are relative to
+///   where the export starts, so write it to the start of a file opened
+///   in binary mode.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+
+class eavlSnapshotExporter : public eavlExporter
+{
+  public:
+    eavlSnapshotExporter(eavlDataSet *data_, size_t align = 4096) :
+        eavlExporter(data_), alignment(align)
+    {}
+    virtual void Export(ostream &out);
+
+  protected:
+    size_t alignment;
+
+    void Pad(ostream &out, size_t nbytes);
+};
+
+#endif
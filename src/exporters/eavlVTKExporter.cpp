@@ -4,13 +4,51 @@
 #include "eavlCoordinates.h"
 
 #include <iostream>
+#include <string.h>
+
+// legacy binary files are big-endian
+static bool HostIsLittleEndian()
+{
+    unsigned int one = 1;
+    return *reinterpret_cast<unsigned char*>(&one) == 1;
+}
+
+template <class T>
+static void WriteBinary(ostream &out, const T *values, size_t n)
+{
+    bool swap = HostIsLittleEndian();
+    const size_t chunk = 4096;
+    T buff[chunk];
+    for (size_t i = 0; i < n; i += chunk)
+    {
+        size_t m = std::min(chunk, n - i);
+        memcpy(buff, values + i, m * sizeof(T));
+        if (swap)
+        {
+            for (size_t j = 0; j < m; j++)
+            {
+                char *p = reinterpret_cast<char*>(&buff[j]);
+                std::reverse(p, p + sizeof(T));
+            }
+        }
+        out.write(reinterpret_cast<const char*>(buff), m * sizeof(T));
+    }
+}
+
+template <class T>
+static void WriteBinary(ostream &out, const vector<T> &values)
+{
+    if (!values.empty())
+        WriteBinary(out, &values[0], values.size());
+    out << endl;
+}
 
 void
 eavlVTKExporter::Export(ostream &out)
 {
     out<<"# vtk DataFile Version 3.0"<<endl;
     out<<"vtk output"<<endl;
-    out<<"ASCII"<<endl;
+    out<<(binary ? "BINARY" : "ASCII")<<endl;
 
     eavlCellSet *cs = NULL;
     if (cellSetIndex >= 0 && cellSetIndex < data->GetNumCellSets())
@@ -26,8 +64,8 @@ eavlVTKExporter::Export(ostream &out)
 }
 
 
-void
-eavlVTKExporter::ExportStructured(ostream &out)
+bool
+eavlVTKExporter::IsRectilinear()
 {
     eavlCoordinates *coords = data->GetCoordinateSystem(0);
     int ndims = coords->GetDimension();
@@ -59,7 +97,13 @@ eavlVTKExporter::ExportStructured(ostream &out)
         rectilinear = false;
         break;
     }
+    return rectilinear;
+}
 
+void
+eavlVTKExporter::ExportStructured(ostream &out)
+{
+    bool rectilinear = IsRectilinear();
 
     if (rectilinear)
     {
@@ -100,7 +144,10 @@ eavlVTKExporter::ExportRectilinearCoords(ostream &out)
         if (axis >= ndims)
         {
             out << axnames[axis] << " 1 float" << endl;
-            out << "0" << endl;
+            if (binary)
+                WriteBinary(out, vector<float>(1, 0.f));
+            else
+                out << "0" << endl;
             continue;
         }
 
@@ -113,7 +160,15 @@ eavlVTKExporter::ExportRectilinearCoords(ostream &out)
 
         int n = (axis >= reg.dimension) ? 1 : reg.nodeDims[axis];
         out << axnames[axis] << " " << n << " " << "float" << endl;
-        if (f->GetAssociation() == eavlField::ASSOC_WHOLEMESH)
+        if (binary)
+        {
+            bool whole = (f->GetAssociation() == eavlField::ASSOC_WHOLEMESH);
+            vector<float> values(n);
+            for (int i=0; i<n; ++i)
+                values[i] = arr->GetComponentAsDouble(whole ? 0 : i, 0);
+            WriteBinary(out, values);
+        }
+        else if (f->GetAssociation() == eavlField::ASSOC_WHOLEMESH)
         {
             for (int i=0; i<n; ++i)
                 out << arr->GetComponentAsDouble(0, 0) << " ";
@@ -150,6 +205,19 @@ eavlVTKExporter::ExportPointCells(ostream &out)
     int nCells = data->GetNumPoints();
 
     out<<"CELLS "<<nCells<<" "<<nCells*2<<endl;
+    if (binary)
+    {
+        vector<int> conn(nCells*2);
+        for (int i = 0; i < nCells; i++)
+        {
+            conn[i*2] = 1;
+            conn[i*2+1] = i;
+        }
+        WriteBinary(out, conn);
+        out<<"CELL_TYPES "<<nCells<<endl;
+        WriteBinary(out, vector<int>(nCells, CellTypeToVTK(EAVL_POINT)));
+        return;
+    }
     for (int i = 0; i < nCells; i++)
     {
         out << "1 " << i << endl;
@@ -183,6 +251,25 @@ eavlVTKExporter::ExportUnstructuredCells(ostream &out)
 {
     int nCells = data->GetCellSet(cellSetIndex)->GetNumCells();
 
+    if (binary)
+    {
+        // one pass over the cells, then each section in one piece
+        vector<int> conn;
+        vector<int> types(nCells);
+        for (int i = 0; i < nCells; i++)
+        {
+            eavlCell cell = data->GetCellSet(cellSetIndex)->GetCellNodes(i);
+            conn.push_back(cell.numIndices);
+            conn.insert(conn.end(), cell.indices, cell.indices + cell.numIndices);
+            types[i] = CellTypeToVTK(cell.type);
+        }
+        out<<"CELLS "<<nCells<<" "<<conn.size()<<endl;
+        WriteBinary(out, conn);
+        out<<"CELL_TYPES "<<nCells<<endl;
+        WriteBinary(out, types);
+        return;
+    }
+
     int sz = 0;
     for (int i = 0; i < nCells; i++)
     {
@@ -232,11 +319,7 @@ eavlVTKExporter::ExportGlobalFields(ostream &out)
                 out<<"FIELD FieldData "<<count<<endl;
             wrote_global_field_header = true;
             out<<data->GetField(f)->GetArray()->GetName()<<" "<<ncomp<<" "<<ntuples<<" float"<<endl;
-            for (int i = 0; i < ntuples; i++)
-            {
-                for (int j = 0; j < ncomp; j++)
-                    out<<data->GetField(f)->GetArray()->GetComponentAsDouble(i,j)<<endl;
-            }
+            ExportValues(out, data->GetField(f)->GetArray());
         }
     }
 }
@@ -261,11 +344,7 @@ eavlVTKExporter::ExportFields(ostream &out)
             wrote_point_header = true;
             out<<"SCALARS "<<data->GetField(f)->GetArray()->GetName()<<" float "<< ncomp<<endl;
             out<<"LOOKUP_TABLE default"<<endl;
-            for (int i = 0; i < ntuples; i++)
-            {
-                for (int j = 0; j < ncomp; j++)
-                    out<<data->GetField(f)->GetArray()->GetComponentAsDouble(i,j)<<endl;
-            }
+            ExportValues(out, data->GetField(f)->GetArray());
         }
     }
 
@@ -290,22 +369,58 @@ eavlVTKExporter::ExportFields(ostream &out)
             wrote_cell_header = true;
             out<<"SCALARS "<<data->GetField(f)->GetArray()->GetName()<<" float "<< ncomp<<endl;
             out<<"LOOKUP_TABLE default"<<endl;
-            for (int i = 0; i < ntuples; i++)
-            {
-                for (int j = 0; j < ncomp; j++)
-                    out<<data->GetField(f)->GetArray()->GetComponentAsDouble(i,j)<<endl;
-            }
+            ExportValues(out, data->GetField(f)->GetArray());
         }
     }
 }
 
 
+void
+eavlVTKExporter::ExportValues(ostream &out, eavlArray *arr)
+{
+    int ntuples = arr->GetNumberOfTuples();
+    int ncomp = arr->GetNumberOfComponents();
+    if (!binary)
+    {
+        for (int i = 0; i < ntuples; i++)
+        {
+            for (int j = 0; j < ncomp; j++)
+                out<<arr->GetComponentAsDouble(i,j)<<endl;
+        }
+        return;
+    }
+
+    // float values are written straight from the host array
+    size_t n = size_t(ntuples) * ncomp;
+    eavlFloatArray *farr = dynamic_cast<eavlFloatArray*>(arr);
+    if (farr && n > 0)
+    {
+        WriteBinary(out, (const float*)farr->GetHostArray(), n);
+        out << endl;
+        return;
+    }
+    vector<float> values(n);
+    for (int i = 0; i < ntuples; i++)
+        for (int j = 0; j < ncomp; j++)
+            values[size_t(i)*ncomp + j] = arr->GetComponentAsDouble(i,j);
+    WriteBinary(out, values);
+}
+
 void
 eavlVTKExporter::ExportPoints(ostream &out)
 {
     out<<"POINTS "<<data->GetNumPoints()<<" float"<<endl;
 
     int npts = data->GetNumPoints();
+    if (binary)
+    {
+        vector<float> values(size_t(npts) * 3);
+        for (int i = 0; i < npts; i++)
+            for (int d = 0; d < 3; d++)
+                values[size_t(i)*3 + d] = data->GetPoint(i, d);
+        WriteBinary(out, values);
+        return;
+    }
     for (int i = 0; i < npts; i++)
     {
         out<<(float)data->GetPoint(i, 0)<<" ";
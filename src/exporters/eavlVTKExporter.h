@@ -9,22 +9,35 @@
 // ****************************************************************************
 // Class :  eavlVTKExporter
 //
+// Purpose:
+///   Write a data set as a VTK "legacy" (*.vtk) file, in ASCII or, after
+///   SetBinary(true), in big-endian BINARY, which writes the values of
+///   float arrays straight from their host buffers.
+//
 // Programmer:  Dave Pugmire
 // Creation:    May 17, 2011
 //
+// Modifications:
+//   Added BINARY output.
+//
 // ****************************************************************************
 
 class eavlVTKExporter : public eavlExporter
 {
   public:
     eavlVTKExporter(eavlDataSet *data_, int which_cells = 0) :
-        eavlExporter(data_), cellSetIndex(which_cells)
+        eavlExporter(data_), cellSetIndex(which_cells), binary(false)
     {}
     virtual void Export(ostream &out);
+    void SetBinary(bool b) { binary = b; }
     
   protected:
 
     int cellSetIndex;
+    bool binary;
+
+    bool IsRectilinear();
+    void ExportValues(ostream &out, eavlArray *arr);
 
     void ExportStructured(ostream &out);
     void ExportUnstructured(ostream &out);
@@ -0,0 +1,414 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlVTKXMLExporter.h"
+#include "eavlCellSetAllStructured.h"
+#include "eavlCoordinates.h"
+#include "eavlException.h"
+
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// uncompressed bytes in each compressed block of an array
+static const size_t compressedBlockSize = 1 << 20;
+
+template <class T>
+static char *CopyValues(const vector<T> &v)
+{
+    char *values = new char[v.size() * sizeof(T) + 1];
+    if (!v.empty())
+        memcpy(values, &v[0], v.size() * sizeof(T));
+    return values;
+}
+
+eavlVTKXMLExporter::eavlVTKXMLExporter(eavlDataSet *data_, int which_cells,
+                                       int compression_level)
+    : eavlVTKExporter(data_, which_cells),
+      compressionLevel(compression_level), appendedBytes(0)
+{
+}
+
+eavlVTKXMLExporter::~eavlVTKXMLExporter()
+{
+    Clear();
+}
+
+string
+eavlVTKXMLExporter::GetDataSetType()
+{
+    eavlCellSet *cs = NULL;
+    if (cellSetIndex >= 0 && cellSetIndex < data->GetNumCellSets())
+        cs = data->GetCellSet(cellSetIndex);
+    if (!dynamic_cast<eavlCellSetAllStructured*>(cs))
+        return "UnstructuredGrid";
+    return IsRectilinear() ? "RectilinearGrid" : "StructuredGrid";
+}
+
+string
+eavlVTKXMLExporter::GetFileExtension()
+{
+    string type = GetDataSetType();
+    if (type == "RectilinearGrid")
+        return ".vtr";
+    if (type == "StructuredGrid")
+        return ".vts";
+    return ".vtu";
+}
+
+void
+eavlVTKXMLExporter::Export(ostream &out)
+{
+    if (compressionLevel < 0 || compressionLevel > 9)
+        THROW(eavlException, "VTK XML compression level must be from 0 to 9");
+#ifndef HAVE_ZLIB
+    if (compressionLevel > 0)
+        THROW(eavlException, "Compressed VTK XML output needs zlib support");
+#endif
+
+    Clear();
+    string type = GetDataSetType();
+
+    // the arrays are encoded as their elements are written, so each
+    // element knows its offset in the appended data
+    ostringstream xml;
+    string extent;
+    if (type != "UnstructuredGrid")
+    {
+        eavlRegularStructure &reg = ((eavlCellSetAllStructured*)
+                                data->GetCellSet(cellSetIndex))->GetRegularStructure();
+        ostringstream e;
+        for (int d = 0; d < 3; d++)
+            e << (d > 0 ? " " : "") << "0 "
+              << ((d < reg.dimension) ? reg.nodeDims[d] - 1 : 0);
+        extent = e.str();
+        xml << "  <" << type << " WholeExtent=\"" << extent << "\">\n";
+    }
+    else
+    {
+        xml << "  <" << type << ">\n";
+    }
+
+    bool wroteFieldData = false;
+    for (int f = 0; f < data->GetNumFields(); f++)
+    {
+        if (data->GetField(f)->GetAssociation() != eavlField::ASSOC_WHOLEMESH)
+            continue;
+        if (!wroteFieldData)
+            xml << "    <FieldData>\n";
+        wroteFieldData = true;
+        WriteField(xml, "      ", data->GetField(f)->GetArray(), true);
+    }
+    if (wroteFieldData)
+        xml << "    </FieldData>\n";
+
+    if (type != "UnstructuredGrid")
+    {
+        xml << "    <Piece Extent=\"" << extent << "\">\n";
+    }
+    else
+    {
+        bool hasCells = (cellSetIndex >= 0 &&
+                         cellSetIndex < data->GetNumCellSets());
+        xml << "    <Piece NumberOfPoints=\"" << data->GetNumPoints()
+            << "\" NumberOfCells=\""
+            << (hasCells ? data->GetCellSet(cellSetIndex)->GetNumCells()
+                         : data->GetNumPoints())
+            << "\">\n";
+    }
+    WriteFields(xml, "      ");
+    if (type == "RectilinearGrid")
+        WriteRectilinearCoords(xml, "      ");
+    else
+        WritePoints(xml, "      ");
+    if (type == "UnstructuredGrid")
+        WriteCells(xml, "      ");
+    xml << "    </Piece>\n";
+    xml << "  </" << type << ">\n";
+
+    unsigned int one = 1;
+    bool little = (*reinterpret_cast<unsigned char*>(&one) == 1);
+    out << "<?xml version=\"1.0\"?>\n"
+        << "<VTKFile type=\"" << type << "\" version=\"1.0\" byte_order=\""
+        << (little ? "LittleEndian" : "BigEndian")
+        << "\" header_type=\"UInt64\"";
+    if (compressionLevel > 0)
+        out << " compressor=\"vtkZLibDataCompressor\"";
+    out << ">\n";
+    out << xml.str();
+    out << "  <AppendedData encoding=\"raw\">\n";
+    out << "   _";
+    for (size_t i = 0; i < blocks.size(); i++)
+    {
+        out.write(blocks[i].header.data(), blocks[i].header.size());
+        if (blocks[i].nbytes > 0)
+            out.write(blocks[i].values, blocks[i].nbytes);
+    }
+    out << "\n  </AppendedData>\n";
+    out << "</VTKFile>\n";
+    Clear();
+
+    if (!out)
+        THROW(eavlException, "Error writing VTK XML file");
+}
+
+void
+eavlVTKXMLExporter::WriteDataArray(ostream &xml, const string &indent,
+                                   const string &type, const string &name,
+                                   int ncomp, eavlIndex ntuples,
+                                   const void *values, size_t nbytes,
+                                   char *owned)
+{
+    Block block;
+    block.values = (const char*)values;
+    block.nbytes = nbytes;
+    block.owned = owned;
+    if (compressionLevel > 0)
+    {
+        Compress(block);
+    }
+    else
+    {
+        unsigned long long n = nbytes;
+        block.header.assign((const char*)&n, sizeof(n));
+    }
+
+    xml << indent << "<DataArray type=\"" << type << "\"";
+    if (!name.empty())
+        xml << " Name=\"" << name << "\"";
+    xml << " NumberOfComponents=\"" << ncomp << "\"";
+    if (ntuples >= 0)
+        xml << " NumberOfTuples=\"" << ntuples << "\"";
+    xml << " format=\"appended\" offset=\"" << appendedBytes << "\"/>\n";
+
+    appendedBytes += block.header.size() + block.nbytes;
+    blocks.push_back(block);
+}
+
+void
+eavlVTKXMLExporter::WriteField(ostream &xml, const string &indent,
+                               eavlArray *arr, bool fieldData)
+{
+    int ncomp = arr->GetNumberOfComponents();
+    eavlIndex ntuples = arr->GetNumberOfTuples();
+    size_t n = size_t(ntuples) * ncomp;
+
+    // the three array types are written from their host buffers
+    string type;
+    size_t size = 0;
+    if (dynamic_cast<eavlFloatArray*>(arr))
+    {
+        type = "Float32";
+        size = sizeof(float);
+    }
+    else if (dynamic_cast<eavlIntArray*>(arr))
+    {
+        type = "Int32";
+        size = sizeof(int);
+    }
+    else if (dynamic_cast<eavlByteArray*>(arr))
+    {
+        type = "UInt8";
+        size = sizeof(byte);
+    }
+    if (!type.empty())
+    {
+        WriteDataArray(xml, indent, type, arr->GetName(), ncomp,
+                       fieldData ? ntuples : -1,
+                       n > 0 ? arr->GetHostArray() : NULL, n * size, NULL);
+        return;
+    }
+
+    vector<float> values(n);
+    for (eavlIndex i = 0; i < ntuples; i++)
+        for (int j = 0; j < ncomp; j++)
+            values[size_t(i)*ncomp + j] = arr->GetComponentAsDouble(i, j);
+    char *owned = CopyValues(values);
+    WriteDataArray(xml, indent, "Float32", arr->GetName(), ncomp,
+                   fieldData ? ntuples : -1, owned, n * sizeof(float), owned);
+}
+
+void
+eavlVTKXMLExporter::WriteFields(ostream &xml, const string &indent)
+{
+    xml << indent << "<PointData>\n";
+    for (int f = 0; f < data->GetNumFields(); f++)
+    {
+        if (data->GetField(f)->GetAssociation() == eavlField::ASSOC_POINTS)
+            WriteField(xml, indent + "  ", data->GetField(f)->GetArray(), false);
+    }
+    xml << indent << "</PointData>\n";
+
+    xml << indent << "<CellData>\n";
+    if (cellSetIndex >= 0 && cellSetIndex < data->GetNumCellSets())
+    {
+        string cellSetName = data->GetCellSet(cellSetIndex)->GetName();
+        for (int f = 0; f < data->GetNumFields(); f++)
+        {
+            eavlField *field = data->GetField(f);
+            if (field->GetAssociation() == eavlField::ASSOC_CELL_SET &&
+                field->GetAssocCellSet() == cellSetName)
+                WriteField(xml, indent + "  ", field->GetArray(), false);
+        }
+    }
+    xml << indent << "</CellData>\n";
+}
+
+void
+eavlVTKXMLExporter::WritePoints(ostream &xml, const string &indent)
+{
+    eavlIndex npts = data->GetNumPoints();
+    vector<float> values(size_t(npts) * 3);
+    for (eavlIndex i = 0; i < npts; i++)
+        for (int d = 0; d < 3; d++)
+            values[size_t(i)*3 + d] = data->GetPoint(i, d);
+
+    char *owned = CopyValues(values);
+    xml << indent << "<Points>\n";
+    WriteDataArray(xml, indent + "  ", "Float32", "", 3, -1,
+                   owned, values.size() * sizeof(float), owned);
+    xml << indent << "</Points>\n";
+}
+
+void
+eavlVTKXMLExporter::WriteRectilinearCoords(ostream &xml, const string &indent)
+{
+    eavlRegularStructure &reg = ((eavlCellSetAllStructured*)
+                            data->GetCellSet(cellSetIndex))->GetRegularStructure();
+    eavlCoordinates *coords = data->GetCoordinateSystem(0);
+    int ndims = coords->GetDimension();
+    const char *axnames[3] = {"x_coordinates", "y_coordinates", "z_coordinates"};
+
+    xml << indent << "<Coordinates>\n";
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        vector<float> values(1, 0.f);
+        if (axis < ndims)
+        {
+            eavlCoordinateAxisField *axf =
+                dynamic_cast<eavlCoordinateAxisField*>(coords->GetAxis(axis));
+            eavlField *f = data->GetField(axf->GetFieldName());
+            eavlArray *arr = f->GetArray();
+            bool whole = (f->GetAssociation() == eavlField::ASSOC_WHOLEMESH);
+            int n = (axis >= reg.dimension) ? 1 : reg.nodeDims[axis];
+            values.resize(n);
+            for (int i = 0; i < n; ++i)
+                values[i] = arr->GetComponentAsDouble(whole ? 0 : i, 0);
+        }
+        char *owned = CopyValues(values);
+        WriteDataArray(xml, indent + "  ", "Float32", axnames[axis], 1, -1,
+                       owned, values.size() * sizeof(float), owned);
+    }
+    xml << indent << "</Coordinates>\n";
+}
+
+void
+eavlVTKXMLExporter::WriteCells(ostream &xml, const string &indent)
+{
+    vector<int> connectivity;
+    vector<long long> offsets;
+    vector<unsigned char> types;
+    if (cellSetIndex >= 0 && cellSetIndex < data->GetNumCellSets())
+    {
+        eavlCellSet *cs = data->GetCellSet(cellSetIndex);
+        int nCells = cs->GetNumCells();
+        offsets.resize(nCells);
+        types.resize(nCells);
+        for (int i = 0; i < nCells; i++)
+        {
+            eavlCell cell = cs->GetCellNodes(i);
+            connectivity.insert(connectivity.end(), cell.indices,
+                                cell.indices + cell.numIndices);
+            offsets[i] = connectivity.size();
+            types[i] = CellTypeToVTK(cell.type);
+        }
+    }
+    else
+    {
+        // no cell set; write each point as a vertex
+        int nCells = data->GetNumPoints();
+        connectivity.resize(nCells);
+        offsets.resize(nCells);
+        types.resize(nCells, CellTypeToVTK(EAVL_POINT));
+        for (int i = 0; i < nCells; i++)
+        {
+            connectivity[i] = i;
+            offsets[i] = i + 1;
+        }
+    }
+
+    xml << indent << "<Cells>\n";
+    char *owned = CopyValues(connectivity);
+    WriteDataArray(xml, indent + "  ", "Int32", "connectivity", 1, -1,
+                   owned, connectivity.size() * sizeof(int), owned);
+    owned = CopyValues(offsets);
+    WriteDataArray(xml, indent + "  ", "Int64", "offsets", 1, -1,
+                   owned, offsets.size() * sizeof(long long), owned);
+    owned = CopyValues(types);
+    WriteDataArray(xml, indent + "  ", "UInt8", "types", 1, -1,
+                   owned, types.size(), owned);
+    xml << indent << "</Cells>\n";
+}
+
+void
+eavlVTKXMLExporter::Compress(Block &block)
+{
+#ifdef HAVE_ZLIB
+    // the header is the number of blocks, the uncompressed size of a
+    // block and of a partial last block, then each compressed size
+    size_t nfull = block.nbytes / compressedBlockSize;
+    size_t last = block.nbytes % compressedBlockSize;
+    eavlIndex nblocks = nfull + (last > 0 ? 1 : 0);
+    vector<unsigned long long> header(3 + nblocks);
+    header[0] = nblocks;
+    header[1] = compressedBlockSize;
+    header[2] = last;
+
+    size_t bound = compressBound(compressedBlockSize);
+    char *compressed = new char[nblocks * bound + 1];
+    const char *values = block.values;
+    int level = compressionLevel;
+    int nfailed = 0;
+#pragma omp parallel for reduction(+:nfailed)
+    for (eavlIndex i = 0; i < nblocks; i++)
+    {
+        uLongf csize = bound;
+        uLong usize = (i == nblocks - 1 && last > 0) ? last : compressedBlockSize;
+        if (compress2((Bytef*)compressed + i * bound, &csize,
+                      (const Bytef*)values + i * compressedBlockSize, usize,
+                      level) != Z_OK)
+            nfailed++;
+        header[3 + i] = csize;
+    }
+    if (nfailed > 0)
+    {
+        delete[] compressed;
+        delete[] block.owned;
+        THROW(eavlException, "zlib failed to compress an array");
+    }
+
+    // close up the gaps between the blocks
+    size_t n = 0;
+    for (eavlIndex i = 0; i < nblocks; i++)
+    {
+        memmove(compressed + n, compressed + i * bound, header[3 + i]);
+        n += header[3 + i];
+    }
+
+    delete[] block.owned;
+    block.owned = compressed;
+    block.values = compressed;
+    block.nbytes = n;
+    block.header.assign((const char*)&header[0],
+                        header.size() * sizeof(unsigned long long));
+#endif
+}
+
+void
+eavlVTKXMLExporter::Clear()
+{
+    for (size_t i = 0; i < blocks.size(); i++)
+        delete[] blocks[i].owned;
+    blocks.clear();
+    appendedBytes = 0;
+}
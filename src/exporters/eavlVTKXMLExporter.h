@@ -0,0 +1,62 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_VTK_XML_EXPORTER_H
+#define EAVL_VTK_XML_EXPORTER_H
+
+#include "STL.h"
+#include "eavlVTKExporter.h"
+
+// ****************************************************************************
+// Class :  eavlVTKXMLExporter
+//
+// Purpose:
+///   Write a data set as a VTK XML file: a RectilinearGrid (*.vtr) or
+///   StructuredGrid (*.vts) for structured cell sets, otherwise an
+///   UnstructuredGrid (*.vtu).  Array values go in raw appended data in
+///   the host's byte order, with field arrays written straight from their
+///   host buffers.  With a compression level from 1 to 9, each array is
+///   split into blocks which are compressed with zlib in parallel.
+///   GetFileExtension says which extension a reader will expect.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+
+class eavlVTKXMLExporter : public eavlVTKExporter
+{
+  public:
+    eavlVTKXMLExporter(eavlDataSet *data_, int which_cells = 0,
+                       int compression_level = 0);
+    ~eavlVTKXMLExporter();
+    virtual void Export(ostream &out);
+    string GetFileExtension();
+
+  protected:
+    // an array's encoded values in the appended data
+    struct Block
+    {
+        string      header;
+        const char *values;
+        size_t      nbytes;
+        char       *owned;
+    };
+
+    int           compressionLevel;
+    vector<Block> blocks;
+    size_t        appendedBytes;
+
+    string GetDataSetType();
+    void WriteDataArray(ostream &xml, const string &indent,
+                        const string &type, const string &name, int ncomp,
+                        eavlIndex ntuples, const void *values, size_t nbytes,
+                        char *owned);
+    void WriteField(ostream &xml, const string &indent, eavlArray *arr,
+                    bool fieldData);
+    void WriteFields(ostream &xml, const string &indent);
+    void WritePoints(ostream &xml, const string &indent);
+    void WriteRectilinearCoords(ostream &xml, const string &indent);
+    void WriteCells(ostream &xml, const string &indent);
+    void Compress(Block &block);
+    void Clear();
+};
+
+#endif
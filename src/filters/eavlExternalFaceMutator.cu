@@ -0,0 +1,344 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlExternalFaceMutator.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlCellSetAllStructured.h"
+#include "eavlCellComponents.h"
+#include "eavlExecutor.h"
+#include "eavlMapOp.h"
+#include "eavlGatherOp.h"
+#include "eavlPrefixSumOp_1.h"
+#include "eavlReduceOp_1.h"
+#include "eavlRadixSortOp.h"
+#include "eavlReverseIndexOp.h"
+#include "eavlSimpleReverseIndexOp.h"
+#include "eavlSourceTopologyMapOp.h"
+#include "eavlCombinedTopologyPackedMapOp.h"
+#include "eavlSourceTopologyGatherMapOp.h"
+#include "eavlException.h"
+#include "eavlTimer.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+class CountElementComponentsFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR int operator()(int shapeType, int n, int ids[],
+                                const IN)
+    {
+        return n;
+    }
+};
+
+class SelectElementComponentFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR int operator()(int shapeType, int n, int ids[],
+                                const IN, int subindex)
+    {
+        return ids[subindex];
+    }
+};
+
+class FirstTwoDifferFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR int operator()(const IN &args)
+    {
+        return args.first != args.rest.first;
+    }
+};
+
+class FaceShapeAndNodesFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR tuple<int,int,int,int,int,int> operator()(int shapeType, int n, int ids[],
+                                                           const IN)
+    {
+        return tuple<int,int,int,int,int,int>(shapeType, n,
+                                              ids[0], ids[1],
+                                              n > 2 ? ids[2] : -1,
+                                              n > 3 ? ids[3] : -1);
+    }
+};
+
+eavlExternalFaceMutator::eavlExternalFaceMutator()
+{
+}
+
+eavlExternalFaceMutator::~eavlExternalFaceMutator()
+{
+}
+
+// ****************************************************************************
+// Method:  eavlExternalFaceMutator::Execute
+//
+// Purpose:
+///   Find the faces used by exactly one cell.  Every (face, cell) incidence
+///   is listed, sorted by face index, and a face is external when its run
+///   in the sorted list has length one; the external faces are then
+///   compacted with a scan.  This needs no atomics, runs as executor
+///   operations on either the CPU or GPU, and always emits the faces in
+///   increasing face index order.
+//
+// Modifications:
+// ****************************************************************************
+void
+eavlExternalFaceMutator::Execute()
+{
+    int inCellSetIndex = dataset->GetCellSetIndex(cellsetname);
+    eavlCellSet *inCells = dataset->GetCellSet(cellsetname);
+
+    if (!dynamic_cast<eavlCellSetAllStructured*>(inCells) &&
+        !dynamic_cast<eavlCellSetExplicit*>(inCells))
+        THROW(eavlException, "Unsupported cell set type");
+
+    int nc = inCells->GetNumCells();
+
+    //
+    // count the faces of each cell and find each cell's first
+    // (face,cell) incidence index
+    //
+    eavlIntArray *cellFaceCount = new eavlIntArray("cellFaceCount", 1, nc);
+    eavlIntArray *cellFaceStart = new eavlIntArray("cellFaceStart", 1, nc);
+    eavlIntArray *totalIncidences = new eavlIntArray("totalIncidences", 1, 1);
+
+    eavlExecutor::AddOperation(
+        new_eavlSourceTopologyMapOp(inCells,
+                                    EAVL_FACES_OF_CELLS,
+                                    eavlOpArgs(cellFaceCount),
+                                    eavlOpArgs(cellFaceCount),
+                                    CountElementComponentsFunctor()),
+        "count faces per cell");
+    eavlExecutor::AddOperation(
+        new eavlPrefixSumOp_1(cellFaceCount, cellFaceStart, false),
+        "scan to generate starting incidence index per cell");
+    eavlExecutor::AddOperation(
+        new eavlReduceOp_1<eavlAddFunctor<int> >
+            (cellFaceCount,
+             totalIncidences,
+             eavlAddFunctor<int>()),
+        "sumreduce to count face incidences");
+    eavlExecutor::Go();
+    int ni = (nc > 0) ? totalIncidences->GetValue(0) : 0;
+
+    //
+    // list (face,cell) incidences and sort them by face.  The sorted
+    // arrays carry one extra slot at the end: the face key there is a -1,
+    // which sorts as the largest unsigned key and so ends up as a
+    // sentinel after all real faces.
+    //
+    eavlIntArray *incidenceSubindex = new eavlIntArray("incidenceSubindex", 1, ni);
+    eavlIntArray *incidenceFace = new eavlIntArray("incidenceFace", 1, ni+1);
+    eavlIntArray *incidenceCell = new eavlIntArray("incidenceCell", 1, ni+1);
+    incidenceFace->SetValue(0, -1);
+    incidenceCell->SetValue(0, -1);
+
+    // flags[0] is always set; flags[i+1] is set when sorted incidence i
+    // is the last one for its face
+    eavlIntArray *lastOfFace = new eavlIntArray("lastOfFace", 1, ni+1);
+    lastOfFace->SetValue(0, 1);
+    eavlIntArray *extFlag = new eavlIntArray("extFlag", 1, ni);
+    eavlIntArray *extIndex = new eavlIntArray("extIndex", 1, ni);
+    eavlIntArray *totalExt = new eavlIntArray("totalExt", 1, 1);
+
+    // write the incidences at offset one, leaving the sentinel in slot 0
+    eavlArrayWithLinearIndex incidenceCellShifted(incidenceCell);
+    incidenceCellShifted.add = 1;
+    eavlIndexable<eavlIntArray> incidenceFaceShifted(incidenceFace,
+                                                     eavlArrayIndexer(1, 1));
+    eavlIndexable<eavlIntArray> incidenceCellShiftedIdx(incidenceCell,
+                                                        eavlArrayIndexer(1, 1));
+    eavlIndexable<eavlIntArray> lastOfFaceShifted(lastOfFace,
+                                                  eavlArrayIndexer(1, 1));
+
+    if (ni > 0)
+    {
+        eavlExecutor::AddOperation(
+            new eavlReverseIndexOp(cellFaceCount,
+                                   cellFaceStart,
+                                   incidenceCellShifted,
+                                   incidenceSubindex,
+                                   MAX_LOCAL_TOPOLOGY_IDS),
+            "generate reverse lookup: face incidence to cell");
+        eavlExecutor::AddOperation(
+            new_eavlCombinedTopologyPackedMapOp(inCells,
+                                                EAVL_FACES_OF_CELLS,
+                                                eavlOpArgs(incidenceSubindex),
+                                                eavlOpArgs(incidenceSubindex),
+                                                eavlOpArgs(incidenceFaceShifted),
+                                                eavlOpArgs(incidenceCellShiftedIdx),
+                                                SelectElementComponentFunctor()),
+            "look up face index for each incidence");
+        eavlExecutor::AddOperation(
+            new_eavlRadixSortOp(eavlOpArgs(incidenceFace),
+                                eavlOpArgs(incidenceCell),
+                                false),
+            "sort incidences by face");
+        eavlExecutor::AddOperation(
+            new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlIntArray>(incidenceFace),
+                                     incidenceFaceShifted),
+                          eavlOpArgs(lastOfFaceShifted),
+                          FirstTwoDifferFunctor()),
+            "flag last incidence of each face");
+        eavlExecutor::AddOperation(
+            new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlIntArray>(lastOfFace),
+                                     lastOfFaceShifted),
+                          eavlOpArgs(extFlag),
+                          eavlMulFunctor<int>()),
+            "flag faces used by exactly one cell");
+        eavlExecutor::AddOperation(
+            new eavlPrefixSumOp_1(extFlag, extIndex, false),
+            "scan to generate external face output index");
+        eavlExecutor::AddOperation(
+            new eavlReduceOp_1<eavlAddFunctor<int> >
+                (extFlag,
+                 totalExt,
+                 eavlAddFunctor<int>()),
+            "sumreduce to count external faces");
+        eavlExecutor::Go();
+    }
+    int n_ext = (ni > 0) ? totalExt->GetValue(0) : 0;
+
+    //
+    // compact the external faces and look up their nodes
+    //
+    eavlIntArray *extIncidence = new eavlIntArray("extIncidence", 1, n_ext);
+    eavlIntArray *extFace = new eavlIntArray("extFace", 1, n_ext);
+    eavlIntArray *extCell = new eavlIntArray("extCell", 1, n_ext);
+    eavlIntArray *extShape = new eavlIntArray("extShape", 1, n_ext);
+    eavlIntArray *extNumNodes = new eavlIntArray("extNumNodes", 1, n_ext);
+    eavlIntArray *extNodes = new eavlIntArray("extNodes", 4, n_ext);
+    eavlIntArray *extConnStart = new eavlIntArray("extConnStart", 1, n_ext);
+
+    if (n_ext > 0)
+    {
+        eavlExecutor::AddOperation(
+            new eavlSimpleReverseIndexOp(extFlag,
+                                         extIndex,
+                                         extIncidence),
+            "generate reverse lookup: external face to incidence");
+        eavlExecutor::AddOperation(
+            new_eavlGatherOp(eavlOpArgs(incidenceFace),
+                             eavlOpArgs(extFace),
+                             eavlOpArgs(extIncidence)),
+            "gather face index of each external face");
+        eavlExecutor::AddOperation(
+            new_eavlGatherOp(eavlOpArgs(incidenceCell),
+                             eavlOpArgs(extCell),
+                             eavlOpArgs(extIncidence)),
+            "gather owning cell of each external face");
+        eavlExecutor::AddOperation(
+            new_eavlSourceTopologyGatherMapOp(inCells,
+                                              EAVL_NODES_OF_FACES,
+                                              eavlOpArgs(extFace),
+                                              eavlOpArgs(eavlIndexable<eavlIntArray>(extShape),
+                                                         eavlIndexable<eavlIntArray>(extNumNodes),
+                                                         eavlIndexable<eavlIntArray>(extNodes,0),
+                                                         eavlIndexable<eavlIntArray>(extNodes,1),
+                                                         eavlIndexable<eavlIntArray>(extNodes,2),
+                                                         eavlIndexable<eavlIntArray>(extNodes,3)),
+                                              eavlOpArgs(extFace),
+                                              FaceShapeAndNodesFunctor()),
+            "look up nodes of each external face");
+        eavlExecutor::AddOperation(
+            new eavlPrefixSumOp_1(extNumNodes, extConnStart, false),
+            "scan to generate starting connectivity index per face");
+        eavlExecutor::Go();
+    }
+
+    //
+    // create the output cell set; each face's connectivity starts
+    // at its node scan plus one slot per preceding face for the count
+    //
+    if(outputCellSetName.empty())
+        outputCellSetName = string("extface_of_")+inCells->GetName();
+    eavlCellSetExplicit *outCells =
+        new eavlCellSetExplicit(outputCellSetName, 2);
+    eavlExplicitConnectivity conn;
+    int nconn = (n_ext > 0) ? (extConnStart->GetValue(n_ext-1) +
+                               extNumNodes->GetValue(n_ext-1) + n_ext) : 0;
+    conn.shapetype.resize(n_ext);
+    conn.connectivity.resize(nconn);
+    if (n_ext > 0)
+    {
+        // bring each array to the host before the parallel loop, which
+        // then only reads raw host pointers
+        const int *connStart = (const int*)extConnStart->GetHostArray();
+        const int *numNodes = (const int*)extNumNodes->GetHostArray();
+        const int *shapes = (const int*)extShape->GetHostArray();
+        const int *allNodes = (const int*)extNodes->GetHostArray();
+        int nodeStride = extNodes->GetNumberOfComponents();
+        #pragma omp parallel for
+        for (int i=0; i<n_ext; i++)
+        {
+            int start = connStart[i] + i;
+            int nnodes = numNodes[i];
+            const int *nodes = allNodes + i * nodeStride;
+            conn.shapetype[i] = shapes[i];
+            conn.connectivity[start] = nnodes;
+            for (int j=0; j<nnodes; j++)
+                conn.connectivity[start + 1 + j] = nodes[j];
+        }
+    }
+    outCells->SetCellNodeConnectivity(conn);
+    dataset->AddCellSet(outCells);
+
+    // copy any cell fields
+    int nOldFields = dataset->GetNumFields();
+    for (int i=0; i < nOldFields; ++i)
+    {
+        eavlField *inField = dataset->GetField(i);
+        if (inField->GetAssociation() == eavlField::ASSOC_CELL_SET &&
+            inField->GetAssocCellSet() == dataset->GetCellSet(inCellSetIndex)->GetName())
+        {
+            eavlArray *inArray = inField->GetArray();
+            int n = n_ext;
+            int nc = inArray->GetNumberOfComponents();
+            // I guess it's most appropriate to re-use the input 
+            // field name directly?
+            eavlFloatArray *outArray =
+                new eavlFloatArray(/*string("extface_of_") + */
+                                   inArray->GetName(), nc);
+            outArray->SetNumberOfTuples(n);
+            if (n > 0)
+            {
+                for (int c=0; c<nc; c++)
+                {
+                    eavlExecutor::AddOperation(
+                        new_eavlGatherOp(eavlOpArgs(eavlIndexable<eavlArray>(inArray, c)),
+                                         eavlOpArgs(eavlIndexable<eavlFloatArray>(outArray, c)),
+                                         eavlOpArgs(extCell)),
+                        "gather cell field");
+                }
+                eavlExecutor::Go();
+            }
+            eavlField *outField = new eavlField(0, outArray,
+                                                eavlField::ASSOC_CELL_SET,
+                                                outCells->GetName());
+            dataset->AddField(outField);
+        }
+    }
+
+    delete cellFaceCount;
+    delete cellFaceStart;
+    delete totalIncidences;
+    delete incidenceSubindex;
+    delete incidenceFace;
+    delete incidenceCell;
+    delete lastOfFace;
+    delete extFlag;
+    delete extIndex;
+    delete totalExt;
+    delete extIncidence;
+    delete extFace;
+    delete extCell;
+    delete extShape;
+    delete extNumNodes;
+    delete extNodes;
+    delete extConnStart;
+}
@@ -571,8 +571,14 @@ eavlIsosurfaceFilter::Execute()
     eavlIntArray *revPtEdgeIndex = new eavlIntArray("revPtEdgeIndex",1,noutpts);
     eavlIntArray *revInputIndex = new eavlIntArray("revInputIndex", 1, noutgeom);
     eavlIntArray *revInputSubindex = new eavlIntArray("revInputSubindex", 1, noutgeom);
-    eavlByteArray *outcaseArray = new eavlByteArray("outcase", 1, noutgeom);
-    eavlIntArray *localouttriArray = new eavlIntArray("localouttri", each_outgeom_count, noutgeom);
+    // (the cell-local edge lookups are used only by the fused group
+    // producing the global edge ids, which elides them when fusing)
+    eavlByteArray *outcaseArray = new eavlByteArray("outcase", 1, noutgeom,
+                                                    eavlArray::ALLOCATE_ON_FIRST_USE);
+    eavlIntArray *localouttriArray = new eavlIntArray("localouttri", each_outgeom_count, noutgeom,
+                                                      eavlArray::ALLOCATE_ON_FIRST_USE);
+    eavlExecutor::MarkIntermediate(outcaseArray);
+    eavlExecutor::MarkIntermediate(localouttriArray);
     eavlIntArray *outtriArray = new eavlIntArray("outtri", each_outgeom_count, noutgeom);
     eavlIntArray *outconn = new eavlIntArray("outconn", each_outgeom_count, noutgeom);
     eavlFloatArray *alpha = new eavlFloatArray("alpha", 1, noutpts);
@@ -8,6 +8,203 @@
 #include "eavlLogicalStructureRegular.h"
 #include "eavlCoordinates.h"
 #include <algorithm>
+#include <cfloat>
+
+// ****************************************************************************
+// Class:  PointGrid
+//
+// Purpose:
+///   A uniform grid of cells over the bounding box of a data set's points,
+///   sized for about one point per cell, holding the points of each cell
+///   contiguously.  Answers closest point queries by searching the cells
+///   around the query in growing shells until no unsearched cell can hold
+///   a closer point.  Ties go to the lowest point index, as in a search
+///   over the points in order.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class PointGrid
+{
+  public:
+    PointGrid(eavlDataSet *ds, int dim)
+    {
+        npts = ds->GetNumPoints();
+        vector<double> pt[3];
+        for (int d=0; d<3; ++d)
+            pt[d].resize(npts, 0.);
+        #pragma omp parallel for
+        for (int p=0; p<npts; ++p)
+        {
+            for (int d=0; d<dim; ++d)
+                pt[d][p] = ds->GetPoint(p, d);
+        }
+
+        // size the cells for about one point each over the axes the
+        // points actually spread along
+        double extent[3];
+        int nactive = 0;
+        double volume = 1;
+        for (int d=0; d<3; ++d)
+        {
+            double lo = 0, hi = 0;
+            if (npts > 0)
+            {
+                lo = hi = pt[d][0];
+                for (int p=1; p<npts; ++p)
+                {
+                    lo = std::min(lo, pt[d][p]);
+                    hi = std::max(hi, pt[d][p]);
+                }
+            }
+            origin[d] = lo;
+            extent[d] = hi - lo;
+            if (extent[d] > 0)
+            {
+                ++nactive;
+                volume *= extent[d];
+            }
+        }
+        double size = (nactive > 0) ? pow(volume / double(std::max(npts,1)),
+                                          1. / double(nactive)) : 1.;
+        ncells = 1;
+        for (int d=0; d<3; ++d)
+        {
+            if (extent[d] > 0)
+            {
+                dims[d] = std::max(1, std::min(1 << 20,
+                                               int(ceil(extent[d] / size))));
+                width[d] = extent[d] / double(dims[d]);
+                invwidth[d] = double(dims[d]) / extent[d];
+            }
+            else
+            {
+                dims[d] = 1;
+                width[d] = 1;
+                invwidth[d] = 0;
+            }
+            ncells *= dims[d];
+        }
+
+        // counting sort of the points by cell, keeping them in index
+        // order within each cell
+        vector<int> cellOf(npts);
+        cellStart.assign(ncells+1, 0);
+        for (int p=0; p<npts; ++p)
+        {
+            int c[3];
+            for (int d=0; d<3; ++d)
+                c[d] = CellIndex(pt[d][p], d);
+            cellOf[p] = c[0] + dims[0]*(c[1] + dims[1]*c[2]);
+            ++cellStart[cellOf[p]+1];
+        }
+        for (int c=0; c<ncells; ++c)
+            cellStart[c+1] += cellStart[c];
+
+        vector<int> next(cellStart.begin(), cellStart.end()-1);
+        ids.resize(npts);
+        coords.resize(npts*3);
+        for (int p=0; p<npts; ++p)
+        {
+            int slot = next[cellOf[p]]++;
+            ids[slot] = p;
+            for (int d=0; d<3; ++d)
+                coords[slot*3+d] = pt[d][p];
+        }
+    }
+
+    /// The index of the point closest to (qx,qy,qz), with its squared
+    /// distance in d2, or -1 if there are no points.
+    int FindClosest(double qx, double qy, double qz, double &d2) const
+    {
+        d2 = DBL_MAX;
+        if (npts == 0)
+            return -1;
+
+        double q[3] = {qx, qy, qz};
+        int qc[3];
+        for (int d=0; d<3; ++d)
+            qc[d] = CellIndex(q[d], d);
+
+        int best = -1;
+        for (int r=0; ; ++r)
+        {
+            int lo[3], hi[3];
+            for (int d=0; d<3; ++d)
+            {
+                lo[d] = std::max(qc[d] - r, 0);
+                hi[d] = std::min(qc[d] + r, dims[d] - 1);
+            }
+
+            // visit the cells exactly r cells away from the query's cell
+            for (int k=lo[2]; k<=hi[2]; ++k)
+            {
+                bool kedge = (k == qc[2]-r || k == qc[2]+r);
+                for (int j=lo[1]; j<=hi[1]; ++j)
+                {
+                    bool jedge = kedge || (j == qc[1]-r || j == qc[1]+r);
+                    int istep = jedge ? 1 : std::max(2*r, 1);
+                    for (int i=qc[0]-r; i<=qc[0]+r; i+=istep)
+                    {
+                        if (i < 0 || i >= dims[0])
+                            continue;
+                        int c = i + dims[0]*(j + dims[1]*k);
+                        for (int s=cellStart[c]; s<cellStart[c+1]; ++s)
+                        {
+                            double dx = coords[s*3+0] - q[0];
+                            double dy = coords[s*3+1] - q[1];
+                            double dz = coords[s*3+2] - q[2];
+                            double dd = dx*dx + dy*dy + dz*dz;
+                            if (dd < d2 || (dd == d2 && ids[s] < best))
+                            {
+                                d2 = dd;
+                                best = ids[s];
+                            }
+                        }
+                    }
+                }
+            }
+
+            // the closest any cell further out can be; stop when that
+            // is beyond the best point found or there are no more cells
+            double bound = DBL_MAX;
+            for (int d=0; d<3; ++d)
+            {
+                if (qc[d] - r > 0)
+                    bound = std::min(bound, q[d] - (origin[d] + (qc[d]-r)*width[d]));
+                if (qc[d] + r < dims[d] - 1)
+                    bound = std::min(bound, (origin[d] + (qc[d]+r+1)*width[d]) - q[d]);
+            }
+            if (bound == DBL_MAX)
+                break;
+            // allow for rounding when the points were binned
+            bound = std::max(bound - 1.e-6 * std::min(width[0], std::min(width[1], width[2])), 0.);
+            if (best >= 0 && bound * bound > d2)
+                break;
+        }
+        return best;
+    }
+
+  protected:
+    int CellIndex(double v, int d) const
+    {
+        double f = (v - origin[d]) * invwidth[d];
+        if (f <= 0)
+            return 0;
+        if (f >= dims[d] - 1)
+            return dims[d] - 1;
+        return int(f);
+    }
+
+    int npts;
+    int ncells;
+    int dims[3];
+    double origin[3], width[3], invwidth[3];
+    vector<int> cellStart;
+    vector<int> ids;
+    vector<double> coords;
+};
 
 eavlPointDistanceFieldFilter::eavlPointDistanceFieldFilter()
 {
@@ -17,6 +214,7 @@ eavlPointDistanceFieldFilter::eavlPointDistanceFieldFilter()
     xmin = ymin = zmin = -1;
     xmax = ymax = zmax = +1;
     ni = nj = nk = 1;
+    outputClosestPoint = false;
 }
 
 eavlPointDistanceFieldFilter::~eavlPointDistanceFieldFilter()
@@ -155,42 +353,28 @@ void eavlPointDistanceFieldFilter::Execute()
     if (exact)
     {
         //
-        // We were asked to create the "exact" results.
-        // This is a naive, slow, O(n*m) algorithm.
-        // (where n = num input points and m = num output mesh nodes)
+        // We were asked to create the "exact" results.  Bin the input
+        // points into a uniform grid, then find the closest point to each
+        // mesh node by searching the grid cells around it in growing
+        // shells, so each node only looks at the points near it.
         //
-        for (int k=0; k<nk; ++k)
+        PointGrid grid(input, dim);
+
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (int myindex=0; myindex<npts; ++myindex)
         {
-            for (int j=0; j<nj; ++j)
+            int i = myindex % ni;
+            int j = (myindex / ni) % nj;
+            int k = myindex / (ni*nj);
+            const float myx = x->GetValue(i);
+            const float myy = y ? y->GetValue(j) : 0;
+            const float myz = z ? z->GetValue(k) : 0;
+            double d2;
+            int p = grid.FindClosest(myx, myy, myz, d2);
+            if (p >= 0)
             {
-                for (int i=0; i<ni; ++i)
-                {
-                    const int myindex = i + j*ni + k*ni*nj;
-                    const float myx = x->GetValue(i);
-                    const float myy = y ? y->GetValue(j) : 0;
-                    const float myz = z ? z->GetValue(k) : 0;
-                    float old_dist = dist->GetValue(myindex);
-                    for (int p=0; p<input->GetNumPoints(); ++p)
-                    {
-                        double px=0,py=0,pz=0;
-                        px = input->GetPoint(p, 0);
-                        if (dim>=2)
-                            py = input->GetPoint(p, 1);
-                        if (dim>=3)
-                            pz = input->GetPoint(p, 2);
-
-                        double dx = px - myx;
-                        double dy = py - myy;
-                        double dz = pz - myz;
-                        double new_dist = sqrt(dx*dx + dy*dy + dz*dz);
-
-                        if (old_dist < 0 || new_dist < old_dist)
-                        {
-                            dist->SetValue(myindex, new_dist);
-                            old_dist = new_dist;
-                        }
-                    }
-                }
+                cp->SetValue(myindex, p);
+                dist->SetValue(myindex, sqrt(d2));
             }
         }
     }
@@ -340,5 +524,8 @@ void eavlPointDistanceFieldFilter::Execute()
         }
     }
 
-    delete cp;
+    if (outputClosestPoint)
+        output->AddField(new eavlField(1, cp, eavlField::ASSOC_POINTS));
+    else
+        delete cp;
 }
@@ -14,6 +14,11 @@
 // Creation:    November 18, 2013
 //
 // Modifications:
+//   The exact mode finds each node's closest point with a uniform grid
+//   over the input points, searched in parallel, instead of comparing
+//   every node with every point.  It now fills in the closest point
+//   field too, which can be added to the output as "cp".
+//
 // ****************************************************************************
 class eavlPointDistanceFieldFilter : public eavlFilter
 {
@@ -65,10 +70,17 @@ class eavlPointDistanceFieldFilter : public eavlFilter
         exact = false;
         niter = n;
     }
+    /// Add the index of each node's closest input point to the output
+    /// as the point field "cp".
+    void SetOutputClosestPoint(bool out)
+    {
+        outputClosestPoint = out;
+    }
     virtual void Execute();
   protected:
     bool exact;
     int niter;
+    bool outputClosestPoint;
     int dim;
     int ni, nj, nk;
     float xmin, xmax;
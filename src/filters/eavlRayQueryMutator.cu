@@ -7,6 +7,7 @@
 #include "eavlFilter.h"
 #include "eavlTimer.h" 
 #include "SplitBVH.h"
+#include "eavlBVHCache.h"
 
 #define END_FLAG    -1000000000
 #define INFINITE    1000000
@@ -57,7 +58,7 @@ eavlRayQueryMutator::eavlRayQueryMutator()
     
     numTris = 0;
 
-    if(eavlExecutor::GetExecutionMode() == eavlExecutor::ForceCPU ) cpu = true;
+    if(eavlExecutor::ForcingCPU()) cpu = true;
     else cpu = false;
 
 }
@@ -338,16 +339,12 @@ void eavlRayQueryMutator::extractGeometry()
     int tri_bvh_in_size = 0;
     int tri_bvh_lf_size = 0;
     
-    bool cacheExists  =false;
-    bool writeCache   =true;
-     
+    bool cacheExists = false;
+    unsigned long long cacheKey = 0;
     if(cacheBVH)
     {
-        cacheExists = readBVHCache(tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size, cacheName.c_str());
-    }
-    else 
-    {
-        writeCache = false;
+        cacheKey = eavlBVHCache::ComputeKey(tri_verts_raw, (long long)numTris * 12, TRIANGLE, numTris, false);
+        cacheExists = eavlBVHCache::Read(cacheName, cacheKey, tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size);
     }
 
     if(!cacheExists)
@@ -356,7 +353,7 @@ void eavlRayQueryMutator::extractGeometry()
         SplitBVH *testSplit= new SplitBVH(tri_verts_raw, numTris, 0); // 0=triangle
         if(verbose) cout<<"Done building."<<endl;
         testSplit->getFlatArray(tri_bvh_in_size, tri_bvh_lf_size, tri_bvh_in_raw, tri_bvh_lf_raw);
-        if( writeCache ) writeBVHCache(tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size, cacheName.c_str());
+        if( cacheBVH ) eavlBVHCache::Write(cacheName, cacheKey, tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size);
         delete testSplit;
     }
 
@@ -14,6 +14,7 @@
 //Operations
 #include "eavlSimpleReverseIndexOp.h"
 #include "eavlPrefixSumOp_1.h"
+#include "eavlRadixSortOp.h"
 #include "eavl1toNScatterOp.h"
 #include "eavlNto1GatherOp.h"
 #include "eavlReduceOp_1.h"
@@ -22,6 +23,9 @@
 #include "eavlMapOp.h"
 //RT
 #include "MortonBVHBuilder.h"
+#include "eavlBVHCache.h"
+#include "eavlBinnedBVHBuilder.h"
+#include "eavlWideBVH.h"
 #include "eavlRTUtil.h"
 #include "SplitBVH.h"
 
@@ -75,13 +79,18 @@ eavlConstTexArray<float>*  cyl_bvh_lf_array;
 eavlConstTexArray<float>*  cyl_scalars_array;
 eavlConstTexArray<int>*    cyl_matIdx_array;
 
+/* Wide BVHs collapsed from the binary ones for tracing on the CPU */
+eavlWideBVH* tri_wide_bvh;
+eavlWideBVH* sphr_wide_bvh;
+eavlWideBVH* cyl_wide_bvh;
+
 eavlConstTexArray<float4>* cmap_array;
 
 eavlRayTracerMutator::eavlRayTracerMutator()
 {
     
     //eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
-    if(eavlExecutor::GetExecutionMode() == eavlExecutor::ForceCPU ) cpu = true;
+    if(eavlExecutor::ForcingCPU()) cpu = true;
     else cpu = false;
 
     scene= new eavlRTScene(RTMaterial());
@@ -157,6 +166,19 @@ eavlRayTracerMutator::eavlRayTracerMutator()
     cyl_scalars_array  = NULL;
     cyl_matIdx_array   = NULL;
 
+    tri_wide_bvh       = NULL;
+    sphr_wide_bvh      = NULL;
+    cyl_wide_bvh       = NULL;
+    useWideBVH         = true;
+    rayOrder           = MortonOrder;
+    tileSize           = 16;
+    progressive        = false;
+    batchRays          = 65536;
+    timeBudget         = 0.f;
+    maxPasses          = 1;
+    nextRay            = 0;
+    progressivePass    = 0;
+
     /* Raw arrays */
     tri_verts_raw    = NULL;
     tri_norms_raw    = NULL;
@@ -220,6 +242,10 @@ eavlRayTracerMutator::eavlRayTracerMutator()
     minDistances = NULL;
 
     compactTempInt = NULL;
+    accR = NULL;
+    accG = NULL;
+    accB = NULL;
+    batchFrame = NULL;
     compactTempFloat = NULL;
 
     rOut = NULL;
@@ -235,7 +261,7 @@ eavlRayTracerMutator::eavlRayTracerMutator()
     count = NULL;
     indexScan = NULL;
     
-    fastBVHBuild = true; //Use the Morton LBVH Builder
+    bvhBuilder = MortonBuilder; //Use the Morton LBVH Builder
 
     setDefaultColorMap();
     if(verbose) cout<<"Constructor finished\n";
@@ -312,7 +338,10 @@ EAVL_HOSTDEVICE void jenkinsMix(unsigned int & a, unsigned int & b, unsigned int
 }
 struct OccRayGenFunctor2
 {   
-    OccRayGenFunctor2(){}
+    int sampleOffset;   /*samples already taken, so the next ones continue the sequence*/
+    OccRayGenFunctor2(int offset = 0)
+        : sampleOffset(offset)
+    {}
 
     EAVL_FUNCTOR tuple<float,float,float> operator()(tuple<float,float,float,float,float,float,int>input, int seed, int sampleNum){
         int hitIdx = get<6>(input);
@@ -354,7 +383,7 @@ struct OccRayGenFunctor2
 
         float  x = 0.0f;
         float  xadd = 1.0f;
-        unsigned int hc2 = 1 + sampleNum;
+        unsigned int hc2 = 1 + sampleNum + sampleOffset;
         while (hc2 != 0)
         {
             xadd *= 0.5f;
@@ -365,7 +394,7 @@ struct OccRayGenFunctor2
 
         float  y = 0.0f;
         float  yadd = 1.0f;
-        int hc3 = 1 + sampleNum;
+        int hc3 = 1 + sampleNum + sampleOffset;
         while (hc3 != 0)
         {
             yadd *= 1.0f / 3.0f;
@@ -428,6 +457,175 @@ EAVL_HOSTDEVICE eavlVector3 triangleIntersectionABG(const eavlVector3 ray,const
 
 
 
+/* Leaf tests shared by the binary and wide BVH traversals. Each tests the ray against the primitives of the leaf
+   at the given offset in the leaf node array, keeping the closest hit, and returns true if it was an occlusion ray
+   that hit something.*/
+EAVL_HOSTDEVICE bool intersectTriLeaf(int leaf, const eavlConstTexArray<float> *tri_bvh_lf_raw, const eavlConstTexArray<float4> *verts,
+                                      float dirx, float diry, float dirz, float ox, float oy, float oz, bool occlusion,
+                                      float &minDistance, int &minIndex)
+{
+    int numTri = (int)tri_bvh_lf_raw->getValue(tri_bvh_lf_tref,leaf)+1;
+
+    for(int i = 1; i < numTri; i++)
+    {        
+        int triIndex = (int)tri_bvh_lf_raw->getValue(tri_bvh_lf_tref,leaf+i);
+       
+        float4 a4 = verts->getValue(tri_verts_tref, triIndex*3);
+        float4 b4 = verts->getValue(tri_verts_tref, triIndex*3+1);
+        float4 c4 = verts->getValue(tri_verts_tref, triIndex*3+2);
+        eavlVector3 e1( a4.w - a4.x , b4.x - a4.y, b4.y - a4.z ); 
+        eavlVector3 e2( b4.z - a4.x , b4.w - a4.y, c4.x - a4.z );
+
+
+        eavlVector3 p;
+        p.x = diry * e2.z - dirz * e2.y;
+        p.y = dirz * e2.x - dirx * e2.z;
+        p.z = dirx * e2.y - diry * e2.x;
+        float dot = e1.x * p.x + e1.y * p.y + e1.z * p.z;
+        if(dot != 0.f)
+        {
+            dot = 1.f/dot;
+            eavlVector3 t;
+            t.x = ox - a4.x;
+            t.y = oy - a4.y;
+            t.z = oz - a4.z;
+
+            float u = (t.x* p.x + t.y * p.y + t.z * p.z) * dot;
+            if(u >= (0.f - EPSILON) && u <= (1.f + EPSILON))
+            {
+                eavlVector3 q; // = t % e1;
+                q.x = t.y * e1.z - t.z * e1.y;
+                q.y = t.z * e1.x - t.x * e1.z;
+                q.z = t.x * e1.y - t.y * e1.x;
+                float v = (dirx * q.x + diry * q.y + dirz * q.z) * dot;
+                if(v >= (0.f - EPSILON) && v <= (1.f + EPSILON))
+                {
+                    float dist = (e2.x * q.x + e2.y * q.y + e2.z * q.z) * dot;
+                    if((dist > EPSILON && dist < minDistance) && !(u + v > 1) )
+                    {
+                        minDistance = dist;
+                        minIndex = triIndex;
+                        if(occlusion) return true;//or set todo to -1
+                    }
+                }
+            }
+
+        }
+       
+    }
+    return false;
+}
+
+EAVL_HOSTDEVICE bool intersectSphereLeaf(int leaf, const eavlConstTexArray<float> *bvh_lf, const eavlConstTexArray<float4> *verts,
+                                         float dirx, float diry, float dirz, float ox, float oy, float oz, bool occlusion,
+                                         float &minDistance, int &minIndex)
+{
+    int numSheres = (int)bvh_lf->getValue(sphr_bvh_lf_tref,leaf)+1;
+ 
+    for(int i = 1; i < numSheres; i++)
+    {        
+        int sphereIndex = (int)bvh_lf->getValue(sphr_bvh_lf_tref,leaf+i);
+        
+        float4 data = verts->getValue(sphr_verts_tref, sphereIndex);
+
+        float lx = data.x-ox;
+        float ly = data.y-oy;
+        float lz = data.z-oz;
+
+        float dot1 = lx*dirx+ly*diry+lz*dirz;
+        if(dot1 >= 0)
+        {
+            float d  = lx*lx + ly*ly + lz*lz - dot1*dot1;
+            float r2 = data.w * data.w;
+            if(d <= r2 )
+            {
+                float tch = sqrt(r2 - d);
+                float t0  = dot1 - tch;
+                //float t1 = dot1+tch; /* if t1 is > 0 and t0<0 then the ray is inside the sphere.
+
+                if( t0 < minDistance && t0 > 0)
+                {
+                    minIndex = sphereIndex;
+                    minDistance = t0;
+                    if(occlusion) return true;
+                }
+                
+            }
+        }
+
+    }
+    return false;
+}
+
+EAVL_HOSTDEVICE bool intersectCylLeaf(int leaf, const eavlConstTexArray<float> *cyl_bvh_lf_raw, const eavlConstTexArray<float4> *verts,
+                                      float dirx, float diry, float dirz, float ox, float oy, float oz, bool occlusion,
+                                      float &minDistance, int &minIndex)
+{
+    int numCyl = (int)cyl_bvh_lf_raw->getValue(cyl_bvh_lf_tref,leaf)+1;
+    eavlVector3 dir(dirx, diry, dirz);
+    eavlVector3 o(ox, oy, oz);
+    for(int i = 1; i < numCyl; i++)
+    {        
+        int cylIndex = (int)cyl_bvh_lf_raw->getValue(cyl_bvh_lf_tref,leaf+i);
+       
+        float4 a4 = verts->getValue(cyl_verts_tref, cylIndex*2);   /*basePoint + radius*/ 
+        float4 b4 = verts->getValue(cyl_verts_tref, cylIndex*2+1); /*axis + height*/
+        
+        eavlVector3 basePoint(a4.x, a4.y, a4.z);
+        eavlVector3 axis(b4.x, b4.y, b4.z);
+        /* project vectors onto the plane defined by the axis*/
+        eavlVector3 pdir = dir - (axis * dir) * axis;
+        eavlVector3 po = o - (axis * o) * axis;
+        eavlVector3 pc = basePoint - (axis * basePoint) * axis;
+        /* get quadratic values*/
+        eavlVector3 L = po - pc;
+        float a = pdir * pdir;
+        float b = 2 * pdir * L;
+        float c = L * L - a4.w * a4.w; 
+
+        float t0 = INFINITE;
+        float t1 = INFINITE;
+
+        solveQuadratic(a, b, c, t0,t1);
+        float dist1 = INFINITE;
+        float dist2 = INFINITE; //TODO consolidate t0-dist1
+        
+        if(t0 > 0)
+        {
+            eavlVector3 hit = o + t0 * dir;
+            eavlVector3 hp = hit - basePoint; 
+            float dot = hp * axis;
+            if(dot > 0 && dot < b4.w) /*b4.w == height of cylinder */
+            {
+                dist1 = t0;
+            }
+        }
+
+        if(t1 > 0)
+        {
+            eavlVector3 hit = o + t1 * dir;
+            eavlVector3 hp = hit - basePoint; 
+            float dot = hp * axis;
+            if(dot > 0 && dot < b4.w)
+            {
+                dist2 = t1;
+            }
+        }
+    
+        dist1 = min(dist1, dist2);
+
+        if(dist1 >EPSILON && dist1 < minDistance && dist1 != INFINITE)
+        {
+            minDistance = dist1;
+            minIndex = cylIndex;
+            if(occlusion) return true;
+        }
+
+
+    }
+    return false;
+}
+
 EAVL_HOSTDEVICE int getIntersectionTri(const eavlVector3 rayDir, const eavlVector3 rayOrigin, bool occlusion, const eavlConstTexArray<float4> *bvh,
                                        const eavlConstTexArray<float> *tri_bvh_lf_raw, const eavlConstTexArray<float4> *verts,const float &maxDistance, float &distance)
 {
@@ -531,55 +729,8 @@ EAVL_HOSTDEVICE int getIntersectionTri(const eavlVector3 rayDir, const eavlVecto
             
 
             currentNode = -currentNode - 1; //swap the neg address 
-            int numTri = (int)tri_bvh_lf_raw->getValue(tri_bvh_lf_tref,currentNode)+1;
-
-            for(int i = 1; i < numTri; i++)
-            {        
-                    int triIndex = (int)tri_bvh_lf_raw->getValue(tri_bvh_lf_tref,currentNode+i);
-                   
-                    float4 a4 = verts->getValue(tri_verts_tref, triIndex*3);
-                    float4 b4 = verts->getValue(tri_verts_tref, triIndex*3+1);
-                    float4 c4 = verts->getValue(tri_verts_tref, triIndex*3+2);
-                    eavlVector3 e1( a4.w - a4.x , b4.x - a4.y, b4.y - a4.z ); 
-                    eavlVector3 e2( b4.z - a4.x , b4.w - a4.y, c4.x - a4.z );
-
-
-                    eavlVector3 p;
-                    p.x = diry * e2.z - dirz * e2.y;
-                    p.y = dirz * e2.x - dirx * e2.z;
-                    p.z = dirx * e2.y - diry * e2.x;
-                    float dot = e1.x * p.x + e1.y * p.y + e1.z * p.z;
-                    if(dot != 0.f)
-                    {
-                        dot = 1.f/dot;
-                        eavlVector3 t;
-                        t.x = ox - a4.x;
-                        t.y = oy - a4.y;
-                        t.z = oz - a4.z;
-
-                        float u = (t.x* p.x + t.y * p.y + t.z * p.z) * dot;
-                        if(u >= (0.f - EPSILON) && u <= (1.f + EPSILON))
-                        {
-                            eavlVector3 q; // = t % e1;
-                            q.x = t.y * e1.z - t.z * e1.y;
-                            q.y = t.z * e1.x - t.x * e1.z;
-                            q.z = t.x * e1.y - t.y * e1.x;
-                            float v = (dirx * q.x + diry * q.y + dirz * q.z) * dot;
-                            if(v >= (0.f - EPSILON) && v <= (1.f + EPSILON))
-                            {
-                                float dist = (e2.x * q.x + e2.y * q.y + e2.z * q.z) * dot;
-                                if((dist > EPSILON && dist < minDistance) && !(u + v > 1) )
-                                {
-                                    minDistance = dist;
-                                    minIndex = triIndex;
-                                    if(occlusion) return minIndex;//or set todo to -1
-                                }
-                            }
-                        }
-
-                    }
-                   
-            }
+            if(intersectTriLeaf(currentNode, tri_bvh_lf_raw, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex))
+                return minIndex;
             currentNode = todo[stackptr];
             stackptr--;
         }
@@ -691,40 +842,8 @@ EAVL_HOSTDEVICE int getIntersectionSphere(const eavlVector3 rayDir, const eavlVe
         if(currentNode < 0 && currentNode != barrier)//check register usage
         {
             currentNode = -currentNode - 1; //swap the neg address
-            int numSheres = (int)bvh_lf->getValue(sphr_bvh_lf_tref,currentNode)+1;
- 
-            for(int i = 1; i < numSheres; i++)
-            {        
-                int sphereIndex = (int)bvh_lf->getValue(sphr_bvh_lf_tref,currentNode+i);
-                
-                float4 data = verts->getValue(sphr_verts_tref, sphereIndex);
-
-                float lx = data.x-ox;
-                float ly = data.y-oy;
-                float lz = data.z-oz;
-
-                float dot1 = lx*dirx+ly*diry+lz*dirz;
-                if(dot1 >= 0)
-                {
-                    float d  = lx*lx + ly*ly + lz*lz - dot1*dot1;
-                    float r2 = data.w * data.w;
-                    if(d <= r2 )
-                    {
-                        float tch = sqrt(r2 - d);
-                        float t0  = dot1 - tch;
-                        //float t1 = dot1+tch; /* if t1 is > 0 and t0<0 then the ray is inside the sphere.
-
-                        if( t0 < minDistance && t0 > 0)
-                        {
-                            minIndex = sphereIndex;
-                            minDistance = t0;
-                            if(occlusion) return minIndex;
-                        }
-                        
-                    }
-                }
-
-            }
+            if(intersectSphereLeaf(currentNode, bvh_lf, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex))
+                return minIndex;
             currentNode = todo[stackptr];
             stackptr--;
         }
@@ -836,68 +955,8 @@ EAVL_HOSTDEVICE int getIntersectionCyl(const eavlVector3 rayDir, const eavlVecto
         {
 
             currentNode = -currentNode - 1; //swap the neg address
-            int numCyl = (int)cyl_bvh_lf_raw->getValue(cyl_bvh_lf_tref,currentNode)+1;
-            eavlVector3 dir(dirx, diry, dirz);
-            eavlVector3 o(ox, oy, oz);
-            for(int i = 1; i < numCyl; i++)
-            {        
-                int cylIndex = (int)cyl_bvh_lf_raw->getValue(cyl_bvh_lf_tref,currentNode+i);
-               
-                float4 a4 = verts->getValue(cyl_verts_tref, cylIndex*2);   /*basePoint + radius*/ 
-                float4 b4 = verts->getValue(cyl_verts_tref, cylIndex*2+1); /*axis + height*/
-                
-                eavlVector3 basePoint(a4.x, a4.y, a4.z);
-                eavlVector3 axis(b4.x, b4.y, b4.z);
-                /* project vectors onto the plane defined by the axis*/
-                eavlVector3 pdir = dir - (axis * dir) * axis;
-                eavlVector3 po = o - (axis * o) * axis;
-                eavlVector3 pc = basePoint - (axis * basePoint) * axis;
-                /* get quadratic values*/
-                eavlVector3 L = po - pc;
-                float a = pdir * pdir;
-                float b = 2 * pdir * L;
-                float c = L * L - a4.w * a4.w; 
-
-                float t0 = INFINITE;
-                float t1 = INFINITE;
-
-                solveQuadratic(a, b, c, t0,t1);
-                float dist1 = INFINITE;
-                float dist2 = INFINITE; //TODO consolidate t0-dist1
-                
-                if(t0 > 0)
-                {
-                    eavlVector3 hit = o + t0 * dir;
-                    eavlVector3 hp = hit - basePoint; 
-                    float dot = hp * axis;
-                    if(dot > 0 && dot < b4.w) /*b4.w == height of cylinder */
-                    {
-                        dist1 = t0;
-                    }
-                }
-
-                if(t1 > 0)
-                {
-                    eavlVector3 hit = o + t1 * dir;
-                    eavlVector3 hp = hit - basePoint; 
-                    float dot = hp * axis;
-                    if(dot > 0 && dot < b4.w)
-                    {
-                        dist2 = t1;
-                    }
-                }
-    
-                dist1 = min(dist1, dist2);
-
-                if(dist1 >EPSILON && dist1 > 0 && dist1 != INFINITE)
-                {
-                    minDistance = dist1;
-                    minIndex = cylIndex;
-                    if(occlusion) return minIndex;
-                }
-
-
-            }
+            if(intersectCylLeaf(currentNode, cyl_bvh_lf_raw, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex))
+                return minIndex;
             currentNode = todo[stackptr];
             stackptr--;
         }
@@ -907,6 +966,144 @@ EAVL_HOSTDEVICE int getIntersectionCyl(const eavlVector3 rayDir, const eavlVecto
  return minIndex;
 }
 
+#ifndef __CUDA_ARCH__
+/* Leaf callback for eavlWideBVH::Traverse, using the same leaf tests as the binary traversals */
+struct WideLeafIntersector
+{
+    primitive_t                     type;
+    const eavlConstTexArray<float>  *bvh_lf;
+    const eavlConstTexArray<float4> *verts;
+    float dirx, diry, dirz;
+    float ox, oy, oz;
+    bool  occlusion;
+    int   minIndex;
+
+    bool operator()(int leaf, float &minDistance)
+    {
+        if(type == TRIANGLE)
+            return intersectTriLeaf(leaf, bvh_lf, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex);
+        else if(type == SPHERE)
+            return intersectSphereLeaf(leaf, bvh_lf, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex);
+        else if(type == CYLINDER)
+            return intersectCylLeaf(leaf, bvh_lf, verts, dirx, diry, dirz, ox, oy, oz, occlusion, minDistance, minIndex);
+        return false;
+    }
+};
+
+int getIntersectionWide(const eavlVector3 rayDir, const eavlVector3 rayOrigin, bool occlusion, const eavlWideBVH *bvh,
+                        const eavlConstTexArray<float> *bvh_lf, const eavlConstTexArray<float4> *verts, primitive_t type,
+                        const float &maxDistance, float &distance)
+{
+    WideLeafIntersector leaf;
+    leaf.type      = type;
+    leaf.bvh_lf    = bvh_lf;
+    leaf.verts     = verts;
+    leaf.dirx      = rayDir.x;
+    leaf.diry      = rayDir.y;
+    leaf.dirz      = rayDir.z;
+    leaf.ox        = rayOrigin.x;
+    leaf.oy        = rayOrigin.y;
+    leaf.oz        = rayOrigin.z;
+    leaf.occlusion = occlusion;
+    leaf.minIndex  = -1;
+    float minDistance = maxDistance;
+    bvh->Traverse(rayOrigin.x, rayOrigin.y, rayOrigin.z, rayDir.x, rayDir.y, rayDir.z, leaf, minDistance);
+    distance = minDistance;
+    return leaf.minIndex;
+}
+#endif
+
+/* Closest (or, for occlusion, any) hit of a primitive type. Rays go through the wide BVH when there is one, which
+   is only on the CPU, and through the binary BVH otherwise. */
+EAVL_HOSTDEVICE int getIntersection(const eavlVector3 rayDir, const eavlVector3 rayOrigin, bool occlusion, const eavlConstTexArray<float4> *bvh,
+                                    const eavlWideBVH *wideBvh, const eavlConstTexArray<float> *bvh_lf, const eavlConstTexArray<float4> *verts,
+                                    primitive_t type, const float &maxDistance, float &distance)
+{
+#ifndef __CUDA_ARCH__
+    if(wideBvh != NULL)
+        return getIntersectionWide(rayDir, rayOrigin, occlusion, wideBvh, bvh_lf, verts, type, maxDistance, distance);
+#endif
+    if(type == TRIANGLE)
+        return getIntersectionTri(rayDir, rayOrigin, occlusion, bvh, bvh_lf, verts, maxDistance, distance);
+    else if(type == SPHERE)
+        return getIntersectionSphere(rayDir, rayOrigin, occlusion, bvh, bvh_lf, verts, maxDistance, distance);
+    else if(type == CYLINDER)
+        return getIntersectionCyl(rayDir, rayOrigin, occlusion, bvh, bvh_lf, verts, maxDistance, distance);
+    return -1;
+}
+
+/* The BVH of one primitive type and the bounds of its root */
+struct PrimitiveBVH
+{
+    primitive_t                     type;
+    const eavlConstTexArray<float4> *verts;
+    const eavlConstTexArray<float4> *bvh;
+    const eavlConstTexArray<float>  *bvh_lf;
+    const eavlWideBVH               *wideBvh;
+    float                           bounds[6];      /*xmin, ymin, zmin, xmax, ymax, zmax*/
+};
+
+/* Top level acceleration structure over the per type BVHs. Each ray is tested against the root bounds of every
+   type and walks the BVHs it enters nearest first, so one pass over the rays finds hits of all types. */
+struct SceneBVH
+{
+    int          numTypes;
+    PrimitiveBVH types[3];
+};
+
+EAVL_HOSTDEVICE int getSceneIntersection(const eavlVector3 rayDir, const eavlVector3 rayOrigin, bool occlusion, const SceneBVH &scene,
+                                         const float &maxDistance, float &distance, int &type)
+{
+    float invDir[3] = {rcp_safe(rayDir.x), rcp_safe(rayDir.y), rcp_safe(rayDir.z)};
+    float o[3]      = {rayOrigin.x, rayOrigin.y, rayOrigin.z};
+
+    /* the types whose bounds the ray enters, nearest first */
+    int   order[3];
+    float entry[3];
+    int   numHit = 0;
+    for(int t = 0; t < scene.numTypes; t++)
+    {
+        const float *b = scene.types[t].bounds;
+        float tmin = 0.f;
+        float tmax = maxDistance;
+        for(int d = 0; d < 3; d++)
+        {
+            float t0 = (b[d]   - o[d]) * invDir[d];
+            float t1 = (b[d+3] - o[d]) * invDir[d];
+            tmin = max(tmin, min(t0, t1));
+            tmax = min(tmax, max(t0, t1));
+        }
+        if(tmax < tmin) continue;
+        int i = numHit++;
+        while(i > 0 && entry[i-1] > tmin)
+        {
+            order[i] = order[i-1];
+            entry[i] = entry[i-1];
+            i--;
+        }
+        order[i] = t;
+        entry[i] = tmin;
+    }
+
+    float minDistance = maxDistance;
+    int   minIndex    = -1;
+    for(int i = 0; i < numHit && entry[i] <= minDistance; i++)
+    {
+        const PrimitiveBVH &p = scene.types[order[i]];
+        float dist;
+        int hit = getIntersection(rayDir, rayOrigin, occlusion, p.bvh, p.wideBvh, p.bvh_lf, p.verts, p.type, minDistance, dist);
+        if(hit != -1)
+        {
+            minIndex    = hit;
+            minDistance = dist;
+            type        = p.type;
+            if(occlusion) break;
+        }
+    }
+    distance = minDistance;
+    return minIndex;
+}
+
 /* it is known that there is an intersection */
 EAVL_HOSTDEVICE float intersectSphereDist(eavlVector3 rayDir, eavlVector3 rayOrigin, float4 sphere)
 {
@@ -1080,17 +1277,10 @@ EAVL_HOSTDEVICE float getIntersectionDepth(const eavlVector3 rayDir, const eavlV
 struct RayIntersectFunctor{
 
 
-    const eavlConstTexArray<float4> *verts;
-    const eavlConstTexArray<float4> *bvh;
-    const eavlConstTexArray<float>  *bvh_inner;
-    primitive_t                     primitiveType;
+    SceneBVH scene;
 
-    RayIntersectFunctor(const eavlConstTexArray<float4> *_verts, const eavlConstTexArray<float4> *theBvh,
-                        const eavlConstTexArray<float> *_bvh_inner, primitive_t _primitveType)
-        :verts(_verts),
-         bvh(theBvh),
-         bvh_inner(_bvh_inner),
-         primitiveType(_primitveType)
+    RayIntersectFunctor(const SceneBVH &_scene)
+        :scene(_scene)
     {}                                                 
     EAVL_HOSTDEVICE tuple<int,float,int> operator()( tuple<float,float,float,float,float,float,int, int, float> rayTuple){
        
@@ -1099,26 +1289,14 @@ struct RayIntersectFunctor{
         if(hitIdx == -1) return tuple<int,float,int>(-1, INFINITE, -1);
 
         int   minHit = -1; 
+        int   type = -1;
         float distance;
         float maxDistance = get<8>(rayTuple);
         eavlVector3 rayOrigin(get<3>(rayTuple),get<4>(rayTuple),get<5>(rayTuple));
         eavlVector3       ray(get<0>(rayTuple),get<1>(rayTuple),get<2>(rayTuple));
-        if(primitiveType == TRIANGLE)
-        {
-            minHit = getIntersectionTri(ray, rayOrigin, false,bvh,bvh_inner, verts,maxDistance,distance);
-        } 
-        else if(primitiveType == SPHERE)
-        {
-            
-            minHit = getIntersectionSphere(ray, rayOrigin, false,bvh,bvh_inner, verts,maxDistance,distance);
-        }
-        else if(primitiveType == CYLINDER)
-        {
-            
-            minHit = getIntersectionCyl(ray, rayOrigin, false,bvh,bvh_inner, verts,maxDistance,distance);
-        }
+        minHit = getSceneIntersection(ray, rayOrigin, false, scene, maxDistance, distance, type);
         
-        if(minHit!=-1) return tuple<int,float,int>(minHit, distance, primitiveType);
+        if(minHit!=-1) return tuple<int,float,int>(minHit, distance, type);
         else           return tuple<int,float,int>(hitIdx, INFINITE, get<7>(rayTuple));
     }
 };
@@ -1321,44 +1499,26 @@ struct DepthFunctor{
 struct occIntersectFunctor{
 
     float           maxDistance;
-    const eavlConstTexArray<float4> *verts;
-    const eavlConstTexArray<float4> *bvh;
-    const eavlConstTexArray<float>  *bvh_lf;
-    primitive_t                     primitiveType;
+    SceneBVH        scene;
 
 
-    occIntersectFunctor(const eavlConstTexArray<float4> *_verts, eavlConstTexArray<float4> *theBvh, eavlConstTexArray<float> *_bvh_lf, float max, primitive_t _primitveType)
-        :verts(_verts),
-         bvh(theBvh),
-         bvh_lf(_bvh_lf),
-         primitiveType(_primitveType)
+    occIntersectFunctor(const SceneBVH &_scene, float max)
+        :scene(_scene)
     {
 
         maxDistance = max;
         
     }                                                   
-    EAVL_FUNCTOR tuple<float> operator()( tuple<float,float,float,float,float,float,int, float> rayTuple){
+    EAVL_FUNCTOR tuple<float> operator()( tuple<float,float,float,float,float,float,int> rayTuple){
         
         int deadRay = get<6>(rayTuple);//hack for now leaving this in for CPU
-        bool alreadyOccluded = get<7>(rayTuple) > 0 ? true : false;
         if(deadRay == -1)     return tuple<float>(0.0f);
-        if(alreadyOccluded)   return tuple<float>(1.f);
         int minHit = -1;   
+        int type;
         float distance;
         eavlVector3 intersect(get<3>(rayTuple),get<4>(rayTuple),get<5>(rayTuple));
         eavlVector3 ray(get<0>(rayTuple),get<1>(rayTuple),get<2>(rayTuple));
-        if(primitiveType ==  TRIANGLE )
-        {
-            minHit= getIntersectionTri(ray, intersect, true,bvh, bvh_lf, verts,maxDistance, distance);
-        }
-        else if(primitiveType == SPHERE)
-        {
-            minHit= getIntersectionSphere(ray, intersect, true,bvh, bvh_lf, verts,maxDistance, distance);
-        }
-        else if(primitiveType == CYLINDER)
-        {
-            minHit= getIntersectionCyl(ray, intersect, true,bvh, bvh_lf, verts,maxDistance, distance);
-        }
+        minHit = getSceneIntersection(ray, intersect, true, scene, maxDistance, distance, type);
 
         if(minHit!=-1) return tuple<float>(0.0f);
         else return tuple<float>(1.0f);
@@ -1369,26 +1529,18 @@ struct occIntersectFunctor{
 
 struct ShadowRayFunctor
 {
-    const eavlConstTexArray<float4> *verts;
-    const eavlConstTexArray<float4> *bvh;
-    const eavlConstTexArray<float>  *bvh_lf;
+    SceneBVH    scene;
     eavlVector3 light;
-    primitive_t type;
 
-    ShadowRayFunctor(eavlVector3 theLight,const eavlConstTexArray<float4> *_verts, const eavlConstTexArray<float4> *theBvh,
-                     const eavlConstTexArray<float> *_bvh_lf, primitive_t _type)
-        :verts(_verts),
-         bvh(theBvh),
-         bvh_lf(_bvh_lf),
-         light(theLight),
-         type(_type)
+    ShadowRayFunctor(eavlVector3 theLight, const SceneBVH &_scene)
+        :scene(_scene),
+         light(theLight)
     {}
 
-    EAVL_FUNCTOR tuple<int> operator()(tuple<float,float,float,int,int> input)
+    EAVL_FUNCTOR tuple<int> operator()(tuple<float,float,float,int> input)
     {
         int hitIdx           = get<3>(input);
-        bool alreadyOccluded = get<4>(input) == 0 ? false : true;
-        if( hitIdx == -1 || alreadyOccluded ) return tuple<int>(1);// primary ray never hit anything.
+        if( hitIdx == -1 ) return tuple<int>(1);// primary ray never hit anything.
 
         //float alpha,beta,gamma,d,tempDistance;
         eavlVector3 rayOrigin(get<0>(input),get<1>(input),get<2>(input));
@@ -1396,20 +1548,9 @@ struct ShadowRayFunctor
         eavlVector3 shadowRay=light-rayOrigin;
         float lightDistance=sqrt(shadowRay.x*shadowRay.x+shadowRay.y*shadowRay.y+shadowRay.z*shadowRay.z);
         shadowRay.normalize();
-        int minHit;
         float distance;
-        if(type ==  TRIANGLE )
-        {
-            minHit= getIntersectionTri(shadowRay, rayOrigin, true,bvh, bvh_lf, verts,lightDistance, distance);
-        }
-        else if(type == SPHERE)
-        {
-            minHit= getIntersectionSphere(shadowRay, rayOrigin, true,bvh, bvh_lf, verts,lightDistance, distance);
-        }
-        else if(type == CYLINDER)
-        {
-            minHit= getIntersectionCyl(shadowRay, rayOrigin, true,bvh, bvh_lf, verts,lightDistance, distance);
-        }
+        int type;
+        int minHit = getSceneIntersection(shadowRay, rayOrigin, true, scene, lightDistance, distance, type);
         if(minHit!=-1) return tuple<int>(1);//in shadow
         else return tuple<int>(0);//clear view of the light
 
@@ -1607,6 +1748,11 @@ void eavlRayTracerMutator::allocateArrays()
 
     deleteClassPtr(compactTempInt);
     deleteClassPtr(compactTempFloat);
+
+    deleteClassPtr(accR);
+    deleteClassPtr(accG);
+    deleteClassPtr(accB);
+    deleteClassPtr(batchFrame);
         //what happens when someone turns these on and off??? 
         //1. we could just always do it and waste memory
         //2 call allocation if we detect dirty settings/dirtySize <-this is what is being done;
@@ -1637,7 +1783,7 @@ void eavlRayTracerMutator::allocateArrays()
     /*Temp arrays for compact*/
     compactTempInt   = new eavlIntArray("temp",1,size);
     compactTempFloat = new eavlFloatArray("temp",1,size);
-    mortonIndexes    = new eavlIntArray("mortonIdxs",1,size);
+    mortonIndexes    = new eavlIntArray("mortonIdxs",1,width*height);
 
     rayDirX          = new eavlFloatArray("x",1,size);
     rayDirY          = new eavlFloatArray("y",1,size);
@@ -1671,7 +1817,7 @@ void eavlRayTracerMutator::allocateArrays()
     indexes          = new eavlIntArray("indexes",1,size);
     shadowHits       = new eavlFloatArray("",1,size);
     ambPct           = new eavlFloatArray("",1, size);
-    zBuffer          = new eavlFloatArray("",1, size);
+    zBuffer          = new eavlFloatArray("",1, width*height);
     frameBuffer      = new eavlByteArray("",1, width*height*4);
     scalars          = new eavlFloatArray("",1,size);
     primitiveTypeHit = new eavlIntArray("primitiveType",1,size);
@@ -1710,6 +1856,30 @@ void eavlRayTracerMutator::allocateArrays()
        eavlExecutor::Go();
     }
 
+    /* progressive frames accumulate into per pixel colors */
+    if(progressive)
+    {
+        accR       = new eavlFloatArray("",1, width*height);
+        accG       = new eavlFloatArray("",1, width*height);
+        accB       = new eavlFloatArray("",1, width*height);
+        batchFrame = new eavlByteArray("",1, size*4);
+
+        /* the pixels not traced yet are black */
+        clearFrameBuffer(accR,accG,accB);
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(accR, accG, accB, accB/*dummy*/),
+                                                 eavlOpArgs(eavlIndexable<eavlByteArray>(frameBuffer,*redIndexer),
+                                                            eavlIndexable<eavlByteArray>(frameBuffer,*greenIndexer),
+                                                            eavlIndexable<eavlByteArray>(frameBuffer,*blueIndexer),
+                                                            eavlIndexable<eavlByteArray>(frameBuffer,*alphaIndexer)),
+                                                 CopyFrameBuffer()),
+                                                 "clear");
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(zBuffer),
+                                                 eavlOpArgs(zBuffer),
+                                                 FloatMemsetFunctor(INFINITE)),
+                                                 "clear");
+        eavlExecutor::Go();
+    }
+
     sizeDirty=false;
 
 }
@@ -1720,6 +1890,7 @@ void eavlRayTracerMutator::Init()
 #if 0    
     if(antiAlias) size=(width+1)*(height+1);
 #endif
+    if(progressive) size = min(size, batchRays);
     currentSize=size; //for compact
     if(sizeDirty) 
     {
@@ -1728,6 +1899,13 @@ void eavlRayTracerMutator::Init()
         cameraDirty=true; //in this case the camera isn't really dirty, but for accumulating occ samples we need this. maybe rename it
     }
 
+    /* anything that changes the image starts the progressive frame over */
+    if(cameraDirty || geomDirty || defaultMatDirty)
+    {
+        nextRay=0;
+        progressivePass=0;
+    }
+
     if(cameraDirty)
     {
         //cout<<"Camera Dirty."<<endl;
@@ -1736,6 +1914,27 @@ void eavlRayTracerMutator::Init()
     }
     //fill the const arrays with vertex and normal data
     
+    initRays(progressive ? nextRay : 0);
+
+    if(geomDirty) extractGeometry();
+    /*Need to start seperating functions that are not geometry. This allows the materials to be updated */
+    if(defaultMatDirty)
+    {
+        numMats         = scene->getNumMaterials();
+        mats_raw        = scene->getMatsPtr();
+        if(mats!=NULL)
+        {
+            delete mats;
+        }
+        INIT(eavlConstArray<float>, mats,numMats*12);
+        defaultMatDirty=false;
+    }
+}
+
+/* Readies the ray arrays for the primary rays of the pixels from first on in
+   the ray order */
+void eavlRayTracerMutator::initRays(int first)
+{
     /* Set ray origins to the eye */
     eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(indexes), //dummy arg
                                              eavlOpArgs(rayOriginX,rayOriginY,rayOriginZ),
@@ -1744,9 +1943,10 @@ void eavlRayTracerMutator::Init()
     eavlExecutor::Go();
 
     /* Copy morton indexes into idxs*/ 
-    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(mortonIndexes),
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlIntArray>(mortonIndexes, eavlArrayIndexer(1, first))),
                                              eavlOpArgs(indexes),
-                                             FloatMemcpyFunctor1to1()),
+                                             IntMemcpyFunctor1to1(),
+                                             min(size, width*height - first)),
                                              "cpy");
     eavlExecutor::Go();
 
@@ -1764,20 +1964,6 @@ void eavlRayTracerMutator::Init()
                                              "init");
         eavlExecutor::Go();
     }
-
-    if(geomDirty) extractGeometry();
-    /*Need to start seperating functions that are not geometry. This allows the materials to be updated */
-    if(defaultMatDirty)
-    {
-        numMats         = scene->getNumMaterials();
-        mats_raw        = scene->getMatsPtr();
-        if(mats!=NULL)
-        {
-            delete mats;
-        }
-        INIT(eavlConstArray<float>, mats,numMats*12);
-        defaultMatDirty=false;
-    }
 }
 
 void eavlRayTracerMutator::extractGeometry()
@@ -1814,45 +2000,14 @@ void eavlRayTracerMutator::extractGeometry()
     int cyl_bvh_lf_size   = 0;
 
 
-    bool cacheExists  =false;
-    bool writeCache   =true;
-     
-
-    if(useBVHCache)
-    {
-        cacheExists=readBVHCache(tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size, bvhCacheName.c_str());
-    }
-    else 
-    {
-        writeCache=false;
-    }
-
     if(numTriangles > 0)
     {
-
-        if(!cacheExists)
-        {  
-            cout<<"Building BVH....Triangles"<<endl;
-            if(fastBVHBuild)
-            {
-                MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(tri_verts_raw, numTriangles, TRIANGLE);
-                mortonBVH->build();
-                tri_bvh_in_raw  = mortonBVH->getInnerNodes(tri_bvh_in_size);
-                tri_bvh_lf_raw  = mortonBVH->getLeafNodes(tri_bvh_lf_size);
-                delete mortonBVH;
-            }
-            else
-            {
-                SplitBVH *sbvh= new SplitBVH(tri_verts_raw, numTriangles, TRIANGLE); // 0=triangle
-                sbvh->getFlatArray(tri_bvh_in_size, tri_bvh_lf_size, tri_bvh_in_raw, tri_bvh_lf_raw);  
-                delete sbvh;
-            }
-            
-            
-            if( writeCache) writeBVHCache(tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size, bvhCacheName.c_str());
-        }
+        buildBVH(tri_verts_raw, numTriangles, 12, TRIANGLE, bvhCacheName+".bvh",
+                 tri_bvh_in_raw, tri_bvh_in_size, tri_bvh_lf_raw, tri_bvh_lf_size);
 
         tri_bvh_in_array   = new eavlConstTexArray<float4>( (float4*)tri_bvh_in_raw, tri_bvh_in_size/4, tri_bvh_in_tref, cpu);
+        if(useWideBVH && eavlExecutor::ForcingCPU())
+            tri_wide_bvh = new eavlWideBVH(tri_bvh_in_raw, tri_bvh_in_size);
         tri_bvh_lf_array   = new eavlConstTexArray<float>( tri_bvh_lf_raw, tri_bvh_lf_size, tri_bvh_lf_tref, cpu);
         tri_verts_array    = new eavlConstTexArray<float4>( (float4*)tri_verts_raw,numTriangles*3, tri_verts_tref, cpu);
         tri_matIdx_array   = new eavlConstTexArray<int>( tri_matIdx_raw, numTriangles, tri_matIdx_tref, cpu );       
@@ -1863,23 +2018,12 @@ void eavlRayTracerMutator::extractGeometry()
     if(numSpheres > 0)
     {
 
-        //TODO: caching
-        if(fastBVHBuild)
-        {
-            MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(sphr_verts_raw, numSpheres, SPHERE);
-            mortonBVH->build();
-            sphr_bvh_in_raw  = mortonBVH->getInnerNodes(sphr_bvh_in_size);
-            sphr_bvh_lf_raw  = mortonBVH->getLeafNodes(sphr_bvh_lf_size);
-            delete mortonBVH;
-        }
-        else
-        {
-            SplitBVH *sbvh= new SplitBVH(sphr_verts_raw, numSpheres, SPHERE); 
-            sbvh->getFlatArray(sphr_bvh_in_size, sphr_bvh_lf_size, sphr_bvh_in_raw, sphr_bvh_lf_raw);
-            delete sbvh;
-        }
+        buildBVH(sphr_verts_raw, numSpheres, 4, SPHERE, bvhCacheName+"_spheres.bvh",
+                 sphr_bvh_in_raw, sphr_bvh_in_size, sphr_bvh_lf_raw, sphr_bvh_lf_size);
 
         sphr_bvh_in_array   = new eavlConstTexArray<float4>( (float4*)sphr_bvh_in_raw, sphr_bvh_in_size/4, sphr_bvh_in_tref, cpu);
+        if(useWideBVH && eavlExecutor::ForcingCPU())
+            sphr_wide_bvh = new eavlWideBVH(sphr_bvh_in_raw, sphr_bvh_in_size);
         sphr_bvh_lf_array   = new eavlConstTexArray<float>( sphr_bvh_lf_raw, sphr_bvh_lf_size, sphr_bvh_lf_tref, cpu);
         sphr_verts_array    = new eavlConstTexArray<float4>( (float4*)sphr_verts_raw,numSpheres, sphr_verts_tref, cpu);
         sphr_matIdx_array   = new eavlConstTexArray<int>( sphr_matIdx_raw, numSpheres,  sphr_matIdx_tref, cpu );
@@ -1889,23 +2033,12 @@ void eavlRayTracerMutator::extractGeometry()
     if(verbose) cout<<"Num lines "<<numCyls<<endl;
     if(numCyls > 0)
     {
-        //TODO: cache
-        if(fastBVHBuild)
-        {
-            MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(cyl_verts_raw, numCyls, CYLINDER);
-            mortonBVH->build();
-            cyl_bvh_in_raw  = mortonBVH->getInnerNodes(cyl_bvh_in_size);
-            cyl_bvh_lf_raw  = mortonBVH->getLeafNodes(cyl_bvh_lf_size);
-            delete mortonBVH;
-        }
-        else
-        {
-            SplitBVH *sbvh= new SplitBVH(cyl_verts_raw, numCyls, CYLINDER); 
-            sbvh->getFlatArray(cyl_bvh_in_size, cyl_bvh_lf_size, cyl_bvh_in_raw, cyl_bvh_lf_raw);
-            delete sbvh;
-        }
+        buildBVH(cyl_verts_raw, numCyls, 8, CYLINDER, bvhCacheName+"_cyls.bvh",
+                 cyl_bvh_in_raw, cyl_bvh_in_size, cyl_bvh_lf_raw, cyl_bvh_lf_size);
 
         cyl_bvh_in_array   = new eavlConstTexArray<float4>( (float4*)cyl_bvh_in_raw, cyl_bvh_in_size/4, cyl_bvh_in_tref, cpu);
+        if(useWideBVH && eavlExecutor::ForcingCPU())
+            cyl_wide_bvh = new eavlWideBVH(cyl_bvh_in_raw, cyl_bvh_in_size);
         cyl_bvh_lf_array   = new eavlConstTexArray<float>( cyl_bvh_lf_raw, cyl_bvh_lf_size, cyl_bvh_lf_tref, cpu);
         cyl_verts_array    = new eavlConstTexArray<float4>( (float4*)cyl_verts_raw,numCyls*2, cyl_verts_tref, cpu);
         cyl_matIdx_array   = new eavlConstTexArray<int>( cyl_matIdx_raw, numCyls,  cyl_matIdx_tref, cpu );
@@ -1921,6 +2054,89 @@ void eavlRayTracerMutator::extractGeometry()
     
 }
 
+// Builds the BVH over the primitives with the chosen builder, or reads it
+// from the cache if caching is on and the cache was written for the same
+// primitives and builder.
+void eavlRayTracerMutator::buildBVH(float *verts, int nprims, int floatsPerPrim, primitive_t primType,
+                                    const string &cacheName, float *&innerNodes, int &innerSize,
+                                    float *&leafNodes, int &leafSize)
+{
+    unsigned long long key = 0;
+    if(useBVHCache)
+    {
+        key = eavlBVHCache::ComputeKey(verts, (long long)nprims * floatsPerPrim,
+                                       primType, nprims, bvhBuilder);
+        if(eavlBVHCache::Read(cacheName, key, innerNodes, innerSize, leafNodes, leafSize))
+            return;
+    }
+
+    if(primType == TRIANGLE) cout<<"Building BVH....Triangles"<<endl;
+    if(bvhBuilder == MortonBuilder)
+    {
+        MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(verts, nprims, primType);
+        mortonBVH->build();
+        innerNodes  = mortonBVH->getInnerNodes(innerSize);
+        leafNodes   = mortonBVH->getLeafNodes(leafSize);
+        delete mortonBVH;
+    }
+    else if(bvhBuilder == BinnedBuilder)
+    {
+        eavlBinnedBVHBuilder binnedBVH(verts, nprims, primType);
+        binnedBVH.build();
+        innerNodes  = binnedBVH.getInnerNodes(innerSize);
+        leafNodes   = binnedBVH.getLeafNodes(leafSize);
+    }
+    else
+    {
+        SplitBVH *sbvh= new SplitBVH(verts, nprims, primType);
+        sbvh->getFlatArray(innerSize, leafSize, innerNodes, leafNodes);
+        delete sbvh;
+    }
+
+    if(useBVHCache)
+        eavlBVHCache::Write(cacheName, key, innerNodes, innerSize, leafNodes, leafSize);
+}
+
+// The wide BVH to trace with, or NULL to use the binary one: wide BVHs
+// are only used when running on the CPU.
+const eavlWideBVH *eavlRayTracerMutator::cpuWideBVH(const eavlWideBVH *bvh) const
+{
+    return (useWideBVH && eavlExecutor::ForcingCPU()) ? bvh : NULL;
+}
+
+// The top level over the BVHs of the primitive types in the scene. Each
+// type's bounds are those of its BVH's root, and the wide BVHs are used
+// if wide is set and they are in use.
+SceneBVH eavlRayTracerMutator::sceneBVH(bool wide) const
+{
+    SceneBVH top;
+    top.numTypes = 0;
+    primitive_t                types[3]  = {TRIANGLE, SPHERE, CYLINDER};
+    int                        counts[3] = {numTriangles, numSpheres, numCyls};
+    eavlConstTexArray<float4> *verts[3]  = {tri_verts_array, sphr_verts_array, cyl_verts_array};
+    eavlConstTexArray<float4> *bvhs[3]   = {tri_bvh_in_array, sphr_bvh_in_array, cyl_bvh_in_array};
+    eavlConstTexArray<float>  *leafs[3]  = {tri_bvh_lf_array, sphr_bvh_lf_array, cyl_bvh_lf_array};
+    const eavlWideBVH         *wides[3]  = {tri_wide_bvh, sphr_wide_bvh, cyl_wide_bvh};
+    const float               *roots[3]  = {tri_bvh_in_raw, sphr_bvh_in_raw, cyl_bvh_in_raw};
+    for(int t = 0; t < 3; t++)
+    {
+        if(counts[t] <= 0) continue;
+        PrimitiveBVH &p = top.types[top.numTypes++];
+        p.type    = types[t];
+        p.verts   = verts[t];
+        p.bvh     = bvhs[t];
+        p.bvh_lf  = leafs[t];
+        p.wideBvh = wide ? cpuWideBVH(wides[t]) : NULL;
+        /* the root holds the bounds of its two children */
+        for(int d = 0; d < 3; d++)
+        {
+            p.bounds[d]   = min(roots[t][d],   roots[t][6+d]);
+            p.bounds[d+3] = max(roots[t][3+d], roots[t][9+d]);
+        }
+    }
+    return top;
+}
+
 void eavlRayTracerMutator::intersect()
 {
     /* Ideas : 
@@ -1937,32 +2153,11 @@ void eavlRayTracerMutator::intersect()
                                              "init");
     eavlExecutor::Go();
 
-    if(numTriangles>0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
-                                                 eavlOpArgs(hitIdx, minDistances, primitiveTypeHit),
-                                                 RayIntersectFunctor(tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array,TRIANGLE)),
-                                                                                                        "intersect");
-        eavlExecutor::Go();
-    }
-    if(numSpheres>0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
-                                                 eavlOpArgs(hitIdx, minDistances, primitiveTypeHit),
-                                                 RayIntersectFunctor(sphr_verts_array,sphr_bvh_in_array,sphr_bvh_lf_array,SPHERE)),
-                                                                                                        "intersect");
-        eavlExecutor::Go();
-
-    }
-    if(numCyls>0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
-                                                 eavlOpArgs(hitIdx, minDistances, primitiveTypeHit),
-                                                 RayIntersectFunctor(cyl_verts_array,cyl_bvh_in_array,cyl_bvh_lf_array,CYLINDER)),
-                                                                                                        "intersect");
-        eavlExecutor::Go();
-
-    }
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
+                                             eavlOpArgs(hitIdx, minDistances, primitiveTypeHit),
+                                             RayIntersectFunctor(sceneBVH(true))),
+                                             "intersect");
+    eavlExecutor::Go();
     //for (int i=0 ; i<size; i++) cout<< hitIdx->GetValue(i)<<" "<<minDistances->GetValue(i)<<" | ";
 
     eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(hitIdx),                /*On primary ray: hits some in as -2, and leave as -1 if it misses everything*/
@@ -1974,59 +2169,17 @@ void eavlRayTracerMutator::intersect()
 
 void eavlRayTracerMutator::occlusionIntersect()
 {
-    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(localHits), //dummy arg
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(occX),
+                                                        eavlIndexable<eavlFloatArray>(occY),
+                                                        eavlIndexable<eavlFloatArray>(occZ),
+                                                        eavlIndexable<eavlFloatArray>(interX, *occIndexer),
+                                                        eavlIndexable<eavlFloatArray>(interY, *occIndexer),
+                                                        eavlIndexable<eavlFloatArray>(interZ, *occIndexer),
+                                                        eavlIndexable<eavlIntArray>  (hitIdx, *occIndexer)),
                                              eavlOpArgs(localHits),
-                                             FloatMemsetFunctor(0.f)),
-                                             "memset");
+                                             occIntersectFunctor(sceneBVH(true), aoMax)),
+                                             "occIntercept");
     eavlExecutor::Go();
-    if(numTriangles > 0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(occX),
-                                                            eavlIndexable<eavlFloatArray>(occY),
-                                                            eavlIndexable<eavlFloatArray>(occZ),
-                                                            eavlIndexable<eavlFloatArray>(interX, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interY, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interZ, *occIndexer),
-                                                            eavlIndexable<eavlIntArray>  (hitIdx, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(localHits)),
-                                                 eavlOpArgs(localHits),
-                                                 occIntersectFunctor(tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array,aoMax, TRIANGLE)),
-                                                 "occIntercept");
-                
-        eavlExecutor::Go();
-    }
-    if(numSpheres > 0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(occX),
-                                                            eavlIndexable<eavlFloatArray>(occY),
-                                                            eavlIndexable<eavlFloatArray>(occZ),
-                                                            eavlIndexable<eavlFloatArray>(interX, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interY, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interZ, *occIndexer),
-                                                            eavlIndexable<eavlIntArray>  (hitIdx, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(localHits)),
-                                                 eavlOpArgs(localHits),
-                                                 occIntersectFunctor(sphr_verts_array,sphr_bvh_in_array,sphr_bvh_lf_array,aoMax, SPHERE)),
-                                                 "occIntercept");
-                
-        eavlExecutor::Go();
-    }
-    if(numCyls > 0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(occX),
-                                                            eavlIndexable<eavlFloatArray>(occY),
-                                                            eavlIndexable<eavlFloatArray>(occZ),
-                                                            eavlIndexable<eavlFloatArray>(interX, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interY, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(interZ, *occIndexer),
-                                                            eavlIndexable<eavlIntArray>  (hitIdx, *occIndexer),
-                                                            eavlIndexable<eavlFloatArray>(localHits)),
-                                                 eavlOpArgs(localHits),
-                                                 occIntersectFunctor(cyl_verts_array,cyl_bvh_in_array,cyl_bvh_lf_array,aoMax, CYLINDER)),
-                                                 "occIntercept");
-                
-        eavlExecutor::Go();
-    }
 }
 
 void eavlRayTracerMutator::reflect()
@@ -2061,59 +2214,19 @@ void eavlRayTracerMutator::reflect()
 
 void eavlRayTracerMutator::shadowIntersect()
 {
-    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(shadowHits), //dummy arg
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(interX,interY,interZ,hitIdx),
                                              eavlOpArgs(shadowHits),
-                                             FloatMemsetFunctor(0.f)),
-                                             "memset");
+                                             ShadowRayFunctor(light, sceneBVH(true))),
+                                             "shadowRays");
     eavlExecutor::Go();
-    
-    
-
-    
-
-    if(numTriangles > 0)
-    {
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(interX,interY,interZ,hitIdx, shadowHits),
-                                                 eavlOpArgs(shadowHits),
-                                                 ShadowRayFunctor(light,tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array, TRIANGLE)),
-                                                 "shadowRays");
-        eavlExecutor::Go();
-    }
-    if(numSpheres > 0)
-    {   
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(interX,interY,interZ,hitIdx, shadowHits),
-                                                 eavlOpArgs(shadowHits),
-                                                 ShadowRayFunctor(light,sphr_verts_array,sphr_bvh_in_array,sphr_bvh_lf_array, SPHERE)),
-                                                 "shadowRays");
-        eavlExecutor::Go(); 
-    }  
-    if(numCyls > 0)
-    {   
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(interX,interY,interZ,hitIdx, shadowHits),
-                                                 eavlOpArgs(shadowHits),
-                                                 ShadowRayFunctor(light, cyl_verts_array, cyl_bvh_in_array, cyl_bvh_lf_array, CYLINDER)),
-                                                 "shadowRays");
-        eavlExecutor::Go(); 
-    }       
 }
 
-void eavlRayTracerMutator::Execute()
+/* Traces the camera rays in the ray arrays through all the bounces, leaving
+   their colors in r, g and b */
+void eavlRayTracerMutator::renderRays()
 {
-    //cudaSetDevice(0);
-    int th ;
-    int tinit;
-    if(verbose) tinit = eavlTimer::Start();
-    if(verbose) th = eavlTimer::Start();
-
-    Init();
-    /*if there are no primitives, just return black*/
-    if(scene->getTotalPrimitives()==0) return;
-    //if(verbose) cerr<<"Executing After Init"<<endl;
-   
-    if(verbose) cerr<<"Number of triangles: "<<numTriangles<<endl;
-    if(verbose) cerr<<"Number of Spheres: "<<numSpheres<<endl;
-    if(verbose) cerr<<"Number of Cylinders: "<<numCyls<<endl;
-    
+    /* rays can't be compacted out of a progressive batch */
+    bool compacting = compactOp && !progressive;
 
     clearFrameBuffer(r,g,b);
 
@@ -2129,7 +2242,6 @@ void eavlRayTracerMutator::Execute()
                                              "ray gen");
     eavlExecutor::Go();
 
-    if(verbose) cout<<"init       RUNTIME: "<<eavlTimer::Stop(tinit,"intersect")<<endl;
     for(int i=0; i<depth;i++) 
     {
         int tintersect;
@@ -2140,7 +2252,7 @@ void eavlRayTracerMutator::Execute()
         if(i==0)
         {
             eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(minDistances),
-                                             eavlOpArgs(zBuffer),
+                                             eavlOpArgs(progressive ? compactTempFloat : zBuffer),
                                              FloatMemcpyFunctor1to1()),
                                              "cpy");
             eavlExecutor::Go();
@@ -2149,7 +2261,7 @@ void eavlRayTracerMutator::Execute()
         if(verbose) cout<<"intersect   RUNTIME: "<<eavlTimer::Stop(tintersect,"intersect")<<endl;
         
 
-        if(compactOp) 
+        if(compacting) 
         {
             int tcompact = eavlTimer::Start();
             currentSize=compact();
@@ -2179,7 +2291,7 @@ void eavlRayTracerMutator::Execute()
                                                                         eavlIndexable<eavlFloatArray>(interY),
                                                                         eavlIndexable<eavlFloatArray>(interZ),
                                                                         eavlIndexable<eavlIntArray>  (hitIdx)),
-                                                            eavlOpArgs(occX,occY,occZ),OccRayGenFunctor2(),
+                                                            eavlOpArgs(occX,occY,occZ),OccRayGenFunctor2(progressive ? progressivePass*occSamples : 0),
                                                             occSamples),
                                                             "occ scatter");
             eavlExecutor::Go();
@@ -2197,7 +2309,16 @@ void eavlRayTracerMutator::Execute()
             eavlExecutor::Go();
 
             /*Only do this when depth is set to zero reflections*/
-            if(!cameraDirty&& depth==1)
+            if(progressive)
+            {
+                /* the samples of earlier passes are in the accumulated colors */
+                eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(tempAmbPct),
+                                                         eavlOpArgs(ambPct),
+                                                         FloatMemcpyFunctor1to1()),
+                                                         "cpy");
+                eavlExecutor::Go();
+            }
+            else if(!cameraDirty&& depth==1)
             {
                 eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(ambPct,tempAmbPct),
                                                          eavlOpArgs(ambPct),
@@ -2237,7 +2358,7 @@ void eavlRayTracerMutator::Execute()
         if(verbose) cout<<  "Shading     RUNTIME: "<<eavlTimer::Stop(shade,"")<<endl;
 
 
-        if(!compactOp)
+        if(!compacting)
         {
 
             //these RGB values are in morton order and must be scattered 
@@ -2310,6 +2431,37 @@ void eavlRayTracerMutator::Execute()
         }
 
     }
+}
+
+void eavlRayTracerMutator::Execute()
+{
+    //cudaSetDevice(0);
+    int th ;
+    int tinit;
+    if(verbose) tinit = eavlTimer::Start();
+    if(verbose) th = eavlTimer::Start();
+
+    Init();
+    /*if there are no primitives, just return black*/
+    if(scene->getTotalPrimitives()==0) return;
+    //if(verbose) cerr<<"Executing After Init"<<endl;
+   
+    if(verbose) cerr<<"Number of triangles: "<<numTriangles<<endl;
+    if(verbose) cerr<<"Number of Spheres: "<<numSpheres<<endl;
+    if(verbose) cerr<<"Number of Cylinders: "<<numCyls<<endl;
+    
+
+    if(verbose) cout<<"init       RUNTIME: "<<eavlTimer::Stop(tinit,"intersect")<<endl;
+
+    if(progressive)
+    {
+        executeProgressive();
+        if(verbose) cout<<"TOTAL       RUNTIME: "<<eavlTimer::Stop(th,"raytrace")<<endl;
+        return;
+    }
+
+    renderRays();
+
     //todo fix this
     int ttest;
     if(verbose) ttest = eavlTimer::Start();
@@ -2410,6 +2562,123 @@ void eavlRayTracerMutator::Execute()
     
     //writeBMP(height,width,r,g,b,(char*)scounter.c_str()); 
 }
+static double wallTime()
+{
+    struct timeval t;
+    gettimeofday(&t, NULL);
+    return t.tv_sec + t.tv_usec * 1e-6;
+}
+
+/* Without ambient occlusion every pass traces the same rays, so one is enough */
+int eavlRayTracerMutator::progressivePasses() const
+{
+    return isOccusionOn ? maxPasses : 1;
+}
+
+/* Traces batches of rays in ray order until the passes over the frame are done
+   or the time budget is spent, and picks up at the next batch on the next call.
+   Each batch is blended into the colors its pixels got in earlier passes, and
+   the blended colors go to the frame buffer, so it always holds the latest
+   colors of every pixel traced. */
+void eavlRayTracerMutator::executeProgressive()
+{
+    double start = wallTime();
+    int numPixels = width*height;
+    bool firstBatch = true;
+    while(progressivePass < progressivePasses())
+    {
+        int first = nextRay;
+        int count = min(size, numPixels - first);
+        if(!firstBatch) initRays(first);   //Init readied the first batch
+        firstBatch = false;
+
+        renderRays();
+
+        /* weighted average with the earlier passes */
+        eavlExecutor::AddOperation(new_eavlGatherOp(eavlOpArgs(accR),
+                                                    eavlOpArgs(r2),
+                                                    eavlOpArgs(indexes),
+                                                    count),
+                                                    "gather");
+        eavlExecutor::AddOperation(new_eavlGatherOp(eavlOpArgs(accG),
+                                                    eavlOpArgs(g2),
+                                                    eavlOpArgs(indexes),
+                                                    count),
+                                                    "gather");
+        eavlExecutor::AddOperation(new_eavlGatherOp(eavlOpArgs(accB),
+                                                    eavlOpArgs(b2),
+                                                    eavlOpArgs(indexes),
+                                                    count),
+                                                    "gather");
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(r2, r),
+                                                 eavlOpArgs(r2),
+                                                 WeightedAccFunctor1to1(progressivePass, 1),
+                                                 count),
+                                                 "weighted average");
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(g2, g),
+                                                 eavlOpArgs(g2),
+                                                 WeightedAccFunctor1to1(progressivePass, 1),
+                                                 count),
+                                                 "weighted average");
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(b2, b),
+                                                 eavlOpArgs(b2),
+                                                 WeightedAccFunctor1to1(progressivePass, 1),
+                                                 count),
+                                                 "weighted average");
+        eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(r2),
+                                                     eavlOpArgs(accR),
+                                                     eavlOpArgs(indexes),
+                                                     count),
+                                                     "scatter");
+        eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(g2),
+                                                     eavlOpArgs(accG),
+                                                     eavlOpArgs(indexes),
+                                                     count),
+                                                     "scatter");
+        eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(b2),
+                                                     eavlOpArgs(accB),
+                                                     eavlOpArgs(indexes),
+                                                     count),
+                                                     "scatter");
+        eavlExecutor::Go();
+
+        /* to the frame buffer */
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(r2, g2, b2, b2/*dummy*/),
+                                                 eavlOpArgs(eavlIndexable<eavlByteArray>(batchFrame,*redIndexer),
+                                                            eavlIndexable<eavlByteArray>(batchFrame,*greenIndexer),
+                                                            eavlIndexable<eavlByteArray>(batchFrame,*blueIndexer),
+                                                            eavlIndexable<eavlByteArray>(batchFrame,*alphaIndexer)),
+                                                 CopyFrameBuffer(),
+                                                 count),
+                                                 "memcopy");
+        eavlArrayIndexer *channels[4] = {redIndexer, greenIndexer, blueIndexer, alphaIndexer};
+        for(int c = 0; c < 4; c++)
+        {
+            eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(eavlIndexable<eavlByteArray>(batchFrame,*channels[c])),
+                                                         eavlOpArgs(eavlIndexable<eavlByteArray>(frameBuffer,*channels[c])),
+                                                         eavlOpArgs(indexes),
+                                                         count),
+                                                         "scatter");
+        }
+        /* the depths of the first bounce */
+        eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(compactTempFloat),
+                                                     eavlOpArgs(zBuffer),
+                                                     eavlOpArgs(indexes),
+                                                     count),
+                                                     "scatter");
+        eavlExecutor::Go();
+
+        nextRay += count;
+        if(nextRay == numPixels)
+        {
+            nextRay = 0;
+            progressivePass++;
+        }
+        if(timeBudget > 0 && wallTime() - start >= timeBudget) break;
+    }
+    if(verbose) cout<<"Progressive pass "<<progressivePass<<" at ray "<<nextRay<<" of "<<numPixels<<endl;
+}
+
 /*
 void eavlRayTracerMutator::printMemUsage()
 {
@@ -2533,34 +2802,101 @@ void eavlRayTracerMutator::clearFrameBuffer(eavlFloatArray *r,eavlFloatArray *g,
     eavlExecutor::Go();
 }
 
-//creates the morton indexes that is used to create the ray directions per frame.
-//only needs to be done once everytime a resolution is specified. Every other frame
-//the morton indexes can just be recopied to the indexes array. Two seperate arrays
-//are needed to support compaction. One day this will be done in parallel when a 
-//sort is created. 
+/* Z-order code of a pixel, from its x and y interleaved bit by bit */
+struct PixelMortonFunctor
+{
+    int width;
+    PixelMortonFunctor(int w)
+        : width(w)
+    {}
+
+    EAVL_FUNCTOR static unsigned int spreadBits(unsigned int v)
+    {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    EAVL_FUNCTOR tuple<int> operator()(tuple<int> input)
+    {
+        int id = get<0>(input);
+        unsigned int code = (spreadBits(id % width) << 1) | spreadBits(id / width);
+        return tuple<int>((int)code);
+    }
+};
+
+/* The pixel of the i-th ray when the image is traced tile by tile: the
+   tiles row by row, and the pixels of each tile row by row. Tiles on the
+   right and bottom edges are narrower. */
+struct TileOrderFunctor
+{
+    int width;
+    int height;
+    int tileSize;
+    TileOrderFunctor(int w, int h, int t)
+        : width(w), height(h), tileSize(t)
+    {}
+
+    EAVL_FUNCTOR tuple<int> operator()(tuple<int> input)
+    {
+        int i = get<0>(input);
+        int tileRow = i / (tileSize * width);
+        int local = i - tileRow * tileSize * width;
+        int rows = min(tileSize, height - tileRow * tileSize);
+        int tileCol = local / (tileSize * rows);
+        local -= tileCol * tileSize * rows;
+        int cols = min(tileSize, width - tileCol * tileSize);
+        int x = tileCol * tileSize + local % cols;
+        int y = tileRow * tileSize + local / cols;
+        return tuple<int>(y * width + x);
+    }
+};
+
+//creates the indexes of the pixels in the order the primary rays are traced.
+//only needs to be done once everytime a resolution or ray order is specified.
+//Every other frame the indexes can just be recopied to the indexes array. Two
+//seperate arrays are needed to support compaction. The tile order is closed
+//form; the morton order sorts the z-order codes of the pixels, which are kept
+//in the temp array allocated with the ray arrays when it holds the whole image.
 void eavlRayTracerMutator::createRays()
 {
-    float fwidth=(float)width;
-    float fheight=(float)height;
-    float w,h;
+    /* progressive batches have a smaller temp array than the image */
+    eavlIntArray *keys = compactTempInt;
+    if(size < width*height) keys = new eavlIntArray("keys",1,width*height);
+
+    /* 0, 1, 2 ... from an exclusive scan of ones */
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(keys),
+                                             eavlOpArgs(keys),
+                                             IntMemsetFunctor(1)),
+                                             "ones");
+    eavlExecutor::AddOperation(new eavlPrefixSumOp_1(keys,mortonIndexes,false),
+                                             "ray ids");
+    eavlExecutor::Go();
 
-    raySort *rayArray= new raySort[size]; // since this is happening every frame it should not be allocated and deleted constantly.
-                                          
-    for(int i=0; i<size;i++)
+    if(rayOrder == TileOrder)
     {
-        rayArray[i].id=i;
-        w = (float)(i%width)/fwidth;
-        h = (float) (i/width)/fheight;
-        rayArray[i].mortonCode=morton2D(w,h);
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(mortonIndexes),
+                                                 eavlOpArgs(mortonIndexes),
+                                                 TileOrderFunctor(width, height, tileSize)),
+                                                 "tile order");
+        eavlExecutor::Go();
     }
-    std::sort(rayArray,rayArray+size,spacialCompare);
-    cout<<endl;
-    for(int i=0; i<size;i++)
+    else
     {
-        mortonIndexes->SetValue(i, rayArray[i].id);
+        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(mortonIndexes),
+                                                 eavlOpArgs(keys),
+                                                 PixelMortonFunctor(width)),
+                                                 "morton codes");
+        eavlExecutor::AddOperation(new_eavlRadixSortOp(eavlOpArgs(keys),
+                                                       eavlOpArgs(mortonIndexes), true),
+                                                       "morton order");
+        eavlExecutor::Go();
     }
-    delete[] rayArray; 
-}  
+    if(keys != compactTempInt) delete keys;
+}
 
 void eavlRayTracerMutator::traversalTest(int warmupRounds, int testRounds)
 {
@@ -2587,7 +2923,7 @@ void eavlRayTracerMutator::traversalTest(int warmupRounds, int testRounds)
     {
         eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
                                                  eavlOpArgs(dummy, dummyFloat, primitiveTypeHit),
-                                                 RayIntersectFunctor(tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array, TRIANGLE )),
+                                                 RayIntersectFunctor(sceneBVH(false))),
                                                                                                     "intersect");
         eavlExecutor::Go();
     }
@@ -2600,17 +2936,56 @@ void eavlRayTracerMutator::traversalTest(int warmupRounds, int testRounds)
     {
         eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
                                                  eavlOpArgs(dummy, dummyFloat, primitiveTypeHit),
-                                                 RayIntersectFunctor(tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array, TRIANGLE )),
+                                                 RayIntersectFunctor(sceneBVH(false))),
                                                                                                     "intersect");
         eavlExecutor::Go();
     }
     rayper=size/(eavlTimer::Stop(test,"test")/(float)testRounds);
     cout << "# "<<rayper/1000000.f<<endl;
 
+    /* The same rays through the wide BVH, which must find the same hits */
+    if(cpuWideBVH(tri_wide_bvh) != NULL || cpuWideBVH(sphr_wide_bvh) != NULL || cpuWideBVH(cyl_wide_bvh) != NULL)
+    {
+        eavlIntArray   *wideDummy = new eavlIntArray("",1,size);
+        eavlFloatArray *wideDummyFloat = new eavlFloatArray("",1,size);
+        for(int i=0; i<warmupRounds;i++)
+        {
+            eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
+                                                     eavlOpArgs(wideDummy, wideDummyFloat, primitiveTypeHit),
+                                                     RayIntersectFunctor(sceneBVH(true))),
+                                                                                                        "intersect");
+            eavlExecutor::Go();
+        }
+        int wideTest = eavlTimer::Start();
+        for(int i=0; i<testRounds;i++)
+        {
+            eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
+                                                     eavlOpArgs(wideDummy, wideDummyFloat, primitiveTypeHit),
+                                                     RayIntersectFunctor(sceneBVH(true))),
+                                                                                                        "intersect");
+            eavlExecutor::Go();
+        }
+        float widerayper=size/(eavlTimer::Stop(wideTest,"test")/(float)testRounds);
+        int mismatches = 0;
+        for(int i=0; i<size; i++)
+            if(wideDummyFloat->GetValue(i) != dummyFloat->GetValue(i)) mismatches++;
+        cout << "# "<<eavlWideBVH::width<<"-wide BVH "<<widerayper/1000000.f<<" Mrays/sec, "
+             <<widerayper/rayper<<"x binary, "<<mismatches<<" rays with a different hit"<<endl;
+        delete wideDummy;
+        delete wideDummyFloat;
+    }
+
 
     //verify output
+    /* when progressive, the rays are only the current batch: the pixels
+       from nextRay on, whose indexes are in indexes */
+    int count = progressive ? min(size, width*height - nextRay) : size;
     eavlFloatArray *depthBuffer= new eavlFloatArray("",1,size);
-    eavlFloatArray *d= new eavlFloatArray("",1,size);
+    eavlFloatArray *d= new eavlFloatArray("",1,width*height);
+    eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(d),
+                                             eavlOpArgs(d),
+                                             FloatMemsetFunctor(0)),
+                                             "init");
 
     eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(indexes), //dummy arg
                                              eavlOpArgs(minDistances),
@@ -2624,14 +2999,14 @@ void eavlRayTracerMutator::traversalTest(int warmupRounds, int testRounds)
     eavlExecutor::Go();
     eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(rayDirX,rayDirY,rayDirZ,rayOriginX,rayOriginY,rayOriginZ,hitIdx,primitiveTypeHit,minDistances),
                                              eavlOpArgs(dummy, depthBuffer, primitiveTypeHit),
-                                             RayIntersectFunctor(tri_verts_array,tri_bvh_in_array,tri_bvh_lf_array, TRIANGLE )),
+                                             RayIntersectFunctor(sceneBVH(false))),
                                                                                                     "intersect");
     eavlExecutor::Go();
 
     float maxDepth = 0;
     float minDepth =INFINITE;
 
-    for(int i=0; i< size; i++)
+    for(int i=0; i< count; i++)
     {
         if( depthBuffer->GetValue(i) == INFINITE) depthBuffer->SetValue(i,0);
         maxDepth= max(depthBuffer->GetValue(i), maxDepth);  
@@ -2639,11 +3014,12 @@ void eavlRayTracerMutator::traversalTest(int warmupRounds, int testRounds)
     } 
     //for(int i=0; i< size; i++) cout<<depthBuffer->GetValue(i)<<" ";
     maxDepth=maxDepth-minDepth;
-    for(int i=0; i< size; i++) depthBuffer->SetValue(i, (depthBuffer->GetValue(i)-minDepth)/maxDepth);
+    for(int i=0; i< count; i++) depthBuffer->SetValue(i, (depthBuffer->GetValue(i)-minDepth)/maxDepth);
     
     eavlExecutor::AddOperation(new_eavlScatterOp(eavlOpArgs(depthBuffer),
                                                  eavlOpArgs(d),
-                                                 eavlOpArgs(mortonIndexes)),
+                                                 eavlOpArgs(indexes),
+                                                 count),
                                                 "scatter");
     eavlExecutor::Go();
 
@@ -2902,6 +3278,9 @@ void eavlRayTracerMutator::freeTextures()
         delete cyl_matIdx_array;
         cyl_matIdx_array = NULL;
     }
+    deleteClassPtr(tri_wide_bvh);
+    deleteClassPtr(sphr_wide_bvh);
+    deleteClassPtr(cyl_wide_bvh);
 
 //eavlConstTexArray<float4>* cmap_array;
     if(verbose) cout<<"Done free"<<endl;
@@ -9,9 +9,15 @@
 #include "eavlRTUtil.h"
 #include "eavlConstTextureArray.h"
 
+class eavlWideBVH;
+struct SceneBVH;
+
 class eavlRayTracerMutator : public eavlMutator
 {
   public:
+    enum RayOrder { MortonOrder, TileOrder };  /*order the primary rays are traced in*/
+    enum BVHBuilder { SplitBuilder, MortonBuilder, BinnedBuilder };  /*builder of the BVHs*/
+
     bool cpu;
     eavlRTScene* scene;
 
@@ -80,7 +86,13 @@ class eavlRayTracerMutator : public eavlMutator
 
     void setBVHBuildFast(bool fast)
     {
-      fastBVHBuild = true;
+      setBVHBuilder(fast ? MortonBuilder : SplitBuilder);
+    }
+
+    void setBVHBuilder(BVHBuilder builder)
+    {
+      if(builder != bvhBuilder) geomDirty = true;
+      bvhBuilder = builder;
     }
 
     void setBVHCache(bool on)
@@ -88,6 +100,52 @@ class eavlRayTracerMutator : public eavlMutator
       useBVHCache=on;
     }
 
+    void setWideBVH(bool on)    /*Trace CPU rays through 4/8-wide BVHs collapsed from the binary ones*/
+    {
+      if(on != useWideBVH) geomDirty = true;
+      useWideBVH = on;
+    }
+
+    /* Trace the primary rays in morton order, or tile by tile in row order for
+       cache locality within tiles of tile x tile pixels */
+    void setRayOrder(RayOrder order, int tile = 16)
+    {
+      tile = max(tile, 1);
+      if(order != rayOrder || (order == TileOrder && tile != tileSize)) sizeDirty = true;
+      rayOrder = order;
+      tileSize = tile;
+    }
+
+    /* Render progressively: each Execute traces batches of raysPerBatch primary
+       rays in ray order, blending them into the frame buffer, and returns after
+       timeBudget seconds (0 for no limit) or when the frame is complete. The
+       next Execute carries on where it stopped, so the ray arrays only hold a
+       batch. With ambient occlusion the frame is traced maxPasses times, each
+       pass adding occSamples new samples to every pixel. */
+    void setProgressive(bool on, int raysPerBatch = 65536, float budget = 0.f, int passes = 1)
+    {
+      raysPerBatch = max(raysPerBatch, 1);
+      if(on != progressive || (on && raysPerBatch != batchRays)) sizeDirty = true;
+      if(on && passes != maxPasses) restartFrame();
+      progressive = on;
+      batchRays   = raysPerBatch;
+      timeBudget  = budget;
+      maxPasses   = max(passes, 1);
+    }
+
+    /* True when the last Execute finished the frame */
+    bool isFrameComplete() const
+    {
+      return !progressive || progressivePass >= progressivePasses();
+    }
+
+    /* Start the progressive frame over, for changes that don't do it already */
+    void restartFrame()
+    {
+      nextRay         = 0;
+      progressivePass = 0;
+    }
+
     void setShadowsOn(bool on)
     {
       shadowsOn=on;
@@ -198,7 +256,7 @@ class eavlRayTracerMutator : public eavlMutator
 
     void setBVHCacheName(const string &name)
     {
-      bvhCacheName = name+".bvh";
+      bvhCacheName = name;
     }
 
     void setAntiAlias(bool isOn)
@@ -264,6 +322,11 @@ class eavlRayTracerMutator : public eavlMutator
       deleteClassPtr(compactTempInt);
       deleteClassPtr(compactTempFloat);
 
+      deleteClassPtr(accR);
+      deleteClassPtr(accG);
+      deleteClassPtr(accB);
+      deleteClassPtr(batchFrame);
+
       deleteClassPtr(redIndexer);
       deleteClassPtr(blueIndexer);
       deleteClassPtr(greenIndexer);
@@ -319,7 +382,7 @@ class eavlRayTracerMutator : public eavlMutator
     float     fovy;           /*half vertical field of view in degrees*/
     float     fovx;           /*half horizontal field of view in degrees**/
     int       depth;          /*Number of ray bounces*/
-    int       size;           /*Size of the ray arrays h*w*/
+    int       size;           /*Size of the ray arrays h*w, or a batch when progressive*/
     int       occSamples;     /*Number of ambient occlusion samples per intersection*/
     int       colorMapSize;   /*Number of values if the color map lookup table*/
     bool      isOccusionOn;   /*True if ambient occlusion is on*/
@@ -336,7 +399,16 @@ class eavlRayTracerMutator : public eavlMutator
     bool      verbose;        /*Turn on print statements*/
     bool      useBVHCache;    /*Turn on print statements*/
     bool      shadowsOn;      /*use shadows*/
-    bool      fastBVHBuild;
+    BVHBuilder bvhBuilder;    /*Builder of the BVHs, Morton by default*/
+    bool      useWideBVH;     /*Collapse the BVHs into wide ones when running on the CPU*/
+    RayOrder  rayOrder;       /*Order of the primary rays*/
+    int       tileSize;       /*Width and height of the tiles in tile order*/
+    bool      progressive;    /*Render the frame a batch of rays at a time*/
+    int       batchRays;      /*Rays per batch when progressive*/
+    float     timeBudget;     /*Seconds an Execute may take when progressive, 0 for no limit*/
+    int       maxPasses;      /*Passes over the frame when progressive with ambient occlusion*/
+    int       nextRay;        /*First ray of the next batch in ray order*/
+    int       progressivePass;/*Passes over the frame done*/
 
     float     aoMax;          /* Maximum ambient occulsion ray length*/
     int       sampleCount;    /* keeps a running total of the number of re-usable ambient occlusion samples ie., the camera is unchanged */
@@ -352,7 +424,7 @@ class eavlRayTracerMutator : public eavlMutator
     std::ostringstream oss;
     string fileprefix;
     string filetype;
-    string bvhCacheName;
+    string bvhCacheName;      /*Prefix of the BVH cache files, one per primitive type*/
     int frameCounter;
     string scounter;
     char* outfilename;
@@ -423,9 +495,13 @@ class eavlRayTracerMutator : public eavlMutator
     eavlIntArray    *primitiveTypeHit;      /*type of primitive that was hit*/
     eavlFloatArray  *minDistances;          /*distance to ray hit */
     eavlIntArray    *indexes;               /*pixel  index corresponding to the ray */
-    eavlIntArray    *mortonIndexes;         /*indexes of primiary rays sorted in morton order */
-    eavlIntArray    *compactTempInt;        /*temp arrays for misc usage */
+    eavlIntArray    *mortonIndexes;         /*indexes of primiary rays sorted in morton or tile order */
+    eavlIntArray    *compactTempInt;        /*temp arrays for misc usage, and the morton codes of the rays */
     eavlFloatArray  *compactTempFloat;
+    eavlFloatArray  *accR;                  /*colors of the pixels accumulated over progressive passes */
+    eavlFloatArray  *accG;
+    eavlFloatArray  *accB;
+    eavlByteArray   *batchFrame;            /*frame buffer values of a progressive batch */
     eavlFloatArray  *zBuffer;
     eavlByteArray   *frameBuffer;           /* RGBARGBA..*/
 
@@ -466,11 +542,20 @@ class eavlRayTracerMutator : public eavlMutator
     float     *mats_raw;
 
     void Init();
+    void initRays(int first);
+    void renderRays();
+    void executeProgressive();
+    int  progressivePasses() const;
     void setDefaultColorMap();
     int  compact();
     void compactFloatArray(eavlFloatArray*& input, eavlIntArray* reverseIndex, int nitems);
     void compactIntArray(eavlIntArray*& input, eavlIntArray* reverseIndex, int nitems);
     void extractGeometry();
+    const eavlWideBVH *cpuWideBVH(const eavlWideBVH *bvh) const;
+    SceneBVH sceneBVH(bool wide) const;
+    void buildBVH(float *verts, int nprims, int floatsPerPrim, primitive_t primType,
+                  const string &cacheName, float *&innerNodes, int &innerSize,
+                  float *&leafNodes, int &leafSize);
     void setCompact(bool);
     void clearFrameBuffer(eavlFloatArray *r,eavlFloatArray *g,eavlFloatArray *b);
     void sort();
@@ -6,14 +6,23 @@
 #include "eavlCellSetAllStructured.h"
 #include "eavlReduceOp_1.h"
 #include "eavlMapOp.h"
+#include "eavlHistogramOp.h"
 
-struct InRange
+struct Magnitude2Functor
 {
-    float lo, hi;
-    InRange(float l, float h) : lo(l), hi(h) { }
-    EAVL_FUNCTOR int operator()(float val)
+    EAVL_FUNCTOR float operator()(tuple<float,float> v)
     {
-        return (val >= lo) && (val < hi);
+        float x = get<0>(v), y = get<1>(v);
+        return sqrtf(x*x + y*y);
+    }
+};
+
+struct Magnitude3Functor
+{
+    EAVL_FUNCTOR float operator()(tuple<float,float,float> v)
+    {
+        float x = get<0>(v), y = get<1>(v), z = get<2>(v);
+        return sqrtf(x*x + y*y + z*z);
     }
 };
 
@@ -26,8 +35,45 @@ void eavlScalarBinFilter::Execute()
     eavlField *field = input->GetField(fieldname);
     eavlArray *array = field->GetArray();
 
-    if (array->GetNumberOfComponents() != 1)
-        THROW(eavlException, "expected single-component field");
+    // vector fields are binned by their magnitude
+    eavlFloatArray *magnitude = NULL;
+    int ncomp = array->GetNumberOfComponents();
+    if (ncomp != 1)
+    {
+        eavlFloatArray *farray = dynamic_cast<eavlFloatArray*>(array);
+        if (!farray || ncomp > 3)
+            THROW(eavlException, "expected a single-component field, "
+                  "or a float field with two or three components");
+        magnitude = new eavlFloatArray("magnitude", 1,
+                                       array->GetNumberOfTuples());
+        if (ncomp == 2)
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(farray, 0),
+                                         eavlIndexable<eavlFloatArray>(farray, 1)),
+                              eavlOpArgs(magnitude),
+                              Magnitude2Functor()),
+                "magnitude");
+        else
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(farray, 0),
+                                         eavlIndexable<eavlFloatArray>(farray, 1),
+                                         eavlIndexable<eavlFloatArray>(farray, 2)),
+                              eavlOpArgs(magnitude),
+                              Magnitude3Functor()),
+                "magnitude");
+        array = magnitude;
+    }
+
+    eavlArray *weights = NULL;
+    if (weightfieldname != "")
+    {
+        eavlField *weightfield = input->GetField(weightfieldname);
+        if (weightfield->GetAssociation() != field->GetAssociation() ||
+            weightfield->GetAssocCellSet() != field->GetAssocCellSet())
+            THROW(eavlException, "weight field must have the same association "
+                  "as the binned field");
+        weights = weightfield->GetArray();
+    }
 
     eavlArray *minval = array->Create("minval", 1, 1);
     eavlArray *maxval = array->Create("maxval", 1, 1);
@@ -42,8 +88,6 @@ void eavlScalarBinFilter::Execute()
 
     eavlExecutor::Go();
 
-    int n = array->GetNumberOfTuples();
-
     float fmin = minval->GetComponentAsDouble(0,0);
     float fmax = maxval->GetComponentAsDouble(0,0);
     float fsize = fmax - fmin;
@@ -52,27 +96,16 @@ void eavlScalarBinFilter::Execute()
     for (int i = 0; i <= nbins; ++i)
         cutoffs->SetValue(i,  fmin + fsize * float(i) / float(nbins));
 
+    // count every bin in one pass over the values
     eavlFloatArray *counts = new eavlFloatArray("counts", 1, nbins);
-    eavlIntArray *inrange = new eavlIntArray("inrange", 1, n);
-    eavlIntArray *tmpcount = new eavlIntArray("tmpcount", 1, 1);
+    eavlExecutor::AddOperation(new eavlHistogramOp(array, 0, cutoffs, counts,
+                                                   weights),
+                               "count values in each bin");
+    eavlExecutor::Go();
 
-    for (int bin = 0; bin<nbins; ++bin)
-    {
-        float lo = cutoffs->GetValue(bin);
-        if (bin == 0)
-            lo = -FLT_MAX;
-        float hi = cutoffs->GetValue(bin+1);
-        if (bin == nbins-1)
-            hi = FLT_MAX;
-        eavlExecutor::AddOperation(new_eavlMapOp(eavlOpArgs(array),
-                                                 eavlOpArgs(inrange),
-                                                 InRange(lo, hi)),
-                                   "test if in range");
-        eavlExecutor::AddOperation(new eavlReduceOp_1<eavlAddFunctor<int> >
-               (inrange, tmpcount, eavlAddFunctor<int>()), "count in range");
-        eavlExecutor::Go();
-        counts->SetValue(bin, tmpcount->GetValue(0));
-    }
+    delete minval;
+    delete maxval;
+    delete magnitude;
 
     // create the output data set
     output->SetNumPoints(nbins+1);
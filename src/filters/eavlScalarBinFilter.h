@@ -16,6 +16,10 @@
 // Creation:    January 17, 2013
 //
 // Modifications:
+//   Count all the bins in a single pass with eavlHistogramOp.  Added an
+//   optional weight field, and binning of two and three component fields
+//   by their magnitude.
+//
 // ****************************************************************************
 class eavlScalarBinFilter : public eavlFilter
 {
@@ -29,10 +33,17 @@ class eavlScalarBinFilter : public eavlFilter
     {
         nbins = n;
     }
+    /// Add the value of this field to a bin for each binned value,
+    /// instead of one.  Empty for plain counts.
+    void SetWeightField(const string &name)
+    {
+        weightfieldname = name;
+    }
     virtual void Execute();
   protected:
     int nbins;
     string fieldname;
+    string weightfieldname;
 };
 
 #endif
@@ -15,7 +15,7 @@ eavlConstTexArray<float4>* scalars_array;
 
 eavlSimpleVRMutator::eavlSimpleVRMutator()
 {
-    if(eavlExecutor::GetExecutionMode() == eavlExecutor::ForceCPU ) cpu = true;
+    if(eavlExecutor::ForcingCPU()) cpu = true;
     else cpu = false;
 
 	height = 500;
@@ -0,0 +1,632 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlThresholdMutator.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlCellSetAllStructured.h"
+#include "eavlExecutor.h"
+#include "eavlMapOp.h"
+#include "eavlGatherOp.h"
+#include "eavlScatterOp.h"
+#include "eavlPrefixSumOp_1.h"
+#include "eavlReduceOp_1.h"
+#include "eavlReverseIndexOp.h"
+#include "eavlSimpleReverseIndexOp.h"
+#include "eavlSourceTopologyMapOp.h"
+#include "eavlSourceTopologyGatherMapOp.h"
+#include "eavlCombinedTopologyPackedMapOp.h"
+#include "eavlException.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+class InRangeFunctor
+{
+  protected:
+    double minval, maxval;
+  public:
+    InRangeFunctor(double vmin, double vmax) : minval(vmin), maxval(vmax) { }
+    EAVL_FUNCTOR int operator()(double value)
+    {
+        return value >= minval && value <= maxval;
+    }
+};
+
+class NodesInRangeFunctor
+{
+  protected:
+    bool all_points_required;
+  public:
+    NodesInRangeFunctor(bool apr) : all_points_required(apr) { }
+    template <class IN>
+    EAVL_FUNCTOR int operator()(int shapeType, int n, int ids[], const IN inputs)
+    {
+        int nin = 0;
+        for (int i=0; i<n; i++)
+        {
+            int in = collect(ids[i], inputs);
+            nin += in;
+        }
+        return all_points_required ? (nin == n) : (nin > 0);
+    }
+};
+
+class ShapeAndNodeCountFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR tuple<int,int> operator()(int shapeType, int n, int ids[],
+                                           const IN)
+    {
+        return tuple<int,int>(shapeType, n);
+    }
+};
+
+class SelectCellNodeFunctor
+{
+  public:
+    template <class IN>
+    EAVL_FUNCTOR int operator()(int shapeType, int n, int ids[],
+                                const IN, int subindex)
+    {
+        return ids[subindex];
+    }
+};
+
+class ConstantIntFunctor
+{
+  protected:
+    int value;
+  public:
+    ConstantIntFunctor(int v) : value(v) { }
+    EAVL_FUNCTOR int operator()(int) { return value; }
+};
+
+// ****************************************************************************
+// Function:  ThresholdCellsOnHost
+//
+// Purpose:
+///   ThresholdCells for cell sets which are neither structured nor
+///   explicit (e.g. subsets), which the topology map operations cannot
+///   traverse.  Cells are read with GetCellNodes and flagged in parallel
+///   on the host, and the kept cells, points and connectivity are built
+///   serially in order.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+static eavlCellSetExplicit *
+ThresholdCellsOnHost(eavlCellSet *inCells, eavlArray *inArray,
+                     bool pointField, int npts, double minval, double maxval,
+                     bool all_points_required,
+                     const string &outputCellSetName, bool compactPoints,
+                     eavlIntArray *&keptCells, eavlIntArray *&keptPoints)
+{
+    int nc = inCells->GetNumCells();
+
+    // read the values outside the parallel region, as array accessors
+    // may update the array's host/device state
+    int nvals = inArray->GetNumberOfTuples();
+    vector<char> inRange(nvals);
+    for (int i=0; i<nvals; i++)
+    {
+        double v = inArray->GetComponentAsDouble(i, 0);
+        inRange[i] = v >= minval && v <= maxval;
+    }
+
+    vector<int> cellFlag(nc);
+    #pragma omp parallel for
+    for (int i=0; i<nc; i++)
+    {
+        if (!pointField)
+        {
+            cellFlag[i] = inRange[i];
+            continue;
+        }
+        eavlCell cell = inCells->GetCellNodes(i);
+        int nin = 0;
+        for (int j=0; j<cell.numIndices; j++)
+            nin += inRange[cell.indices[j]];
+        cellFlag[i] = all_points_required ? (nin == cell.numIndices)
+                                          : (nin > 0);
+    }
+
+    vector<int> kept;
+    for (int i=0; i<nc; i++)
+        if (cellFlag[i])
+            kept.push_back(i);
+    int nkept = kept.size();
+    keptCells = new eavlIntArray("keptCells", 1, nkept);
+    for (int i=0; i<nkept; i++)
+        keptCells->SetValue(i, kept[i]);
+
+    eavlExplicitConnectivity conn;
+    for (int i=0; i<nkept; i++)
+        conn.AddElement(inCells->GetCellNodes(kept[i]));
+
+    keptPoints = NULL;
+    if (compactPoints)
+    {
+        // flag the points used, then number them in order
+        vector<int> pointIndex(npts, -1);
+        for (eavlIndex i=0; i<conn.connectivity.size(); )
+        {
+            int n = conn.connectivity[i++];
+            for (int j=0; j<n; j++, i++)
+                pointIndex[conn.connectivity[i]] = 1;
+        }
+        int nkeptpts = 0;
+        for (int p=0; p<npts; p++)
+            if (pointIndex[p] >= 0)
+                pointIndex[p] = nkeptpts++;
+        keptPoints = new eavlIntArray("keptPoints", 1, nkeptpts);
+        for (int p=0; p<npts; p++)
+            if (pointIndex[p] >= 0)
+                keptPoints->SetValue(pointIndex[p], p);
+        for (eavlIndex i=0; i<conn.connectivity.size(); )
+        {
+            int n = conn.connectivity[i++];
+            for (int j=0; j<n; j++, i++)
+                conn.connectivity[i] = pointIndex[conn.connectivity[i]];
+        }
+    }
+
+    eavlCellSetExplicit *subset =
+        new eavlCellSetExplicit(outputCellSetName,
+                                inCells->GetDimensionality());
+    subset->SetCellNodeConnectivity(conn);
+    return subset;
+}
+
+// ****************************************************************************
+// Function:  ThresholdCells
+//
+// Purpose:
+///   Select the cells of a cell set in the range, and create an explicit
+///   cell set of them.  The cells in range are flagged with a map (through
+///   a topology map over their nodes for a point field), compacted with a
+///   scan, and each node of each kept cell is looked up by a reverse index
+///   into its cell.  When compacting the points, the points used by the
+///   kept cells are flagged by a scatter and compacted with a scan, and
+///   the cells' nodes are renumbered.  The input cell indices of the kept
+///   cells, and of the kept points when compacting, are returned for
+///   gathering the fields.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   Other kinds of cell sets are thresholded on the host.
+// ****************************************************************************
+static eavlCellSetExplicit *
+ThresholdCells(eavlDataSet *ds, const string &cellsetname,
+               const string &fieldname, double minval, double maxval,
+               bool all_points_required, const string &outputCellSetName,
+               bool compactPoints,
+               eavlIntArray *&keptCells, eavlIntArray *&keptPoints)
+{
+    int inCellSetIndex = ds->GetCellSetIndex(cellsetname);
+    eavlCellSet *inCells = ds->GetCellSet(inCellSetIndex);
+
+    eavlField *inField = ds->GetField(fieldname);
+    eavlField::Association fieldAssociation = inField->GetAssociation();
+    if (fieldAssociation != eavlField::ASSOC_POINTS &&
+        (fieldAssociation != eavlField::ASSOC_CELL_SET ||
+         inField->GetAssocCellSet() != inCells->GetName()))
+    {
+        THROW(eavlException,"Field for subset didn't match cell set.");
+    }
+    eavlArray *inArray = inField->GetArray();
+
+    int nc = inCells->GetNumCells();
+    int npts = ds->GetNumPoints();
+
+    if (!dynamic_cast<eavlCellSetAllStructured*>(inCells) &&
+        !dynamic_cast<eavlCellSetExplicit*>(inCells))
+    {
+        return ThresholdCellsOnHost(inCells, inArray,
+                                    fieldAssociation == eavlField::ASSOC_POINTS,
+                                    npts, minval, maxval, all_points_required,
+                                    outputCellSetName, compactPoints,
+                                    keptCells, keptPoints);
+    }
+
+    //
+    // flag the cells in range and compact them
+    //
+    eavlIntArray *cellFlag = new eavlIntArray("cellFlag", 1, nc);
+    eavlIntArray *cellIndex = new eavlIntArray("cellIndex", 1, nc);
+    eavlIntArray *totalCells = new eavlIntArray("totalCells", 1, 1);
+    eavlIntArray *pointFlag = NULL;
+    if (nc > 0)
+    {
+        if (fieldAssociation == eavlField::ASSOC_CELL_SET)
+        {
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlArray>(inArray, 0)),
+                              eavlOpArgs(cellFlag),
+                              InRangeFunctor(minval, maxval)),
+                "flag cells in range");
+        }
+        else
+        {
+            pointFlag = new eavlIntArray("pointFlag", 1, npts);
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlArray>(inArray, 0)),
+                              eavlOpArgs(pointFlag),
+                              InRangeFunctor(minval, maxval)),
+                "flag points in range");
+            eavlExecutor::AddOperation(
+                new_eavlSourceTopologyMapOp(inCells,
+                                            EAVL_NODES_OF_CELLS,
+                                            eavlOpArgs(pointFlag),
+                                            eavlOpArgs(cellFlag),
+                                            NodesInRangeFunctor(all_points_required)),
+                "flag cells with nodes in range");
+        }
+        eavlExecutor::AddOperation(
+            new eavlPrefixSumOp_1(cellFlag, cellIndex, false),
+            "scan to generate output cell index");
+        eavlExecutor::AddOperation(
+            new eavlReduceOp_1<eavlAddFunctor<int> >
+                (cellFlag,
+                 totalCells,
+                 eavlAddFunctor<int>()),
+            "sumreduce to count output cells");
+        eavlExecutor::Go();
+    }
+    int nkept = (nc > 0) ? totalCells->GetValue(0) : 0;
+
+    //
+    // look up the shape and node count of each kept cell
+    //
+    keptCells = new eavlIntArray("keptCells", 1, nkept);
+    eavlIntArray *keptShape = new eavlIntArray("keptShape", 1, nkept);
+    eavlIntArray *keptNumNodes = new eavlIntArray("keptNumNodes", 1, nkept);
+    eavlIntArray *keptConnStart = new eavlIntArray("keptConnStart", 1, nkept);
+    eavlIntArray *totalNodes = new eavlIntArray("totalNodes", 1, 1);
+    if (nkept > 0)
+    {
+        eavlExecutor::AddOperation(
+            new eavlSimpleReverseIndexOp(cellFlag,
+                                         cellIndex,
+                                         keptCells),
+            "generate reverse lookup: output cell to input cell");
+        eavlExecutor::AddOperation(
+            new_eavlSourceTopologyGatherMapOp(inCells,
+                                              EAVL_NODES_OF_CELLS,
+                                              eavlOpArgs(keptCells),
+                                              eavlOpArgs(keptShape,
+                                                         keptNumNodes),
+                                              eavlOpArgs(keptCells),
+                                              ShapeAndNodeCountFunctor()),
+            "look up shape and node count of each output cell");
+        eavlExecutor::AddOperation(
+            new eavlPrefixSumOp_1(keptNumNodes, keptConnStart, false),
+            "scan to generate starting node index per output cell");
+        eavlExecutor::AddOperation(
+            new eavlReduceOp_1<eavlAddFunctor<int> >
+                (keptNumNodes,
+                 totalNodes,
+                 eavlAddFunctor<int>()),
+            "sumreduce to count output cell nodes");
+        eavlExecutor::Go();
+    }
+    int nnodes = (nkept > 0) ? totalNodes->GetValue(0) : 0;
+
+    //
+    // look up every node of every kept cell
+    //
+    eavlIntArray *nodeCell = new eavlIntArray("nodeCell", 1, nnodes);
+    eavlIntArray *nodeSubindex = new eavlIntArray("nodeSubindex", 1, nnodes);
+    eavlIntArray *nodeInputCell = new eavlIntArray("nodeInputCell", 1, nnodes);
+    eavlIntArray *nodePoint = new eavlIntArray("nodePoint", 1, nnodes);
+    if (nnodes > 0)
+    {
+        eavlExecutor::AddOperation(
+            new eavlReverseIndexOp(keptNumNodes,
+                                   keptConnStart,
+                                   nodeCell,
+                                   nodeSubindex,
+                                   MAX_LOCAL_TOPOLOGY_IDS),
+            "generate reverse lookup: cell node to output cell");
+        eavlExecutor::AddOperation(
+            new_eavlGatherOp(eavlOpArgs(keptCells),
+                             eavlOpArgs(nodeInputCell),
+                             eavlOpArgs(nodeCell)),
+            "gather input cell of each cell node");
+        eavlExecutor::AddOperation(
+            new_eavlCombinedTopologyPackedMapOp(inCells,
+                                                EAVL_NODES_OF_CELLS,
+                                                eavlOpArgs(nodeSubindex),
+                                                eavlOpArgs(nodeSubindex),
+                                                eavlOpArgs(nodePoint),
+                                                eavlOpArgs(nodeInputCell),
+                                                SelectCellNodeFunctor()),
+            "look up point of each cell node");
+        eavlExecutor::Go();
+    }
+
+    //
+    // compact the points used by the kept cells and renumber the nodes
+    //
+    keptPoints = NULL;
+    eavlIntArray *outNodePoint = nodePoint;
+    eavlIntArray *pointUsed = NULL, *pointIndex = NULL, *totalPoints = NULL;
+    eavlIntArray *ones = NULL;
+    if (compactPoints)
+    {
+        pointUsed = new eavlIntArray("pointUsed", 1, npts);
+        pointIndex = new eavlIntArray("pointIndex", 1, npts);
+        totalPoints = new eavlIntArray("totalPoints", 1, 1);
+        ones = new eavlIntArray("ones", 1, nnodes);
+        outNodePoint = new eavlIntArray("outNodePoint", 1, nnodes);
+        if (npts > 0)
+        {
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(pointUsed),
+                              eavlOpArgs(pointUsed),
+                              ConstantIntFunctor(0)),
+                "clear point used flags");
+            if (nnodes > 0)
+            {
+                eavlExecutor::AddOperation(
+                    new_eavlMapOp(eavlOpArgs(nodePoint),
+                                  eavlOpArgs(ones),
+                                  ConstantIntFunctor(1)),
+                    "fill ones");
+                eavlExecutor::AddOperation(
+                    new_eavlScatterOp(eavlOpArgs(ones),
+                                      eavlOpArgs(pointUsed),
+                                      eavlOpArgs(nodePoint)),
+                    "flag points used by output cells");
+            }
+            eavlExecutor::AddOperation(
+                new eavlPrefixSumOp_1(pointUsed, pointIndex, false),
+                "scan to generate output point index");
+            eavlExecutor::AddOperation(
+                new eavlReduceOp_1<eavlAddFunctor<int> >
+                    (pointUsed,
+                     totalPoints,
+                     eavlAddFunctor<int>()),
+                "sumreduce to count output points");
+            eavlExecutor::Go();
+        }
+        int nkeptpts = (npts > 0) ? totalPoints->GetValue(0) : 0;
+
+        keptPoints = new eavlIntArray("keptPoints", 1, nkeptpts);
+        if (nkeptpts > 0)
+        {
+            eavlExecutor::AddOperation(
+                new eavlSimpleReverseIndexOp(pointUsed,
+                                             pointIndex,
+                                             keptPoints),
+                "generate reverse lookup: output point to input point");
+            eavlExecutor::AddOperation(
+                new_eavlGatherOp(eavlOpArgs(pointIndex),
+                                 eavlOpArgs(outNodePoint),
+                                 eavlOpArgs(nodePoint)),
+                "renumber cell nodes to output points");
+            eavlExecutor::Go();
+        }
+    }
+
+    //
+    // create the output cell set; each cell's connectivity starts
+    // at its node scan plus one slot per preceding cell for the count
+    //
+    eavlCellSetExplicit *subset =
+        new eavlCellSetExplicit(outputCellSetName,
+                                inCells->GetDimensionality());
+    eavlExplicitConnectivity conn;
+    conn.shapetype.resize(nkept);
+    conn.connectivity.resize(nnodes + nkept);
+    // take the host pointers outside the parallel region, as array
+    // accessors may update the arrays' host/device state
+    const int *connStartPtr = nkept ? (const int*)keptConnStart->GetHostArray() : NULL;
+    const int *numNodesPtr = nkept ? (const int*)keptNumNodes->GetHostArray() : NULL;
+    const int *shapePtr = nkept ? (const int*)keptShape->GetHostArray() : NULL;
+    const int *nodePointPtr = nnodes ? (const int*)outNodePoint->GetHostArray() : NULL;
+    #pragma omp parallel for
+    for (int i=0; i<nkept; i++)
+    {
+        int start = connStartPtr[i];
+        int n = numNodesPtr[i];
+        conn.shapetype[i] = shapePtr[i];
+        conn.connectivity[start + i] = n;
+        for (int j=0; j<n; j++)
+            conn.connectivity[start + i + 1 + j] = nodePointPtr[start + j];
+    }
+    subset->SetCellNodeConnectivity(conn);
+
+    delete cellFlag;
+    delete cellIndex;
+    delete totalCells;
+    delete pointFlag;
+    delete keptShape;
+    delete keptNumNodes;
+    delete keptConnStart;
+    delete totalNodes;
+    delete nodeCell;
+    delete nodeSubindex;
+    delete nodeInputCell;
+    delete nodePoint;
+    delete pointUsed;
+    delete pointIndex;
+    delete totalPoints;
+    delete ones;
+    if (outNodePoint != nodePoint)
+        delete outNodePoint;
+
+    return subset;
+}
+
+// gather each component of a field's array into a new array
+static void
+GatherField(eavlArray *inArray, eavlArray *outArray, eavlIntArray *indices)
+{
+    if (indices->GetNumberOfTuples() == 0)
+        return;
+    for (int c=0; c<inArray->GetNumberOfComponents(); c++)
+    {
+        eavlExecutor::AddOperation(
+            new_eavlGatherOp(eavlOpArgs(eavlIndexable<eavlArray>(inArray, c)),
+                             eavlOpArgs(eavlIndexable<eavlArray>(outArray, c)),
+                             eavlOpArgs(indices)),
+            "gather field");
+    }
+}
+
+eavlThresholdMutator::eavlThresholdMutator()
+{
+    minval = -FLT_MAX;
+    maxval = +FLT_MAX;
+    all_points_required = false;
+    outputCellSetName = "";
+}
+
+
+void
+eavlThresholdMutator::Execute()
+{
+    int inCellSetIndex = dataset->GetCellSetIndex(cellsetname);
+    eavlCellSet *inCells = dataset->GetCellSet(inCellSetIndex);
+
+    if(outputCellSetName.empty())
+        outputCellSetName = string("threshold_of_")+inCells->GetName();
+
+    eavlIntArray *keptCells, *keptPoints;
+    eavlCellSetExplicit *subset =
+        ThresholdCells(dataset, cellsetname, fieldname, minval, maxval,
+                       all_points_required, outputCellSetName, false,
+                       keptCells, keptPoints);
+    int numnewcells = subset->GetNumCells();
+
+    //int new_cellset_index = dataset->GetNumCellSets();
+    dataset->AddCellSet(subset);
+
+    int nOldFields = dataset->GetNumFields();
+    for (int i=0; i<nOldFields; i++)
+    {
+        eavlField *f = dataset->GetField(i);
+        if (f->GetAssociation() == eavlField::ASSOC_CELL_SET &&
+            f->GetAssocCellSet() == dataset->GetCellSet(inCellSetIndex)->GetName())
+        {
+            int numcomp = f->GetArray()->GetNumberOfComponents();
+            eavlFloatArray *a = new eavlFloatArray(
+                                 string("threshold_of_")+f->GetArray()->GetName(),
+                                 numcomp, numnewcells);
+            GatherField(f->GetArray(), a, keptCells);
+
+            eavlField *newfield = new eavlField(f->GetOrder(), a,
+                                                eavlField::ASSOC_CELL_SET,
+                                                subset->GetName());
+            dataset->AddField(newfield);
+        }
+    }
+    eavlExecutor::Go();
+
+    delete keptCells;
+}
+
+eavlThresholdFilter::eavlThresholdFilter()
+{
+    minval = -FLT_MAX;
+    maxval = +FLT_MAX;
+    all_points_required = false;
+    outputCellSetName = "";
+}
+
+void
+eavlThresholdFilter::Execute()
+{
+    int inCellSetIndex = input->GetCellSetIndex(cellsetname);
+    eavlCellSet *inCells = input->GetCellSet(inCellSetIndex);
+
+    if(outputCellSetName.empty())
+        outputCellSetName = string("threshold_of_")+inCells->GetName();
+
+    eavlIntArray *keptCells, *keptPoints;
+    eavlCellSetExplicit *subset =
+        ThresholdCells(input, cellsetname, fieldname, minval, maxval,
+                       all_points_required, outputCellSetName, true,
+                       keptCells, keptPoints);
+    int noutcells = subset->GetNumCells();
+    int noutpts = keptPoints->GetNumberOfTuples();
+
+    output->SetNumPoints(noutpts);
+    output->AddCellSet(subset);
+
+    ///\todo: assuming first coordinate system
+    eavlCoordinates *coordsys = input->GetCoordinateSystem(0);
+    int spatialdim = coordsys->GetDimension();
+    const char *axisnames[] = {"xcoord", "ycoord", "zcoord"};
+    const eavlCoordinatesCartesian::CartesianAxisType axistypes[] = {
+        eavlCoordinatesCartesian::X,
+        eavlCoordinatesCartesian::Y,
+        eavlCoordinatesCartesian::Z};
+    if (spatialdim < 1 || spatialdim > 3)
+        THROW(eavlException, "Unexpected number of spatial dimensions");
+
+    eavlCoordinatesCartesian *newcoordsys = NULL;
+    if (spatialdim == 1)
+        newcoordsys = new eavlCoordinatesCartesian(NULL, axistypes[0]);
+    else if (spatialdim == 2)
+        newcoordsys = new eavlCoordinatesCartesian(NULL, axistypes[0],
+                                                   axistypes[1]);
+    else
+        newcoordsys = new eavlCoordinatesCartesian(NULL, axistypes[0],
+                                                   axistypes[1],
+                                                   axistypes[2]);
+    for (int d=0; d<spatialdim; d++)
+    {
+        eavlFloatArray *coords = new eavlFloatArray(axisnames[d], 1, noutpts);
+        if (noutpts > 0)
+        {
+            eavlExecutor::AddOperation(
+                new_eavlGatherOp(eavlOpArgs(input->GetIndexableAxis(d)),
+                                 eavlOpArgs(coords),
+                                 eavlOpArgs(keptPoints)),
+                "gather coordinates");
+        }
+        newcoordsys->SetAxis(d, new eavlCoordinateAxisField(axisnames[d], 0));
+        output->AddField(new eavlField(1, coords, eavlField::ASSOC_POINTS));
+    }
+    output->AddCoordinateSystem(newcoordsys);
+
+    // gather the point fields and the cell set's cell fields
+    for (int i=0; i<input->GetNumFields(); i++)
+    {
+        eavlField *f = input->GetField(i);
+        eavlArray *a = f->GetArray();
+
+        // we already did the coordinate fields
+        if (coordsys->IsCoordinateAxisField(a->GetName()))
+            continue;
+
+        if (f->GetAssociation() == eavlField::ASSOC_POINTS)
+        {
+            eavlArray *outArr = a->Create(a->GetName(),
+                                          a->GetNumberOfComponents(), noutpts);
+            GatherField(a, outArr, keptPoints);
+            output->AddField(new eavlField(f->GetOrder(), outArr,
+                                           eavlField::ASSOC_POINTS));
+        }
+        else if (f->GetAssociation() == eavlField::ASSOC_CELL_SET &&
+                 f->GetAssocCellSet() == inCells->GetName())
+        {
+            eavlArray *outArr = a->Create(a->GetName(),
+                                          a->GetNumberOfComponents(), noutcells);
+            GatherField(a, outArr, keptCells);
+            output->AddField(new eavlField(f->GetOrder(), outArr,
+                                           eavlField::ASSOC_CELL_SET,
+                                           subset->GetName()));
+        }
+        else
+        {
+            // skip field: either wrong cell set or not nodal/zonal assoc
+        }
+    }
+    eavlExecutor::Go();
+
+    delete keptCells;
+    delete keptPoints;
+}
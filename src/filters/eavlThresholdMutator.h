@@ -5,6 +5,7 @@
 #include "STL.h"
 #include "eavlDataSet.h"
 #include "eavlCellComponents.h"
+#include "eavlCellSetExplicit.h"
 #include "eavlFilter.h"
 
 // ****************************************************************************
@@ -18,6 +19,12 @@
 // Programmer:  Jeremy Meredith, Dave Pugmire, Sean Ahern, James Kress
 // Creation:    April 13, 2012
 //
+// Modifications:
+//   Select the cells and build their connectivity with executor operations
+//   (a map to flag the cells in range, a scan to compact them, and gathers
+//   for their nodes and the cell fields), so it runs on the CPU or GPU.
+//   The input cell set must be explicit or structured.
+//
 // ****************************************************************************
 class eavlThresholdMutator : public eavlMutator
 {
@@ -48,9 +55,56 @@ class eavlThresholdMutator : public eavlMutator
     {
         outputCellSetName = name;
     }
-    
+
     virtual void Execute();
 };
 
-#endif
+// ****************************************************************************
+// Class:  eavlThresholdFilter
+//
+// Purpose:
+///   Create a new data set holding the thresholded cells of a cell set,
+///   with only the points those cells use.  The points are renumbered in
+///   their input order, and the coordinates, the point fields and the
+///   cell set's cell fields are gathered into the output, so the output
+///   shrinks with the fraction of cells kept.  The coordinates of the
+///   output are Cartesian, from the input's first coordinate system.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlThresholdFilter : public eavlFilter
+{
+  protected:
+    double minval, maxval;
+    string fieldname, cellsetname, outputCellSetName;
+    bool all_points_required;
+  public:
+    eavlThresholdFilter();
+    void SetRange(double vmin, double vmax)
+    {
+        minval = vmin;
+        maxval = vmax;
+    }
+    void SetField(const string &name)
+    {
+        fieldname = name;
+    }
+    void SetCellSet(const string &name)
+    {
+        cellsetname = name;
+    }
+    void SetNodalThresholdAllPointsRequired(bool apr)
+    {
+        all_points_required = apr;
+    }
+    void SetOutputCellSetName(const string &name)
+    {
+        outputCellSetName = name;
+    }
 
+    virtual void Execute();
+};
+
+#endif
@@ -114,14 +114,14 @@ eavlBOVImporter::GetMesh(const string&, int chunk)
 }
 
 template<class T> static eavlFloatArray *
-CopyValues(string nm, T *buff, int nTups, int nComps)
+CopyValues(string nm, T *buff, eavlIndex nTups, int nComps)
 {
     eavlFloatArray *arr = new eavlFloatArray(nm, nComps);
     arr->SetNumberOfTuples(nTups);
-    int idx = 0;
+    eavlIndex idx = 0;
     for (int i = 0; i < nComps; i++)
     {
-        for (int j = 0; j < nTups; j++, idx++)
+        for (eavlIndex j = 0; j < nTups; j++, idx++)
             arr->SetComponentFromDouble(j, i, (double)(buff[idx]));
     }
 
@@ -134,10 +134,10 @@ eavlBOVImporter::GetField(const string &var, const string &mesh, int chunk)
     string fileName = DataFileFromChunk(chunk);
     bool gzipped = (fileName.length() > 3 && fileName.substr(fileName.length()-3) == ".gz");
 
-    int nTuples = brickSize[0]*brickSize[1]*brickSize[2];
+    eavlIndex nTuples = eavlIndex(brickSize[0])*brickSize[1]*brickSize[2];
 
     size_t typeSz = SizeOfDataType();
-    size_t sz = nTuples*numComponents*typeSz;
+    size_t sz = size_t(nTuples)*numComponents*typeSz;
     void *buff = new void*[sz];
     if (gzipped)
     {
@@ -17,6 +17,7 @@
 #include "eavlPNGImporter.h"
 #include "eavlCurveImporter.h"
 #include "eavlLAMMPSDumpImporter.h"
+#include "eavlSnapshotImporter.h"
 
 #include "eavlException.h"
 
@@ -59,6 +60,10 @@ eavlImporterFactory::GetImporterForFile(const std::string &fn_orig)
     {
         importer = new eavlLAMMPSDumpImporter(fn_orig);
     }
+    else if (flen>5 && filename.substr(flen-5) == ".eavl")
+    {
+        importer = new eavlSnapshotImporter(fn_orig);
+    }
 #ifdef HAVE_NETCDF
     else if (flen>3 && filename.substr(flen-3) == ".nc")
     {
@@ -2,40 +2,121 @@
 // This file contains code from VisIt, (c) 2000-2014 LLNS.  See COPYRIGHT.txt.
 
 #include "eavlLAMMPSDumpImporter.h"
+#include "eavlUtility.h"
 
 #include <string.h>
+#include <stdlib.h>
+#include <iomanip>
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+inline bool IsBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool IsBlankLine(const char *p, const char *eol)
+{
+    for (; p < eol; p++)
+    {
+        if (!IsBlank(*p))
+            return false;
+    }
+    return true;
+}
+
+// the line starting at p, without its end of line; p moves past it
+static string NextLine(const char *file, size_t fileBytes, size_t &p)
+{
+    size_t start = p;
+    const char *eol = (const char*)memchr(file+p, '\n', fileBytes-p);
+    size_t end = eol ? size_t(eol - file) : fileBytes;
+    p = eol ? end + 1 : fileBytes;
+    if (end > start && file[end-1] == '\r')
+        end--;
+    return string(file + start, end - start);
+}
 
 // ****************************************************************************
-//  Method:  eavlLAMMPSDumpImporter::OpenFileAtBeginning
+//  Method:  eavlLAMMPSDumpImporter::Map
 //
 //  Purpose:
-//    Opens the file, or else seeks to the beginning.
+//    Maps the file into memory, or reads the whole file if it can't be
+//    mapped, and notes its modification time for checking the index.
 //
 //  Arguments:
 //    none
 //
-//  Programmer:  Jeremy Meredith
-//  Creation:    February  9, 2009
+//  Creation:    October 17, 2026
+//
+//  Modifications:
 //
 // ****************************************************************************
 void
-eavlLAMMPSDumpImporter::OpenFileAtBeginning()
+eavlLAMMPSDumpImporter::Map()
 {
-    if (!in.is_open())
+#if !defined(_WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        THROW(eavlException, "Couldn't open file " + filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        THROW(eavlException, "Couldn't stat file " + filename);
+    }
+    fileBytes = st.st_size;
+    fileTime = st.st_mtime;
+    if (fileBytes > 0)
     {
-        in.open(filename.c_str());
-        if (!in)
+        void *p = mmap(NULL, fileBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
         {
-            THROW(eavlException, "Couldn't open file" + filename);
+            file = (const char*)p;
+            mapped = true;
         }
     }
-    else
+    close(fd);
+    if (mapped || fileBytes == 0)
+        return;
+#endif
+
+    // no mapping: read the whole file instead
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in)
+        THROW(eavlException, "Couldn't open file " + filename);
+    in.seekg(0, ios::end);
+    fileBytes = in.tellg();
+    in.seekg(0, ios::beg);
+    char *contents = new char[fileBytes > 0 ? fileBytes : 1];
+    in.read(contents, fileBytes);
+    file = contents;
+    if (!in)
     {
-        in.clear();
-        in.seekg(0, ios::beg);
+        Unmap();
+        THROW(eavlException, "Error reading file " + filename);
     }
 }
 
+void
+eavlLAMMPSDumpImporter::Unmap()
+{
+#if !defined(_WIN32)
+    if (mapped)
+        munmap(const_cast<char*>(file), fileBytes);
+    else
+#endif
+        delete[] file;
+    file = NULL;
+    fileBytes = 0;
+    mapped = false;
+}
+
 
 // ****************************************************************************
 //  Method: GetMesh
@@ -77,6 +158,7 @@ eavlLAMMPSDumpImporter::GetMesh(const string &mesh, int)
         new eavlFloatArray("ycoord",1, n),
         new eavlFloatArray("zcoord",1, n)
     };
+#pragma omp parallel for
     for (int i=0; i<n; i++)
     {
         double x = vars[xIndex][i];
@@ -144,6 +226,7 @@ eavlLAMMPSDumpImporter::GetField(const string &varname, const string &mesh, int
     if (string(varname) == "type")
     {
         eavlIntArray *iarr = new eavlIntArray(varname, 1, n);
+#pragma omp parallel for
         for (int i=0; i<n; ++i)
             iarr->SetValue(i, speciesVar[i]);
         arr = iarr;
@@ -151,6 +234,7 @@ eavlLAMMPSDumpImporter::GetField(const string &varname, const string &mesh, int
     else if (string(varname) == "id")
     {
         eavlIntArray *iarr = new eavlIntArray(varname, 1, n);
+#pragma omp parallel for
         for (int i=0; i<n; ++i)
             iarr->SetValue(i, idVar[i]);
         arr = iarr;
@@ -158,6 +242,7 @@ eavlLAMMPSDumpImporter::GetField(const string &varname, const string &mesh, int
     else
     {
         eavlFloatArray *farr = new eavlFloatArray(varname, 1, n);
+#pragma omp parallel for
         for (int i=0; i<n; ++i)
             farr->SetValue(i, vars[varIndex][i]);
         arr = farr;
@@ -180,6 +265,9 @@ eavlLAMMPSDumpImporter::GetField(const string &varname, const string &mesh, int
 //  Creation:    February  9, 2009
 //
 //  Modifications:
+//    Parse the atoms from the mapped file in parallel: the atom lines are
+//    split into chunks at line boundaries, the lines of each chunk are
+//    counted, and then each chunk is parsed into its atoms' slots.
 //
 // ****************************************************************************
 void
@@ -190,50 +278,97 @@ eavlLAMMPSDumpImporter::ReadTimeStep(int timestep)
     // don't read this time step if it's already in memory
     if (currentTimestep == timestep)
         return;
-    currentTimestep = timestep;
-
-    OpenFileAtBeginning();
-    in.seekg(file_positions[timestep]);
+    if (timestep < 0 || timestep >= nTimeSteps)
+        THROW(eavlException, "Invalid time step");
 
-    speciesVar.resize(nAtoms[timestep]);
-    idVar.resize(nAtoms[timestep]);
+    int n = nAtoms[timestep];
+    speciesVar.resize(n);
+    idVar.resize(n);
     for (int v=0; v<int(vars.size()); v++)
     {
         // id and species are ints; don't bother with the float arrays for them
         if (v == idIndex || v == speciesIndex)
             continue;
-        vars[v].resize(nAtoms[timestep]);
+        vars[v].resize(n);
     }
 
-    std::vector<double> tmpVars(nVars);
-    int tmpID, tmpSpecies;
+    const char *begin = file + file_positions[timestep];
+    const char *end = file + block_ends[timestep];
+    size_t nbytes = end - begin;
+    int nchunks = int(std::min(nbytes / 65536 + 1, size_t(4096)));
+    vector<const char *> chunk(nchunks+1);
+    for (int c=0; c<nchunks; c++)
+    {
+        const char *p = begin + nbytes * c / nchunks;
+        while (c > 0 && p < end && p[-1] != '\n')
+            p++;
+        chunk[c] = p;
+    }
+    chunk[nchunks] = end;
 
-    char buff[1000];
-    // read all the atoms
-    for (int a=0; a<nAtoms[timestep]; a++)
+    // count the atom lines in each chunk to find where their atoms go
+    vector<int> firstAtom(nchunks+1, 0);
+#pragma omp parallel for
+    for (int c=0; c<nchunks; c++)
     {
-        in.getline(buff,1000);
-        istringstream sin(buff);
-        for (int v=0; v<nVars; v++)
+        int count = 0;
+        for (const char *p=chunk[c]; p<chunk[c+1]; )
         {
-            if (v==speciesIndex)
-                sin >> tmpSpecies;
-            else if (v==idIndex)
-                sin >> tmpID;
-            else
-                sin >> tmpVars[v];
+            const char *eol = (const char*)memchr(p, '\n', chunk[c+1]-p);
+            if (!eol)
+                eol = chunk[c+1];
+            if (!IsBlankLine(p, eol))
+                count++;
+            p = (eol < chunk[c+1]) ? eol+1 : eol;
         }
-
-        int index = a;  // no longer tmpID (tmpID-1 actually); don't re-sort
-        for (int v=0; v<nVars; v++)
+        firstAtom[c+1] = count;
+    }
+    for (int c=0; c<nchunks; c++)
+        firstAtom[c+1] += firstAtom[c];
+    if (firstAtom[nchunks] != n)
+        THROW(eavlException, "Wrong number of atoms in time step");
+
+    int nbad = 0;
+#pragma omp parallel for reduction(+:nbad)
+    for (int c=0; c<nchunks; c++)
+    {
+        int a = firstAtom[c];
+        for (const char *p=chunk[c]; p<chunk[c+1]; )
         {
-            if (v == idIndex || v == speciesIndex)
-                continue;
-            vars[v][index] = tmpVars[v];
+            const char *eol = (const char*)memchr(p, '\n', chunk[c+1]-p);
+            if (!eol)
+                eol = chunk[c+1];
+            if (!IsBlankLine(p, eol))
+            {
+                // index is a: no longer tmpID (tmpID-1 actually); don't re-sort
+                const char *t = p;
+                for (int v=0; v<nVars; v++)
+                {
+                    while (t < eol && IsBlank(*t))
+                        t++;
+                    const char *e = t;
+                    while (e < eol && !IsBlank(*e))
+                        e++;
+                    double value = 0;
+                    if (t == e || !ParseNumber(t, e, value))
+                        nbad++;
+                    if (v == speciesIndex)
+                        speciesVar[a] = int(value) - 1;
+                    else if (v == idIndex)
+                        idVar[a] = int(value);
+                    else
+                        vars[v][a] = value;
+                    t = e;
+                }
+                a++;
+            }
+            p = (eol < chunk[c+1]) ? eol+1 : eol;
         }
-        speciesVar[index] = tmpSpecies - 1;
-        idVar[index] = tmpID;
     }
+    if (nbad > 0)
+        THROW(eavlException, "Couldn't parse the atoms of time step");
+
+    currentTimestep = timestep;
 }
 
 
@@ -252,6 +387,9 @@ eavlLAMMPSDumpImporter::ReadTimeStep(int timestep)
 //  Creation:    February  9, 2009
 //
 //  Modifications:
+//    Take the meta data from the index file next to the dump when it
+//    matches the dump's size and modification time; otherwise scan the
+//    dump and write a new index.
 //
 // ****************************************************************************
 void
@@ -260,109 +398,314 @@ eavlLAMMPSDumpImporter::ReadAllMetaData()
     if (metaDataRead)
         return;
 
-    OpenFileAtBeginning();
+    Map();
+    try
+    {
+        if (!ReadIndex())
+        {
+            ScanFile();
+            WriteIndex();
+        }
+
+        if (xIndex<0 || yIndex<0 || zIndex<0 || idIndex<0 || speciesIndex<0)
+        {
+            THROW(eavlException, "Bad file " + filename +
+                  ": Didn't get indices for all necessary vars");
+        }
+    }
+    catch (...)
+    {
+        Unmap();
+        throw;
+    }
+
+    // don't read the meta data more than once
+    metaDataRead = true;
+}
 
-    char buff[1000];
 
+// ****************************************************************************
+//  Method:  eavlLAMMPSDumpImporter::ScanFile
+//
+//  Purpose:
+//    Scan the whole dump for its time steps, noting where the atoms of
+//    each one start and end; the atom lines themselves are skipped.
+//
+//  Arguments:
+//    none
+//
+//  Programmer:  Jeremy Meredith
+//  Creation:    February  9, 2009
+//
+//  Modifications:
+//    Split out of ReadAllMetaData, and scan the mapped file by lines.
+//
+// ****************************************************************************
+void
+eavlLAMMPSDumpImporter::ScanFile()
+{
     nTimeSteps = 0;
     nVars = -1;
+    cycles.clear();
+    nAtoms.clear();
+    file_positions.clear();
+    block_ends.clear();
 
-    while (in)
+    size_t p = 0;
+    while (p < fileBytes)
     {
-        in.getline(buff,1000);
-        if (strncmp(buff, "ITEM:", 5) != 0)
+        string line = NextLine(file, fileBytes, p);
+        if (strncmp(line.c_str(), "ITEM:", 5) != 0)
             continue;
 
-        string item(&buff[6]);
+        string item = (line.length() > 6) ? line.substr(6) : string();
         if (item == "TIMESTEP")
         {
             nTimeSteps++;
-            in.getline(buff,1000);
-            cycles.push_back(strtol(buff, NULL, 10));
-        }
-        else if (item.substr(0,19) == "BOX BOUNDS xy xz yz")
-        {
-            float xy, xz, yz;
-            in >> xMin >> xMax >> xy;
-            in >> yMin >> yMax >> xz;
-            in >> zMin >> zMax >> yz;
-            in.getline(buff, 1000); // get rest of Z line
+            line = NextLine(file, fileBytes, p);
+            cycles.push_back(strtol(line.c_str(), NULL, 10));
         }
         else if (item.substr(0,10) == "BOX BOUNDS")
         {
-            in >> xMin >> xMax;
-            in >> yMin >> yMax;
-            in >> zMin >> zMax;
-            in.getline(buff, 1000); // get rest of Z line
+            // low and high bounds, then the tilt factor of a triclinic box
+            double *bounds[3][2] = {{&xMin, &xMax}, {&yMin, &yMax},
+                                    {&zMin, &zMax}};
+            for (int d=0; d<3; d++)
+            {
+                line = NextLine(file, fileBytes, p);
+                char *e;
+                *bounds[d][0] = strtod(line.c_str(), &e);
+                *bounds[d][1] = strtod(e, NULL);
+            }
         }
         else if (item == "NUMBER OF ATOMS")
         {
-            in.getline(buff,1000);
-            int n = strtol(buff, NULL, 10);
+            line = NextLine(file, fileBytes, p);
+            int n = strtol(line.c_str(), NULL, 10);
             nAtoms.push_back(n);
         }
         else if (item.substr(0,5) == "ATOMS")
         {
-            istream::pos_type current_pos = in.tellg();
-            file_positions.push_back(current_pos);
+            file_positions.push_back(p);
             if (nVars == -1)
-            {
-                istringstream sin(&buff[11]);
-                string varName;
-                xScaled = yScaled = zScaled = false;
-                while (sin >> varName)
-                {
-                    if (varName == "id")
-                        idIndex = (int)varNames.size();
-                    else if (varName == "type")
-                        speciesIndex = (int)varNames.size();
-                    else if (varName == "x" || varName == "xs" || 
-                               varName == "xu" || varName == "xsu" )
-                        xIndex = (int)varNames.size();
-                    else if (varName == "y" || varName == "ys" ||
-                               varName == "yu" || varName == "ysu" )
-                        yIndex = (int)varNames.size();
-                    else if (varName == "z" || varName == "zs" ||
-                               varName == "zu" || varName == "zsu" )
-                        zIndex = (int)varNames.size();
-
-                    if (varName == "xs" || "xsu")
-                        xScaled = true;
-                    if (varName == "ys" || "ysu")
-                        yScaled = true;
-                    if (varName == "zs" || "zsu")
-                        zScaled = true;
-
-                    varNames.push_back(varName);
+                ParseAtomsHeader(line.substr(11));
 
-                }
-                nVars = (int)varNames.size();
-                if (nVars == 0)
-                {
-                    // OLD FORMAT: Assume "id type x y z"
-                    varNames.push_back("id");
-                    varNames.push_back("type");
-                    varNames.push_back("x");
-                    varNames.push_back("y");
-                    varNames.push_back("z");
-                    idIndex = 0;
-                    speciesIndex = 1;
-                    xIndex = 2; xScaled = false;
-                    yIndex = 3; yScaled = false;
-                    zIndex = 4; zScaled = false;
-                    nVars = (int)varNames.size();
-                }
-                vars.resize(nVars);
+            // skip over the atoms
+            int n = (nAtoms.size() == file_positions.size()) ? nAtoms.back() : 0;
+            for (int a=0; a<n && p<fileBytes; a++)
+            {
+                const char *eol = (const char*)memchr(file+p, '\n', fileBytes-p);
+                p = eol ? (eol - file) + 1 : fileBytes;
             }
+            block_ends.push_back(p);
         }
     }
+}
+
 
-    if (xIndex<0 || yIndex<0 || zIndex<0 || idIndex<0 || speciesIndex<0)
+// ****************************************************************************
+//  Method:  eavlLAMMPSDumpImporter::ParseAtomsHeader
+//
+//  Purpose:
+//    Find the variables, and which of them are the id, species and
+//    coordinates, from the names after "ITEM: ATOMS".
+//
+//  Arguments:
+//    header     the variable names
+//
+//  Programmer:  Jeremy Meredith
+//  Creation:    February  9, 2009
+//
+//  Modifications:
+//    Split out of ReadAllMetaData.  Only mark the coordinates as scaled
+//    when their names say so.
+//
+// ****************************************************************************
+void
+eavlLAMMPSDumpImporter::ParseAtomsHeader(const string &header)
+{
+    atomsHeader = header;
+    varNames.clear();
+    xIndex = yIndex = zIndex = speciesIndex = idIndex = -1;
+
+    istringstream sin(header);
+    string varName;
+    xScaled = yScaled = zScaled = false;
+    while (sin >> varName)
     {
-        THROW(eavlException, "Bad file " + filename +
-              ": Didn't get indices for all necessary vars");
+        if (varName == "id")
+            idIndex = (int)varNames.size();
+        else if (varName == "type")
+            speciesIndex = (int)varNames.size();
+        else if (varName == "x" || varName == "xs" || 
+                   varName == "xu" || varName == "xsu" )
+            xIndex = (int)varNames.size();
+        else if (varName == "y" || varName == "ys" ||
+                   varName == "yu" || varName == "ysu" )
+            yIndex = (int)varNames.size();
+        else if (varName == "z" || varName == "zs" ||
+                   varName == "zu" || varName == "zsu" )
+            zIndex = (int)varNames.size();
+
+        if (varName == "xs" || varName == "xsu")
+            xScaled = true;
+        if (varName == "ys" || varName == "ysu")
+            yScaled = true;
+        if (varName == "zs" || varName == "zsu")
+            zScaled = true;
+
+        varNames.push_back(varName);
+
     }
+    nVars = (int)varNames.size();
+    if (nVars == 0)
+    {
+        // OLD FORMAT: Assume "id type x y z"
+        varNames.push_back("id");
+        varNames.push_back("type");
+        varNames.push_back("x");
+        varNames.push_back("y");
+        varNames.push_back("z");
+        idIndex = 0;
+        speciesIndex = 1;
+        xIndex = 2; xScaled = false;
+        yIndex = 3; yScaled = false;
+        zIndex = 4; zScaled = false;
+        nVars = (int)varNames.size();
+    }
+    vars.resize(nVars);
+}
 
-    // don't read the meta data more than once
-    metaDataRead = true;
+
+// ****************************************************************************
+//  Method:  eavlLAMMPSDumpImporter::ReadIndex
+//
+//  Purpose:
+//    Read the meta data from the index file next to the dump.  Returns
+//    false, leaving the meta data alone, if there is no index or it was
+//    written for a different version of the dump.
+//
+//  Arguments:
+//    none
+//
+//  Creation:    October 17, 2026
+//
+//  Modifications:
+//
+// ****************************************************************************
+bool
+eavlLAMMPSDumpImporter::ReadIndex()
+{
+    ifstream idx(GetIndexFilename().c_str());
+    if (!idx)
+        return false;
+
+    string magic;
+    int version = 0;
+    long long size = -1, time = -1;
+    idx >> magic >> version >> size >> time;
+    if (!idx || magic != "eavlLAMMPSDumpIndex" || version != 1 ||
+        size != (long long)fileBytes || time != fileTime)
+        return false;
+
+    double bounds[6];
+    for (int i=0; i<6; i++)
+        idx >> bounds[i];
+    string header;
+    getline(idx, header); // rest of the bounds line
+    getline(idx, header);
+
+    int nsteps = -1;
+    idx >> nsteps;
+    if (!idx || nsteps < 0)
+        return false;
+    vector<int> stepCycles(nsteps), stepAtoms(nsteps);
+    vector<size_t> stepStarts(nsteps), stepEnds(nsteps);
+    for (int i=0; i<nsteps; i++)
+    {
+        idx >> stepCycles[i] >> stepAtoms[i] >> stepStarts[i] >> stepEnds[i];
+        if (!idx || stepAtoms[i] < 0 || stepStarts[i] > stepEnds[i] ||
+            stepEnds[i] > fileBytes)
+            return false;
+    }
+
+    // the atoms of the last time step should follow their item line
+    if (nsteps > 0)
+    {
+        const char item[] = "ITEM: ATOMS";
+        size_t p = stepStarts[nsteps-1];
+        if (p == 0 || file[p-1] != '\n')
+            return false;
+        size_t q = p - 1;
+        while (q > 0 && file[q-1] != '\n')
+            q--;
+        if (p - 1 - q < sizeof(item) - 1 ||
+            strncmp(file + q, item, sizeof(item) - 1) != 0)
+            return false;
+    }
+
+    xMin = bounds[0]; xMax = bounds[1];
+    yMin = bounds[2]; yMax = bounds[3];
+    zMin = bounds[4]; zMax = bounds[5];
+    ParseAtomsHeader(header);
+    nTimeSteps = nsteps;
+    cycles.swap(stepCycles);
+    nAtoms.swap(stepAtoms);
+    file_positions.swap(stepStarts);
+    block_ends.swap(stepEnds);
+    return true;
+}
+
+
+// ****************************************************************************
+//  Method:  eavlLAMMPSDumpImporter::WriteIndex
+//
+//  Purpose:
+//    Write the meta data to the index file next to the dump, by way of a
+//    temporary file so readers never see a partial index.  A dump in a
+//    directory we can't write to just goes without an index.
+//
+//  Arguments:
+//    none
+//
+//  Creation:    October 17, 2026
+//
+//  Modifications:
+//
+// ****************************************************************************
+void
+eavlLAMMPSDumpImporter::WriteIndex()
+{
+    if (int(cycles.size()) != nTimeSteps || int(nAtoms.size()) != nTimeSteps ||
+        int(file_positions.size()) != nTimeSteps || nVars < 0)
+        return;
+
+    string name = GetIndexFilename();
+    string tmpname = name + ".tmp";
+    {
+        ofstream out(tmpname.c_str());
+        if (!out)
+            return;
+        out << "eavlLAMMPSDumpIndex 1\n"
+            << fileBytes << " " << fileTime << "\n"
+            << setprecision(17)
+            << xMin << " " << xMax << " "
+            << yMin << " " << yMax << " "
+            << zMin << " " << zMax << "\n"
+            << atomsHeader << "\n"
+            << nTimeSteps << "\n";
+        for (int i=0; i<nTimeSteps; i++)
+        {
+            out << cycles[i] << " " << nAtoms[i] << " "
+                << file_positions[i] << " " << block_ends[i] << "\n";
+        }
+        if (!out)
+        {
+            out.close();
+            remove(tmpname.c_str());
+            return;
+        }
+    }
+    if (rename(tmpname.c_str(), name.c_str()) != 0)
+        remove(tmpname.c_str());
 }
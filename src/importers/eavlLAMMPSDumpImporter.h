@@ -17,12 +17,20 @@
 // Creation:    December 18, 2013
 //
 // Modifications:
+//   The file is mapped and each time step's atoms are parsed in parallel.
+//   The position and atom count of every time step are kept in an index
+//   file next to the dump, so reopening the dump doesn't scan it again.
+//
 // ****************************************************************************
 class eavlLAMMPSDumpImporter : public eavlImporter
 {
   public:
     eavlLAMMPSDumpImporter(const string &fn)
     {
+        file = NULL;
+        fileBytes = 0;
+        mapped = false;
+        fileTime = 0;
         currentTimestep = -1;
         metaDataRead = false;
         filename = fn;
@@ -34,6 +42,7 @@ class eavlLAMMPSDumpImporter : public eavlImporter
     }
     virtual ~eavlLAMMPSDumpImporter()
     {
+        Unmap();
     }
 
     virtual vector<string> GetDiscreteDimNames()
@@ -69,10 +78,18 @@ class eavlLAMMPSDumpImporter : public eavlImporter
     eavlDataSet   *GetMesh(const string &name, int chunk);
     eavlField     *GetField(const string &name, const string &mesh, int chunk);
 
+    /// The index file kept next to the dump.
+    string GetIndexFilename() { return filename + ".eavlidx"; }
+
   protected:
-    ifstream                           in;
+    const char                        *file;
+    size_t                             fileBytes;
+    bool                               mapped;
+    long long                          fileTime;
     std::vector<int>                   cycles;
-    std::vector<istream::pos_type>     file_positions;
+    std::vector<size_t>                file_positions;
+    std::vector<size_t>                block_ends;
+    std::string                        atomsHeader;
     std::string                        filename;
     bool                               metaDataRead;
     int                                nTimeSteps;
@@ -90,9 +107,14 @@ class eavlLAMMPSDumpImporter : public eavlImporter
     std::vector<int>                   speciesVar, idVar;
     std::vector< std::string >         varNames;
 
-    void OpenFileAtBeginning();
+    void Map();
+    void Unmap();
     void ReadTimeStep(int);
     void ReadAllMetaData();
+    void ScanFile();
+    bool ReadIndex();
+    void WriteIndex();
+    void ParseAtomsHeader(const string &header);
 };
 
 #endif
@@ -3,6 +3,7 @@
 #include "eavlPDBImporter.h"
 
 #include "eavlAtomicProperties.h"
+#include "eavlBondFinder.h"
 #include "eavlCellSetExplicit.h"
 #include <cstring>
 
@@ -13,12 +14,12 @@ eavlPDBImporter::eavlPDBImporter(const string &fn)
 
     nmodels = 0;
     metadata_read = false;
+    bonds_created = false;
     dbTitle = "";
 }
 
 eavlPDBImporter::~eavlPDBImporter()
 {
-    bonds.clear();
     for (size_t i=0; i<allatoms.size(); i++)
     {
         allatoms[i].clear();
@@ -94,15 +95,7 @@ eavlPDBImporter::GetMesh(const string &mesh, int)
     // skip for now
 
     // bonds cell set:
-    eavlCellSetExplicit *bondcells = new eavlCellSetExplicit("bonds", 1);
-    eavlExplicitConnectivity bondconn;
-    for (size_t i=0; i<bonds.size(); i++)
-    {
-        int ix[2] = {bonds[i].first,bonds[i].second};
-        bondconn.AddElement(EAVL_BEAM, 2, ix);
-    }
-    bondcells->SetCellNodeConnectivity(bondconn);
-    data->AddCellSet(bondcells);
+    data->AddCellSet(bondFinder.CreateCellSet("bonds"));
 
     return data;
 }
@@ -163,256 +156,6 @@ eavlPDBImporter::GetField(const string &varname, const string &mesh, int chunk)
 }
 
 
-// ****************************************************************************
-//  Function:  AtomsShouldBeBonded
-//
-//  Purpose:
-///   Simple but effective test to see if two atoms are bonded.
-//
-//  Arguments:
-//    atoms      all atoms
-//    a1,a2      two atom indices
-//
-//  Programmer:  Jeremy Meredith
-//  Creation:    March 23, 2006
-//
-// ****************************************************************************
-
-bool
-eavlPDBImporter::AtomsShouldBeBonded(const vector<eavlPDBImporter::Atom> &atoms, int a1, int a2)
-{
-    float dx = atoms[a1].x - atoms[a2].x;
-    float dy = atoms[a1].y - atoms[a2].y;
-    float dz = atoms[a1].z - atoms[a2].z;
-    float dist2 = dx*dx + dy*dy + dz*dz;
-    if (dist2 > .4*.4)
-    {
-        if (atoms[a1].atomicnumber==1 ||
-            atoms[a2].atomicnumber==1)
-        {
-            if (dist2 < 1.2*1.2)
-            {
-                return true;
-            }
-        }
-        else
-        {
-            if (dist2 < 1.9*1.9)
-            {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
-// ****************************************************************************
-//  Method:  eavlPDBImporter::CreateBondsFromModel_Slow
-//
-//  Purpose:
-///   Search all appropriate atom pairs for bonds using a slower algorithm.
-//
-//  Arguments:
-//    model      the model index to use for distance tests
-//
-//  Programmer:  Jeremy Meredith
-//  Creation:    March 23, 2006
-//
-//  Modifications:
-//    Jeremy Meredith, Mon Aug 28 17:49:30 EDT 2006
-//    Bonds are now line segment cells, not an atom-centered 4-comp array.
-//
-// ****************************************************************************
-void
-eavlPDBImporter::CreateBondsFromModel_Slow(int model)
-{
-    // We should only have to create bonds once for all models
-    if (bonds.size() > 0)
-        return;
-
-    vector<Atom> &atoms = allatoms[model];
-    int natoms = atoms.size();
-    bonds.reserve(natoms);  // just a guess
-
-    //
-    // This is an N^2 algorithm.  Slow, but safe.
-    // Don't use it unless there's something wrong
-    // with the fast one.
-    //
-    for (int i=0; i<natoms; i++)
-    {
-        for (int j=0; j<i; j++)
-        {
-            if (AtomsShouldBeBonded(atoms,i,j))
-            {
-                bonds.push_back(pair<int,int>(i,j));
-            }
-        }
-    }
-}
-
-// ****************************************************************************
-//  Method:  eavlPDBImporter::CreateBondsFromModel_Fast
-//
-//  Purpose:
-///   Search all appropriate atom pairs for bonds using a faster algorithm.
-//
-//  Arguments:
-//    model      the model index to use for distance tests
-//
-//  Programmer:  Jeremy Meredith
-//  Creation:    March 23, 2006
-//
-//  Modifications:
-//    Jeremy Meredith, Mon Aug 28 17:49:30 EDT 2006
-//    Bonds are now line segment cells, not an atom-centered 4-comp array.
-//
-//    Jeremy Meredith, Wed Apr 18 11:02:04 EDT 2007
-//    Account for potentially zero atoms.  This only seemed to appear
-//    when there was a parsing problem with the file, so maybe it should
-//    be changed to throw an error in ReadAtomsForModel()?
-//
-// ****************************************************************************
-void
-eavlPDBImporter::CreateBondsFromModel_Fast(int model)
-{
-    // We should only have to create bonds once for all models
-    if (bonds.size() > 0)
-        return;
-
-    vector<Atom> &atoms = allatoms[model];
-    int natoms = atoms.size();
-    if (natoms <= 0)
-        return;
-
-    //
-    // The strategy here is to divide atoms into 3D spatial bins
-    // and compare atoms in some (i,j,k) bin with all atoms in
-    // the 27 surrounding bins -- i.e. (i-1,j-1,k-1) thru
-    // (i+1,j+1,k+1) -- to find ones that should be bonded.
-    //
-    // This means that the size of each bin, determined by
-    // the value "maxBondDist", should truly at least as
-    // large as the maximum bond distance, or else this
-    // will fail to catch some bonds.
-    //
-    // Simultaneously, setting maxBondDist too large means
-    // that too many atoms must be compared for bonds, and
-    // will likely slow down the algorithm.
-    //
-    float maxBondDist = 3.0;
-
-    float minx =  FLT_MAX;
-    float maxx = -FLT_MAX;
-    float miny =  FLT_MAX;
-    float maxy = -FLT_MAX;
-    float minz =  FLT_MAX;
-    float maxz = -FLT_MAX;
-
-    for (int a=0; a<natoms; a++)
-    {
-        Atom &atom = atoms[a];
-        if (atom.x < minx)
-            minx = atom.x;
-        if (atom.x > maxx)
-            maxx = atom.x;
-        if (atom.y < miny)
-            miny = atom.y;
-        if (atom.y > maxy)
-            maxy = atom.y;
-        if (atom.z < minz)
-            minz = atom.z;
-        if (atom.z > maxz)
-            maxz = atom.z;
-    }
-
-    float szx = maxx - minx;
-    float szy = maxy - miny;
-    float szz = maxz - minz;
-
-    int ni = 1 + int(szx / maxBondDist);
-    int nj = 1 + int(szy / maxBondDist);
-    int nk = 1 + int(szz / maxBondDist);
-
-    //
-    // I know -- I'm using a grid of STL vectors, and this
-    // could potentially be inefficient, but I'll wait until
-    // I see a problem with this strategy before I change it.
-    //
-    typedef vector<int> intvec;
-    intvec *atomgrid = new intvec[ni*nj*nk];
-
-    for (int a=0; a<natoms; a++)
-    {
-        Atom &atom = atoms[a];
-        int ix = int((atom.x - minx) / maxBondDist);
-        int jx = int((atom.y - miny) / maxBondDist);
-        int kx = int((atom.z - minz) / maxBondDist);
-        atomgrid[ix + ni*(jx + nj*(kx))].push_back(a);
-    }
-
-    for (int i=0; i<ni; i++)
-    {
-        for (int j=0; j<nj; j++)
-        {
-            for (int k=0; k<nk; k++)
-            {
-                int index1 = i + ni*(j + nj*(k));
-                int na = atomgrid[index1].size();
-                for (int a=0; a<na; a++)
-                {
-                    int ctr = 0;
-                    int a1 = atomgrid[index1][a];
-                    for (int p=-1; p<=1 && ctr<4; p++)
-                    {
-                        int ii = i+p;
-                        if (ii<0 || ii>=ni)
-                            continue;
-
-                        for (int q=-1; q<=1 && ctr<4; q++)
-                        {
-                            int jj = j+q;
-                            if (jj<0 || jj>=nj)
-                                continue;
-
-                            for (int r=-1; r<=1 && ctr<4; r++)
-                            {
-                                int kk = k+r;
-                                if (kk<0 || kk>=nk)
-                                    continue;
-
-                                int index2 = ii + ni*(jj + nj*(kk));
-                                int naa = atomgrid[index2].size();
-                                for (int aa=0; aa<naa && ctr<4; aa++)
-                                {
-                                    if (index1==index2 && a==aa)
-                                        continue;
-
-                                    int a2 = atomgrid[index2][aa];
-
-                                    // Only create one direction of
-                                    // each bond pair
-                                    if (a1 > a2)
-                                        continue;
-
-                                    if (AtomsShouldBeBonded(atoms,a1,a2))
-                                    {
-                                        bonds.push_back(pair<int,int>(a1,a2));
-                                        ctr++;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    delete[] atomgrid;
-}
-
-
 // ****************************************************************************
 //  Method:  eavlPDBImporter::ReadAllMetaData
 //
@@ -702,11 +445,33 @@ eavlPDBImporter::ReadAtomsForModel(int model)
 //  Programmer:  Jeremy Meredith
 //  Creation:    August 28, 2006
 //
+//  Modifications:
+//    Find the bonds from covalent radii with the parallel cell list
+//    search of eavlBondFinder, replacing the serial binned search and
+//    the all-pairs search with fixed distance thresholds.
+//
 // ****************************************************************************
 void
 eavlPDBImporter::CreateBondsFromModel(int model)
 {
-    CreateBondsFromModel_Fast(model);
+    // We should only have to create bonds once for all models
+    if (bonds_created)
+        return;
+
+    vector<Atom> &atoms = allatoms[model];
+    int natoms = atoms.size();
+    vector<float> x(natoms), y(natoms), z(natoms);
+    vector<int> elements(natoms);
+    for (int a=0; a<natoms; a++)
+    {
+        x[a] = atoms[a].x;
+        y[a] = atoms[a].y;
+        z[a] = atoms[a].z;
+        elements[a] = atoms[a].atomicnumber;
+    }
+    if (natoms > 0)
+        bondFinder.FindBonds(natoms, &x[0], &y[0], &z[0], &elements[0]);
+    bonds_created = true;
     
 #if 0 // to generate bonds from CONECT records, re-enable this
 
@@ -5,6 +5,7 @@
 #include "STL.h"
 #include "eavlDataSet.h"
 #include "eavlImporter.h"
+#include "eavlBondFinder.h"
 
 // ****************************************************************************
 // Class:  eavlPDBImporter
@@ -16,6 +17,9 @@
 // Creation:    July 26, 2012
 //
 // Modifications:
+//   Bonds come from eavlBondFinder, which searches a cell list in
+//   parallel using the covalent radii of the atoms.
+//
 // ****************************************************************************
 class eavlPDBImporter : public eavlImporter
 {
@@ -71,9 +75,10 @@ class eavlPDBImporter : public eavlImporter
     ifstream in;
 
     bool metadata_read;
+    bool bonds_created;
     int  nmodels;
     std::vector< std::vector<Atom> >    allatoms;
-    std::vector< std::pair<int, int> >  bonds;
+    eavlBondFinder                      bondFinder;
 
     std::vector<ConnectRecord>       connect;
     std::vector<std::string>         compoundNames;
@@ -82,13 +87,10 @@ class eavlPDBImporter : public eavlImporter
     std::string dbTitle;
 
 
-    static bool AtomsShouldBeBonded(const vector<Atom> &atoms, int a1, int a2);
     void OpenFileAtBeginning();
     void ReadAllMetaData();
     void ReadAtomsForModel(int);
     void CreateBondsFromModel(int);
-    void CreateBondsFromModel_Slow(int);
-    void CreateBondsFromModel_Fast(int);
 };
 
 #endif
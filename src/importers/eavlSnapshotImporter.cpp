@@ -0,0 +1,180 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlSnapshotImporter.h"
+#include "eavlException.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// a field array wrapping the values of a, or NULL if a is another type
+template <class T>
+static eavlArray *WrapArray(eavlArray *a)
+{
+    eavlConcreteArray<T> *c = dynamic_cast<eavlConcreteArray<T>*>(a);
+    if (!c)
+        return NULL;
+    return new eavlConcreteArray<T>(eavlArray::HOST, (T*)c->GetHostArray(),
+                                    c->GetName(), c->GetNumberOfComponents(),
+                                    c->GetNumberOfTuples());
+}
+
+static eavlArray *WrapArray(eavlArray *a)
+{
+    eavlArray *w = WrapArray<float>(a);
+    if (!w)
+        w = WrapArray<int>(a);
+    if (!w)
+        w = WrapArray<byte>(a);
+    if (!w)
+        THROW(eavlException, "Unexpected array type in snapshot");
+    return w;
+}
+
+eavlSnapshotImporter::eavlSnapshotImporter(const string &filename)
+    : file(NULL), fileBytes(0), mapped(false), data(NULL), meshReturned(false)
+{
+    Map(filename);
+
+    eavlSnapshotHeader header;
+    if (fileBytes < sizeof(header) || !eavlSnapshotHeader::HasMagic(file))
+    {
+        Unmap();
+        THROW(eavlException, filename + " is not an EAVL snapshot");
+    }
+    memcpy(&header, file, sizeof(header));
+
+    string error;
+    if (header.version > eavlSnapshotHeader::CurrentVersion)
+        error = "was written by a newer version of EAVL";
+    else if (header.byteOrder != eavlSnapshotHeader::ByteOrderMark)
+        error = "was written with a different byte order";
+    else if (header.sizeofSize != sizeof(size_t) ||
+             header.sizeofIndex != sizeof(eavlIndex))
+        error = "was written with a different size_t or index width";
+    else if (header.metadataOffset > fileBytes ||
+             header.metadataBytes > fileBytes - header.metadataOffset ||
+             header.payloadOffset > fileBytes ||
+             header.payloadBytes > fileBytes - header.payloadOffset)
+        error = "is truncated";
+    if (!error.empty())
+    {
+        Unmap();
+        THROW(eavlException, filename + " " + error);
+    }
+
+    try
+    {
+        string metadata(file + header.metadataOffset, header.metadataBytes);
+        istringstream in(metadata, ios::in | ios::binary);
+        eavlSnapshotStream s(in, file + header.payloadOffset,
+                             header.payloadBytes);
+        data = new eavlDataSet;
+        data->deserialize(s);
+        if (!in)
+            THROW(eavlException, filename + " is corrupt");
+    }
+    catch (...)
+    {
+        delete data;
+        Unmap();
+        throw;
+    }
+
+    for (int i = 0; i < data->GetNumFields(); i++)
+    {
+        eavlField *f = data->GetField(i);
+        fields[f->GetArray()->GetName()] =
+            new eavlField(f, WrapArray(f->GetArray()));
+    }
+    for (int i = 0; i < data->GetNumCellSets(); i++)
+        cellSetNames.push_back(data->GetCellSet(i)->GetName());
+}
+
+eavlSnapshotImporter::~eavlSnapshotImporter()
+{
+    for (map<string, eavlField*>::iterator it = fields.begin();
+         it != fields.end(); ++it)
+        delete it->second;
+    if (!meshReturned)
+        delete data;
+    Unmap();
+}
+
+eavlDataSet *
+eavlSnapshotImporter::GetMesh(const string &, int)
+{
+    meshReturned = true;
+    return data;
+}
+
+eavlField *
+eavlSnapshotImporter::GetField(const string &name, const string &, int)
+{
+    map<string, eavlField*>::iterator it = fields.find(name);
+    if (it == fields.end())
+        THROW(eavlException, "Couldn't find field " + name + " in snapshot");
+    return new eavlField(it->second, WrapArray(it->second->GetArray()));
+}
+
+void
+eavlSnapshotImporter::Map(const string &filename)
+{
+#if !defined(_WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        THROW(eavlException, "Couldn't open " + filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        THROW(eavlException, "Couldn't stat " + filename);
+    }
+    fileBytes = st.st_size;
+    if (fileBytes > 0)
+    {
+        // private and writable, so writes through a host pointer go to
+        // copies of the pages and never reach the file
+        void *p = mmap(NULL, fileBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                       fd, 0);
+        if (p != MAP_FAILED)
+        {
+            file = (char*)p;
+            mapped = true;
+        }
+    }
+    close(fd);
+    if (mapped || fileBytes == 0)
+        return;
+#endif
+
+    // no mapping: read the whole file instead
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in)
+        THROW(eavlException, "Couldn't open " + filename);
+    in.seekg(0, ios::end);
+    fileBytes = in.tellg();
+    in.seekg(0, ios::beg);
+    file = new char[fileBytes > 0 ? fileBytes : 1];
+    in.read(file, fileBytes);
+    if (!in)
+    {
+        Unmap();
+        THROW(eavlException, "Error reading " + filename);
+    }
+}
+
+void
+eavlSnapshotImporter::Unmap()
+{
+#if !defined(_WIN32)
+    if (mapped)
+        munmap(file, fileBytes);
+    else
+#endif
+        delete[] file;
+    file = NULL;
+    mapped = false;
+}
@@ -0,0 +1,54 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_SNAPSHOT_IMPORTER_H
+#define EAVL_SNAPSHOT_IMPORTER_H
+
+#include "STL.h"
+#include "eavlDataSet.h"
+#include "eavlImporter.h"
+
+// ****************************************************************************
+// Class:  eavlSnapshotImporter
+//
+// Purpose:
+///   Open a snapshot written by eavlSnapshotExporter.  The file is mapped
+///   and only the serialized structure is read; each field array wraps
+///   its values in the mapping as an external host array, so opening is
+///   quick whatever the size of the fields, and the pages of a field are
+///   read only once it is used.  The mapping is private, so the file is
+///   never modified.
+///
+///   GetMesh returns the whole data set, fields included, so
+///   GetFieldList is empty; GetField returns a new field wrapping the
+///   same values.  The mapping lives as long as the importer, so delete
+///   the data set and fields it returned before deleting the importer.
+//
+// Creation:    October 17, 2026
+//
+// ****************************************************************************
+class eavlSnapshotImporter : public eavlImporter
+{
+  public:
+    eavlSnapshotImporter(const string &filename);
+    ~eavlSnapshotImporter();
+
+    int                 GetNumChunks(const std::string &) { return 1; }
+    vector<string>      GetFieldList(const std::string &) { return vector<string>(); }
+    vector<string>      GetCellSetList(const std::string &) { return cellSetNames; }
+
+    eavlDataSet   *GetMesh(const string &name, int chunk);
+    eavlField     *GetField(const string &name, const string &mesh, int chunk);
+
+  protected:
+    char                    *file;
+    size_t                   fileBytes;
+    bool                     mapped;
+    eavlDataSet             *data;
+    bool                     meshReturned;
+    map<string, eavlField*>  fields;
+    vector<string>           cellSetNames;
+
+    void Map(const string &filename);
+    void Unmap();
+};
+
+#endif
@@ -3,10 +3,17 @@
 #include "eavlCellSetExplicit.h"
 #include "eavlCellSetAllStructured.h"
 #include "eavlException.h"
+#include "eavlUtility.h"
 
 #include <cstring>
+#include <cstdlib>
 
-bool debug =false;
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 
 template <int T>
@@ -56,19 +63,29 @@ inline void byte_swap_element<8>(char *p)
     p[4] = val;
 }
 
-// oddly, this is already defined.  neat!
-//#define LITTLE_ENDIAN
+// binary legacy files are big-endian.  (LITTLE_ENDIAN from the system
+// headers is only the name of a byte order, not the host's, so check.)
+static bool HostIsLittleEndian()
+{
+    unsigned int one = 1;
+    return *reinterpret_cast<unsigned char*>(&one) == 1;
+}
 
+// a big-endian value of type T at p, which needn't be aligned
 template <class T>
-inline void byte_swap(vector<T> &v)
+inline T ReadBigEndian(const char *p, bool swap)
 {
-#ifdef LITTLE_ENDIAN
-    int n = v.size();
-    for (int e=0; e<n; e++)
-    {
-        byte_swap_element<sizeof(T)>(reinterpret_cast<char*>(&(v[e])));
-    }
-#endif
+    T t;
+    memcpy(&t, p, sizeof(T));
+    if (swap)
+        byte_swap_element<sizeof(T)>(reinterpret_cast<char*>(&t));
+    return t;
+}
+
+inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' ||
+           c == '\f' || c == '\v';
 }
 
 // ----------------------------------------------------------------------------
@@ -202,181 +219,231 @@ eavlVTKImporter::StringFromDataSetType(eavlVTKImporter::DataSetType dst)
 
 
 
+bool eavlVTKImporter::ReadLine(char *line)
+{
+    if (pos >= fileBytes)
+    {
+        line[0] = '\0';
+        return false;
+    }
+    const char *start = file + pos;
+    const char *nl = (const char*)memchr(start, '\n', fileBytes - pos);
+    size_t len = nl ? size_t(nl - start) : fileBytes - pos;
+    pos += nl ? len + 1 : len;
+    if (len > 0 && start[len-1] == '\r')
+        len--;
+    if (len > 4095)
+        len = 4095;
+    memcpy(line, start, len);
+    line[len] = '\0';
+    return true;
+}
+
+void eavlVTKImporter::SkipLine()
+{
+    if (pos >= fileBytes)
+        return;
+    const char *nl = (const char*)memchr(file + pos, '\n', fileBytes - pos);
+    pos = nl ? size_t(nl - file) + 1 : fileBytes;
+}
+
+string eavlVTKImporter::ReadToken()
+{
+    while (pos < fileBytes && IsSpace(file[pos]))
+        pos++;
+    size_t start = pos;
+    while (pos < fileBytes && !IsSpace(file[pos]))
+        pos++;
+    return string(file + start, pos - start);
+}
+
 bool eavlVTKImporter::GetNextLine()
 {
     // skip blank lines
     // turn keywords into uppercase
-    strcpy(buff, "");
-    if (debug) cerr << "++ initialized to null\n";
+    buff[0] = '\0';
     while (buff[0] == '\0')
     {
-        if (debug) cerr << "++ entered pass\n";
-        is->getline(buff, 4096);
-        if (debug) cerr << "++ got buff; len="<<strlen(buff)<<endl;
-        if (debug) cerr << "++ buff first byte = "<<int(buff[0])<<endl;
-        if (!(*is) || is->eof())
+        if (!ReadLine(buff))
+        {
+            atEnd = true;
             return false;
-        if (debug) cerr << "++ not eof or bad\n";
+        }
     }
-    if (debug) cerr << "++ breaking out of loop\n";
     strcpy(bufforig,buff);
     toupper(buff);
     return true;
 }
 
-template <class IT, class OT>
-inline void BinaryReadThenCopyToVector(istream *is, int n, vector<OT> &v)
+template <class T>
+void
+eavlVTKImporter::ReadAsciiValues(eavlIndex n, T *out)
 {
-    vector<IT> t(n);
-    is->read(reinterpret_cast<char*>(&t[0]), sizeof(IT) * n);
-    byte_swap(t); // meaningless for size 1 types, of course
-    for (int i=0; i<n; i++) v[i] = OT(t[i]);
+    // a quick serial scan finds where each block of values starts, and
+    // the expensive part, converting them, is done a block per thread
+    const eavlIndex blockSize = 8192;
+    eavlIndex nblocks = (n + blockSize - 1) / blockSize;
+    vector<size_t> blockStart(nblocks);
+    size_t p = pos;
+    for (eavlIndex i = 0; i < n; i++)
+    {
+        while (p < fileBytes && IsSpace(file[p]))
+            p++;
+        if (p >= fileBytes)
+            THROW(eavlException, "Unexpected end of file reading values");
+        if (i % blockSize == 0)
+            blockStart[i / blockSize] = p;
+        while (p < fileBytes && !IsSpace(file[p]))
+            p++;
+    }
+    pos = p;
+
+    const char *f = file;
+    const char *end = file + p;
+    int nbad = 0;
+#pragma omp parallel for reduction(+:nbad)
+    for (eavlIndex b = 0; b < nblocks; b++)
+    {
+        const char *c = f + blockStart[b];
+        eavlIndex last = std::min(n, (b + 1) * blockSize);
+        for (eavlIndex i = b * blockSize; i < last; i++)
+        {
+            while (IsSpace(*c))
+                c++;
+            const char *e = c;
+            while (e < end && !IsSpace(*e))
+                e++;
+            double v = 0;
+            if (!ParseNumber(c, e, v))
+                nbad++;
+            out[i] = T(v);
+            c = e;
+        }
+    }
+    if (nbad > 0)
+        THROW(eavlException, "Couldn't parse a numeric value");
 }
 
-template <class IT>
-inline void BinaryReadThenCopyToArray(istream *is, int nt, int nc, eavlArray *arr)
+template <class IT, class T>
+void
+eavlVTKImporter::ReadBinaryValues(eavlIndex n, T *out)
 {
-    vector<IT> t(nt*nc);
-    is->read(reinterpret_cast<char*>(&t[0]), sizeof(IT) * nt*nc);
-    byte_swap(t);
-    for(int i = 0; i < nt; i++)
-        for (int j = 0; j < nc; j++)
-            arr->SetComponentFromDouble(i, j, t[i]);
+    if (size_t(n) > (fileBytes - pos) / sizeof(IT))
+        THROW(eavlException, "Unexpected end of file reading binary values");
+    const char *f = file + pos;
+    bool swap = HostIsLittleEndian();
+#pragma omp parallel for
+    for (eavlIndex i = 0; i < n; i++)
+        out[i] = T(ReadBigEndian<IT>(f + i * sizeof(IT), swap));
+    pos += size_t(n) * sizeof(IT);
 }
 
+template <class T>
 void
-eavlVTKImporter::ReadIntoArray(DataType dt, eavlArray *arr)
+eavlVTKImporter::ReadBinaryBits(eavlIndex n, T *out)
 {
-    int nt = arr->GetNumberOfTuples();
-    int nc = arr->GetNumberOfComponents();
+    // packed eight to a byte, first value in the high bit
+    size_t nbytes = (size_t(n) + 7) / 8;
+    if (nbytes > fileBytes - pos)
+        THROW(eavlException, "Unexpected end of file reading binary bits");
+    const unsigned char *f = (const unsigned char*)file + pos;
+#pragma omp parallel for
+    for (eavlIndex i = 0; i < n; i++)
+        out[i] = T((f[i / 8] >> (7 - i % 8)) & 1);
+    pos += nbytes;
+}
 
+template <class T>
+void
+eavlVTKImporter::ReadValues(eavlIndex n, DataType dt, T *out)
+{
     if (binary)
     {
         switch (dt)
         {
           case dt_bit:
-            THROW(eavlException,"don't know how to support bits in binary files");
+            ReadBinaryBits(n, out);
+            break;
 
           case dt_unsigned_char:
-            BinaryReadThenCopyToArray<unsigned char>(is, nt, nc, arr);
+            ReadBinaryValues<unsigned char>(n, out);
             break;
 
           case dt_char:
-            BinaryReadThenCopyToArray<char>(is, nt, nc, arr);
+            ReadBinaryValues<char>(n, out);
             break;
 
           case dt_unsigned_short:
-            BinaryReadThenCopyToArray<unsigned short>(is, nt, nc, arr);
+            ReadBinaryValues<unsigned short>(n, out);
             break;
 
           case dt_short:
-            BinaryReadThenCopyToArray<signed short>(is, nt, nc, arr);
+            ReadBinaryValues<signed short>(n, out);
             break;
 
           case dt_unsigned_int:
-            BinaryReadThenCopyToArray<unsigned int>(is, nt, nc, arr);
+            ReadBinaryValues<unsigned int>(n, out);
             break;
 
           case dt_int:
-            BinaryReadThenCopyToArray<signed int>(is, nt, nc, arr);
+            ReadBinaryValues<signed int>(n, out);
             break;
 
           case dt_unsigned_long:
-            BinaryReadThenCopyToArray<unsigned long>(is, nt, nc, arr);
+            ReadBinaryValues<unsigned long>(n, out);
             break;
 
           case dt_long:
-            BinaryReadThenCopyToArray<signed long>(is, nt, nc, arr);
+            ReadBinaryValues<signed long>(n, out);
             break;
 
           case dt_float:
-            BinaryReadThenCopyToArray<float>(is, nt, nc, arr);
+            ReadBinaryValues<float>(n, out);
             break;
 
           case dt_double:
-            BinaryReadThenCopyToArray<double>(is, nt, nc, arr);
+            ReadBinaryValues<double>(n, out);
             break;
 
           default:
-            THROW(eavlException,"incorrect DataType for eavlArray");
-
-        }       
-        is->getline(buff, 4096); // skip the EOL
+            THROW(eavlException,"incorrect DataType");
+        }
     }
     else
     {
-        double v;
-        for(int i = 0; i < nt; i++)
-            for(int j = 0; j < nc; j++)
-            {
-                (*is) >> v;
-                arr->SetComponentFromDouble(i, j, v);
-            }
-        is->getline(buff,4096); // skip the EOL
+        ReadAsciiValues(n, out);
     }
+    SkipLine(); // skip the EOL
 }
 
-template <class T>
 void
-eavlVTKImporter::ReadIntoVector(int n,DataType dt,vector<T> &v)
+eavlVTKImporter::ReadIntoArray(DataType dt, eavlArray *arr)
 {
-    v.resize(n);
-    if (binary)
-    {
-        switch (dt)
-        {
-          case dt_bit:
-            THROW(eavlException,"don't know how to support bits in binary files");
-
-          case dt_unsigned_char:
-            BinaryReadThenCopyToVector<unsigned char>(is, n, v);
-            break;
-
-          case dt_char:
-            BinaryReadThenCopyToVector<char>(is, n, v);
-            break;
-
-          case dt_unsigned_short:
-            BinaryReadThenCopyToVector<unsigned short>(is, n, v);
-            break;
-
-          case dt_short:
-            BinaryReadThenCopyToVector<signed short>(is, n, v);
-            break;
-
-          case dt_unsigned_int:
-            BinaryReadThenCopyToVector<unsigned int>(is, n, v);
-            break;
-
-          case dt_int:
-            BinaryReadThenCopyToVector<signed int>(is, n, v);
-            break;
-
-          case dt_unsigned_long:
-            BinaryReadThenCopyToVector<unsigned long>(is, n, v);
-            break;
-
-          case dt_long:
-            BinaryReadThenCopyToVector<signed long>(is, n, v);
-            break;
-
-          case dt_float:
-            BinaryReadThenCopyToVector<float>(is, n, v);
-            break;
-
-          case dt_double:
-            BinaryReadThenCopyToVector<double>(is, n, v);
-            break;
+    eavlIndex nt = arr->GetNumberOfTuples();
+    int nc = arr->GetNumberOfComponents();
+    eavlIndex n = nt * nc;
 
-        }       
-        is->getline(buff, 4096); // skip the EOL
-    }
-    else
+    // float arrays, which is all we create, are filled in place
+    eavlFloatArray *farr = dynamic_cast<eavlFloatArray*>(arr);
+    if (farr && n > 0)
     {
-        for (int i=0; i<n; i++)
-            (*is) >> v[i];
-        is->getline(buff,4096); // skip the EOL
+        ReadValues(n, dt, (float*)farr->GetHostArray());
+        return;
     }
+
+    vector<double> v;
+    ReadIntoVector(n, dt, v);
+    for(eavlIndex i = 0; i < nt; i++)
+        for (int j = 0; j < nc; j++)
+            arr->SetComponentFromDouble(i, j, v[i*nc+j]);
+}
+
+template <class T>
+void
+eavlVTKImporter::ReadIntoVector(eavlIndex n,DataType dt,vector<T> &v)
+{
+    v.resize(n);
+    ReadValues(n, dt, n > 0 ? &v[0] : (T*)NULL);
 }
 
 /*
@@ -419,26 +486,91 @@ eavlVTKImporter::Print(ostream &out)
 */
 
 eavlVTKImporter::eavlVTKImporter(const string &filename)
+    : file(NULL), fileBytes(0), pos(0), mapped(false), atEnd(false)
 {
-    is = new ifstream(filename.c_str(), ios::in);
-    if (is->fail())
-        THROW(eavlException, string("Could not open file ")+filename);
-
-    Import();
+    Map(filename);
+    try
+    {
+        Import();
+    }
+    catch (...)
+    {
+        Unmap();
+        throw;
+    }
+    // everything has been copied out of the file by now
+    Unmap();
 }
 
 eavlVTKImporter::eavlVTKImporter(const char *data, size_t len)
+    : file(data), fileBytes(len), pos(0), mapped(false), atEnd(false)
 {
-    string str(data, len);
-    is = new istringstream(str);
     Import();
+    file = NULL;
 }
 
 eavlVTKImporter::~eavlVTKImporter()
 {
-    if (is)
-        delete is;
-    is = NULL;
+}
+
+void
+eavlVTKImporter::Map(const string &filename)
+{
+#if !defined(_WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        THROW(eavlException, string("Could not open file ")+filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        THROW(eavlException, string("Could not stat file ")+filename);
+    }
+    fileBytes = st.st_size;
+    if (fileBytes > 0)
+    {
+        void *p = mmap(NULL, fileBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+        {
+            madvise(p, fileBytes, MADV_SEQUENTIAL);
+            file = (const char*)p;
+            mapped = true;
+        }
+    }
+    close(fd);
+    if (mapped || fileBytes == 0)
+        return;
+#endif
+
+    // no mapping: read the whole file instead
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    if (!in)
+        THROW(eavlException, string("Could not open file ")+filename);
+    in.seekg(0, ios::end);
+    fileBytes = in.tellg();
+    in.seekg(0, ios::beg);
+    char *contents = new char[fileBytes > 0 ? fileBytes : 1];
+    in.read(contents, fileBytes);
+    file = contents;
+    if (!in)
+    {
+        Unmap();
+        THROW(eavlException, string("Error reading file ")+filename);
+    }
+}
+
+void
+eavlVTKImporter::Unmap()
+{
+#if !defined(_WIN32)
+    if (mapped)
+        munmap(const_cast<char*>(file), fileBytes);
+    else
+#endif
+        delete[] file;
+    file = NULL;
+    fileBytes = 0;
+    mapped = false;
 }
 
 void
@@ -493,7 +625,7 @@ eavlVTKImporter::GetField(const string &name, const string &mesh, int chunk)
 void
 eavlVTKImporter::ParseVersion()
 {
-    is->getline(buff, 4096);
+    ReadLine(buff);
     toupper(buff);
     string line(buff);
     if (line != "# VTK DATAFILE VERSION 1.0" &&
@@ -510,7 +642,7 @@ eavlVTKImporter::ParseVersion()
 void
 eavlVTKImporter::ParseHeader()
 {
-    is->getline(buff, 4096);
+    ReadLine(buff);
     comment = buff;
 }
 
@@ -518,7 +650,7 @@ eavlVTKImporter::ParseHeader()
 void
 eavlVTKImporter::ParseFormat()
 {
-    is->getline(buff, 4096);
+    ReadLine(buff);
     toupper(buff);
     string format(buff);
     if (format == "ASCII")
@@ -620,15 +752,10 @@ eavlVTKImporter::ParseFieldData(eavlVTKImporter::Location loc)
         THROW(eavlException,string("Expected some number of arrays; got: ")+s);
     for (int i=0; i<narrays; i++)
     {
-        string an;
-        int    ac;
-        int    at;
-        string ad;
-
-        *is >> an;
-        *is >> ac;
-        *is >> at;
-        *is >> ad;
+        string an = ReadToken();
+        int    ac = atoi(ReadToken().c_str());
+        int    at = atoi(ReadToken().c_str());
+        string ad = ReadToken();
         toupper(ad);
 
         eavlFloatArray *arr = new eavlFloatArray(an,ac);
@@ -636,7 +763,7 @@ eavlVTKImporter::ParseFieldData(eavlVTKImporter::Location loc)
         //Changed to ReadIntoArray
         //int n = arr->GetNumberOfComponents() * arr->GetNumberOfTuples();
         //ReadIntoVector(n, DataTypeFromString(ad), arr->values);
-        is->getline(buff, 4096); // skip the EOL
+        SkipLine(); // skip the EOL
         
         ReadIntoArray(DataTypeFromString(ad), arr);
 
@@ -825,7 +952,7 @@ eavlVTKImporter::ParsePoints(eavlLogicalStructureRegular *log)
     sin >> s;
     if (s != "POINTS")
         THROW(eavlException,string("Expected POINTS, got ")+s);
-    int npoints;
+    eavlIndex npoints;
     sin >> npoints;
     sin >> s;
     data->SetNumPoints(npoints);
@@ -881,7 +1008,7 @@ eavlVTKImporter::ParsePoints(eavlLogicalStructureRegular *log)
     {
         
         axisValues[d]->SetNumberOfTuples(data->GetNumPoints());
-        for (int i=0; i<data->GetNumPoints(); i++)
+        for (eavlIndex i=0; i<data->GetNumPoints(); i++)
             axisValues[d]->SetComponentFromDouble(i, 0, vals[i*3+d]);
 
         eavlField *field = new eavlField(1, axisValues[d], eavlField::ASSOC_POINTS);
@@ -1185,7 +1312,7 @@ void
 eavlVTKImporter::ParseAttributes()
 {
     Location loc = LOC_DATASET;
-    while ((*is) && !(is->eof()))
+    while (!atEnd)
     {
         istringstream sin(buff);
         string s;
@@ -17,6 +17,12 @@
 // Programmer:  Jeremy Meredith, Dave Pugmire, Sean Ahern
 // Creation:    February 17, 2011
 //
+// Modifications:
+//   Parse from memory instead of an istream: files are mapped, ASCII
+//   values are converted in parallel blocks by a hand-written number
+//   parser, and binary values of every type, including bits, are read
+//   big-endian and swapped on little-endian hosts.
+//
 // ****************************************************************************
 class eavlVTKImporter : public eavlImporter
 {
@@ -56,7 +62,11 @@ class eavlVTKImporter : public eavlImporter
         DS_UNSTRUCTURED_GRID
     };
 
-    istream *is;
+    const char *file;
+    size_t      fileBytes;
+    size_t      pos;
+    bool        mapped;
+    bool        atEnd;
     char buff[4096];
     char bufforig[4096];
     enum Location { LOC_DATASET, LOC_CELLS, LOC_POINTS };
@@ -91,9 +101,23 @@ class eavlVTKImporter : public eavlImporter
     string StringFromDataSetType(DataSetType dst);
 
     template <class T>
-    void ReadIntoVector(int,DataType,vector<T>&);
+    void ReadIntoVector(eavlIndex,DataType,vector<T>&);
     void ReadIntoArray(DataType, eavlArray *);
+    template <class T>
+    void ReadValues(eavlIndex n, DataType dt, T *out);
+    template <class T>
+    void ReadAsciiValues(eavlIndex n, T *out);
+    template <class IT, class T>
+    void ReadBinaryValues(eavlIndex n, T *out);
+    template <class T>
+    void ReadBinaryBits(eavlIndex n, T *out);
     bool GetNextLine();
+    bool ReadLine(char *line);
+    void SkipLine();
+    string ReadToken();
+
+    void Map(const string &filename);
+    void Unmap();
   protected:
     vector<int> cell_to_cell_splitmap;
     eavlDataSet *data;
@@ -113,6 +113,11 @@ class eavl1toNScatterOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::SPARSE_WRITE, accesses);
+    }
 };
 
 // helper function for type deduction
@@ -26,7 +26,7 @@ struct collecttype<nulltype>
 template <class T>
 struct collectclass
 {
-    EAVL_HOSTDEVICE static typename collecttype<T>::type get(int i, T &t)
+    EAVL_HOSTDEVICE static typename collecttype<T>::type get(eavlIndex i, T &t)
     {
         return typename collecttype<T>::type(t.first.array[t.first.indexer.index(i)],
                                              collectclass<typename T::resttype>::get(i, t.rest));
@@ -36,7 +36,7 @@ struct collectclass
 template <class FT>
 struct collectclass< cons<FT, nulltype> >
 {
-    EAVL_HOSTDEVICE static typename collecttype<cons<FT,nulltype> >::type get(int i, cons<FT, nulltype> &t)
+    EAVL_HOSTDEVICE static typename collecttype<cons<FT,nulltype> >::type get(eavlIndex i, cons<FT, nulltype> &t)
     {
         return typename collecttype< cons<FT,nulltype> >::type(t.first.array[t.first.indexer.index(i)],
                                                                cnull());
@@ -47,7 +47,7 @@ struct collectclass< cons<FT, nulltype> >
 template <class T>
 struct const_collectclass
 {
-    EAVL_HOSTDEVICE static typename collecttype<T>::const_type get(int i, const T &t)
+    EAVL_HOSTDEVICE static typename collecttype<T>::const_type get(eavlIndex i, const T &t)
     {
         return typename collecttype<const T>::const_type(t.first.array[t.first.indexer.index(i)],
                                                    const_collectclass<const typename T::resttype>::get(i, t.rest));
@@ -57,7 +57,7 @@ struct const_collectclass
 template <class FT>
 struct const_collectclass< const cons<FT, nulltype> >
 {
-    EAVL_HOSTDEVICE static typename collecttype<const cons<FT,nulltype> >::const_type get(int i, const cons<FT, nulltype> &t)
+    EAVL_HOSTDEVICE static typename collecttype<const cons<FT,nulltype> >::const_type get(eavlIndex i, const cons<FT, nulltype> &t)
     {
         return typename collecttype< const cons<FT,nulltype> >::const_type(t.first.array[t.first.indexer.index(i)],
                                                                      cnull());
@@ -66,13 +66,13 @@ struct const_collectclass< const cons<FT, nulltype> >
 
 // collect, using the index, one value from each array in the input, and return as references
 template<class FT, class RT>
-EAVL_HOSTDEVICE typename collecttype< const cons<FT, RT> >::const_type collect(int i, const cons<FT, RT> &t)
+EAVL_HOSTDEVICE typename collecttype< const cons<FT, RT> >::const_type collect(eavlIndex i, const cons<FT, RT> &t)
 {
     return const_collectclass< const cons<FT,RT> >::get(i, t);
 }
 
 template<class FT, class RT>
-EAVL_HOSTDEVICE typename collecttype< cons<FT, RT> >::type collect(int i, cons<FT, RT> &t)
+EAVL_HOSTDEVICE typename collecttype< cons<FT, RT> >::type collect(eavlIndex i, cons<FT, RT> &t)
 {
     return collectclass< cons<FT,RT> >::get(i, t);
 }
@@ -159,6 +159,12 @@ class eavlCombinedTopologyMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(s_inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(d_inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
 };
 
 // helper function for type deduction
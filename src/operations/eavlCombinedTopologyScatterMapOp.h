@@ -174,6 +174,13 @@ class eavlCombinedTopologyScatterMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(s_inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(d_inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::SPARSE_WRITE, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+    }
 };
 
 // helper function for type deduction
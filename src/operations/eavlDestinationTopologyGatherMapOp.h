@@ -171,6 +171,12 @@ class eavlDestinationTopologyGatherMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+    }
 };
 
 // helper function for type deduction
@@ -162,6 +162,11 @@ class eavlDestinationTopologyMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
 };
 
 // helper function for type deduction
@@ -45,6 +45,51 @@ struct eavlDestinationTopologyPackedMapOp_CPU
     }
 };
 
+template <class CONN, class F, class IN, class OUT, class INDEX>
+class eavlDestinationTopologyPackedMapOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    CONN     conn;
+    const IN inputs;
+    OUT      outputs;
+    INDEX    indices;
+    F        functor;
+  public:
+    eavlDestinationTopologyPackedMapOp_CPU_Kernel(CONN c, const IN i, OUT o,
+                                                  INDEX ind, F &f)
+        : conn(c), inputs(i), outputs(o), indices(ind), functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        int *sparseindices = get<0>(indices).array;
+        int ids[MAX_LOCAL_TOPOLOGY_IDS];
+        for (int denseindex = begin; denseindex < end; ++denseindex)
+        {
+            int sparseindex = sparseindices[get<0>(indices).indexer.index(denseindex)];
+
+            int nids;
+            int shapeType = conn.GetElementComponents(sparseindex, nids, ids);
+
+            collect(denseindex, outputs) = functor(shapeType, nids, ids,
+                                                   collect(denseindex, inputs));
+        }
+    }
+};
+
+template <class CONN>
+struct eavlDestinationTopologyPackedMapOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT, class INDEX>
+    static void call(int, eavlFusedTopologyBinding<CONN> &binding,
+                     const IN inputs, OUT outputs,
+                     INDEX indices, F &functor)
+    {
+        binding.kernel = new eavlDestinationTopologyPackedMapOp_CPU_Kernel<CONN,F,IN,OUT,INDEX>(binding.conn, inputs, outputs, indices, functor);
+    }
+};
+
 #if defined __CUDACC__
 
 template <class CONN, class F, class IN, class OUT, class INDEX>
@@ -109,6 +154,8 @@ struct eavlDestinationTopologyPackedMapOp_GPU
 // Creation:    August  1, 2013
 //
 // Modifications:
+//   Can be fused by the executor with adjacent ops sharing the same
+//   iteration domain.
 // ****************************************************************************
 template <class I, class O, class INDEX, class F>
 class eavlDestinationTopologyPackedMapOp : public eavlOperation
@@ -171,6 +218,38 @@ class eavlDestinationTopologyPackedMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if (!dynamic_cast<eavlCellSetExplicit*>(cells) &&
+            !dynamic_cast<eavlCellSetAllStructured*>(cells))
+            return -1;
+        return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlCellSetExplicit *elExp = dynamic_cast<eavlCellSetExplicit*>(cells);
+        eavlCellSetAllStructured *elStr = dynamic_cast<eavlCellSetAllStructured*>(cells);
+        int n = outputs.first.length();
+        if (elExp)
+        {
+            eavlFusedTopologyBinding<eavlExplicitConnectivity&> binding(elExp->GetConnectivity(topology));
+            eavlOpDispatch<eavlDestinationTopologyPackedMapOp_CPU_Bind<eavlExplicitConnectivity&> >(n, binding, inputs, outputs, indices, functor);
+            return binding.kernel;
+        }
+        else if (elStr)
+        {
+            eavlFusedTopologyBinding<eavlRegularConnectivity> binding(eavlRegularConnectivity(elStr->GetRegularStructure(),topology));
+            eavlOpDispatch<eavlDestinationTopologyPackedMapOp_CPU_Bind<eavlRegularConnectivity> >(n, binding, inputs, outputs, indices, functor);
+            return binding.kernel;
+        }
+        return NULL;
+    }
 };
 
 // helper function for type deduction
@@ -19,14 +19,14 @@ struct eavlGatherOp_CPU
 {
     static inline eavlArray::Location location() { return eavlArray::HOST; }
     template <class F, class IN, class OUT, class INDEX>
-    static void call(int nitems, int,
+    static void call(eavlIndex nitems, int,
                      const IN inputs, OUT outputs,
                      INDEX indices, F&)
     {
         int *sparseindices = get<0>(indices).array;
 
 #pragma omp parallel for
-        for (int denseindex = 0; denseindex < nitems; ++denseindex)
+        for (eavlIndex denseindex = 0; denseindex < nitems; ++denseindex)
         {
             int sparseindex = sparseindices[get<0>(indices).indexer.index(denseindex)];
             // can't use operator= because it's ambiguous when only
@@ -37,11 +37,45 @@ struct eavlGatherOp_CPU
     }
 };
 
+template <class IN, class OUT, class INDEX>
+class eavlGatherOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    const IN inputs;
+    OUT      outputs;
+    INDEX    indices;
+  public:
+    eavlGatherOp_CPU_Kernel(const IN i, OUT o, INDEX ind) : inputs(i), outputs(o), indices(ind)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        int *sparseindices = get<0>(indices).array;
+        for (eavlIndex denseindex = begin; denseindex < end; ++denseindex)
+        {
+            int sparseindex = sparseindices[get<0>(indices).indexer.index(denseindex)];
+            collect(denseindex, outputs).CopyFrom(collect(sparseindex, inputs));
+        }
+    }
+};
+
+struct eavlGatherOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT, class INDEX>
+    static void call(eavlIndex, eavlFusedKernel *&kernel,
+                     const IN inputs, OUT outputs,
+                     INDEX indices, F&)
+    {
+        kernel = new eavlGatherOp_CPU_Kernel<IN,OUT,INDEX>(inputs, outputs, indices);
+    }
+};
+
 #if defined __CUDACC__
 
 template <class IN, class OUT, class INDEX>
 __global__ void
-eavlGatherOp_kernel(int nitems,
+eavlGatherOp_kernel(eavlIndex nitems,
                     const IN inputs, OUT outputs,
                     INDEX indices)
 {
@@ -49,7 +83,7 @@ eavlGatherOp_kernel(int nitems,
 
     const int numThreads = blockDim.x * gridDim.x;
     const int threadID   = blockIdx.x * blockDim.x + threadIdx.x;
-    for (int denseindex = threadID; denseindex < nitems; denseindex += numThreads)
+    for (eavlIndex denseindex = threadID; denseindex < nitems; denseindex += numThreads)
     {
         int sparseindex = sparseindices[get<0>(indices).indexer.index(denseindex)];
         // can't use operator= because it's ambiguous when only
@@ -64,7 +98,7 @@ struct eavlGatherOp_GPU
 {
     static inline eavlArray::Location location() { return eavlArray::DEVICE; }
     template <class F, class IN, class OUT, class INDEX>
-    static void call(int nitems, int,
+    static void call(eavlIndex nitems, int,
                      const IN inputs, OUT outputs,
                      INDEX indices, F&)
     {
@@ -98,6 +132,12 @@ struct eavlGatherOp_GPU
 // Modifications: Matt Larsen 7/10/14 Added ability to only process a subset of 
 //                the output length. This allows the output array length to be 
 //                larger than the index array length.
+//
+//   Gather ops can be fused by the executor with adjacent map and gather
+//   ops sharing the same iteration domain, as long as no fused op writes
+//   the gathered-from arrays.
+//
+//   Item counts and output indices are eavlIndex.
 // ****************************************************************************
 template <class I, class O, class INDEX>
 class eavlGatherOp : public eavlOperation
@@ -107,20 +147,20 @@ class eavlGatherOp : public eavlOperation
     I            inputs;
     O            outputs;
     INDEX        indices;
-    int          nitems;
+    eavlIndex    nitems;
   public:
     eavlGatherOp(I i, O o, INDEX ind)
         : inputs(i), outputs(o), indices(ind), nitems(-1)
     {
     }
-    eavlGatherOp(I i, O o, INDEX ind, int itemsToProcess)
+    eavlGatherOp(I i, O o, INDEX ind, eavlIndex itemsToProcess)
         : inputs(i), outputs(o), indices(ind), nitems(itemsToProcess)
     {
     }
     virtual void GoCPU()
     {
         int dummy;
-        int n=0;
+        eavlIndex n=0;
         if( nitems > 0 ) n = nitems;
         else n = outputs.first.length();
         eavlOpDispatch<eavlGatherOp_CPU>(n, dummy, inputs, outputs, indices, functor);
@@ -129,7 +169,7 @@ class eavlGatherOp : public eavlOperation
     {
 #ifdef HAVE_CUDA
         int dummy;
-        int n=0;
+        eavlIndex n=0;
         if( nitems > 0 ) n = nitems;
         else n = outputs.first.length();
         eavlOpDispatch<eavlGatherOp_GPU>(n, dummy, inputs, outputs, indices, functor);
@@ -137,6 +177,23 @@ class eavlGatherOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if( nitems > 0 ) return nitems;
+        else return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlFusedKernel *kernel = NULL;
+        eavlOpDispatch<eavlGatherOp_CPU_Bind>(GetFusionDomain(), kernel, inputs, outputs, indices, functor);
+        return kernel;
+    }
 };
 
 // helper function for type deduction
@@ -147,7 +204,7 @@ eavlGatherOp<I,O,INDEX> *new_eavlGatherOp(I i, O o, INDEX indices)
 }
 
 template <class I, class O, class INDEX>
-eavlGatherOp<I,O,INDEX> *new_eavlGatherOp(I i, O o, INDEX indices, int itemsToProcess) 
+eavlGatherOp<I,O,INDEX> *new_eavlGatherOp(I i, O o, INDEX indices, eavlIndex itemsToProcess) 
 {
     return new eavlGatherOp<I,O,INDEX>(i,o,indices, itemsToProcess);
 }
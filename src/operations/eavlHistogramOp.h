@@ -0,0 +1,332 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_HISTOGRAM_OP_H
+#define EAVL_HISTOGRAM_OP_H
+
+#include "eavlOperation.h"
+#include "eavlArray.h"
+#include "eavlException.h"
+#include "eavlThreadPool.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#ifndef DOXYGEN
+
+// reads the value to bin for item i: one component, or the magnitude
+// of all of them when comp is negative
+template <class T>
+EAVL_HOSTDEVICE float eavlHistogramValue(const T *vals, int nc, int comp, eavlIndex i)
+{
+    if (comp >= 0)
+        return float(vals[i*nc + comp]);
+    float sum = 0;
+    for (int c=0; c<nc; c++)
+    {
+        float v = float(vals[i*nc + c]);
+        sum += v*v;
+    }
+    return sqrtf(sum);
+}
+
+// the bin holding v: the number of interior edges at or below it, so
+// values below the first edge fall in the first bin and values at or
+// above the last edge fall in the last bin; -1 for NaN
+EAVL_HOSTDEVICE int eavlHistogramBin(float v, const float *edges, int nbins)
+{
+    if (v != v)
+        return -1;
+    int lo = 0, hi = nbins-1;
+    while (lo < hi)
+    {
+        int mid = (lo + hi + 1) / 2;
+        if (v >= edges[mid])
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+    return lo;
+}
+
+template <class T, class W>
+static void eavlHistogramOp_CPU(eavlIndex n, const T *vals, int nc, int comp,
+                                const W *weights,
+                                const float *edges, int nbins,
+                                float *counts)
+{
+    int nthreads = 1;
+#ifdef HAVE_OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    // private bins for each thread, merged in thread order at the end
+    vector<double> bins((size_t)nthreads * nbins, 0.);
+#pragma omp parallel num_threads(nthreads)
+    {
+        int threadid = 0;
+#ifdef HAVE_OPENMP
+        threadid = omp_get_thread_num();
+#endif
+        double *mybins = &bins[(size_t)threadid * nbins];
+#pragma omp for schedule(static)
+        for (eavlIndex i=0; i<n; i++)
+        {
+            int b = eavlHistogramBin(eavlHistogramValue(vals, nc, comp, i),
+                                     edges, nbins);
+            if (b >= 0)
+                mybins[b] += weights ? double(weights[i]) : 1.;
+        }
+    }
+
+    for (int b=0; b<nbins; b++)
+    {
+        double sum = 0;
+        for (int t=0; t<nthreads; t++)
+            sum += bins[(size_t)t * nbins + b];
+        counts[b] = float(sum);
+    }
+}
+
+// bins each chunk of a thread pool loop into its own partial histogram
+template <class T, class W>
+struct eavlHistogramOp_poolBody : public eavlParallelForBody
+{
+    eavlIndex grain;
+    const T *vals;
+    int nc, comp;
+    const W *weights;
+    const float *edges;
+    int nbins;
+    double *partials;
+    eavlHistogramOp_poolBody(eavlIndex g, const T *v, int nc_, int comp_,
+                             const W *w, const float *e, int nb, double *p)
+        : grain(g), vals(v), nc(nc_), comp(comp_), weights(w),
+          edges(e), nbins(nb), partials(p)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        double *mybins = partials + (size_t)(begin / grain) * nbins;
+        for (eavlIndex i=begin; i<end; i++)
+        {
+            int b = eavlHistogramBin(eavlHistogramValue(vals, nc, comp, i),
+                                     edges, nbins);
+            if (b >= 0)
+                mybins[b] += weights ? double(weights[i]) : 1.;
+        }
+    }
+};
+
+template <class T, class W>
+static void eavlHistogramOp_Pool(eavlIndex n, const T *vals, int nc, int comp,
+                                 const W *weights,
+                                 const float *edges, int nbins,
+                                 float *counts)
+{
+    if (n == 0)
+    {
+        for (int b=0; b<nbins; b++)
+            counts[b] = 0;
+        return;
+    }
+
+    // partials are merged in chunk order, so weighted sums do not
+    // depend on which threads ran which chunks
+    eavlIndex grain = eavlThreadPool::GetParallelForGrain(n);
+    eavlIndex nchunks = (n + grain - 1) / grain;
+    vector<double> partials((size_t)nchunks * nbins, 0.);
+    eavlHistogramOp_poolBody<T,W> body(grain, vals, nc, comp, weights,
+                                       edges, nbins, &partials[0]);
+    eavlThreadPool::ParallelFor(n, body, grain);
+
+    for (int b=0; b<nbins; b++)
+    {
+        double sum = 0;
+        for (eavlIndex c=0; c<nchunks; c++)
+            sum += partials[(size_t)c * nbins + b];
+        counts[b] = float(sum);
+    }
+}
+
+#if defined __CUDACC__
+
+// the most bins kept in shared memory; larger histograms add straight
+// into the global counts
+#define EAVL_HISTOGRAM_SHARED_BINS 4096
+
+template <class T, class W>
+__global__ static void eavlHistogramOp_kernel(eavlIndex n, const T *vals, int nc, int comp,
+                                              const W *weights,
+                                              const float *edges, int nbins,
+                                              float *counts)
+{
+    extern __shared__ float sbins[];
+    const bool shared = (nbins <= EAVL_HISTOGRAM_SHARED_BINS);
+    if (shared)
+    {
+        for (int b = threadIdx.x; b < nbins; b += blockDim.x)
+            sbins[b] = 0;
+        __syncthreads();
+    }
+
+    const eavlIndex numThreads = blockDim.x * gridDim.x;
+    const eavlIndex threadID   = blockIdx.x * blockDim.x + threadIdx.x;
+    for (eavlIndex index = threadID; index < n; index += numThreads)
+    {
+        int b = eavlHistogramBin(eavlHistogramValue(vals, nc, comp, index),
+                                 edges, nbins);
+        if (b < 0)
+            continue;
+        float w = weights ? float(weights[index]) : 1.f;
+        if (shared)
+            atomicAdd(&sbins[b], w);
+        else
+            atomicAdd(&counts[b], w);
+    }
+
+    if (shared)
+    {
+        __syncthreads();
+        for (int b = threadIdx.x; b < nbins; b += blockDim.x)
+        {
+            if (sbins[b] != 0)
+                atomicAdd(&counts[b], sbins[b]);
+        }
+    }
+}
+
+template <class T, class W>
+static void eavlHistogramOp_GPU(eavlIndex n, const T *d_vals, int nc, int comp,
+                                const W *d_weights,
+                                const float *d_edges, int nbins,
+                                float *d_counts)
+{
+    cudaMemset(d_counts, 0, sizeof(float) * nbins);
+    int numBlocks  = 64;
+    int numThreads = 256;
+    size_t sharedSize = (nbins <= EAVL_HISTOGRAM_SHARED_BINS) ? sizeof(float) * nbins : 0;
+    eavlHistogramOp_kernel<T,W><<<numBlocks, numThreads, sharedSize>>>
+        (n, d_vals, nc, comp, d_weights, d_edges, nbins, d_counts);
+    CUDA_CHECK_ERROR();
+}
+#endif
+
+#endif // DOXYGEN
+
+// ****************************************************************************
+// Class:  eavlHistogramOp
+//
+// Purpose:
+///   Counts the values of an array falling in each of a set of bins in a
+///   single pass over the array.  The bins are given by an array of
+///   nbins+1 increasing edges; bin b holds the values v with
+///   edges[b] <= v < edges[b+1], except that the first bin also holds
+///   everything below its upper edge and the last bin everything at or
+///   above its lower edge.  NaNs are not counted.
+///
+///   The value of each tuple is one of its components, or the magnitude
+///   of all of them (MAGNITUDE).  With a weight array, each tuple adds
+///   its weight to its bin instead of one.
+///
+///   On the CPU each thread fills a private histogram and the histograms
+///   are summed at the end; on the GPU each block accumulates into bins
+///   in shared memory before adding them to the output.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlHistogramOp : public eavlOperation
+{
+  public:
+    static const int MAGNITUDE = -1;
+  protected:
+    eavlArray      *values;
+    int             component;
+    eavlArray      *weights;
+    eavlFloatArray *edges;
+    eavlFloatArray *counts;
+  public:
+    eavlHistogramOp(eavlArray *values_, int component_,
+                    eavlFloatArray *edges_, eavlFloatArray *counts_,
+                    eavlArray *weights_ = NULL)
+        : values(values_), component(component_), weights(weights_),
+          edges(edges_), counts(counts_)
+    {
+        if (component >= values->GetNumberOfComponents())
+            THROW(eavlException,"eavlHistogramOp component out of range.");
+        if (edges->GetNumberOfTuples() < 2 ||
+            counts->GetNumberOfTuples() != edges->GetNumberOfTuples() - 1)
+            THROW(eavlException,"eavlHistogramOp expects one more edge than bins.");
+        if (weights &&
+            (weights->GetNumberOfComponents() != 1 ||
+             weights->GetNumberOfTuples() != values->GetNumberOfTuples()))
+            THROW(eavlException,"eavlHistogramOp expects one weight per value.");
+    }
+
+    virtual void GoCPU()
+    {
+        Dispatch<CPU>(eavlArray::HOST);
+    }
+    virtual void GoCPUThreadPool()
+    {
+        Dispatch<POOL>(eavlArray::HOST);
+    }
+    virtual void GoGPU()
+    {
+#if defined __CUDACC__
+        Dispatch<GPU>(eavlArray::DEVICE);
+#else
+        THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
+#endif
+    }
+
+  protected:
+    enum Backend { CPU, POOL, GPU };
+
+    template <int B, class T, class W>
+    void Run(const T *vals, const W *wts, const float *e, float *c)
+    {
+        eavlIndex n = values->GetNumberOfTuples();
+        int nc = values->GetNumberOfComponents();
+        int nbins = counts->GetNumberOfTuples();
+        if (B == CPU)
+            eavlHistogramOp_CPU(n, vals, nc, component, wts, e, nbins, c);
+        else if (B == POOL)
+            eavlHistogramOp_Pool(n, vals, nc, component, wts, e, nbins, c);
+#if defined __CUDACC__
+        else
+            eavlHistogramOp_GPU(n, vals, nc, component, wts, e, nbins, c);
+#endif
+    }
+
+    template <int B, class T>
+    void DispatchWeights(const T *vals, eavlArray::Location loc)
+    {
+        const float *e = (const float*)edges->GetRawPointer(loc);
+        float *c = (float*)counts->GetRawPointer(loc);
+        if (!weights)
+            Run<B>(vals, (const float*)NULL, e, c);
+        else if (dynamic_cast<eavlFloatArray*>(weights))
+            Run<B>(vals, (const float*)weights->GetRawPointer(loc), e, c);
+        else if (dynamic_cast<eavlIntArray*>(weights))
+            Run<B>(vals, (const int*)weights->GetRawPointer(loc), e, c);
+        else if (dynamic_cast<eavlByteArray*>(weights))
+            Run<B>(vals, (const byte*)weights->GetRawPointer(loc), e, c);
+        else
+            THROW(eavlException,"eavlHistogramOp: unknown weight array type.");
+    }
+
+    template <int B>
+    void Dispatch(eavlArray::Location loc)
+    {
+        if (dynamic_cast<eavlFloatArray*>(values))
+            DispatchWeights<B>((const float*)values->GetRawPointer(loc), loc);
+        else if (dynamic_cast<eavlIntArray*>(values))
+            DispatchWeights<B>((const int*)values->GetRawPointer(loc), loc);
+        else if (dynamic_cast<eavlByteArray*>(values))
+            DispatchWeights<B>((const byte*)values->GetRawPointer(loc), loc);
+        else
+            THROW(eavlException,"eavlHistogramOp: unknown value array type.");
+    }
+};
+
+#endif
@@ -1,18 +1,35 @@
 #ifndef EAVL_INDEXABLE_H
 #define EAVL_INDEXABLE_H
 
+#include <climits>
 #include "eavlRegularStructure.h"
 
+// The element holding item i of an array read with the given strides.
+// A mod of INT_MAX means the index does not wrap, which only makes a
+// difference to indices past 2^31 in 64-bit index builds.
+EAVL_HOSTDEVICE eavlIndex eavlLinearIndex(eavlIndex i, int div, int mod,
+                                          int mul, int add)
+{
+#ifdef EAVL_64BIT_INDICES
+    eavlIndex j = i / div;
+    if (mod != INT_MAX)
+        j %= mod;
+    return j * mul + add;
+#else
+    return (((i/div)%mod)*mul)+add;
+#endif
+}
+
 class eavlArrayIndexer
 {
   public:
     ///\todo: order doesn't match existing EAVL order
     int div, mod;
     int mul, add;
-    eavlArrayIndexer() : div(1), mod(1e9), mul(1), add(0)
+    eavlArrayIndexer() : div(1), mod(INT_MAX), mul(1), add(0)
     {
     }
-    eavlArrayIndexer(int mul, int add) : div(1), mod(1e9), mul(mul), add(add)
+    eavlArrayIndexer(int mul, int add) : div(1), mod(INT_MAX), mul(mul), add(add)
     {
     }
     eavlArrayIndexer(int div, int mod, int mul, int add) : div(div), mod(mod), mul(mul), add(add)
@@ -21,7 +38,10 @@ class eavlArrayIndexer
     virtual void Print(ostream &) const
     {
     }
-    EAVL_HOSTDEVICE int index(int i) const { return (((i/div)%mod)*mul)+add; }
+    EAVL_HOSTDEVICE eavlIndex index(eavlIndex i) const
+    {
+        return eavlLinearIndex(i, div, mod, mul, add);
+    }
 };
 
 template <class T>
@@ -49,15 +69,15 @@ class eavlIndexable
                   comp)
     {
     }
-    int length() const
+    eavlIndex length() const
     {
         // We don't need to account for div/mod here because
         // we're only using this to determine how many
         // output values we have, and output values don't have
         // div/mod.  (I'm not sure we could do it accurately
         // even if we wanted to....)
-        int nvalues = array->GetNumberOfTuples() * array->GetNumberOfComponents();
-        return int((nvalues - indexer.add) / indexer.mul);
+        eavlIndex nvalues = array->GetNumberOfTuples() * array->GetNumberOfComponents();
+        return eavlIndex((nvalues - indexer.add) / indexer.mul);
     }
     virtual void Print(ostream &)
     {
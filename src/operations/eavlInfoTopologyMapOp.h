@@ -36,6 +36,41 @@ struct eavlInfoTopologyMapOp_CPU
     }
 };
 
+template <class CONN, class F, class IN, class OUT>
+class eavlInfoTopologyMapOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    CONN     conn;
+    const IN inputs;
+    OUT      outputs;
+    F        functor;
+  public:
+    eavlInfoTopologyMapOp_CPU_Kernel(CONN c, const IN i, OUT o, F &f)
+        : conn(c), inputs(i), outputs(o), functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (int index = begin; index < end; ++index)
+        {
+            int shapeType = conn.GetShapeType(index);
+            collect(index, outputs) = functor(shapeType, collect(index, inputs));
+        }
+    }
+};
+
+template <class CONN>
+struct eavlInfoTopologyMapOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT>
+    static void call(int, eavlFusedTopologyBinding<CONN> &binding,
+                     const IN inputs, OUT outputs, F &functor)
+    {
+        binding.kernel = new eavlInfoTopologyMapOp_CPU_Kernel<CONN,F,IN,OUT>(binding.conn, inputs, outputs, functor);
+    }
+};
+
 #if defined __CUDACC__
 
 template <class CONN, class F, class IN, class OUT>
@@ -95,6 +130,8 @@ struct eavlInfoTopologyMapOp_GPU
 // Creation:    August  1, 2013
 //
 // Modifications:
+//   Can be fused by the executor with adjacent ops sharing the same
+//   iteration domain.
 // ****************************************************************************
 template <class I, class O, class F>
 class eavlInfoTopologyMapOp : public eavlOperation
@@ -156,6 +193,37 @@ class eavlInfoTopologyMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if (!dynamic_cast<eavlCellSetExplicit*>(cells) &&
+            !dynamic_cast<eavlCellSetAllStructured*>(cells))
+            return -1;
+        return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlCellSetExplicit *elExp = dynamic_cast<eavlCellSetExplicit*>(cells);
+        eavlCellSetAllStructured *elStr = dynamic_cast<eavlCellSetAllStructured*>(cells);
+        int n = outputs.first.length();
+        if (elExp)
+        {
+            eavlFusedTopologyBinding<eavlExplicitConnectivity&> binding(elExp->GetConnectivity(topology));
+            eavlOpDispatch<eavlInfoTopologyMapOp_CPU_Bind<eavlExplicitConnectivity&> >(n, binding, inputs, outputs, functor);
+            return binding.kernel;
+        }
+        else if (elStr)
+        {
+            eavlFusedTopologyBinding<eavlRegularConnectivity> binding(eavlRegularConnectivity(elStr->GetRegularStructure(),topology));
+            eavlOpDispatch<eavlInfoTopologyMapOp_CPU_Bind<eavlRegularConnectivity> >(n, binding, inputs, outputs, functor);
+            return binding.kernel;
+        }
+        return NULL;
+    }
 };
 
 // helper function for type deduction
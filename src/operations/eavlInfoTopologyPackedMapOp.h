@@ -40,6 +40,46 @@ struct eavlInfoTopologyPackedMapOp_CPU
     }
 };
 
+template <class CONN, class F, class IN, class OUT, class INDEX>
+class eavlInfoTopologyPackedMapOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    CONN     conn;
+    const IN inputs;
+    OUT      outputs;
+    INDEX    indices;
+    F        functor;
+  public:
+    eavlInfoTopologyPackedMapOp_CPU_Kernel(CONN c, const IN i, OUT o,
+                                           INDEX ind, F &f)
+        : conn(c), inputs(i), outputs(o), indices(ind), functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        int *sparseindices = get<0>(indices).array;
+        for (int denseindex = begin; denseindex < end; ++denseindex)
+        {
+            int sparseindex = sparseindices[get<0>(indices).indexer.index(denseindex)];
+            int shapeType = conn.GetShapeType(sparseindex);
+            collect(denseindex, outputs) = functor(shapeType, collect(denseindex, inputs));
+        }
+    }
+};
+
+template <class CONN>
+struct eavlInfoTopologyPackedMapOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT, class INDEX>
+    static void call(int, eavlFusedTopologyBinding<CONN> &binding,
+                     const IN inputs, OUT outputs,
+                     INDEX indices, F &functor)
+    {
+        binding.kernel = new eavlInfoTopologyPackedMapOp_CPU_Kernel<CONN,F,IN,OUT,INDEX>(binding.conn, inputs, outputs, indices, functor);
+    }
+};
+
 #if defined __CUDACC__
 
 template <class CONN, class F, class IN, class OUT, class INDEX>
@@ -99,6 +139,8 @@ struct eavlInfoTopologyPackedMapOp_GPU
 // Creation:    August  1, 2013
 //
 // Modifications:
+//   Can be fused by the executor with adjacent ops sharing the same
+//   iteration domain.
 // ****************************************************************************
 template <class I, class O, class INDEX, class F>
 class eavlInfoTopologyPackedMapOp : public eavlOperation
@@ -161,6 +203,38 @@ class eavlInfoTopologyPackedMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if (!dynamic_cast<eavlCellSetExplicit*>(cells) &&
+            !dynamic_cast<eavlCellSetAllStructured*>(cells))
+            return -1;
+        return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlCellSetExplicit *elExp = dynamic_cast<eavlCellSetExplicit*>(cells);
+        eavlCellSetAllStructured *elStr = dynamic_cast<eavlCellSetAllStructured*>(cells);
+        int n = outputs.first.length();
+        if (elExp)
+        {
+            eavlFusedTopologyBinding<eavlExplicitConnectivity&> binding(elExp->GetConnectivity(topology));
+            eavlOpDispatch<eavlInfoTopologyPackedMapOp_CPU_Bind<eavlExplicitConnectivity&> >(n, binding, inputs, outputs, indices, functor);
+            return binding.kernel;
+        }
+        else if (elStr)
+        {
+            eavlFusedTopologyBinding<eavlRegularConnectivity> binding(eavlRegularConnectivity(elStr->GetRegularStructure(),topology));
+            eavlOpDispatch<eavlInfoTopologyPackedMapOp_CPU_Bind<eavlRegularConnectivity> >(n, binding, inputs, outputs, indices, functor);
+            return binding.kernel;
+        }
+        return NULL;
+    }
 };
 
 // helper function for type deduction
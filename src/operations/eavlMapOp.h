@@ -17,10 +17,10 @@ struct eavlMapOp_CPU
 {
     static inline eavlArray::Location location() { return eavlArray::HOST; }
     template <class F, class IN, class OUT>
-    static void call(int nitems, int, const IN inputs, OUT outputs, F &functor)
+    static void call(eavlIndex nitems, int, const IN inputs, OUT outputs, F &functor)
     {
 #pragma omp parallel for
-        for (int index = 0; index < nitems; ++index)
+        for (eavlIndex index = 0; index < nitems; ++index)
         {
             typename collecttype<IN>::const_type in(collect(index, inputs));
             typename collecttype<OUT>::type out(collect(index, outputs));
@@ -33,16 +33,48 @@ struct eavlMapOp_CPU
     }
 };
 
+template <class F, class IN, class OUT>
+class eavlMapOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    const IN inputs;
+    OUT      outputs;
+    F        functor;
+  public:
+    eavlMapOp_CPU_Kernel(const IN i, OUT o, F &f) : inputs(i), outputs(o), functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex index = begin; index < end; ++index)
+        {
+            typename collecttype<IN>::const_type in(collect(index, inputs));
+            typename collecttype<OUT>::type out(collect(index, outputs));
+            out = functor(in);
+        }
+    }
+};
+
+struct eavlMapOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT>
+    static void call(eavlIndex, eavlFusedKernel *&kernel, const IN inputs, OUT outputs, F &functor)
+    {
+        kernel = new eavlMapOp_CPU_Kernel<F,IN,OUT>(inputs, outputs, functor);
+    }
+};
+
 
 #if defined __CUDACC__
 
 template <class F, class IN, class OUT>
 __global__ void
-mapKernel(int nitems, const IN inputs, OUT outputs, F functor)
+mapKernel(eavlIndex nitems, const IN inputs, OUT outputs, F functor)
 {
     const int numThreads = blockDim.x * gridDim.x;
     const int threadID   = blockIdx.x * blockDim.x + threadIdx.x;
-    for (int index = threadID; index < nitems; index += numThreads)
+    for (eavlIndex index = threadID; index < nitems; index += numThreads)
     { 
         //if (threadID<nitems)  
         collect(index, outputs) = functor(collect(index, inputs));
@@ -54,7 +86,7 @@ struct eavlMapOp_GPU
     static inline eavlArray::Location location() { return eavlArray::DEVICE; }
 
     template <class F, class IN, class OUT>
-    static void call(int nitems, int, const IN inputs, OUT outputs, F &functor)
+    static void call(eavlIndex nitems, int, const IN inputs, OUT outputs, F &functor)
     {
         
         int numThreads = 128;
@@ -81,6 +113,10 @@ struct eavlMapOp_GPU
 // Creation:    July 25, 2013
 //
 // Modifications:
+//   Map ops can be fused by the executor with adjacent map and gather
+//   ops sharing the same iteration domain.
+//
+//   Item counts and indices are eavlIndex.
 // ****************************************************************************
 template <class I, class O, class F>
 class eavlMapOp : public eavlOperation
@@ -89,18 +125,18 @@ class eavlMapOp : public eavlOperation
     I  inputs;
     O  outputs;
     F  functor;
-    int nitems;
+    eavlIndex nitems;
   public:
     eavlMapOp(I i, O o, F f) : inputs(i), outputs(o), functor(f), nitems(-1)
     {
     }
-    eavlMapOp(I i, O o, F f, int nItems) : inputs(i), outputs(o), functor(f), nitems(nItems)
+    eavlMapOp(I i, O o, F f, eavlIndex nItems) : inputs(i), outputs(o), functor(f), nitems(nItems)
     {
     }
     virtual void GoCPU()
     {
         int dummy;
-        int n;
+        eavlIndex n;
         if( nitems > 0 ) n = nitems;
         else n = outputs.first.length();
         eavlOpDispatch<eavlMapOp_CPU>(n, dummy, inputs, outputs, functor);
@@ -109,7 +145,7 @@ class eavlMapOp : public eavlOperation
     {
 #ifdef HAVE_CUDA
         int dummy;
-        int n;
+        eavlIndex n;
         if( nitems > 0 ) n = nitems;
         else n = outputs.first.length();
         eavlOpDispatch<eavlMapOp_GPU>(n, dummy, inputs, outputs, functor);
@@ -117,6 +153,22 @@ class eavlMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if( nitems > 0 ) return nitems;
+        else return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlFusedKernel *kernel = NULL;
+        eavlOpDispatch<eavlMapOp_CPU_Bind>(GetFusionDomain(), kernel, inputs, outputs, functor);
+        return kernel;
+    }
 };
 
 // helper function for type deduction
@@ -126,7 +178,7 @@ eavlMapOp<I,O,F> *new_eavlMapOp(I i, O o, F f)
     return new eavlMapOp<I,O,F>(i,o,f);
 }
 template <class I, class O, class F>
-eavlMapOp<I,O,F> *new_eavlMapOp(I i, O o, F f, int itemsToProcess) 
+eavlMapOp<I,O,F> *new_eavlMapOp(I i, O o, F f, eavlIndex itemsToProcess) 
 {
     return new eavlMapOp<I,O,F>(i,o,f, itemsToProcess);
 }
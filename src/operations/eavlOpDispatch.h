@@ -6,6 +6,7 @@
 #include "eavlTuple.h"
 #include "eavlIndexable.h"
 #include "eavlTupleTraits.h"
+#include "eavlTrace.h"
 
 // ****************************************************************************
 // Function:  eavlOpDispatch
@@ -105,7 +106,7 @@ template <int N,
           class F>
 struct dispatchclass_start
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<Z0F,Z0R> &args0,
                    cons<Z1F,Z1R> &args1,
                    cons<Z2F,Z2R> &args2,
@@ -132,7 +133,7 @@ template <class K,
           class F>
 struct dispatchclass_start<1, K, S, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
@@ -157,7 +158,7 @@ template <class K,
           class F>
 struct dispatchclass_start<2, K, S, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
@@ -182,7 +183,7 @@ template <class K,
           class F>
 struct dispatchclass_start<3, K, S, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
@@ -207,7 +208,7 @@ template <class K,
           class F>
 struct dispatchclass_start<4, K, S, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, nulltype, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
                    cons<nulltype,nulltype> &,
@@ -241,7 +242,7 @@ template <int N,
           class F>
 struct dispatchclassgetrawptr
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<Z0F,Z0R> &args0,
                    cons<Z1F,Z1R> &args1,
                    cons<Z2F,Z2R> &args2,
@@ -254,6 +255,8 @@ struct dispatchclassgetrawptr
     {
         typedef typename Z0F::type::type rawtype;
         rawtype *raw = (rawtype*)((K::location()==eavlArray::HOST) ? args0.first.array->GetHostArray() : args0.first.array->GetCUDAArray());
+        if (eavlTrace::IsEnabled())
+            eavlTrace::AddDispatch(args0.first.array, n, (long long)n * sizeof(rawtype), eavlTrace::UNKNOWN);
         typedef cons<eavlIndexable<rawtype>, RZ0> newp;
         dispatchclass_dropfirst<N, K, S, Z0F, Z0R, Z1F, Z1R, Z2F, Z2R, Z3F, Z3R, newp, RZ1, RZ2, RZ3, F>
             ::go(n, structure, args0, args1, args2, args3, newp(eavlIndexable<rawtype>(raw, args0.first.indexer), ptrs0), ptrs1, ptrs2, ptrs3, functor);
@@ -275,7 +278,7 @@ template <int N,
           class F>
 struct dispatchclassgetrawptr<N, K, S, eavlIndexable<eavlArray>, Z0R, Z1F, Z1R, Z2F, Z2R, Z3F, Z3R, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<eavlIndexable<eavlArray>,Z0R> &args0,
                    cons<Z1F,Z1R> &args1,
                    cons<Z2F,Z2R> &args2,
@@ -288,6 +291,8 @@ struct dispatchclassgetrawptr<N, K, S, eavlIndexable<eavlArray>, Z0R, Z1F, Z1R,
     {
         eavlConcreteArray<int> *ai = dynamic_cast<eavlConcreteArray<int>*>(args0.first.array);
         eavlConcreteArray<float> *af = dynamic_cast<eavlConcreteArray<float>*>(args0.first.array);
+        if (eavlTrace::IsEnabled())
+            eavlTrace::AddDispatch(args0.first.array, n, (long long)n * args0.first.array->GetBasicTypeSize(), eavlTrace::UNKNOWN);
         if (ai)
         {
             int *raw = (int*)((K::location()==eavlArray::HOST) ? ai->GetHostArray() : ai->GetCUDAArray());
@@ -323,7 +328,7 @@ template <int N,
           class F>
 struct dispatchclass_dropfirst
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<Z0F,Z0R> &args0,
                    cons<Z1F,Z1R> &args1,
                    cons<Z2F,Z2R> &args2,
@@ -356,7 +361,7 @@ template <int N,
           class F>
 struct dispatchclass_dropfirst<N, K, S, Z0F, nulltype, Z1F, Z1R, Z2F, Z2R, Z3F, Z3R, RZ0, RZ1, RZ2, RZ3, F>
 {
-    static void go(int n, S &structure,
+    static void go(eavlIndex n, S &structure,
                    cons<Z0F,nulltype> &args0,
                    cons<Z1F,Z1R> &args1,
                    cons<Z2F,Z2R> &args2,
@@ -376,7 +381,7 @@ struct dispatchclass_dropfirst<N, K, S, Z0F, nulltype, Z1F, Z1R, Z2F, Z2R, Z3F,
 // entry points for dispatch
 // 4-arg
 template<class K, class S, class T0, class T1, class T2, class T3, class F>
-void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, T3 arrays3, F functor)
+void eavlOpDispatch(eavlIndex n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, T3 arrays3, F functor)
 {
     dispatchclassgetrawptr<0, K, S,
         typename T0::firsttype, typename T0::resttype,
@@ -392,7 +397,7 @@ void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, T3
 
 // 3-arg
 template<class K, class S, class T0, class T1, class T2, class F>
-void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, F functor)
+void eavlOpDispatch(eavlIndex n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, F functor)
 {
     cons<nulltype,nulltype> empty;
     dispatchclassgetrawptr<0, K, S,
@@ -409,7 +414,7 @@ void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, T2 arrays2, F f
 
 // 2-arg
 template<class K, class S, class T0, class T1, class F>
-void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, F functor)
+void eavlOpDispatch(eavlIndex n, S &structure, T0 arrays0, T1 arrays1, F functor)
 {
     cons<nulltype,nulltype> empty;
     dispatchclassgetrawptr<0, K, S,
@@ -426,7 +431,7 @@ void eavlOpDispatch(int n, S &structure, T0 arrays0, T1 arrays1, F functor)
 
 // 1-arg
 template<class K, class S, class T0, class F>
-void eavlOpDispatch(int n, S &structure, T0 arrays0, F functor)
+void eavlOpDispatch(eavlIndex n, S &structure, T0 arrays0, F functor)
 {
     cons<nulltype,nulltype> empty;
     dispatchclassgetrawptr<0, K, S,
@@ -2,13 +2,14 @@
 #ifndef EAVL_OP_DISPATCH_IO1_H
 #define EAVL_OP_DISPATCH_IO1_H
 #include "eavlException.h"
+#include "eavlTrace.h"
 
 // ----------------------------------------------------------------------------
 
 template <template <typename KF, typename KIO0> class K,
           class F,
           class S, class IO0>
-void eavlDispatch_io1_final(int n, eavlArray::Location loc,
+void eavlDispatch_io1_final(eavlIndex n, eavlArray::Location loc,
                              S &structure,
                              IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
                              IO0 *o0, int o0mul, int o0add,
@@ -23,7 +24,7 @@ void eavlDispatch_io1_final(int n, eavlArray::Location loc,
 template <template <typename KF, typename KIO0> class K,
           class F,
           class S>
-void eavlDispatch_io1(int n, eavlArray::Location loc,
+void eavlDispatch_io1(eavlIndex n, eavlArray::Location loc,
                       S &structure,
                       eavlArray *i0, int i0div, int i0mod, int i0mul, int i0add,
                       eavlArray *o0, int o0mul, int o0add,
@@ -42,6 +43,18 @@ void eavlDispatch_io1(int n, eavlArray::Location loc,
         (i0_i && !o0_i))
         THROW(eavlException,"eavlDispatch_io1 must have same-typed input and output array.");
         
+    if (eavlTrace::IsEnabled())
+    {
+        // reductions write fewer values than they read
+        eavlIndex nout = std::min(n, o0->GetNumberOfTuples() *
+                                     o0->GetNumberOfComponents());
+        int valuesize = i0->GetBasicTypeSize();
+        eavlTrace::AddDispatch(i0, n, (long long)n * valuesize,
+                               eavlTrace::READ);
+        eavlTrace::AddDispatch(o0, n, (long long)nout * valuesize,
+                               eavlTrace::WRITE);
+    }
+
 
     if (i0_f)
         eavlDispatch_io1_final<K>(n, loc, structure,
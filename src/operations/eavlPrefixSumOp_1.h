@@ -5,32 +5,117 @@
 #include "eavlOperation.h"
 #include "eavlArray.h"
 #include "eavlOpDispatch_io1.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
 
 #ifndef DOXYGEN
 
+template <class IO0>
+void cpuPrefixSumOp_1_serial(eavlIndex n, bool inclusive,
+                             IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
+                             IO0 *o0, int o0mul, int o0add)
+{
+    if (inclusive)
+    {
+        o0[0*o0mul+o0add] = i0[eavlLinearIndex(0, i0div, i0mod, i0mul, i0add)];
+        for (eavlIndex i=1; i<n; ++i)
+            o0[i*o0mul+o0add] = o0[(i-1)*o0mul+o0add] + i0[eavlLinearIndex(i, i0div, i0mod, i0mul, i0add)];
+    }
+    else
+    {
+        o0[0*o0mul+o0add] = 0;
+        for (eavlIndex i=1; i<n; ++i)
+            o0[i*o0mul+o0add] = o0[(i-1)*o0mul+o0add] + i0[eavlLinearIndex(i-1, i0div, i0mod, i0mul, i0add)];
+    }
+}
+
+#ifdef HAVE_OPENMP
+// below this many values per thread, the serial scan wins
+#define EAVL_PREFIX_SUM_MIN_VALUES_PER_THREAD 16384
+
 template <class F,
           class IO0>
 struct cpuPrefixSumOp_1_function
 {
-    static void call(int n, bool &inclusive,
+    static void call(eavlIndex n, bool &inclusive,
                      IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
                      IO0 *o0, int o0mul, int o0add,
                      F &functor)
     {
-        if (inclusive)
+        int maxthreads = int(std::min(eavlIndex(omp_get_max_threads()),
+                                      n / EAVL_PREFIX_SUM_MIN_VALUES_PER_THREAD));
+        if (maxthreads <= 1)
         {
-            o0[0*o0mul+o0add] = i0[((0/i0div)%i0mod)*i0mul+i0add];
-            for (int i=1; i<n; ++i)
-                o0[i*o0mul+o0add] = o0[(i-1)*o0mul+o0add] + i0[((i/i0div)%i0mod)*i0mul+i0add];
+            cpuPrefixSumOp_1_serial(n, inclusive,
+                                    i0, i0div, i0mod, i0mul, i0add,
+                                    o0, o0mul, o0add);
+            return;
         }
-        else
+
+        // Two passes over contiguous per-thread chunks: first each thread
+        // sums its chunk, then after an exclusive scan of those partial
+        // sums, each thread scans its chunk again starting from its offset.
+        // Only reading the input twice keeps this safe for in-place use.
+        IO0 *partial = new IO0[maxthreads+1];
+#pragma omp parallel num_threads(maxthreads)
         {
-            o0[0*o0mul+o0add] = 0;
-            for (int i=1; i<n; ++i)
-                o0[i*o0mul+o0add] = o0[(i-1)*o0mul+o0add] + i0[(((i-1)/i0div)%i0mod)*i0mul+i0add];
+            int nthreads = omp_get_num_threads();
+            int threadid = omp_get_thread_num();
+            eavlIndex begin = eavlIndex(((long long)n * threadid) / nthreads);
+            eavlIndex end   = eavlIndex(((long long)n * (threadid+1)) / nthreads);
+
+            IO0 sum = 0;
+            for (eavlIndex i=begin; i<end; ++i)
+                sum += i0[eavlLinearIndex(i, i0div, i0mod, i0mul, i0add)];
+            partial[threadid+1] = sum;
+#pragma omp barrier
+
+#pragma omp single
+            {
+                partial[0] = 0;
+                for (int t=1; t<=nthreads; ++t)
+                    partial[t] += partial[t-1];
+            }
+
+            IO0 running = partial[threadid];
+            if (inclusive)
+            {
+                for (eavlIndex i=begin; i<end; ++i)
+                {
+                    running += i0[eavlLinearIndex(i, i0div, i0mod, i0mul, i0add)];
+                    o0[i*o0mul+o0add] = running;
+                }
+            }
+            else
+            {
+                for (eavlIndex i=begin; i<end; ++i)
+                {
+                    IO0 value = i0[eavlLinearIndex(i, i0div, i0mod, i0mul, i0add)];
+                    o0[i*o0mul+o0add] = running;
+                    running += value;
+                }
+            }
         }
+        delete[] partial;
+    }
+};
+#else
+template <class F,
+          class IO0>
+struct cpuPrefixSumOp_1_function
+{
+    static void call(eavlIndex n, bool &inclusive,
+                     IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
+                     IO0 *o0, int o0mul, int o0add,
+                     F &functor)
+    {
+        cpuPrefixSumOp_1_serial(n, inclusive,
+                                i0, i0div, i0mod, i0mul, i0add,
+                                o0, o0mul, o0add);
     }
 };
+#endif
 
 
 #if defined __CUDACC__
@@ -231,7 +316,7 @@ template <class F,
           class IO0>
 struct gpuPrefixSumOp_1_function
 {
-    static void call(int n, bool &inclusive,
+    static void call(eavlIndex n, bool &inclusive,
                      IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
                      IO0 *o0, int o0mul, int o0add,
                      F &functor)
@@ -331,6 +416,10 @@ struct gpuPrefixSumOp_1_function
 // Creation:    April 1, 2012
 //
 // Modifications:
+//   The CPU version is now a two-pass blocked scan when OpenMP is enabled
+//   and the array is large enough to amortize the thread startup.
+//
+//   Item counts and indices are eavlIndex.
 // ****************************************************************************
 class eavlPrefixSumOp_1 : public eavlOperation
 {
@@ -346,9 +435,14 @@ class eavlPrefixSumOp_1 : public eavlOperation
         : inArray0(in0), outArray0(out0), inclusive(incl)
     {
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        accesses.push_back(eavlFusionAccess(inArray0, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(outArray0, eavlFusionAccess::ELEMENT_WRITE));
+    }
     virtual void GoCPU()
     {
-        int n = inArray0.array->GetNumberOfTuples();
+        eavlIndex n = inArray0.array->GetNumberOfTuples();
         if (n == 0)
             return;
 
@@ -360,7 +454,7 @@ class eavlPrefixSumOp_1 : public eavlOperation
     virtual void GoGPU()
     {
 #if defined __CUDACC__
-        int n = inArray0.array->GetNumberOfTuples();
+        eavlIndex n = inArray0.array->GetNumberOfTuples();
         if (n == 0)
             return;
 
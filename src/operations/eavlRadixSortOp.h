@@ -25,10 +25,10 @@ typedef unsigned int uint;
 
 /* Merge sorted lists A and B into list A. Av and Bv are then values  A must have dim >= m+n */
 template<class T>
-void merge(T A[], T B[], T Av[], T Bv[], int m, int n) 
+void merge(T A[], T B[], T Av[], T Bv[], eavlIndex m, eavlIndex n) 
 {
-    int i=0, j=0, k=0;
-    int size = m+n;
+    eavlIndex i=0, j=0, k=0;
+    eavlIndex size = m+n;
     T *C  = (T *)malloc(size*sizeof(T));
     T *Cv = (T *)malloc(size*sizeof(T));
     while (i < m && j < n) 
@@ -45,12 +45,12 @@ void merge(T A[], T B[], T Av[], T Bv[], int m, int n)
         } 
         k++;
     }
-    if (i < m) for (int p = i; p < m; p++,k++)
+    if (i < m) for (eavlIndex p = i; p < m; p++,k++)
     {
       C[k]  = A[p];
       Cv[k] = Av[p];  
     } 
-    else for (int p = j; p < n; p++,k++)
+    else for (eavlIndex p = j; p < n; p++,k++)
     {
       C[k]  = B[p];
       Cv[k] = Bv[p]; 
@@ -64,8 +64,8 @@ void merge(T A[], T B[], T Av[], T Bv[], int m, int n)
     free(Cv);
 }
 
-static void insertion_sort(uint *keys, uint *values, int offset, int end) {
-    int x, y;
+static void insertion_sort(uint *keys, uint *values, eavlIndex offset, eavlIndex end) {
+    eavlIndex x, y;
     uint temp, tempv;
     for (x=offset; x<end; ++x) 
     {
@@ -81,14 +81,14 @@ static void insertion_sort(uint *keys, uint *values, int offset, int end) {
     }
 }
 
-static void radix_sort(uint *keys, uint *values, int offset, int end, int shift) {
+static void radix_sort(uint *keys, uint *values, eavlIndex offset, eavlIndex end, int shift) {
     int x, y;
     uint value, valuev, temp, tempv;
-    int last[256] = { 0 }, pointer[256];
+    eavlIndex last[256] = { 0 }, pointer[256];
 
-    for (x=offset; x<end; ++x) 
+    for (eavlIndex i=offset; i<end; ++i) 
     {
-        ++last[(keys[x] >> shift) & 0xFF];
+        ++last[(keys[i] >> shift) & 0xFF];
     }
 
     last[0] += offset;
@@ -126,21 +126,21 @@ static void radix_sort(uint *keys, uint *values, int offset, int end, int shift)
         shift -= 8;
         for (x=0; x<256; ++x) 
         {
-            temp = x > 0 ? pointer[x] - pointer[x-1] : pointer[0] - offset;
-            if (temp > 64) 
+            eavlIndex count = x > 0 ? pointer[x] - pointer[x-1] : pointer[0] - offset;
+            if (count > 64) 
             {
-                radix_sort(keys, values, pointer[x] - temp, pointer[x], shift);
+                radix_sort(keys, values, pointer[x] - count, pointer[x], shift);
             } 
-            else if (temp > 1) 
+            else if (count > 1) 
             {
-                insertion_sort(keys, values, pointer[x] - temp, pointer[x]);
+                insertion_sort(keys, values, pointer[x] - count, pointer[x]);
             }
         }
     }
 }
 
 /* Merges N sorted sub-sections of keys a into final, fully sorted keys a */
-static void keysmerge(uint *keys, uint *values, int size, int *index, int N)
+static void keysmerge(uint *keys, uint *values, eavlIndex size, eavlIndex *index, int N)
 {
     int i;
     while (N > 1) 
@@ -164,7 +164,7 @@ struct eavlRadixSortOp_CPU
 {
     static inline eavlArray::Location location() { return eavlArray::HOST; }
     template <class F, class IN, class OUT>
-    static void call(int nitems, int useValues,
+    static void call(eavlIndex nitems, int useValues,
                      const IN inputs, OUT outputs,
                       F&)
     {
@@ -173,7 +173,7 @@ struct eavlRadixSortOp_CPU
         if(!useValues)
         {   
             #pragma omp parallel for
-            for(int i = 0; i < nitems; i++)
+            for(eavlIndex i = 0; i < nitems; i++)
             {
                 values[i] = i;
             }
@@ -181,9 +181,9 @@ struct eavlRadixSortOp_CPU
 #ifdef HAVE_OPENMP
         int threads = omp_get_max_threads();
         threads = pow(2, floor(log(threads)/log(2))); // needs to be power of 2
-        int *index = (int *)malloc((threads+1)*sizeof(int));
+        eavlIndex *index = (eavlIndex *)malloc((threads+1)*sizeof(eavlIndex));
        
-        for(int i = 0; i < threads; i++) index[i] = i*nitems/threads; 
+        for(int i = 0; i < threads; i++) index[i] = (long long)i*nitems/threads; 
         index[threads] = nitems;
         #pragma omp parallel for
         for(int i = 0; i < threads; i++) radix_sort(keys,values,index[i], index[i+1],24);
@@ -195,6 +195,91 @@ struct eavlRadixSortOp_CPU
     }
 };
 
+// thread pool loop bodies for the CPU sort: generating the indexes,
+// sorting each piece, and merging adjacent pairs of sorted pieces
+struct eavlRadixSortIndexBody : public eavlParallelForBody
+{
+    uint *values;
+    eavlRadixSortIndexBody(uint *v) : values(v) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex i = begin; i < end; i++)
+            values[i] = i;
+    }
+};
+
+struct eavlRadixSortPieceBody : public eavlParallelForBody
+{
+    uint *keys, *values;
+    eavlIndex *index;
+    eavlRadixSortPieceBody(uint *k, uint *v, eavlIndex *idx)
+        : keys(k), values(v), index(idx) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex p = begin; p < end; p++)
+            radix_sort(keys, values, index[p], index[p+1], 24);
+    }
+};
+
+struct eavlRadixSortMergeBody : public eavlParallelForBody
+{
+    uint *keys, *values;
+    eavlIndex *index;
+    eavlRadixSortMergeBody(uint *k, uint *v, eavlIndex *idx)
+        : keys(k), values(v), index(idx) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex p = begin; p < end; p++)
+        {
+            eavlIndex i = 2 * p;
+            merge(keys + index[i], keys + index[i+1], values + index[i], values + index[i+1],
+                  index[i+1] - index[i], index[i+2] - index[i+1]);
+        }
+    }
+};
+
+// the same algorithm as eavlRadixSortOp_CPU, with each parallel loop run
+// on eavlThreadPool and one piece per pool thread plus the caller
+struct eavlRadixSortOp_ThreadPool
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT>
+    static void call(eavlIndex nitems, int useValues,
+                     const IN inputs, OUT outputs,
+                      F&)
+    {
+        uint *keys = (uint*)inputs.first.array;
+        uint *values = (uint*)outputs.first.array;
+        if(!useValues)
+        {
+            eavlRadixSortIndexBody body(values);
+            eavlThreadPool::ParallelFor(nitems, body);
+        }
+        if (nitems < 2)
+            return;
+
+        int threads = 1;
+        while (threads * 2 <= eavlThreadPool::GetNumberOfThreads() + 1 &&
+               threads * 2 <= nitems)
+            threads *= 2;
+        std::vector<eavlIndex> index(threads+1);
+        for(int i = 0; i < threads; i++) index[i] = (long long)i*nitems/threads;
+        index[threads] = nitems;
+
+        eavlRadixSortPieceBody sorter(keys, values, &index[0]);
+        eavlThreadPool::ParallelFor(threads, sorter, 1);
+
+        /* Merge sorted keys pieces */
+        eavlRadixSortMergeBody merger(keys, values, &index[0]);
+        for (int N = threads; N > 1; N /= 2)
+        {
+            for(int i = 0; i < N; i++) index[i] = (long long)i*nitems/N;
+            index[N] = nitems;
+            eavlThreadPool::ParallelFor(N/2, merger, 1);
+        }
+    }
+};
+
 #if defined __CUDACC__
 
 // Alternative macro to catch CUDA errors
@@ -682,7 +767,7 @@ struct eavlRadixSortOp_GPU
 {
     static inline eavlArray::Location location() { return eavlArray::DEVICE; }
     template <class F, class IN, class OUT>
-    static void call(int nitems, int useValues,
+    static void call(eavlIndex nitems, int useValues,
                      IN inputs, OUT outputs, F&)
     {
                  
@@ -821,6 +906,10 @@ struct eavlRadixSortOp_GPU
 //             adapted from Erik Gorset. See COPYRIGHT.txt )
 //
 // Modifications:
+//   Added a thread pool version for the ForceCPUThreadPool execution mode.
+//
+//   The CPU sorts take eavlIndex counts and offsets, so with 64-bit
+//   indices they sort up to 2^32 items (the limit of the uint values).
 //    
 // ****************************************************************************
 template <class I, class O>
@@ -830,7 +919,7 @@ class eavlRadixSortOp : public eavlOperation
     DummyFunctor functor;
     I            inputs;
     O            outputs;
-    int          nitems;
+    eavlIndex    nitems;
     int          usevals;
   public:
     eavlRadixSortOp(I i, O o, bool genIndexes)
@@ -838,7 +927,7 @@ class eavlRadixSortOp : public eavlOperation
     {
         usevals = !genIndexes;
     }
-    eavlRadixSortOp(I i, O o, bool genIndexes, int itemsToProcess)
+    eavlRadixSortOp(I i, O o, bool genIndexes, eavlIndex itemsToProcess)
         : inputs(i), outputs(o), nitems(itemsToProcess)
     {
         usevals = !genIndexes;
@@ -846,16 +935,23 @@ class eavlRadixSortOp : public eavlOperation
     virtual void GoCPU()
     {
         
-        int n = 0;
+        eavlIndex n = 0;
         if(nitems > 0) n = nitems;
         else n = inputs.first.length();
         eavlOpDispatch<eavlRadixSortOp_CPU>(n, usevals, inputs, outputs, functor);
     }
+    virtual void GoCPUThreadPool()
+    {
+        eavlIndex n = 0;
+        if(nitems > 0) n = nitems;
+        else n = inputs.first.length();
+        eavlOpDispatch<eavlRadixSortOp_ThreadPool>(n, usevals, inputs, outputs, functor);
+    }
     virtual void GoGPU()
     {
 #ifdef HAVE_CUDA
         
-        int n=0;
+        eavlIndex n=0;
         if(nitems > 0) n = nitems;
         else n = inputs.first.length();
         eavlOpDispatch<eavlRadixSortOp_GPU>(n, usevals, inputs, outputs, functor);
@@ -863,6 +959,13 @@ class eavlRadixSortOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::SPARSE_WRITE, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::SPARSE_WRITE, accesses);
+    }
 };
 
 // helper function for type deduction
@@ -873,7 +976,7 @@ eavlRadixSortOp<I,O> *new_eavlRadixSortOp(I i, O o, bool genIndexes)
 }
 
 template <class I, class O>
-eavlRadixSortOp<I,O> *new_eavlRadixSortOp(I i, O o, bool genIndexes, int itemsToProcess) 
+eavlRadixSortOp<I,O> *new_eavlRadixSortOp(I i, O o, bool genIndexes, eavlIndex itemsToProcess) 
 {
     return new eavlRadixSortOp<I,O>(i,o, genIndexes, itemsToProcess);
 }
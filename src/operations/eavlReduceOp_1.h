@@ -17,7 +17,7 @@ template <class F,
           class IO0>
 struct cpuReduceOp_1_function
 {
-    static void call(int n, int &dummy,
+    static void call(eavlIndex n, int &dummy,
                      IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
                      IO0 *o0, int o0mul, int o0add,
                      F &functor)
@@ -31,14 +31,14 @@ struct cpuReduceOp_1_function
         IO0 *tmp = NULL;
 #pragma omp parallel default(none) shared(cerr,tmp,n,i0,i0div,i0mod,i0mul,i0add,o0,o0mul,o0add,functor)
         {
-            int nthreads = std::min(omp_get_num_threads(), n);
+            int nthreads = int(std::min(eavlIndex(omp_get_num_threads()), n));
             int threadid = omp_get_thread_num();
 #pragma omp single
             {
                 tmp = new IO0[nthreads];
                 for (int i=0; i<nthreads; i++)
                 {
-                    int index_i0 = ((i / i0div) % i0mod) * i0mul + i0add;
+                    eavlIndex index_i0 = eavlLinearIndex(i, i0div, i0mod, i0mul, i0add);
                     tmp[i] = i0[index_i0];
                 }
             }
@@ -46,9 +46,9 @@ struct cpuReduceOp_1_function
 
             // we might be able to change this to use a omp for directive,
             // but if so, just do nthreads to n, not strided
-            for (int i=nthreads+threadid; i<n; i+=nthreads)
+            for (eavlIndex i=nthreads+threadid; i<n; i+=nthreads)
             {
-                int index_i0 = ((i / i0div) % i0mod) * i0mul + i0add;
+                eavlIndex index_i0 = eavlLinearIndex(i, i0div, i0mod, i0mul, i0add);
                 tmp[threadid] = functor(i0[index_i0], tmp[threadid]);
             }
 #pragma omp barrier
@@ -70,7 +70,7 @@ template <class F,
           class IO0>
 struct cpuReduceOp_1_function
 {
-    static void call(int n, int &dummy,
+    static void call(eavlIndex n, int &dummy,
                      IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
                      IO0 *o0, int o0mul, int o0add,
                      F &functor)
@@ -82,27 +82,88 @@ struct cpuReduceOp_1_function
         }
 
         *o0 = *i0;
-        for (int i=1; i<n; i++)
+        for (eavlIndex i=1; i<n; i++)
         {
-            int index_i0 = ((i / i0div) % i0mod) * i0mul + i0add;
+            eavlIndex index_i0 = eavlLinearIndex(i, i0div, i0mod, i0mul, i0add);
             *o0 = functor(i0[index_i0], *o0);
         }
     }
 };
 #endif
 
+// reduces each chunk of a thread pool loop to its own partial result
+template <class F,
+          class IO0>
+struct poolReduceOp_1_body : public eavlParallelForBody
+{
+    eavlIndex grain;
+    IO0 *partials;
+    IO0 *i0;
+    int i0div, i0mod, i0mul, i0add;
+    F &functor;
+    poolReduceOp_1_body(eavlIndex g, IO0 *p,
+                        IO0 *i0_, int i0div_, int i0mod_, int i0mul_, int i0add_,
+                        F &f)
+        : grain(g), partials(p),
+          i0(i0_), i0div(i0div_), i0mod(i0mod_), i0mul(i0mul_), i0add(i0add_),
+          functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        IO0 result = i0[eavlLinearIndex(begin, i0div, i0mod, i0mul, i0add)];
+        for (eavlIndex i=begin+1; i<end; i++)
+        {
+            eavlIndex index_i0 = eavlLinearIndex(i, i0div, i0mod, i0mul, i0add);
+            result = functor(i0[index_i0], result);
+        }
+        partials[begin / grain] = result;
+    }
+};
+
+template <class F,
+          class IO0>
+struct poolReduceOp_1_function
+{
+    static void call(eavlIndex n, int &dummy,
+                     IO0 *i0, int i0div, int i0mod, int i0mul, int i0add,
+                     IO0 *o0, int o0mul, int o0add,
+                     F &functor)
+    {
+        if (n == 0)
+        {
+            *o0 = functor.identity();
+            return;
+        }
+
+        // partials are combined in chunk order, so the result does not
+        // depend on which threads ran which chunks
+        eavlIndex grain = eavlThreadPool::GetParallelForGrain(n);
+        eavlIndex nchunks = (n + grain - 1) / grain;
+        std::vector<IO0> partials(nchunks);
+        poolReduceOp_1_body<F,IO0> body(grain, &partials[0],
+                                        i0, i0div, i0mod, i0mul, i0add,
+                                        functor);
+        eavlThreadPool::ParallelFor(n, body, grain);
+
+        *o0 = partials[0];
+        for (eavlIndex c=1; c<nchunks; c++)
+            *o0 = functor(partials[c], *o0);
+    }
+};
+
 #if defined __CUDACC__
 // Reduction Kernel
 template <class F, class T, int blockSize>
 __global__ void
-reduceKernel_1(int n,
+reduceKernel_1(eavlIndex n,
                const T * __restrict__ i0, int i0div, int i0mod, int i0mul, int i0add,
                T * __restrict__ o0, int o0mul, int o0add,
                F functor,
                T identity)
 {
     const unsigned int tid = threadIdx.x;
-    unsigned int i = (blockIdx.x*(blockDim.x*2)) + tid;
+    eavlIndex i = (blockIdx.x*(blockDim.x*2)) + tid;
     const unsigned int gridSize = blockDim.x*2*gridDim.x;
     
     volatile __shared__ T sdata[256];
@@ -112,9 +173,9 @@ reduceKernel_1(int n,
     // Reduce multiple elements per thread
     while (i < n)
     {
-        sdata[tid] = functor(sdata[tid], i0[((i/i0div)%i0mod)*i0mul+i0add]);
+        sdata[tid] = functor(sdata[tid], i0[eavlLinearIndex(i, i0div, i0mod, i0mul, i0add)]);
         if (i+blockSize < n)
-            sdata[tid] = functor(sdata[tid], i0[(((i+blockSize)/i0div)%i0mod)*i0mul+i0add]);
+            sdata[tid] = functor(sdata[tid], i0[eavlLinearIndex(i+blockSize, i0div, i0mod, i0mul, i0add)]);
         i += gridSize;
     }
     __syncthreads();
@@ -183,7 +244,7 @@ template <class T> T *Reduce_Temp_Storage<T>::host = NULL;
 template <class F, class IO0>
 struct gpuReduceOp_1_function
 {
-    static void call(int n, int &dummy,
+    static void call(eavlIndex n, int &dummy,
                      IO0 *d_i0, int i0div, int i0mod, int i0mul, int i0add,
                      IO0 *d_o0, int o0mul, int o0add,
                      F &functor)
@@ -244,6 +305,10 @@ struct gpuReduceOp_1_function
 //
 // Modifications: Matt Larse 10/21/2014 - added ability to process subset of
 //                                        input
+//   Added a thread pool version, which reduces chunks of the input with
+//   work stealing and combines their results in a fixed order.
+//
+//   Item counts and indices are eavlIndex.
 // ****************************************************************************
 template <class F>
 class eavlReduceOp_1 : public eavlOperation
@@ -252,7 +317,7 @@ class eavlReduceOp_1 : public eavlOperation
     eavlArrayWithLinearIndex inArray0;
     eavlArrayWithLinearIndex outArray0;
     F           functor;
-    int         nitems;
+    eavlIndex   nitems;
   public:
     eavlReduceOp_1(eavlArrayWithLinearIndex in0,
                    eavlArrayWithLinearIndex out0,
@@ -263,11 +328,16 @@ class eavlReduceOp_1 : public eavlOperation
     }
     eavlReduceOp_1(eavlArrayWithLinearIndex in0,
                    eavlArrayWithLinearIndex out0,
-                   F f, int itemsToProcess)
+                   F f, eavlIndex itemsToProcess)
         : inArray0(in0), outArray0(out0), functor(f)
     {
         nitems = itemsToProcess;
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        accesses.push_back(eavlFusionAccess(inArray0, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(outArray0, eavlFusionAccess::SPARSE_WRITE));
+    }
     virtual void GoCPU()
     {
         if(nitems < 1) nitems = inArray0.array->GetNumberOfTuples();
@@ -278,6 +348,16 @@ class eavlReduceOp_1 : public eavlOperation
                      outArray0.array, outArray0.mul, outArray0.add,
                      functor);
     }
+    virtual void GoCPUThreadPool()
+    {
+        if(nitems < 1) nitems = inArray0.array->GetNumberOfTuples();
+
+        int dummy;
+        eavlDispatch_io1<poolReduceOp_1_function>(nitems, eavlArray::HOST, dummy,
+                     inArray0.array, inArray0.div, inArray0.mod, inArray0.mul, inArray0.add,
+                     outArray0.array, outArray0.mul, outArray0.add,
+                     functor);
+    }
     virtual void GoGPU()
     {
 #if defined __CUDACC__
@@ -115,6 +115,14 @@ class eavlReverseIndexOp : public eavlOperation
     {
     }
 
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        accesses.push_back(eavlFusionAccess(inOutputCounts, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(inOutputIndex, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(outInputIndex, eavlFusionAccess::SPARSE_WRITE));
+        accesses.push_back(eavlFusionAccess(outInputSubindex, eavlFusionAccess::SPARSE_WRITE));
+    }
+
     virtual void GoCPU()
     {
         int n = inOutputCounts.array->GetNumberOfTuples();
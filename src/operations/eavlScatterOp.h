@@ -19,14 +19,14 @@ struct eavlScatterOp_CPU
 {
     static inline eavlArray::Location location() { return eavlArray::HOST; }
     template <class F, class IN, class OUT, class INDEX>
-    static void call(int nitems, int,
+    static void call(eavlIndex nitems, int,
                      const IN inputs, OUT outputs,
                      INDEX indices, F&)
     {
         int *denseindices = get<0>(indices).array;
 
 #pragma omp parallel for
-        for (int sparseindex = 0; sparseindex < nitems; ++sparseindex)
+        for (eavlIndex sparseindex = 0; sparseindex < nitems; ++sparseindex)
         {
 
             int denseindex = denseindices[get<0>(indices).indexer.index(sparseindex)];
@@ -42,7 +42,7 @@ struct eavlScatterOp_CPU
 
 template <class IN, class OUT, class INDEX>
 __global__ void
-eavlScatterOp_kernel(int nitems,
+eavlScatterOp_kernel(eavlIndex nitems,
                     const IN inputs, OUT outputs,
                     INDEX indices)
 {
@@ -50,7 +50,7 @@ eavlScatterOp_kernel(int nitems,
 
     const int numThreads = blockDim.x * gridDim.x;
     const int threadID   = blockIdx.x * blockDim.x + threadIdx.x;
-    for (int sparseindex = threadID; sparseindex < nitems; sparseindex += numThreads)
+    for (eavlIndex sparseindex = threadID; sparseindex < nitems; sparseindex += numThreads)
     {
         int denseindex = denseindices[get<0>(indices).indexer.index(sparseindex)];
         // can't use operator= because it's ambiguous when only
@@ -65,7 +65,7 @@ struct eavlScatterOp_GPU
 {
     static inline eavlArray::Location location() { return eavlArray::DEVICE; }
     template <class F, class IN, class OUT, class INDEX>
-    static void call(int nitems, int,
+    static void call(eavlIndex nitems, int,
                      const IN inputs, OUT outputs,
                      INDEX indices, F&)
     {
@@ -104,6 +104,8 @@ struct eavlScatterOp_GPU
 // Modifications:
 //     Matt Larsen- 2/5/2014 (used eavlGatherOp as a template to create op)
 //     Matt Larsen- 7/10/2014 Added support for operating on subset of input
+//
+//   Item counts and input indices are eavlIndex.
 // ****************************************************************************
 template <class I, class O, class INDEX>
 class eavlScatterOp : public eavlOperation
@@ -113,20 +115,20 @@ class eavlScatterOp : public eavlOperation
     I            inputs;
     O            outputs;
     INDEX        indices;
-    int          nitems;
+    eavlIndex    nitems;
   public:
     eavlScatterOp(I i, O o, INDEX ind)
         : inputs(i), outputs(o), indices(ind), nitems(-1)
     {
     }
-    eavlScatterOp(I i, O o, INDEX ind, int itemsToProcess)
+    eavlScatterOp(I i, O o, INDEX ind, eavlIndex itemsToProcess)
         : inputs(i), outputs(o), indices(ind), nitems(itemsToProcess)
     {
     }
     virtual void GoCPU()
     {
         int dummy;
-        int n=0;
+        eavlIndex n=0;
         if(nitems > 0) n = nitems;
         else n = inputs.first.length();
         eavlOpDispatch<eavlScatterOp_CPU>(n, dummy, inputs, outputs, indices, functor);
@@ -135,7 +137,7 @@ class eavlScatterOp : public eavlOperation
     {
 #ifdef HAVE_CUDA
         int dummy;
-        int n=0;
+        eavlIndex n=0;
         if(nitems > 0) n = nitems;
         else n = inputs.first.length();
         eavlOpDispatch<eavlScatterOp_GPU>(n, dummy, inputs, outputs, indices, functor);
@@ -143,6 +145,12 @@ class eavlScatterOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(inputs, eavlFusionAccess::ELEMENT_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::SPARSE_WRITE, accesses);
+        eavlCollectFusionAccesses(indices, eavlFusionAccess::ELEMENT_READ, accesses);
+    }
 };
 
 // helper function for type deduction
@@ -153,7 +161,7 @@ eavlScatterOp<I,O,INDEX> *new_eavlScatterOp(I i, O o, INDEX indices)
 }
 
 template <class I, class O, class INDEX>
-eavlScatterOp<I,O,INDEX> *new_eavlScatterOp(I i, O o, INDEX indices, int itemsToProcess) 
+eavlScatterOp<I,O,INDEX> *new_eavlScatterOp(I i, O o, INDEX indices, eavlIndex itemsToProcess) 
 {
     return new eavlScatterOp<I,O,INDEX>(i,o,indices, itemsToProcess);
 }
@@ -98,6 +98,13 @@ class eavlSimpleReverseIndexOp : public eavlOperation
     {
     }
 
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        accesses.push_back(eavlFusionAccess(inOutputFlag, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(inOutputIndex, eavlFusionAccess::SPARSE_READ));
+        accesses.push_back(eavlFusionAccess(outInputIndex, eavlFusionAccess::SPARSE_WRITE));
+    }
+
     virtual void GoCPU()
     {
         int n = inOutputFlag.array->GetNumberOfTuples();
@@ -39,6 +39,44 @@ struct eavlSourceTopologyMapOp_CPU
     }
 };
 
+template <class CONN, class F, class IN, class OUT>
+class eavlSourceTopologyMapOp_CPU_Kernel : public eavlFusedKernel
+{
+  protected:
+    CONN     conn;
+    const IN s_inputs;
+    OUT      outputs;
+    F        functor;
+  public:
+    eavlSourceTopologyMapOp_CPU_Kernel(CONN c, const IN is, OUT o, F &f)
+        : conn(c), s_inputs(is), outputs(o), functor(f)
+    {
+    }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        int ids[MAX_LOCAL_TOPOLOGY_IDS];
+        for (int index = begin; index < end; ++index)
+        {
+            int nids;
+            int shapeType = conn.GetElementComponents(index, nids, ids);
+
+            collect(index, outputs) = functor(shapeType, nids, ids, s_inputs);
+        }
+    }
+};
+
+template <class CONN>
+struct eavlSourceTopologyMapOp_CPU_Bind
+{
+    static inline eavlArray::Location location() { return eavlArray::HOST; }
+    template <class F, class IN, class OUT>
+    static void call(int, eavlFusedTopologyBinding<CONN> &binding,
+                     const IN s_inputs, OUT outputs, F &functor)
+    {
+        binding.kernel = new eavlSourceTopologyMapOp_CPU_Kernel<CONN,F,IN,OUT>(binding.conn, s_inputs, outputs, functor);
+    }
+};
+
 #if defined __CUDACC__
 
 template <class CONN, class F, class IN, class OUT>
@@ -92,6 +130,8 @@ struct eavlSourceTopologyMapOp_GPU
 // Creation:    July 26, 2013
 //
 // Modifications:
+//   Can be fused by the executor with adjacent ops sharing the same
+//   iteration domain, as long as no fused op writes the source arrays.
 // ****************************************************************************
 template <class IS, class O, class F>
 class eavlSourceTopologyMapOp : public eavlOperation
@@ -153,6 +193,37 @@ class eavlSourceTopologyMapOp : public eavlOperation
         THROW(eavlException,"Executing GPU code without compiling under CUDA compiler.");
 #endif
     }
+    virtual eavlIndex GetFusionDomain()
+    {
+        if (!dynamic_cast<eavlCellSetExplicit*>(cells) &&
+            !dynamic_cast<eavlCellSetAllStructured*>(cells))
+            return -1;
+        return outputs.first.length();
+    }
+    virtual void GetFusionAccesses(vector<eavlFusionAccess> &accesses)
+    {
+        eavlCollectFusionAccesses(s_inputs, eavlFusionAccess::SPARSE_READ, accesses);
+        eavlCollectFusionAccesses(outputs, eavlFusionAccess::ELEMENT_WRITE, accesses);
+    }
+    virtual eavlFusedKernel *BindFusedKernelCPU()
+    {
+        eavlCellSetExplicit *elExp = dynamic_cast<eavlCellSetExplicit*>(cells);
+        eavlCellSetAllStructured *elStr = dynamic_cast<eavlCellSetAllStructured*>(cells);
+        int n = outputs.first.length();
+        if (elExp)
+        {
+            eavlFusedTopologyBinding<eavlExplicitConnectivity&> binding(elExp->GetConnectivity(topology));
+            eavlOpDispatch<eavlSourceTopologyMapOp_CPU_Bind<eavlExplicitConnectivity&> >(n, binding, s_inputs, outputs, functor);
+            return binding.kernel;
+        }
+        else if (elStr)
+        {
+            eavlFusedTopologyBinding<eavlRegularConnectivity> binding(eavlRegularConnectivity(elStr->GetRegularStructure(),topology));
+            eavlOpDispatch<eavlSourceTopologyMapOp_CPU_Bind<eavlRegularConnectivity> >(n, binding, s_inputs, outputs, functor);
+            return binding.kernel;
+        }
+        return NULL;
+    }
 };
 
 // helper function for type deduction
@@ -0,0 +1,227 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlBVHCache.h"
+#include "eavlConfig.h"
+
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+static const char bvhCacheMagic[8] = {'E','A','V','L','B','V','H','\0'};
+
+struct eavlBVHCacheHeader
+{
+    char               magic[8];
+    unsigned int       version;
+    unsigned int       headerSize;
+    unsigned long long key;
+    int                innerSize;
+    int                leafSize;
+};
+
+// the primitive buffer is hashed in chunks of this many words, so the
+// chunks can be hashed in parallel and still give the same key for any
+// number of threads
+static const long long keyChunkWords = 1 << 16;
+
+static const unsigned long long fnvOffset = 14695981039346656037ULL;
+static const unsigned long long fnvPrime  = 1099511628211ULL;
+
+static inline unsigned long long
+HashWord(unsigned long long h, unsigned long long w)
+{
+    return (h ^ w) * fnvPrime;
+}
+
+static unsigned long long
+HashWords(const unsigned int *words, long long n)
+{
+    unsigned long long h = fnvOffset;
+    for (long long i=0; i<n; i++)
+        h = HashWord(h, words[i]);
+    return h;
+}
+
+unsigned long long
+eavlBVHCache::ComputeKey(const float *prims, long long nfloats,
+                         int primType, int nprims, int builder)
+{
+    const unsigned int *words = (const unsigned int *)prims;
+    long long nchunks = (nfloats + keyChunkWords - 1) / keyChunkWords;
+    vector<unsigned long long> chunkHashes(nchunks);
+#pragma omp parallel for schedule(static)
+    for (long long c=0; c<nchunks; c++)
+    {
+        long long begin = c * keyChunkWords;
+        long long end = begin + keyChunkWords;
+        if (end > nfloats)
+            end = nfloats;
+        chunkHashes[c] = HashWords(words + begin, end - begin);
+    }
+
+    unsigned long long h = fnvOffset;
+    for (long long c=0; c<nchunks; c++)
+    {
+        h = HashWord(h, chunkHashes[c] & 0xffffffffULL);
+        h = HashWord(h, chunkHashes[c] >> 32);
+    }
+    h = HashWord(h, (unsigned long long)nfloats);
+    h = HashWord(h, (unsigned int)primType);
+    h = HashWord(h, (unsigned int)nprims);
+    h = HashWord(h, (unsigned int)builder);
+    h = HashWord(h, version);
+    return h;
+}
+
+// checks the header and the file size, and copies out the nodes
+static bool
+ReadNodes(const char *data, long long size, const string &filename,
+          unsigned long long key,
+          float *&innerNodes, int &innerSize,
+          float *&leafNodes, int &leafSize)
+{
+    eavlBVHCacheHeader header;
+    if (size < (long long)sizeof(header))
+    {
+        cerr<<"BVH cache "<<filename<<" is truncated. Rebuilding..."<<endl;
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, bvhCacheMagic, sizeof(bvhCacheMagic)) != 0 ||
+        header.version != eavlBVHCache::version ||
+        header.headerSize != sizeof(header))
+    {
+        cerr<<"BVH cache "<<filename<<" has an unknown format. Rebuilding..."<<endl;
+        return false;
+    }
+    if (header.key != key)
+    {
+        cerr<<"BVH cache "<<filename<<" was built for other geometry or settings. Rebuilding..."<<endl;
+        return false;
+    }
+    if (header.innerSize < 0 || header.leafSize < 0 ||
+        size != (long long)sizeof(header) +
+                (long long)sizeof(float) * (header.innerSize + (long long)header.leafSize))
+    {
+        cerr<<"BVH cache "<<filename<<" is truncated. Rebuilding..."<<endl;
+        return false;
+    }
+
+    const char *nodes = data + sizeof(header);
+    innerSize = header.innerSize;
+    leafSize = header.leafSize;
+    innerNodes = new float[innerSize];
+    leafNodes = new float[leafSize];
+    memcpy(innerNodes, nodes, sizeof(float) * innerSize);
+    memcpy(leafNodes, nodes + sizeof(float) * innerSize, sizeof(float) * leafSize);
+    return true;
+}
+
+bool
+eavlBVHCache::Read(const string &filename, unsigned long long key,
+                   float *&innerNodes, int &innerSize,
+                   float *&leafNodes, int &leafSize)
+{
+#if !defined(_WIN32)
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        cerr<<"Could not open file "<<filename<<" for reading bvh cache. Rebuilding..."<<endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        cerr<<"BVH cache "<<filename<<" is truncated. Rebuilding..."<<endl;
+        return false;
+    }
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        cerr<<"Could not map file "<<filename<<" for reading bvh cache. Rebuilding..."<<endl;
+        return false;
+    }
+    cout<<"Reading BVH Cache"<<endl;
+    bool ok = ReadNodes((const char *)data, st.st_size, filename, key,
+                        innerNodes, innerSize, leafNodes, leafSize);
+    munmap(data, st.st_size);
+    return ok;
+#else
+    ifstream bvhcache(filename.c_str(), ios::in | ios::binary);
+    if (!bvhcache.is_open())
+    {
+        cerr<<"Could not open file "<<filename<<" for reading bvh cache. Rebuilding..."<<endl;
+        return false;
+    }
+    cout<<"Reading BVH Cache"<<endl;
+    bvhcache.seekg(0, ios::end);
+    long long size = bvhcache.tellg();
+    bvhcache.seekg(0, ios::beg);
+    vector<char> data(size > 0 ? size : 1);
+    bvhcache.read(&data[0], size);
+    return ReadNodes(&data[0], size, filename, key,
+                     innerNodes, innerSize, leafNodes, leafSize);
+#endif
+}
+
+bool
+eavlBVHCache::Write(const string &filename, unsigned long long key,
+                    const float *innerNodes, int innerSize,
+                    const float *leafNodes, int leafSize)
+{
+    cout<<"Writing BVH to cache"<<endl;
+    eavlBVHCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, bvhCacheMagic, sizeof(bvhCacheMagic));
+    header.version = version;
+    header.headerSize = sizeof(header);
+    header.key = key;
+    header.innerSize = innerSize;
+    header.leafSize = leafSize;
+
+    // write under a name of our own, so another job never maps a
+    // partly written file
+    ostringstream tmpname;
+    tmpname << filename << ".tmp";
+#if !defined(_WIN32)
+    tmpname << "." << getpid();
+#endif
+    ofstream bvhcache(tmpname.str().c_str(), ios::out | ios::binary);
+    if (!bvhcache.is_open())
+    {
+        cerr<<"Error. Could not open file "<<filename<<" for storing bvh cache."<<endl;
+        return false;
+    }
+    bvhcache.write((const char*)&header, sizeof(header));
+    bvhcache.write((const char*)innerNodes, sizeof(float)*innerSize);
+    bvhcache.write((const char*)leafNodes, sizeof(float)*leafSize);
+    bvhcache.close();
+    if (!bvhcache)
+    {
+        cerr<<"Error. Could not write bvh cache "<<filename<<"."<<endl;
+        remove(tmpname.str().c_str());
+        return false;
+    }
+#if defined(_WIN32)
+    remove(filename.c_str());
+#endif
+    if (rename(tmpname.str().c_str(), filename.c_str()) != 0)
+    {
+        cerr<<"Error. Could not store bvh cache "<<filename<<"."<<endl;
+        remove(tmpname.str().c_str());
+        return false;
+    }
+    return true;
+}
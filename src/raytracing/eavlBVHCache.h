@@ -0,0 +1,49 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_BVH_CACHE_H
+#define EAVL_BVH_CACHE_H
+
+#include <string>
+using std::string;
+
+// ****************************************************************************
+// Class:  eavlBVHCache
+//
+// Purpose:
+///   Stores the flattened inner and leaf node arrays of a BVH in a binary
+///   file so later runs on the same geometry can skip building it.  The
+///   Morton, split and binned BVH builders produce the same flat layout,
+///   so any one's nodes can be cached.
+///
+///   A cache file starts with a versioned header holding a key computed
+///   from the primitive buffer the BVH was built over, the primitive type
+///   and count, and the build settings.  Read only accepts a file whose
+///   header matches the current key and whose size matches the sizes in
+///   the header, so a cache written for other geometry or settings, or a
+///   truncated one, is never used.  Files are memory mapped when read,
+///   and written under a temporary name that is renamed into place, so
+///   several jobs can share a cache file.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+//   The key takes the builder, not just whether the fast one was used.
+//
+// ****************************************************************************
+class eavlBVHCache
+{
+  public:
+    static const unsigned int version = 1;
+
+    static unsigned long long ComputeKey(const float *prims, long long nfloats,
+                                         int primType, int nprims,
+                                         int builder);
+
+    static bool Read(const string &filename, unsigned long long key,
+                     float *&innerNodes, int &innerSize,
+                     float *&leafNodes, int &leafSize);
+    static bool Write(const string &filename, unsigned long long key,
+                      const float *innerNodes, int innerSize,
+                      const float *leafNodes, int leafSize);
+};
+
+#endif
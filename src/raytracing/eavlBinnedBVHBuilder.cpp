@@ -0,0 +1,525 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlBinnedBVHBuilder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+// Ranges with more primitives than this are split near the root, one at a
+// time, before the subtrees are built in parallel.  It is a fraction of
+// the primitives, not of the threads, so the tree is the same however
+// many threads build it.
+static const int subtreeTasks = 256;
+static const int minSubtreeSize = 4096;
+
+// Ranges are binned in parallel in chunks of about this many primitives.
+static const int binChunkSize = 16384;
+
+struct eavlBinnedBVHBin
+{
+    float box[6];
+    float centroidBox[6];
+    int   count;
+
+    void Clear()
+    {
+        for (int d = 0; d < 3; d++)
+        {
+            box[d] = centroidBox[d] = FLT_MAX;
+            box[d+3] = centroidBox[d+3] = -FLT_MAX;
+        }
+        count = 0;
+    }
+};
+
+static inline void GrowBox(float *box, const float *other)
+{
+    for (int d = 0; d < 3; d++)
+    {
+        box[d] = std::min(box[d], other[d]);
+        box[d+3] = std::max(box[d+3], other[d+3]);
+    }
+}
+
+static inline void GrowBoxPoint(float *box, const float *p)
+{
+    for (int d = 0; d < 3; d++)
+    {
+        box[d] = std::min(box[d], p[d]);
+        box[d+3] = std::max(box[d+3], p[d]);
+    }
+}
+
+static inline void ClearBox(float *box)
+{
+    for (int d = 0; d < 3; d++)
+    {
+        box[d] = FLT_MAX;
+        box[d+3] = -FLT_MAX;
+    }
+}
+
+// half the surface area, which is all the SAH needs
+static inline float HalfArea(const float *box)
+{
+    float dx = box[3] - box[0], dy = box[4] - box[1], dz = box[5] - box[2];
+    if (dx < 0.f || dy < 0.f || dz < 0.f)
+        return 0.f;
+    return dx*dy + dy*dz + dz*dx;
+}
+
+static inline int BinIndex(float c, float cmin, float scale)
+{
+    int b = int((c - cmin) * scale);
+    if (b >= eavlBinnedBVHBuilder::numBins)
+        b = eavlBinnedBVHBuilder::numBins - 1;
+    return b < 0 ? 0 : b;
+}
+
+// Whether a primitive's centroid falls in a bin left of the split.
+struct eavlBinnedBVHLeftOf
+{
+    const float *centroids;
+    int          axis;
+    float        cmin;
+    float        scale;
+    int          splitBin;
+
+    bool operator()(int p) const
+    {
+        return BinIndex(centroids[p*3 + axis], cmin, scale) < splitBin;
+    }
+};
+
+eavlBinnedBVHBuilder::eavlBinnedBVHBuilder(const float *_verts,
+                                           int _numPrimitives, int _primType,
+                                           int _maxLeafSize)
+    : verts(_verts), numPrimitives(_numPrimitives), primType(_primType),
+      maxLeafSize(_maxLeafSize < 1 ? 1 : _maxLeafSize)
+{
+}
+
+// The bounds and centroid of every primitive, the same bounds the split
+// builder uses, and the bounds of them all.
+void eavlBinnedBVHBuilder::ComputeBounds(float *rootBox, float *rootCentroidBox)
+{
+    primBoxes.resize(numPrimitives * 6);
+    centroids.resize(numPrimitives * 3);
+    primIds.resize(numPrimitives);
+
+#pragma omp parallel for schedule(static)
+    for (int i = 0; i < numPrimitives; i++)
+    {
+        float *box = &primBoxes[i*6];
+        ClearBox(box);
+        if (primType == 0)
+        {
+            for (int j = 0; j < 3; j++)
+                GrowBoxPoint(box, verts + i*12 + j*3);
+        }
+        else if (primType == 1)
+        {
+            const float *sphere = verts + i*4;
+            for (int d = 0; d < 3; d++)
+            {
+                box[d] = sphere[d] - sphere[3];
+                box[d+3] = sphere[d] + sphere[3];
+            }
+        }
+        else if (primType == 2)
+        {
+            for (int j = 0; j < 4; j++)
+                GrowBoxPoint(box, verts + i*16 + j*4);
+        }
+        else if (primType == 3)
+        {
+            // the base and top circles, padded by the radius on every axis
+            const float *cyl = verts + i*8;
+            float top[3];
+            for (int d = 0; d < 3; d++)
+                top[d] = cyl[d] + cyl[4+d] * cyl[7];
+            for (int d = 0; d < 3; d++)
+            {
+                box[d] = std::min(cyl[d], top[d]) - cyl[3];
+                box[d+3] = std::max(cyl[d], top[d]) + cyl[3];
+            }
+        }
+        for (int d = 0; d < 3; d++)
+            centroids[i*3 + d] = 0.5f * (box[d] + box[d+3]);
+        primIds[i] = i;
+    }
+
+    int nchunks = (numPrimitives + binChunkSize - 1) / binChunkSize;
+    vector<float> chunkBoxes(nchunks * 12);
+#pragma omp parallel for schedule(static)
+    for (int c = 0; c < nchunks; c++)
+    {
+        float *box = &chunkBoxes[c*12];
+        ClearBox(box);
+        ClearBox(box + 6);
+        int end = std::min(numPrimitives, (c + 1) * binChunkSize);
+        for (int i = c * binChunkSize; i < end; i++)
+        {
+            GrowBox(box, &primBoxes[i*6]);
+            GrowBoxPoint(box + 6, &centroids[i*3]);
+        }
+    }
+    ClearBox(rootBox);
+    ClearBox(rootCentroidBox);
+    for (int c = 0; c < nchunks; c++)
+    {
+        GrowBox(rootBox, &chunkBoxes[c*12]);
+        GrowBox(rootCentroidBox, &chunkBoxes[c*12 + 6]);
+    }
+}
+
+// Splits a range at the cheapest bin boundary on any axis, partitioning
+// its primitives in place.  Returns false when the range should be a
+// leaf.  Ranges too big for a leaf whose centroids all coincide are cut
+// in half.
+bool eavlBinnedBVHBuilder::Split(Range &range, Range &left, Range &right,
+                                 bool parallel)
+{
+    if (range.count <= 1)
+        return false;
+
+    float scale[3];
+    bool  usable = false;
+    for (int a = 0; a < 3; a++)
+    {
+        float extent = range.centroidBox[a+3] - range.centroidBox[a];
+        scale[a] = (extent > 0.f) ? numBins / extent : 0.f;
+        if (!(scale[a] < FLT_MAX))
+            scale[a] = 0.f;
+        usable = usable || scale[a] > 0.f;
+    }
+
+    float bestCost = FLT_MAX;
+    int   bestAxis = -1, bestBin = 0;
+    eavlBinnedBVHBin bins[3][numBins];
+    if (usable)
+    {
+        // each chunk bins its primitives into its own bins, which are
+        // then merged in order
+        int nchunks = parallel ? (range.count + binChunkSize - 1) / binChunkSize : 1;
+        int chunkSize = (range.count + nchunks - 1) / nchunks;
+        vector<eavlBinnedBVHBin> chunkBins(nchunks * 3 * numBins);
+#pragma omp parallel for schedule(static) if(nchunks > 1)
+        for (int c = 0; c < nchunks; c++)
+        {
+            eavlBinnedBVHBin *cb = &chunkBins[c * 3 * numBins];
+            for (int b = 0; b < 3 * numBins; b++)
+                cb[b].Clear();
+            int begin = range.begin + c * chunkSize;
+            int end = std::min(range.begin + range.count, begin + chunkSize);
+            for (int i = begin; i < end; i++)
+            {
+                int p = primIds[i];
+                const float *centroid = &centroids[p*3];
+                for (int a = 0; a < 3; a++)
+                {
+                    if (scale[a] == 0.f)
+                        continue;
+                    eavlBinnedBVHBin &bin = cb[a * numBins +
+                        BinIndex(centroid[a], range.centroidBox[a], scale[a])];
+                    GrowBox(bin.box, &primBoxes[p*6]);
+                    GrowBoxPoint(bin.centroidBox, centroid);
+                    bin.count++;
+                }
+            }
+        }
+        for (int a = 0; a < 3; a++)
+        {
+            for (int b = 0; b < numBins; b++)
+            {
+                bins[a][b].Clear();
+                for (int c = 0; c < nchunks; c++)
+                {
+                    const eavlBinnedBVHBin &cb = chunkBins[(c*3 + a) * numBins + b];
+                    GrowBox(bins[a][b].box, cb.box);
+                    GrowBox(bins[a][b].centroidBox, cb.centroidBox);
+                    bins[a][b].count += cb.count;
+                }
+            }
+        }
+
+        // sweep from the right for the cost of every right side, then
+        // from the left; the cost of a node and of a primitive are both 1
+        float invArea = HalfArea(range.box);
+        invArea = invArea > 0.f ? 1.f / invArea : 0.f;
+        for (int a = 0; a < 3; a++)
+        {
+            if (scale[a] == 0.f)
+                continue;
+            float rightCost[numBins];
+            float box[6];
+            ClearBox(box);
+            int count = 0;
+            for (int b = numBins - 1; b > 0; b--)
+            {
+                GrowBox(box, bins[a][b].box);
+                count += bins[a][b].count;
+                rightCost[b] = HalfArea(box) * count;
+            }
+            ClearBox(box);
+            count = 0;
+            for (int b = 1; b < numBins; b++)
+            {
+                GrowBox(box, bins[a][b-1].box);
+                count += bins[a][b-1].count;
+                if (count == 0 || count == range.count)
+                    continue;
+                float cost = 1.f + (HalfArea(box) * count + rightCost[b]) * invArea;
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin = b;
+                }
+            }
+        }
+    }
+
+    if (range.count <= maxLeafSize &&
+        (bestAxis < 0 || float(range.count) <= bestCost))
+        return false;
+
+    left.begin = range.begin;
+    ClearBox(left.box);
+    ClearBox(left.centroidBox);
+    ClearBox(right.box);
+    ClearBox(right.centroidBox);
+    if (bestAxis < 0)
+    {
+        left.count = range.count / 2;
+        for (int i = range.begin; i < range.begin + range.count; i++)
+        {
+            Range &side = (i < range.begin + left.count) ? left : right;
+            GrowBox(side.box, &primBoxes[primIds[i]*6]);
+            GrowBoxPoint(side.centroidBox, &centroids[primIds[i]*3]);
+        }
+    }
+    else
+    {
+        eavlBinnedBVHLeftOf leftOf;
+        leftOf.centroids = &centroids[0];
+        leftOf.axis = bestAxis;
+        leftOf.cmin = range.centroidBox[bestAxis];
+        leftOf.scale = scale[bestAxis];
+        leftOf.splitBin = bestBin;
+        int *begin = &primIds[range.begin];
+        left.count = int(std::partition(begin, begin + range.count, leftOf) - begin);
+        for (int b = 0; b < numBins; b++)
+        {
+            Range &side = (b < bestBin) ? left : right;
+            GrowBox(side.box, bins[bestAxis][b].box);
+            GrowBox(side.centroidBox, bins[bestAxis][b].centroidBox);
+        }
+    }
+    right.begin = range.begin + left.count;
+    right.count = range.count - left.count;
+    return true;
+}
+
+// Builds the subtree of a range into nodes, parents before children and
+// left subtrees before right, numbering its inner nodes and leaf array
+// offsets from 0.
+void eavlBinnedBVHBuilder::BuildSubtree(const Range &root, vector<Node> &nodes,
+                                        int &numInner, int &leafFloats)
+{
+    numInner = 0;
+    leafFloats = 0;
+    vector<Range> stack(1, root);
+    stack[0].parent = -1;
+    while (!stack.empty())
+    {
+        Range range = stack.back();
+        stack.pop_back();
+
+        int index = (int)nodes.size();
+        if (range.parent >= 0)
+            nodes[range.parent].child[range.side] = index;
+
+        Node node;
+        memcpy(node.box, range.box, sizeof(node.box));
+        node.child[0] = node.child[1] = -1;
+        Range left, right;
+        if (Split(range, left, right, false))
+        {
+            node.begin = range.begin;
+            node.count = 0;
+            node.flat = numInner++;
+            left.parent = right.parent = index;
+            left.side = 0;
+            right.side = 1;
+            stack.push_back(right);
+            stack.push_back(left);
+        }
+        else
+        {
+            node.begin = range.begin;
+            node.count = range.count;
+            node.flat = leafFloats;
+            leafFloats += 1 + range.count;
+        }
+        nodes.push_back(node);
+    }
+}
+
+// Writes a subtree's nodes into the flat arrays, its inner nodes from
+// inner node innerBase and its leaves from leafBase.
+void eavlBinnedBVHBuilder::WriteSubtree(const vector<Node> &nodes,
+                                        int innerBase, int leafBase)
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const Node &node = nodes[i];
+        if (node.count > 0)
+        {
+            float *leaf = &leafNodes[leafBase + node.flat];
+            leaf[0] = (float)node.count;
+            for (int p = 0; p < node.count; p++)
+                leaf[1 + p] = (float)primIds[node.begin + p];
+            continue;
+        }
+
+        float *inner = &innerNodes[(innerBase + node.flat) * 16];
+        for (int k = 0; k < 2; k++)
+        {
+            const Node &child = nodes[node.child[k]];
+            memcpy(inner + k*6, child.box, 6 * sizeof(float));
+            inner[12 + k] = (child.count > 0) ? float(-(leafBase + child.flat) - 1)
+                                              : float((innerBase + child.flat) * 4);
+        }
+        inner[14] = -2.f;
+        inner[15] = -2.f;
+    }
+}
+
+void eavlBinnedBVHBuilder::build()
+{
+    innerNodes.clear();
+    leafNodes.clear();
+    if (numPrimitives < 1)
+        return;
+
+    Range root;
+    root.begin = 0;
+    root.count = numPrimitives;
+    root.parent = -1;
+    root.side = 0;
+    ComputeBounds(root.box, root.centroidBox);
+
+    // split the biggest range until they are all small enough to build
+    // as subtrees; the inner nodes made here come first in the flat
+    // array, and reference a subtree s as -s - 1
+    int grain = std::max(minSubtreeSize, numPrimitives / subtreeTasks);
+    vector<Range> tasks(1, root);
+    vector<Node>  top;
+    for (;;)
+    {
+        int biggest = 0;
+        for (size_t t = 1; t < tasks.size(); t++)
+            if (tasks[t].count > tasks[biggest].count)
+                biggest = (int)t;
+        Range range = tasks[biggest];
+        Range left, right;
+        if (range.count <= grain || !Split(range, left, right, true))
+            break;
+
+        int index = (int)top.size();
+        Node node;
+        memcpy(node.box, range.box, sizeof(node.box));
+        node.begin = range.begin;
+        node.count = 0;
+        node.flat = index;
+        top.push_back(node);
+        if (range.parent >= 0)
+            top[range.parent].child[range.side] = index;
+        left.parent = right.parent = index;
+        left.side = 0;
+        right.side = 1;
+        tasks[biggest] = left;
+        tasks.push_back(right);
+    }
+    for (size_t t = 0; t < tasks.size(); t++)
+        if (tasks[t].parent >= 0)
+            top[tasks[t].parent].child[tasks[t].side] = -(int)t - 1;
+
+    int ntasks = (int)tasks.size();
+    vector<vector<Node> > subtrees(ntasks);
+    vector<int> innerBase(ntasks + 1), leafBase(ntasks + 1);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int t = 0; t < ntasks; t++)
+        BuildSubtree(tasks[t], subtrees[t], innerBase[t+1], leafBase[t+1]);
+
+    innerBase[0] = (int)top.size();
+    leafBase[0] = 0;
+    for (int t = 0; t < ntasks; t++)
+    {
+        innerBase[t+1] += innerBase[t];
+        leafBase[t+1] += leafBase[t];
+    }
+
+    // a lone leaf still needs an inner node above it, as the split
+    // builder writes it
+    bool loneLeaf = (innerBase[ntasks] == 0);
+    innerNodes.resize(loneLeaf ? 16 : innerBase[ntasks] * 16);
+    leafNodes.resize(leafBase[ntasks]);
+    if (loneLeaf)
+    {
+        memcpy(&innerNodes[0], root.box, 6 * sizeof(float));
+        innerNodes[12] = -1.f;
+        innerNodes[13] = -1.f;
+        innerNodes[14] = -2.f;
+        innerNodes[15] = -2.f;
+    }
+
+    for (size_t i = 0; i < top.size(); i++)
+    {
+        float *inner = &innerNodes[i * 16];
+        for (int k = 0; k < 2; k++)
+        {
+            int c = top[i].child[k];
+            if (c >= 0)
+            {
+                memcpy(inner + k*6, top[c].box, 6 * sizeof(float));
+                inner[12 + k] = float(c * 4);
+            }
+            else
+            {
+                int t = -c - 1;
+                memcpy(inner + k*6, tasks[t].box, 6 * sizeof(float));
+                inner[12 + k] = (subtrees[t][0].count > 0) ? float(-leafBase[t] - 1)
+                                                           : float(innerBase[t] * 4);
+            }
+        }
+        inner[14] = -2.f;
+        inner[15] = -2.f;
+    }
+
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int t = 0; t < ntasks; t++)
+    {
+        WriteSubtree(subtrees[t], innerBase[t], leafBase[t]);
+        vector<Node>().swap(subtrees[t]);
+    }
+}
+
+float *eavlBinnedBVHBuilder::getInnerNodes(int &size) const
+{
+    size = (int)innerNodes.size();
+    float *array = new float[size];
+    if (size > 0)
+        memcpy(array, &innerNodes[0], sizeof(float) * size);
+    return array;
+}
+
+float *eavlBinnedBVHBuilder::getLeafNodes(int &size) const
+{
+    size = (int)leafNodes.size();
+    float *array = new float[size];
+    if (size > 0)
+        memcpy(array, &leafNodes[0], sizeof(float) * size);
+    return array;
+}
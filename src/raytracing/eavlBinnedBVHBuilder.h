@@ -0,0 +1,89 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_BINNED_BVH_BUILDER_H
+#define EAVL_BINNED_BVH_BUILDER_H
+
+#include <vector>
+using std::vector;
+
+// ****************************************************************************
+// Class:  eavlBinnedBVHBuilder
+//
+// Purpose:
+///   Builds a BVH over triangles, spheres, tets or cylinders with the
+///   surface area heuristic evaluated over bins of primitive centroids,
+///   and flattens it into the same inner and leaf node arrays as the
+///   Morton and split BVH builders.
+///
+///   Each node bins its primitives along all three axes, and splits at
+///   the bin boundary with the lowest SAH cost, or becomes a leaf when
+///   that is cheaper and it is small enough.  The nodes near the root are
+///   split one at a time, binning in parallel, until there are enough
+///   subtrees to go around; the subtrees are then built in parallel, one
+///   per thread at a time.  The tree does not depend on the number of
+///   threads.  Unlike the split builder, primitives are never split, so
+///   each is in exactly one leaf.
+///
+///   Inner nodes are written depth first, so a subtree's nodes are
+///   contiguous, and the leaf arrays hold the number of primitives then
+///   their indexes.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlBinnedBVHBuilder
+{
+  public:
+    static const int numBins = 16;
+
+    eavlBinnedBVHBuilder(const float *verts, int numPrimitives, int primType,
+                         int maxLeafSize = 8);
+
+    void   build();
+
+    /// Copies of the flat node arrays, which the caller deletes.
+    float *getInnerNodes(int &size) const;
+    float *getLeafNodes(int &size) const;
+
+  protected:
+    struct Node
+    {
+        float box[6];       /// minx, miny, minz, maxx, maxy, maxz
+        int   child[2];     /// local node indexes, for inner nodes
+        int   begin;        /// first primitive in the sorted list, for leaves
+        int   count;        /// 0 for inner nodes
+        int   flat;         /// index among the subtree's inner nodes, or
+                            /// offset in its leaf array
+    };
+
+    // a range of primitives still to be built, with its bounds and the
+    // bounds of its centroids
+    struct Range
+    {
+        int   begin, count;
+        float box[6];
+        float centroidBox[6];
+        int   parent, side;
+    };
+
+    const float  *verts;
+    int           numPrimitives;
+    int           primType;
+    int           maxLeafSize;
+
+    vector<float> primBoxes;     /// 6 floats per primitive
+    vector<float> centroids;     /// 3 floats per primitive
+    vector<int>   primIds;       /// primitives, sorted into the leaves
+
+    vector<float> innerNodes;
+    vector<float> leafNodes;
+
+    void  ComputeBounds(float *rootBox, float *rootCentroidBox);
+    bool  Split(Range &range, Range &left, Range &right, bool parallel);
+    void  BuildSubtree(const Range &root, vector<Node> &nodes,
+                       int &numInner, int &leafFloats);
+    void  WriteSubtree(const vector<Node> &nodes, int innerBase,
+                       int leafBase);
+};
+
+#endif
@@ -326,7 +326,7 @@ inline void writeBMP(int _height, int _width, eavlFloatArray *r, eavlFloatArray
     img = (unsigned char *)malloc(3*_width*_height);
     memset(img,0,sizeof(img));
 
-    for(int j=size;j>-1;j--)
+    for(int j=size-1;j>-1;j--)
     {
         img[j*3  ]= (unsigned char) (int)(b->GetValue(j)*255);
         img[j*3+1]= (unsigned char) (int)(g->GetValue(j)*255);
@@ -433,66 +433,6 @@ struct tri
 
 };
 
-inline bool readBVHCache(float *&innerNodes, int &innerSize, float *&leafNodes, int &leafSize, const char* filename )
-{
-    ifstream bvhcache(filename, ios::in |ios::binary);
-    if(bvhcache.is_open())
-    {
-        cout<<"Reading BVH Cache"<<endl;
-        bvhcache.read((char*)&innerSize, sizeof(innerSize));
-        if(innerSize<0) 
-        {
-            cerr<<"Invalid inner node array size "<<innerSize<<endl;
-            bvhcache.close();
-            return false;
-        }
-        innerNodes= new float[innerSize];
-        bvhcache.read((char*)innerNodes, sizeof(float)*innerSize);
-
-        bvhcache.read((char*)&leafSize, sizeof(leafSize));
-        if(leafSize<0) 
-        {
-            cerr<<"Invalid leaf array size "<<leafSize<<endl;
-            bvhcache.close();
-            delete innerNodes;
-            return false;
-        }
-
-        leafNodes= new float[leafSize];
-        bvhcache.read((char*)leafNodes, sizeof(float)*leafSize);
-    }
-    else
-    {
-        cerr<<"Could not open file "<<filename<<" for reading bvh cache. Rebuilding..."<<endl;
-        bvhcache.close();
-        return false;
-    }
-
-    bvhcache.close();
-    return true;
-}
-
-inline void writeBVHCache(const float *innerNodes, const int innerSize, const float * leafNodes, const int leafSize, const char* filename )
-{
-    cout<<"Writing BVH to cache"<<endl;
-    ofstream bvhcache(filename, ios::out | ios::binary);
-    
-    if(bvhcache.is_open()) 
-    {
-        bvhcache.write((char*)&innerSize, sizeof(innerSize));
-        bvhcache.write((const char*)innerNodes, sizeof(float)*innerSize);
-
-        bvhcache.write((char*)&leafSize, sizeof(leafSize));
-        bvhcache.write((const char*)leafNodes, sizeof(float)*leafSize);
-    }
-    else
-    {
-        cerr<<"Error. Could not open file "<<filename<<" for storing bvh cache."<<endl;
-    }
-    bvhcache.close();
-    
-}
-
 inline bool spacialCompare(const raySort &lhs,const raySort &rhs)
 {
     return lhs.mortonCode < rhs.mortonCode;
@@ -0,0 +1,87 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavlWideBVH.h"
+
+// A child of a wide node being gathered: a binary node or leaf reference
+// and its bounds.
+struct eavlWideBVHChild
+{
+    int   ref;
+    float box[6];
+
+    float Area() const
+    {
+        float dx = box[3] - box[0], dy = box[4] - box[1], dz = box[5] - box[2];
+        return dx*dy + dy*dz + dz*dx;
+    }
+};
+
+// The two children of the binary node starting at float4 index ref.
+static void BinaryChildren(const float *innerNodes, int ref,
+                           eavlWideBVHChild &left, eavlWideBVHChild &right)
+{
+    const float *n = innerNodes + ref * 4;
+    for (int d = 0; d < 6; d++)
+    {
+        left.box[d]  = n[d];
+        right.box[d] = n[6 + d];
+    }
+    left.ref  = (int)n[12];
+    right.ref = (int)n[13];
+}
+
+eavlWideBVH::eavlWideBVH(const float *innerNodes, int innerSize)
+{
+    if (innerSize < 16)
+        return;
+
+    // the binary node each wide node is collapsed from, in the order the
+    // wide nodes are created; the root of both is at 0
+    vector<int> binary(1, 0);
+    nodes.reserve(innerSize / 16 / (width - 1) + 1);
+    for (size_t w = 0; w < binary.size(); w++)
+    {
+        eavlWideBVHChild children[width];
+        BinaryChildren(innerNodes, binary[w], children[0], children[1]);
+        int n = 2;
+
+        // open the largest inner child until the node is full
+        while (n < width)
+        {
+            int open = -1;
+            float openArea = -1.f;
+            for (int c = 0; c < n; c++)
+            {
+                if (children[c].ref >= 0 && children[c].Area() > openArea)
+                {
+                    open = c;
+                    openArea = children[c].Area();
+                }
+            }
+            if (open < 0)
+                break;
+            BinaryChildren(innerNodes, children[open].ref,
+                           children[open], children[n]);
+            n++;
+        }
+
+        Node node;
+        node.numChildren = n;
+        for (int c = 0; c < width; c++)
+        {
+            for (int d = 0; d < 6; d++)
+                node.bounds[d][c] = (c < n) ? children[c].box[d] : 0.f;
+            node.children[c] = -1;
+        }
+        for (int c = 0; c < n; c++)
+        {
+            if (children[c].ref >= 0)
+            {
+                node.children[c] = (int)binary.size();
+                binary.push_back(children[c].ref);
+            }
+            else
+                node.children[c] = children[c].ref;
+        }
+        nodes.push_back(node);
+    }
+}
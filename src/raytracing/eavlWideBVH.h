@@ -0,0 +1,218 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_WIDE_BVH_H
+#define EAVL_WIDE_BVH_H
+
+#include <vector>
+using std::vector;
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define EAVL_WIDE_BVH_WIDTH 8
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define EAVL_WIDE_BVH_WIDTH 4
+#else
+#define EAVL_WIDE_BVH_WIDTH 4
+#endif
+
+// ****************************************************************************
+// Class:  eavlWideBVH
+//
+// Purpose:
+///   A BVH whose inner nodes hold the bounds of up to eight children, for
+///   tracing rays on the CPU.  It is collapsed from the flat binary inner
+///   node array of the Morton or split BVH builders: each wide node takes
+///   the two children of a binary node, then repeatedly opens its child
+///   with the largest surface area until it holds width children or only
+///   leaves.  Leaf references are kept as the builders wrote them, so the
+///   binary leaf node array is used as is.
+///
+///   The child bounds are stored one plane per axis, so one ray is tested
+///   against all the children of a node at once: four at a time with
+///   SSE, or eight with AVX2 when built with it, falling back to a scalar
+///   loop elsewhere.
+//
+// Creation:    October 17, 2026
+//
+// Modifications:
+// ****************************************************************************
+class eavlWideBVH
+{
+  public:
+    static const int width = EAVL_WIDE_BVH_WIDTH;
+
+    struct Node
+    {
+        float bounds[6][width];     /// minx, miny, minz, maxx, maxy, maxz
+        int   children[width];      /// >= 0 a node, < 0 a binary leaf reference
+        int   numChildren;
+    };
+
+    /// Collapse a binary BVH in the builders' flat layout: 16 floats per
+    /// inner node, holding the bounds of both children then the two child
+    /// references, with inner node references counted in float4s.
+    eavlWideBVH(const float *innerNodes, int innerSize);
+
+    int         GetNumNodes() const { return (int)nodes.size(); }
+    const Node &GetNode(int i) const { return nodes[i]; }
+
+    /// Find the closest hit along a ray closer than minDistance.  For each
+    /// leaf the ray reaches, leaf(-ref - 1, minDistance) is called with the
+    /// leaf's offset in the leaf node array; it shortens minDistance when
+    /// it hits, and returns true to end the traversal (for occlusion rays).
+    template<class LeafIntersector>
+    void Traverse(float ox, float oy, float oz, float dirx, float diry,
+                  float dirz, LeafIntersector &leaf, float &minDistance) const;
+
+  protected:
+    vector<Node> nodes;
+
+    int IntersectNode(const Node &node, const float *inv, const float *odir,
+                      float maxDistance, float *tmin) const;
+};
+
+// Slab test of a ray against the children of a node.  Returns a bit mask
+// of the children whose bounds the ray enters before maxDistance, and the
+// entry distance of each child.
+inline int eavlWideBVH::IntersectNode(const Node &node, const float *inv,
+                                      const float *odir, float maxDistance,
+                                      float *tmin) const
+{
+    int valid = (1 << node.numChildren) - 1;
+#if defined(__AVX2__)
+    __m256 ix = _mm256_set1_ps(inv[0]), ox = _mm256_set1_ps(odir[0]);
+    __m256 iy = _mm256_set1_ps(inv[1]), oy = _mm256_set1_ps(odir[1]);
+    __m256 iz = _mm256_set1_ps(inv[2]), oz = _mm256_set1_ps(odir[2]);
+    __m256 tx0 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[0]), ix), ox);
+    __m256 ty0 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[1]), iy), oy);
+    __m256 tz0 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[2]), iz), oz);
+    __m256 tx1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[3]), ix), ox);
+    __m256 ty1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[4]), iy), oy);
+    __m256 tz1 = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(node.bounds[5]), iz), oz);
+    __m256 tn = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(tx0, tx1), _mm256_min_ps(ty0, ty1)),
+                              _mm256_max_ps(_mm256_min_ps(tz0, tz1), _mm256_setzero_ps()));
+    __m256 tf = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(tx0, tx1), _mm256_max_ps(ty0, ty1)),
+                              _mm256_min_ps(_mm256_max_ps(tz0, tz1), _mm256_set1_ps(maxDistance)));
+    _mm256_storeu_ps(tmin, tn);
+    return _mm256_movemask_ps(_mm256_cmp_ps(tn, tf, _CMP_LE_OQ)) & valid;
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128 ix = _mm_set1_ps(inv[0]), ox = _mm_set1_ps(odir[0]);
+    __m128 iy = _mm_set1_ps(inv[1]), oy = _mm_set1_ps(odir[1]);
+    __m128 iz = _mm_set1_ps(inv[2]), oz = _mm_set1_ps(odir[2]);
+    __m128 tx0 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[0]), ix), ox);
+    __m128 ty0 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[1]), iy), oy);
+    __m128 tz0 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[2]), iz), oz);
+    __m128 tx1 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[3]), ix), ox);
+    __m128 ty1 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[4]), iy), oy);
+    __m128 tz1 = _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(node.bounds[5]), iz), oz);
+    __m128 tn = _mm_max_ps(_mm_max_ps(_mm_min_ps(tx0, tx1), _mm_min_ps(ty0, ty1)),
+                           _mm_max_ps(_mm_min_ps(tz0, tz1), _mm_setzero_ps()));
+    __m128 tf = _mm_min_ps(_mm_min_ps(_mm_max_ps(tx0, tx1), _mm_max_ps(ty0, ty1)),
+                           _mm_min_ps(_mm_max_ps(tz0, tz1), _mm_set1_ps(maxDistance)));
+    _mm_storeu_ps(tmin, tn);
+    return _mm_movemask_ps(_mm_cmple_ps(tn, tf)) & valid;
+#else
+    int hits = 0;
+    for (int c = 0; c < width; c++)
+    {
+        float t[6];
+        for (int d = 0; d < 6; d++)
+            t[d] = node.bounds[d][c] * inv[d % 3] - odir[d % 3];
+        float tn = t[0] < t[3] ? t[0] : t[3];
+        float tf = t[0] < t[3] ? t[3] : t[0];
+        for (int d = 1; d < 3; d++)
+        {
+            float lo = t[d] < t[d+3] ? t[d] : t[d+3];
+            float hi = t[d] < t[d+3] ? t[d+3] : t[d];
+            tn = tn > lo ? tn : lo;
+            tf = tf < hi ? tf : hi;
+        }
+        tn = tn > 0.f ? tn : 0.f;
+        tf = tf < maxDistance ? tf : maxDistance;
+        tmin[c] = tn;
+        if (tn <= tf)
+            hits |= 1 << c;
+    }
+    return hits & valid;
+#endif
+}
+
+template<class LeafIntersector>
+void eavlWideBVH::Traverse(float ox, float oy, float oz, float dirx,
+                           float diry, float dirz, LeafIntersector &leaf,
+                           float &minDistance) const
+{
+    if (nodes.empty())
+        return;
+
+    // the same reciprocal the binary traversal uses, so both test the
+    // same boxes
+    float dir[3] = {dirx, diry, dirz};
+    float inv[3], odir[3];
+    float o[3] = {ox, oy, oz};
+    for (int d = 0; d < 3; d++)
+    {
+        float f = (dir[d] < 1e-8f && dir[d] > -1e-8f) ? 1e-8f : dir[d];
+        inv[d] = 1.f / f;
+        odir[d] = o[d] * inv[d];
+    }
+
+    // each node pushes at most width-1 children past the one visited
+    // next, and collapsing only makes the tree shallower
+    int   todo[64 * width];
+    float todoDist[64 * width];
+    int   stackptr = 0;
+    int   current = 0;
+
+    for (;;)
+    {
+        if (current >= 0)
+        {
+            const Node &node = nodes[current];
+            float tmin[width];
+            int mask = IntersectNode(node, inv, odir, minDistance, tmin);
+
+            // the children hit, nearest first
+            int   hit[width];
+            float hitDist[width];
+            int   nhit = 0;
+            for (int c = 0; mask; c++, mask >>= 1)
+            {
+                if (!(mask & 1))
+                    continue;
+                int i = nhit++;
+                while (i > 0 && hitDist[i-1] > tmin[c])
+                {
+                    hit[i] = hit[i-1];
+                    hitDist[i] = hitDist[i-1];
+                    i--;
+                }
+                hit[i] = node.children[c];
+                hitDist[i] = tmin[c];
+            }
+            for (int i = nhit - 1; i >= 0; i--)
+            {
+                todo[stackptr] = hit[i];
+                todoDist[stackptr] = hitDist[i];
+                stackptr++;
+            }
+        }
+        else
+        {
+            if (leaf(-current - 1, minDistance))
+                return;
+        }
+
+        // skip anything farther than the closest hit found since it was
+        // pushed
+        do
+        {
+            if (stackptr == 0)
+                return;
+            stackptr--;
+        } while (todoDist[stackptr] > minDistance);
+        current = todo[stackptr];
+    }
+}
+
+#endif
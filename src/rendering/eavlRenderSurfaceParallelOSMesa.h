@@ -30,7 +30,7 @@ class eavlRenderSurfaceParallelOSMesa : public eavlRenderSurfaceOSMesa
         const unsigned char *rgba = GetRGBABuffer();
         const float *zbuff = GetZBuffer();
 
-        MPI_Errhandler_set(MPI_COMM_WORLD,MPI_ERRORS_RETURN);                    
+        MPI_Comm_set_errhandler(MPI_COMM_WORLD,MPI_ERRORS_RETURN);
         ParallelZComposite(comm,
                            npixels,
                            zbuff, rgba,
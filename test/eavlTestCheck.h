@@ -0,0 +1,38 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#ifndef EAVL_TEST_CHECK_H
+#define EAVL_TEST_CHECK_H
+
+#include "eavl.h"
+
+// Scaffolding shared by the self-verifying tests: each failed Check is
+// reported and clears "ok", and main returns VerificationResult(), which
+// reports the outcome and gives the exit status.
+
+static bool ok = true;
+
+static inline void Check(bool cond, const std::string &what)
+{
+    if (!cond)
+    {
+        cout << "FAILED: " << what << endl;
+        ok = false;
+    }
+}
+
+static inline void PrintUsage(const char *usage)
+{
+    cout <<"\nUsage: "<<usage<<endl;
+}
+
+static inline int VerificationResult()
+{
+    if (!ok)
+    {
+        cout << "Verification failed.\n";
+        return 1;
+    }
+    cout << "Verified.\n";
+    return 0;
+}
+
+#endif
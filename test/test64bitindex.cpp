@@ -0,0 +1,209 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlExecutor.h"
+#include "eavlRegularStructure.h"
+#include "eavlMapOp.h"
+#include "eavlReduceOp_1.h"
+#include "eavlPrefixSumOp_1.h"
+#include "eavlRadixSortOp.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Checks the index arithmetic of eavlIndex: linear indexing of strided
+// arrays, regular structure counts and logical indices, and the map,
+// reduce, prefix sum and sort operations on the CPU and thread pool
+// backends.  With "large", and in a build configured with 64-bit
+// indices, also maps and reduces a byte array of more than 2^31 values
+// (a little over 2 GB) and checks the values past 2^31.
+
+static const char *usage = "test64bitindex [large]";
+
+struct DoubleFunctor
+{
+    EAVL_FUNCTOR unsigned char operator()(unsigned char x) { return x * 2; }
+};
+
+struct ToKeyFunctor
+{
+    EAVL_FUNCTOR int operator()(int x) { return (x * 7919) % 1000; }
+};
+
+static void CheckIndexing()
+{
+    // plain and wrapping strides
+    Check(eavlLinearIndex(10, 1, INT_MAX, 1, 0) == 10, "plain index");
+    Check(eavlLinearIndex(10, 2, 3, 4, 1) == ((10/2)%3)*4+1, "strided index");
+    Check(eavlArrayIndexer().index(123456789) == 123456789,
+          "default indexer does not wrap");
+
+    eavlRegularStructure reg;
+    reg.SetNodeDimension3D(301, 201, 101);
+    Check(reg.GetNumNodes() == eavlIndex(301)*201*101, "number of nodes");
+    Check(reg.GetNumCells() == eavlIndex(300)*200*100, "number of cells");
+    int i, j, k;
+    reg.CalculateLogicalNodeIndices3D(reg.CalculateNodeIndex3D(300,17,100),
+                                      i, j, k);
+    Check(i == 300 && j == 17 && k == 100, "logical node indices");
+
+#ifdef EAVL_64BIT_INDICES
+    // a 2049^3 lattice has more than 2^33 nodes
+    reg.SetNodeDimension3D(2049, 2049, 2049);
+    long long n = 2049;
+    Check((long long)reg.GetNumNodes() == n*n*n, "large number of nodes");
+    Check((long long)reg.GetNumCells() == (n-1)*(n-1)*(n-1),
+          "large number of cells");
+    Check((long long)reg.CalculateNodeIndex3D(2048,2048,2048) == n*n*n-1,
+          "large node index");
+    reg.CalculateLogicalNodeIndices3D(n*n*n-2, i, j, k);
+    Check(i == 2047 && j == 2048 && k == 2048, "large logical indices");
+    Check(eavlLinearIndex(n*n*n, 1, INT_MAX, 1, 0) == n*n*n,
+          "no wrap past 2^31");
+#endif
+}
+
+static void CheckOps(int n)
+{
+    const eavlExecutor::ExecutionMode modes[] =
+        { eavlExecutor::ForceCPU, eavlExecutor::ForceCPUThreadPool };
+    const char *modenames[] = { "cpu", "thread pool" };
+    for (int m=0; m<2; m++)
+    {
+        eavlExecutor::SetExecutionMode(modes[m]);
+        string mode(modenames[m]);
+
+        eavlIntArray *values = new eavlIntArray("values", 1, n);
+        eavlIntArray *sums = new eavlIntArray("sums", 1, n);
+        eavlIntArray *keys = new eavlIntArray("keys", 1, n);
+        eavlIntArray *order = new eavlIntArray("order", 1, n);
+        eavlIntArray *total = new eavlIntArray("total", 1, 1);
+        for (int i=0; i<n; i++)
+            values->SetValue(i, i % 5);
+
+        eavlExecutor::AddOperation(
+            new eavlPrefixSumOp_1(values, sums, true), "prefix sum");
+        eavlExecutor::AddOperation(
+            new eavlReduceOp_1<eavlAddFunctor<int> >
+                (values, total, eavlAddFunctor<int>()),
+            "sum");
+        eavlExecutor::AddOperation(
+            new_eavlMapOp(eavlOpArgs(values), eavlOpArgs(keys),
+                          ToKeyFunctor()),
+            "make keys");
+        eavlExecutor::AddOperation(
+            new_eavlRadixSortOp(eavlOpArgs(keys), eavlOpArgs(order), true),
+            "sort");
+        eavlExecutor::Go();
+
+        int running = 0;
+        for (int i=0; i<n; i++)
+        {
+            running += i % 5;
+            if (sums->GetValue(i) != running)
+            {
+                Check(false, mode + " prefix sum");
+                break;
+            }
+        }
+        Check(total->GetValue(0) == running, mode + " reduction");
+        for (int i=0; i<n; i++)
+        {
+            int o = order->GetValue(i);
+            if ((i > 0 && keys->GetValue(i-1) > keys->GetValue(i)) ||
+                o < 0 || o >= n ||
+                ToKeyFunctor()(values->GetValue(o)) != keys->GetValue(i))
+            {
+                Check(false, mode + " sort");
+                break;
+            }
+        }
+
+        delete values;
+        delete sums;
+        delete keys;
+        delete order;
+        delete total;
+    }
+}
+
+#ifdef EAVL_64BIT_INDICES
+static void CheckLargeArray()
+{
+    eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+    eavlIndex n = eavlIndex(INT_MAX) + 1025;
+    eavlIndex marked = n - 7;
+
+    int th = eavlTimer::Start();
+    eavlByteArray *values = new eavlByteArray("values", 1, n);
+    for (eavlIndex i=0; i<n; i++)
+        values->SetValue(i, (unsigned char)(i % 3));
+    values->SetValue(marked, 50);
+    double fillTime = eavlTimer::Stop(th, "");
+    Check(values->GetNumberOfTuples() == n, "large array length");
+
+    eavlByteArray *maxval = new eavlByteArray("max", 1, 1);
+    th = eavlTimer::Start();
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(values), eavlOpArgs(values),
+                      DoubleFunctor()),
+        "double values");
+    eavlExecutor::AddOperation(
+        new eavlReduceOp_1<eavlMaxFunctor<unsigned char> >
+            (values, maxval, eavlMaxFunctor<unsigned char>()),
+        "max");
+    eavlExecutor::Go();
+    double opTime = eavlTimer::Stop(th, "");
+
+    Check(maxval->GetValue(0) == 100, "large array reduction");
+    Check(values->GetValue(marked) == 100, "large array value past 2^31");
+    Check(values->GetValue(n-1) == (unsigned char)(2 * ((n-1) % 3)),
+          "large array last value");
+    Check(values->GetValue(eavlIndex(INT_MAX) + 1) ==
+          (unsigned char)(2 * ((eavlIndex(INT_MAX) + 1) % 3)),
+          "large array value at 2^31");
+
+    cout << n << " byte values" << endl;
+    cout << "  fill:         " << fillTime << endl;
+    cout << "  map and max:  " << opTime << endl;
+
+    delete values;
+    delete maxval;
+}
+#endif
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        bool large = (argc == 2 && string(argv[1]) == "large");
+        if (argc > 2 || (argc == 2 && !large))
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+
+        cout << "eavlIndex is " << 8*sizeof(eavlIndex) << "-bit" << endl;
+        CheckIndexing();
+        CheckOps(100000);
+        if (large)
+        {
+#ifdef EAVL_64BIT_INDICES
+            CheckLargeArray();
+#else
+            cout << "large array check skipped: "
+                 << "needs a build with 64-bit indices" << endl;
+#endif
+        }
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
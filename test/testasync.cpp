@@ -0,0 +1,185 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlExecutor.h"
+#include "eavlGatherOp.h"
+#include "eavlMapOp.h"
+#include "eavlReduceOp_1.h"
+#include "eavlThreadPool.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Runs a small plan shaped like the end of the isosurface pipeline (three
+// independent per-component gathers, then operations combining them)
+// asynchronously, doing other work while it runs, and checks that the
+// dependencies between the operations were honored.
+
+static const char *usage = "testasync [nvalues] [niterations]";
+
+struct ScaleFunctor
+{
+    float s;
+    ScaleFunctor(float s_) : s(s_) { }
+    EAVL_FUNCTOR float operator()(float x) { return x * s; }
+};
+
+static void RunPlan(int n, bool async)
+{
+    eavlFloatArray *coords = new eavlFloatArray("coords", 3, n);
+    eavlIntArray *index = new eavlIntArray("index", 1, n);
+    for (int i=0; i<n; i++)
+    {
+        index->SetValue(i, n-1-i);
+        for (int c=0; c<3; c++)
+            coords->SetComponentFromDouble(i, c, i % 100 + c);
+    }
+    eavlFloatArray *x = new eavlFloatArray("x", 1, n);
+    eavlFloatArray *y = new eavlFloatArray("y", 1, n);
+    eavlFloatArray *z = new eavlFloatArray("z", 1, n);
+    eavlFloatArray *sum = new eavlFloatArray("sum", 1, n);
+    eavlFloatArray *total = new eavlFloatArray("total", 1, 1);
+
+    eavlExecutor::AddOperation(
+        new_eavlGatherOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(coords, 0)),
+                         eavlOpArgs(x), eavlOpArgs(index)),
+        "gather x");
+    eavlExecutor::AddOperation(
+        new_eavlGatherOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(coords, 1)),
+                         eavlOpArgs(y), eavlOpArgs(index)),
+        "gather y");
+    eavlExecutor::AddOperation(
+        new_eavlGatherOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(coords, 2)),
+                         eavlOpArgs(z), eavlOpArgs(index)),
+        "gather z");
+    // must wait for the gathers to read the coordinates
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(coords, 0)),
+                      eavlOpArgs(eavlIndexable<eavlFloatArray>(coords, 0)),
+                      ScaleFunctor(-1)),
+        "negate coords x");
+    // must wait for all three gathers
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(x, y, z), eavlOpArgs(sum),
+                      eavlAddFunctor<float>()),
+        "sum components");
+    eavlExecutor::AddOperation(
+        new eavlReduceOp_1<eavlAddFunctor<float> >
+            (sum, total, eavlAddFunctor<float>()),
+        "total");
+
+    if (async)
+    {
+        eavlPlanFuture future = eavlExecutor::GoAsync();
+        // stand-in for I/O overlapping the plan
+        double busy = 0;
+        for (int i=0; i<n; i++)
+            busy += i % 7;
+        Check(busy > 0 || n == 0, "caller work");
+        future.Wait();
+        Check(future.IsDone(), "future done after wait");
+    }
+    else
+    {
+        eavlExecutor::Go();
+    }
+
+    double expected = 0;
+    for (int i=0; i<n; i++)
+    {
+        int j = n-1-i;
+        float vx = j % 100, vy = j % 100 + 1, vz = j % 100 + 2;
+        if (x->GetValue(i) != vx || y->GetValue(i) != vy ||
+            z->GetValue(i) != vz || sum->GetValue(i) != vx + vy + vz)
+        {
+            cout << "Mismatch at " << i << endl;
+            ok = false;
+            break;
+        }
+        if (coords->GetComponentAsDouble(i, 0) != -(i % 100))
+        {
+            cout << "Coordinates negated too early or not at all at "
+                 << i << endl;
+            ok = false;
+            break;
+        }
+        expected += vx + vy + vz;
+    }
+    Check(fabs(total->GetValue(0) - expected) <= 1.e-3 * expected,
+          "reduced total");
+
+    delete coords;
+    delete index;
+    delete x;
+    delete y;
+    delete z;
+    delete sum;
+    delete total;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int nvalues = (argc > 1) ? atoi(argv[1]) : 10000;
+        int niter = (argc > 2) ? atoi(argv[2]) : 20;
+        if (nvalues < 1 || niter < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+        cout << "Running " << niter << " plans on "
+             << eavlThreadPool::GetNumberOfThreads() << " threads" << endl;
+
+        RunPlan(nvalues, false);
+        for (int it=0; it<niter; it++)
+            RunPlan(nvalues, true);
+
+        // Go waits for the same concurrent execution
+        eavlExecutor::SetConcurrentExecution(true);
+        RunPlan(nvalues, false);
+        eavlExecutor::SetConcurrentExecution(false);
+
+        // an empty plan is done immediately
+        eavlPlanFuture empty = eavlExecutor::GoAsync();
+        Check(empty.IsDone(), "empty plan");
+
+#ifndef HAVE_CUDA
+        // failures are reported by Wait
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceGPU);
+        eavlFloatArray *a = new eavlFloatArray("a", 1, 10);
+        eavlExecutor::AddOperation(
+            new_eavlMapOp(eavlOpArgs(a), eavlOpArgs(a), ScaleFunctor(2)),
+            "needs a GPU");
+        eavlPlanFuture failing = eavlExecutor::GoAsync();
+        bool threw = false;
+        try
+        {
+            failing.Wait();
+        }
+        catch (const eavlException &)
+        {
+            threw = true;
+        }
+        Check(threw, "error reported by Wait");
+        delete a;
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+#endif
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -9,6 +9,7 @@
 #include "eavlImporterFactory.h"
 #include "eavlLAMMPSDumpImporter.h"
 #include "eavlVTKExporter.h"
+#include "eavlBondFinder.h"
 
 #include "eavlIsosurfaceFilter.h"
 #include "eavlPointDistanceFieldFilter.h"
@@ -77,6 +78,15 @@ void FillXYZArraysFromFile(const std::string &filename)
             z.push_back(data->GetPoint(i, 2));
         }
     }
+
+    // bonds between all the atoms of the snapshot
+    cerr << "FINDING BONDS\n";
+    vector<int> typeToElement;
+    typeToElement.push_back(74); // W
+    typeToElement.push_back(2);  // He
+    eavlBondFinder bonds;
+    bonds.FindBonds(data, "type", typeToElement);
+    cerr << "FOUND " << bonds.GetNumBonds() << " BONDS\n";
     delete data;
 
     cerr << "USING " << x.size() << " ATOMS OUT OF "<<npts<<" IN THE FILE\n";
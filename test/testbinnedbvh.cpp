@@ -0,0 +1,504 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlVector4.h"
+#include "MortonBVHBuilder.h"
+#include "SplitBVH.h"
+#include "eavlBinnedBVHBuilder.h"
+#include "eavlTestCheck.h"
+
+#include <cstdio>
+#include <iomanip>
+
+using namespace std;
+
+// Builds BVHs over a closed, bumpy surface like an isosurface with the
+// Morton, split and binned SAH builders.  Checks that the binned BVH's
+// flat arrays are well formed: every triangle in exactly one leaf, no
+// leaf over the size limit, and every box holding what is under it; that
+// it is the same when built again, and for spheres and cylinders too.
+// Traces rays through all three, which must find the same closest hits,
+// and the same as testing every triangle for some of them.  Reports the
+// build time, the SAH cost, the nodes visited and triangles tested per
+// ray, and the trace time of each builder's BVH.
+
+static const char *usage = "testbinnedbvh [ntriangles] [nrays]";
+
+enum Builder { Morton, Split, Binned };
+
+static void Build(float *verts, int nprims, primitive_t primType, Builder builder,
+                  float *&inner, int &innerSize, float *&leaf, int &leafSize)
+{
+    if (builder == Morton)
+    {
+        MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(verts, nprims, primType);
+        mortonBVH->build();
+        inner = mortonBVH->getInnerNodes(innerSize);
+        leaf = mortonBVH->getLeafNodes(leafSize);
+        delete mortonBVH;
+    }
+    else if (builder == Split)
+    {
+        SplitBVH *sbvh = new SplitBVH(verts, nprims, primType);
+        sbvh->getFlatArray(innerSize, leafSize, inner, leaf);
+        delete sbvh;
+    }
+    else
+    {
+        eavlBinnedBVHBuilder binnedBVH(verts, nprims, primType);
+        binnedBVH.build();
+        inner = binnedBVH.getInnerNodes(innerSize);
+        leaf = binnedBVH.getLeafNodes(leafSize);
+    }
+}
+
+struct Ray
+{
+    float o[3];
+    float d[3];
+};
+
+// Tests a ray against one triangle, packed as the ray tracer packs them:
+// nine coordinates then three scalars.
+static bool HitTriangle(const float *tri, const Ray &ray, float &dist)
+{
+    float e1[3], e2[3], p[3], t[3], q[3];
+    for (int c=0; c<3; c++)
+    {
+        e1[c] = tri[3+c] - tri[c];
+        e2[c] = tri[6+c] - tri[c];
+        t[c] = ray.o[c] - tri[c];
+    }
+    p[0] = ray.d[1]*e2[2] - ray.d[2]*e2[1];
+    p[1] = ray.d[2]*e2[0] - ray.d[0]*e2[2];
+    p[2] = ray.d[0]*e2[1] - ray.d[1]*e2[0];
+    float dot = e1[0]*p[0] + e1[1]*p[1] + e1[2]*p[2];
+    if (dot == 0.f)
+        return false;
+    dot = 1.f / dot;
+    float u = (t[0]*p[0] + t[1]*p[1] + t[2]*p[2]) * dot;
+    if (u < 0.f || u > 1.f)
+        return false;
+    q[0] = t[1]*e1[2] - t[2]*e1[1];
+    q[1] = t[2]*e1[0] - t[0]*e1[2];
+    q[2] = t[0]*e1[1] - t[1]*e1[0];
+    float v = (ray.d[0]*q[0] + ray.d[1]*q[1] + ray.d[2]*q[2]) * dot;
+    if (v < 0.f || u + v > 1.f)
+        return false;
+    dist = (e2[0]*q[0] + e2[1]*q[1] + e2[2]*q[2]) * dot;
+    return dist > 0.f;
+}
+
+// The ray tracer's binary traversal for the closest hit, counting the
+// inner nodes visited and the triangles tested.
+static int Trace(const float *inner, const float *leafNodes,
+                 const float *verts, const Ray &ray, float &minDistance,
+                 long long &nodes, long long &tests)
+{
+    float inv[3], odir[3];
+    for (int c=0; c<3; c++)
+    {
+        float f = (fabs(ray.d[c]) < 1e-8f) ? 1e-8f : ray.d[c];
+        inv[c] = 1.f / f;
+        odir[c] = ray.o[c] * inv[c];
+    }
+    int minIndex = -1;
+    int todo[64];
+    int stackptr = 0;
+    todo[0] = -1000000000;
+    int current = 0;
+    while (current != -1000000000)
+    {
+        if (current > -1)
+        {
+            nodes++;
+            const float *n = inner + current*4;
+            float tmin[2], tmax[2];
+            for (int k=0; k<2; k++)
+            {
+                const float *b = n + k*6;
+                float lo = 0.f, hi = minDistance;
+                for (int c=0; c<3; c++)
+                {
+                    float t0 = b[c] * inv[c] - odir[c];
+                    float t1 = b[c+3] * inv[c] - odir[c];
+                    lo = max(lo, min(t0, t1));
+                    hi = min(hi, max(t0, t1));
+                }
+                tmin[k] = lo;
+                tmax[k] = hi;
+            }
+            bool hit0 = tmax[0] >= tmin[0], hit1 = tmax[1] >= tmin[1];
+            if (!hit0 && !hit1)
+            {
+                current = todo[stackptr--];
+            }
+            else
+            {
+                int left = (int)n[12], right = (int)n[13];
+                current = hit0 ? left : right;
+                if (hit0 && hit1)
+                {
+                    if (tmin[0] > tmin[1])
+                    {
+                        current = right;
+                        todo[++stackptr] = left;
+                    }
+                    else
+                        todo[++stackptr] = right;
+                }
+            }
+        }
+        if (current < 0 && current != -1000000000)
+        {
+            int leaf = -current - 1;
+            int count = (int)leafNodes[leaf];
+            for (int i=1; i<=count; i++)
+            {
+                int t = (int)leafNodes[leaf + i];
+                float dist;
+                tests++;
+                if (HitTriangle(verts + t*12, ray, dist) && dist < minDistance)
+                {
+                    minDistance = dist;
+                    minIndex = t;
+                }
+            }
+            current = todo[stackptr--];
+        }
+    }
+    return minIndex;
+}
+
+static float HalfArea(const float *box)
+{
+    float dx = box[3] - box[0], dy = box[4] - box[1], dz = box[5] - box[2];
+    if (dx < 0.f || dy < 0.f || dz < 0.f)
+        return 0.f;
+    return dx*dy + dy*dz + dz*dx;
+}
+
+// The SAH cost of a flat BVH, with inner nodes and primitive tests both
+// costing one.
+static double SAHCost(const float *inner, int innerSize, const float *leafNodes)
+{
+    float root[6];
+    for (int d=0; d<3; d++)
+    {
+        root[d] = min(inner[d], inner[6+d]);
+        root[d+3] = max(inner[3+d], inner[9+d]);
+    }
+    double cost = HalfArea(root);
+    for (int i=0; i<innerSize/16; i++)
+    {
+        for (int k=0; k<2; k++)
+        {
+            int ref = (int)inner[i*16 + 12 + k];
+            float area = HalfArea(inner + i*16 + k*6);
+            cost += (ref < 0) ? area * leafNodes[-ref - 1] : area;
+        }
+    }
+    return cost / HalfArea(root);
+}
+
+static bool Contains(const float *outer, const float *box)
+{
+    for (int d=0; d<3; d++)
+        if (box[d] < outer[d] || box[d+3] > outer[d+3])
+            return false;
+    return true;
+}
+
+// Checks a binned BVH's flat arrays against the boxes of its primitives:
+// the references are in range, every primitive is in one leaf, and every
+// box holds the boxes of the nodes and primitives under it.
+static void CheckTree(const float *inner, int innerSize, const float *leafNodes,
+                      int leafSize, const vector<float> &primBoxes,
+                      const string &what)
+{
+    int nprims = (int)primBoxes.size() / 6;
+    int ninner = innerSize / 16;
+    vector<int> seen(nprims, 0), leafRefs(leafSize, 0), innerRefs(ninner, 0);
+    bool refsOk = (innerSize % 16 == 0 && ninner > 0), boxesOk = true;
+    bool sizesOk = true;
+    for (int i=0; refsOk && i<ninner; i++)
+    {
+        for (int k=0; refsOk && k<2; k++)
+        {
+            const float *box = inner + i*16 + k*6;
+            int ref = (int)inner[i*16 + 12 + k];
+            if (ref >= 0)
+            {
+                refsOk = (ref % 4 == 0 && ref/4 > i && ref/4 < ninner);
+                if (!refsOk)
+                    break;
+                innerRefs[ref/4]++;
+                const float *child = inner + ref*4;
+                float childBox[6];
+                for (int d=0; d<3; d++)
+                {
+                    childBox[d] = min(child[d], child[6+d]);
+                    childBox[d+3] = max(child[3+d], child[9+d]);
+                }
+                boxesOk = boxesOk && Contains(box, childBox);
+            }
+            else
+            {
+                int leaf = -ref - 1;
+                refsOk = (leaf < leafSize);
+                if (!refsOk)
+                    break;
+                leafRefs[leaf]++;
+                int count = (int)leafNodes[leaf];
+                sizesOk = sizesOk && count >= 1 && count <= 8 &&
+                          leaf + count < leafSize;
+                for (int p=1; sizesOk && p<=count; p++)
+                {
+                    int prim = (int)leafNodes[leaf + p];
+                    sizesOk = (prim >= 0 && prim < nprims);
+                    if (sizesOk)
+                    {
+                        seen[prim]++;
+                        boxesOk = boxesOk && Contains(box, &primBoxes[prim*6]);
+                    }
+                }
+            }
+        }
+    }
+    for (int i=1; refsOk && i<ninner; i++)
+        refsOk = (innerRefs[i] == 1);
+    Check(refsOk, what + " node references");
+    Check(sizesOk, what + " leaf sizes");
+    Check(boxesOk, what + " boxes hold what is under them");
+    bool once = refsOk && sizesOk;
+    for (int p=0; once && p<nprims; p++)
+        once = (seen[p] == 1);
+    Check(once, what + " every primitive in one leaf");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int ntris = (argc > 1) ? atoi(argv[1]) : 50000;
+        int nrays = (argc > 2) ? atoi(argv[2]) : 100000;
+        if (ntris < 2 || nrays < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        // a bumpy sphere, cut into a grid of quads by latitude and
+        // longitude, two triangles each
+        int nu = max(2, (int)sqrt(ntris / 2.));
+        int nv = max(1, ntris / 2 / nu);
+        ntris = nu * nv * 2;
+        float *verts = new float[ntris * 12];
+        vector<float> triBoxes(ntris * 6);
+        for (int i=0; i<nu; i++)
+        {
+            for (int j=0; j<nv; j++)
+            {
+                float p[4][3];
+                for (int c=0; c<4; c++)
+                {
+                    float u = 2.f * 3.14159265f * ((i + c%2) % nu) / nu;
+                    float v = 3.14159265f * (0.02f + 0.96f * (j + c/2) / nv);
+                    float r = 1.f + 0.1f * sin(7.f*u) * sin(5.f*v) +
+                              0.03f * sin(31.f*u + 17.f*v);
+                    p[c][0] = r * cos(u) * sin(v);
+                    p[c][1] = r * cos(v);
+                    p[c][2] = r * sin(u) * sin(v);
+                }
+                const int corners[2][3] = {{0, 1, 2}, {1, 3, 2}};
+                for (int k=0; k<2; k++)
+                {
+                    int t = (i*nv + j)*2 + k;
+                    for (int c=0; c<3; c++)
+                        for (int d=0; d<3; d++)
+                            verts[t*12 + c*3 + d] = p[corners[k][c]][d];
+                    for (int s=9; s<12; s++)
+                        verts[t*12 + s] = 0.f;
+                    for (int d=0; d<3; d++)
+                    {
+                        triBoxes[t*6 + d] = min(verts[t*12 + d],
+                                            min(verts[t*12 + 3 + d], verts[t*12 + 6 + d]));
+                        triBoxes[t*6 + 3 + d] = max(verts[t*12 + d],
+                                                max(verts[t*12 + 3 + d], verts[t*12 + 6 + d]));
+                    }
+                }
+            }
+        }
+
+        // rays from around the surface towards points near its middle
+        vector<Ray> rays(nrays);
+        srand(7);
+        for (int r=0; r<nrays; r++)
+        {
+            float len2 = 0;
+            for (int c=0; c<3; c++)
+            {
+                rays[r].o[c] = -2.5f + 5.f * rand() / float(RAND_MAX);
+                rays[r].d[c] = -0.5f + rand() / float(RAND_MAX) - rays[r].o[c];
+                len2 += rays[r].d[c] * rays[r].d[c];
+            }
+            for (int c=0; c<3; c++)
+                rays[r].d[c] /= sqrt(len2);
+        }
+
+        cout << ntris << " triangles, " << nrays << " rays" << endl;
+        cout << "builder  build time  SAH cost  nodes/ray  tests/ray  trace time" << endl;
+        const char *names[3] = {"morton", "split ", "binned"};
+        vector<int>   hit[3];
+        vector<float> hitDist[3];
+        double cost[3];
+        for (int b=0; b<3; b++)
+        {
+            const string name = names[b];
+            float *inner = NULL, *leafNodes = NULL;
+            int innerSize = 0, leafSize = 0;
+            int th = eavlTimer::Start();
+            Build(verts, ntris, TRIANGLE, Builder(b), inner, innerSize,
+                  leafNodes, leafSize);
+            double buildTime = eavlTimer::Stop(th, "");
+
+            if (b == Binned)
+            {
+                CheckTree(inner, innerSize, leafNodes, leafSize, triBoxes, name);
+
+                float *inner2 = NULL, *leaf2 = NULL;
+                int innerSize2 = 0, leafSize2 = 0;
+                Build(verts, ntris, TRIANGLE, Binned, inner2, innerSize2,
+                      leaf2, leafSize2);
+                Check(innerSize2 == innerSize && leafSize2 == leafSize &&
+                      memcmp(inner2, inner, innerSize * sizeof(float)) == 0 &&
+                      memcmp(leaf2, leafNodes, leafSize * sizeof(float)) == 0,
+                      "binned BVH is the same when built again");
+                delete[] inner2;
+                delete[] leaf2;
+            }
+
+            cost[b] = SAHCost(inner, innerSize, leafNodes);
+            hit[b].resize(nrays);
+            hitDist[b].resize(nrays);
+            long long nodes = 0, tests = 0;
+            th = eavlTimer::Start();
+            for (int r=0; r<nrays; r++)
+            {
+                hitDist[b][r] = 1.e6f;
+                hit[b][r] = Trace(inner, leafNodes, verts, rays[r],
+                                  hitDist[b][r], nodes, tests);
+            }
+            double traceTime = eavlTimer::Stop(th, "");
+
+            cout << name << "  " << setw(10) << buildTime
+                 << "  " << setw(8) << cost[b]
+                 << "  " << setw(9) << double(nodes) / nrays
+                 << "  " << setw(9) << double(tests) / nrays
+                 << "  " << setw(10) << traceTime << endl;
+            delete[] inner;
+            delete[] leafNodes;
+        }
+
+        int hits = 0;
+        bool same = true;
+        for (int r=0; r<nrays; r++)
+        {
+            if (hit[Binned][r] >= 0)
+                hits++;
+            for (int b=0; b<Binned; b++)
+                if (hitDist[b][r] != hitDist[Binned][r] ||
+                    (hit[b][r] < 0) != (hit[Binned][r] < 0))
+                    same = false;
+        }
+        Check(hits > nrays / 10, "rays hit triangles");
+        Check(same, "closest hits match the other builders'");
+        Check(cost[Binned] < cost[Morton], "binned SAH cost below morton's");
+
+        // against every triangle, for some of the rays
+        same = true;
+        for (int r=0; r<nrays && r<200; r++)
+        {
+            float minDist = 1.e6f;
+            for (int t=0; t<ntris; t++)
+            {
+                float dist;
+                if (HitTriangle(verts + t*12, rays[r], dist) && dist < minDist)
+                    minDist = dist;
+            }
+            if (minDist != hitDist[Binned][r])
+                same = false;
+        }
+        Check(same, "binned closest hits match all triangles");
+        delete[] verts;
+
+        // spheres and cylinders along a helix
+        int nprims = 5000;
+        vector<float> spheres(nprims * 4), cyls(nprims * 8);
+        vector<float> sphereBoxes(nprims * 6), cylBoxes(nprims * 6);
+        for (int i=0; i<nprims; i++)
+        {
+            float a = 0.01f * i;
+            float c[3] = {cos(a), 0.001f * i, sin(a)};
+            float radius = 0.01f + 0.005f * (i % 3);
+            float axis[3] = {-sin(a), 0.f, cos(a)};
+            float height = 0.02f;
+            for (int d=0; d<3; d++)
+            {
+                spheres[i*4 + d] = c[d];
+                cyls[i*8 + d] = c[d];
+                cyls[i*8 + 4 + d] = axis[d];
+                sphereBoxes[i*6 + d] = c[d] - radius;
+                sphereBoxes[i*6 + 3 + d] = c[d] + radius;
+                float top = c[d] + axis[d] * height;
+                cylBoxes[i*6 + d] = min(c[d], top) - radius;
+                cylBoxes[i*6 + 3 + d] = max(c[d], top) + radius;
+            }
+            spheres[i*4 + 3] = radius;
+            cyls[i*8 + 3] = radius;
+            cyls[i*8 + 7] = height;
+        }
+        for (int s=0; s<2; s++)
+        {
+            float *inner = NULL, *leafNodes = NULL;
+            int innerSize = 0, leafSize = 0;
+            Build(s ? &cyls[0] : &spheres[0], nprims, s ? CYLINDER : SPHERE,
+                  Binned, inner, innerSize, leafNodes, leafSize);
+            CheckTree(inner, innerSize, leafNodes, leafSize,
+                      s ? cylBoxes : sphereBoxes,
+                      s ? "binned cylinders" : "binned spheres");
+            delete[] inner;
+            delete[] leafNodes;
+        }
+
+        // a single primitive still gets an inner node
+        {
+            float *inner = NULL, *leafNodes = NULL;
+            int innerSize = 0, leafSize = 0;
+            Build(&spheres[0], 1, SPHERE, Binned, inner, innerSize,
+                  leafNodes, leafSize);
+            Check(innerSize == 16 && leafSize == 2 && inner[12] == -1.f &&
+                  leafNodes[0] == 1.f && leafNodes[1] == 0.f &&
+                  Contains(inner, &sphereBoxes[0]),
+                  "binned BVH of one primitive");
+            delete[] inner;
+            delete[] leafNodes;
+        }
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
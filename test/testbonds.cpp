@@ -0,0 +1,251 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlAtomicProperties.h"
+#include "eavlBondFinder.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+// Finds the bonds between randomly placed atoms of mixed elements with
+// eavlBondFinder and checks them against a search over all pairs, for a
+// box of atoms at about liquid density, a flat sheet, and sparse
+// clusters spread far apart.  Also checks the bond cell set, and
+// finding bonds from a data set with a LAMMPS-style species type field.
+// Prints the time of the cell list and all-pairs searches.
+
+static const char *usage = "testbonds [number of atoms]";
+
+struct Atoms
+{
+    vector<float> x, y, z;
+    vector<int>   element;
+
+    int size() const { return int(x.size()); }
+    void Add(float px, float py, float pz, int e)
+    {
+        x.push_back(px);
+        y.push_back(py);
+        z.push_back(pz);
+        element.push_back(e);
+    }
+};
+
+// a small generator, so the atoms are the same everywhere
+static unsigned int seed = 12345;
+static float Random()
+{
+    seed = seed * 1664525u + 1013904223u;
+    return float(seed >> 8) / float(1 << 24);
+}
+
+static int RandomElement()
+{
+    // mostly organic, with a few metals, an unknown element and one
+    // outside the table
+    static const int elements[10] = {1, 1, 6, 6, 7, 8, 16, 74, 0, 500};
+    return elements[int(Random() * 10) % 10];
+}
+
+static float Radius(int e)
+{
+    return covalent_radius[(e < 0 || e > MAX_ELEMENT_NUMBER) ? 0 : e];
+}
+
+static vector<int> AllPairs(const Atoms &atoms, float tolerance,
+                            float minDistance)
+{
+    vector<int> bonds;
+    int n = atoms.size();
+    float minDistance2 = minDistance * minDistance;
+    for (int a=0; a<n; a++)
+    {
+        float ra = Radius(atoms.element[a]);
+        for (int b=a+1; b<n; b++)
+        {
+            float dx = atoms.x[b] - atoms.x[a];
+            float dy = atoms.y[b] - atoms.y[a];
+            float dz = atoms.z[b] - atoms.z[a];
+            float dist2 = dx*dx + dy*dy + dz*dz;
+            float maxDist = ra + Radius(atoms.element[b]) + tolerance;
+            if (dist2 > minDistance2 && dist2 < maxDist*maxDist)
+            {
+                bonds.push_back(a);
+                bonds.push_back(b);
+            }
+        }
+    }
+    return bonds;
+}
+
+static bool SameBonds(const eavlBondFinder &finder, const vector<int> &ref)
+{
+    if (finder.GetNumBonds() * 2 != (eavlIndex)ref.size())
+        return false;
+    for (eavlIndex i=0; i<finder.GetNumBonds(); i++)
+    {
+        if (finder.GetBondAtom(i, 0) != ref[i*2] ||
+            finder.GetBondAtom(i, 1) != ref[i*2+1])
+            return false;
+    }
+    return true;
+}
+
+static void CheckAtoms(const Atoms &atoms, const string &what,
+                       double &cellTime, double &pairTime)
+{
+    eavlBondFinder finder;
+    int th = eavlTimer::Start();
+    finder.FindBonds(atoms.size(), &atoms.x[0], &atoms.y[0], &atoms.z[0],
+                     &atoms.element[0]);
+    cellTime = eavlTimer::Stop(th, "");
+
+    th = eavlTimer::Start();
+    vector<int> ref = AllPairs(atoms, 0.45f, 0.4f);
+    pairTime = eavlTimer::Stop(th, "");
+
+    Check(ref.size() > 0, what + " has bonds");
+    Check(SameBonds(finder, ref), what + " bonds match all pairs");
+
+    finder.SetTolerance(0.2f);
+    finder.SetMinimumDistance(1.0f);
+    finder.FindBonds(atoms.size(), &atoms.x[0], &atoms.y[0], &atoms.z[0],
+                     &atoms.element[0]);
+    Check(SameBonds(finder, AllPairs(atoms, 0.2f, 1.0f)),
+          what + " bonds match all pairs with other settings");
+}
+
+static eavlDataSet *CreatePointDataSet(const Atoms &atoms,
+                                       const vector<int> &types)
+{
+    int n = atoms.size();
+    eavlDataSet *data = new eavlDataSet;
+    data->SetNumPoints(n);
+    eavlCoordinatesCartesian *coords = new eavlCoordinatesCartesian(NULL,
+                                              eavlCoordinatesCartesian::X,
+                                              eavlCoordinatesCartesian::Y,
+                                              eavlCoordinatesCartesian::Z);
+    data->AddCoordinateSystem(coords);
+    coords->SetAxis(0,new eavlCoordinateAxisField("xcoord",0));
+    coords->SetAxis(1,new eavlCoordinateAxisField("ycoord",0));
+    coords->SetAxis(2,new eavlCoordinateAxisField("zcoord",0));
+
+    eavlFloatArray *axisValues[3] = {
+        new eavlFloatArray("xcoord",1, n),
+        new eavlFloatArray("ycoord",1, n),
+        new eavlFloatArray("zcoord",1, n)
+    };
+    eavlFloatArray *type = new eavlFloatArray("type", 1, n);
+    for (int i=0; i<n; i++)
+    {
+        axisValues[0]->SetValue(i, atoms.x[i]);
+        axisValues[1]->SetValue(i, atoms.y[i]);
+        axisValues[2]->SetValue(i, atoms.z[i]);
+        type->SetValue(i, types[i]);
+    }
+    for (int d=0; d<3; d++)
+        data->AddField(new eavlField(1, axisValues[d], eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(1, type, eavlField::ASSOC_POINTS));
+    return data;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 5000;
+        if (n < 100)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        // about 0.1 atoms per cubic angstrom, with a few pairs closer than
+        // the minimum bond distance
+        Atoms box;
+        float side = powf(n / 0.1f, 1.f/3.f);
+        for (int i=0; i<n; i++)
+            box.Add(Random()*side, Random()*side, Random()*side, RandomElement());
+        for (int i=0; i<n; i+=97)
+            box.Add(box.x[i] + .1f, box.y[i], box.z[i], 1);
+        double cellTime, pairTime;
+        CheckAtoms(box, "box", cellTime, pairTime);
+
+        Atoms sheet;
+        for (int i=0; i<n/10; i++)
+            sheet.Add(Random()*50, Random()*50, 3.f, RandomElement());
+        double t1, t2;
+        CheckAtoms(sheet, "sheet", t1, t2);
+
+        // clusters a long way apart, so the cells are widened
+        Atoms sparse;
+        for (int c=0; c<27; c++)
+            for (int i=0; i<20; i++)
+                sparse.Add((c%3)*1.e4f + Random()*4, ((c/3)%3)*1.e4f + Random()*4,
+                           (c/9)*1.e4f + Random()*4, 6);
+        CheckAtoms(sparse, "sparse clusters", t1, t2);
+
+        // the bonds as a cell set of lines
+        eavlBondFinder finder;
+        finder.FindBonds(box.size(), &box.x[0], &box.y[0], &box.z[0],
+                         &box.element[0]);
+        eavlCellSetExplicit *cells = finder.CreateCellSet("bonds");
+        bool same = (cells->GetDimensionality() == 1 &&
+                     cells->GetNumCells() == finder.GetNumBonds());
+        for (int c=0; same && c<cells->GetNumCells(); c++)
+        {
+            eavlCell cell = cells->GetCellNodes(c);
+            same = (cell.type == EAVL_BEAM && cell.numIndices == 2 &&
+                    cell.indices[0] == finder.GetBondAtom(c, 0) &&
+                    cell.indices[1] == finder.GetBondAtom(c, 1));
+        }
+        Check(same, "bond cell set");
+        delete cells;
+        eavlIndex nbonds = finder.GetNumBonds();
+
+        // a data set of tungsten and helium, as in a LAMMPS dump, with the
+        // species type in a point field
+        vector<int> types(box.size());
+        Atoms species = box;
+        vector<int> typeToElement;
+        typeToElement.push_back(74);
+        typeToElement.push_back(2);
+        for (int i=0; i<box.size(); i++)
+        {
+            types[i] = (box.element[i] == 1) ? 1 : 0;
+            species.element[i] = typeToElement[types[i]];
+        }
+        eavlDataSet *data = CreatePointDataSet(box, types);
+        finder.FindBonds(data, "type", typeToElement);
+        Check(SameBonds(finder, AllPairs(species, 0.45f, 0.4f)),
+              "bonds from a data set with species types");
+        delete data;
+
+        // no atoms
+        finder.FindBonds(0, NULL, NULL, NULL, NULL);
+        Check(finder.GetNumBonds() == 0, "no atoms, no bonds");
+
+        cout << box.size() << " atoms, " << nbonds << " bonds" << endl;
+        cout << "cell list: " << cellTime << endl;
+        cout << "all pairs: " << pairTime << endl;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
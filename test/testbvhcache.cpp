@@ -0,0 +1,174 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlVector4.h"
+#include "MortonBVHBuilder.h"
+#include "SplitBVH.h"
+#include "eavlBVHCache.h"
+#include "eavlTestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+// Builds BVHs over random triangles with the Morton and split builders,
+// stores them in a BVH cache, and checks that reading the cache back
+// gives the same nodes, and that a cache is not used after a vertex or
+// the build settings change or when the file was cut short.  Reports the
+// time to build each BVH and to read it from the cache.
+
+static const char *usage = "testbvhcache [ntriangles] [cachefile]";
+
+static void Build(float *verts, int ntris, bool fast,
+                  float *&inner, int &innerSize, float *&leaf, int &leafSize)
+{
+    if (fast)
+    {
+        MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(verts, ntris, TRIANGLE);
+        mortonBVH->build();
+        inner = mortonBVH->getInnerNodes(innerSize);
+        leaf = mortonBVH->getLeafNodes(leafSize);
+        delete mortonBVH;
+    }
+    else
+    {
+        SplitBVH *sbvh = new SplitBVH(verts, ntris, TRIANGLE);
+        sbvh->getFlatArray(innerSize, leafSize, inner, leaf);
+        delete sbvh;
+    }
+}
+
+static bool Same(const float *a, const float *b, int n)
+{
+    for (int i=0; i<n; i++)
+        if (a[i] != b[i])
+            return false;
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int ntris = (argc > 1) ? atoi(argv[1]) : 5000;
+        string filename = (argc > 2) ? argv[2] : "testbvhcache.bvh";
+        if (ntris < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        // three float4 vertices per triangle
+        float *verts = new float[ntris * 12];
+        srand(7);
+        for (int t=0; t<ntris; t++)
+        {
+            float cx = rand() / float(RAND_MAX);
+            float cy = rand() / float(RAND_MAX);
+            float cz = rand() / float(RAND_MAX);
+            for (int v=0; v<3; v++)
+            {
+                verts[t*12 + v*4 + 0] = cx + 0.01f * rand() / float(RAND_MAX);
+                verts[t*12 + v*4 + 1] = cy + 0.01f * rand() / float(RAND_MAX);
+                verts[t*12 + v*4 + 2] = cz + 0.01f * rand() / float(RAND_MAX);
+                verts[t*12 + v*4 + 3] = 0.f;
+            }
+        }
+
+        cout << ntris << " triangles" << endl;
+        cout << "builder   build time  cache read time" << endl;
+        for (int fast=1; fast>=0; fast--)
+        {
+            const char *name = fast ? "morton" : "split ";
+            unsigned long long key =
+                eavlBVHCache::ComputeKey(verts, ntris * 12LL, TRIANGLE,
+                                         ntris, fast);
+
+            float *inner = NULL, *leaf = NULL;
+            int innerSize = 0, leafSize = 0;
+            int th = eavlTimer::Start();
+            Build(verts, ntris, fast, inner, innerSize, leaf, leafSize);
+            double buildTime = eavlTimer::Stop(th, "");
+            Check(eavlBVHCache::Write(filename, key, inner, innerSize,
+                                      leaf, leafSize),
+                  string(name) + " cache written");
+
+            float *cinner = NULL, *cleaf = NULL;
+            int cinnerSize = 0, cleafSize = 0;
+            th = eavlTimer::Start();
+            bool read = eavlBVHCache::Read(filename, key, cinner, cinnerSize,
+                                           cleaf, cleafSize);
+            double readTime = eavlTimer::Stop(th, "");
+            Check(read && cinnerSize == innerSize && cleafSize == leafSize &&
+                  Same(cinner, inner, innerSize) &&
+                  Same(cleaf, leaf, leafSize),
+                  string(name) + " cache read back");
+            delete[] cinner;
+            delete[] cleaf;
+
+            cout << name << "  " << setw(12) << buildTime
+                 << "  " << setw(15) << readTime << endl;
+
+            // the key must follow the build settings and the geometry
+            unsigned long long otherBuild =
+                eavlBVHCache::ComputeKey(verts, ntris * 12LL, TRIANGLE,
+                                         ntris, !fast);
+            Check(otherBuild != key, "key depends on the builder");
+            Check(!eavlBVHCache::Read(filename, otherBuild, cinner, cinnerSize,
+                                      cleaf, cleafSize),
+                  string(name) + " cache rejected for the other builder");
+
+            float saved = verts[ntris * 6 + 1];
+            verts[ntris * 6 + 1] += 1.e-3f;
+            unsigned long long moved =
+                eavlBVHCache::ComputeKey(verts, ntris * 12LL, TRIANGLE,
+                                         ntris, fast);
+            verts[ntris * 6 + 1] = saved;
+            Check(moved != key, "key depends on the vertices");
+            Check(!eavlBVHCache::Read(filename, moved, cinner, cinnerSize,
+                                      cleaf, cleafSize),
+                  string(name) + " cache rejected after a vertex moved");
+
+            delete[] inner;
+            delete[] leaf;
+        }
+
+        // cut the last cache short
+        {
+            ifstream in(filename.c_str(), ios::in | ios::binary);
+            string contents((istreambuf_iterator<char>(in)),
+                            istreambuf_iterator<char>());
+            in.close();
+            ofstream out(filename.c_str(), ios::out | ios::binary);
+            out.write(contents.data(), contents.size() - 4);
+        }
+        float *cinner = NULL, *cleaf = NULL;
+        int cinnerSize = 0, cleafSize = 0;
+        unsigned long long key =
+            eavlBVHCache::ComputeKey(verts, ntris * 12LL, TRIANGLE, ntris,
+                                     false);
+        Check(!eavlBVHCache::Read(filename, key, cinner, cinnerSize,
+                                  cleaf, cleafSize),
+              "truncated cache rejected");
+        remove(filename.c_str());
+
+        delete[] verts;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
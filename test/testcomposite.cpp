@@ -0,0 +1,214 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlCompositor.h"
+#include "eavlException.h"
+#include <cmath>
+
+using namespace std;
+
+// Composites a synthetic image from every rank with each algorithm, with
+// and without background encoding and blending, checks the results
+// against images composited serially, and reports the timings.  Run it
+// with mpirun on any number of ranks.
+
+static void printUsage()
+{
+    cout <<"\nUsage: mpirun -np <n> testcomposite [width] [height] [niterations]"<<endl;
+}
+
+static const unsigned char bg[3] = {0, 0, 0};
+
+// about a third of each rank's pixels are background, and the ranks are
+// slabs in depth, seen from the front or back depending on the pixel
+static bool Covered(int rank, int x, int y)
+{
+    return ((x / 4) * 7 + (y / 4) * 3 + rank * 5) % 3 != 0;
+}
+
+static void MakePixel(int rank, int size, int x, int y, bool blend,
+                      float &z, unsigned char *rgba)
+{
+    if (!Covered(rank, x, y))
+    {
+        z = 1.f;
+        rgba[0] = bg[0];
+        rgba[1] = bg[1];
+        rgba[2] = bg[2];
+        rgba[3] = blend ? 0 : 255;
+        return;
+    }
+    int order = ((x + y) % 2) ? rank : size - 1 - rank;
+    z = 0.1f + 0.8f * (order + 0.5f) / size;
+    rgba[0] = 1 + (rank * 37 + x) % 255;
+    rgba[1] = 1 + (rank * 91 + y) % 255;
+    rgba[2] = 1 + (rank * 53 + x + y) % 255;
+    rgba[3] = blend ? 64 + (rank * 29 + x) % 128 : 255;
+}
+
+// composite every rank's pixel in depth order
+static void ExpectedPixel(int size, int x, int y, bool blend,
+                          float &z, float *rgba)
+{
+    vector< pair<float,int> > frags;
+    for (int r=0; r<size; r++)
+    {
+        if (Covered(r, x, y))
+        {
+            float fz;
+            unsigned char c[4];
+            MakePixel(r, size, x, y, blend, fz, c);
+            frags.push_back(make_pair(fz, r));
+        }
+    }
+    sort(frags.begin(), frags.end());
+    if (frags.empty())
+    {
+        z = 1.f;
+        rgba[0] = bg[0];
+        rgba[1] = bg[1];
+        rgba[2] = bg[2];
+        rgba[3] = blend ? 0 : 255;
+        return;
+    }
+    z = frags[0].first;
+    float acc[4] = {0, 0, 0, 0};
+    for (size_t f=0; f<frags.size(); f++)
+    {
+        float fz;
+        unsigned char c[4];
+        MakePixel(frags[f].second, size, x, y, blend, fz, c);
+        float a = blend ? c[3] / 255.f : 1.f;
+        float w = (1.f - acc[3]) * a;
+        for (int i=0; i<3; i++)
+            acc[i] += w * c[i];
+        acc[3] += w;
+        if (!blend)
+            break;
+    }
+    for (int i=0; i<3; i++)
+        rgba[i] = acc[i] / acc[3];
+    rgba[3] = acc[3] * 255.f;
+}
+
+int main(int argc, char *argv[])
+{
+    MPI_Init(&argc, &argv);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    bool ok = true;
+    try
+    {
+        if (argc > 4)
+        {
+            if (rank == 0)
+                printUsage();
+            MPI_Finalize();
+            return 0;
+        }
+        int width  = (argc > 1) ? atoi(argv[1]) : 256;
+        int height = (argc > 2) ? atoi(argv[2]) : 256;
+        int niter  = (argc > 3) ? atoi(argv[3]) : 3;
+        if (width < 1 || height < 1 || niter < 1)
+        {
+            if (rank == 0)
+                printUsage();
+            MPI_Finalize();
+            return 1;
+        }
+        int npixels = width * height;
+
+        const char *names[] = {"reduce", "binary swap", "radix-2", "radix-4", "radix-8"};
+        eavlCompositor::Algorithm algorithms[] = {
+            eavlCompositor::Reduce, eavlCompositor::BinarySwap,
+            eavlCompositor::RadixK, eavlCompositor::RadixK, eavlCompositor::RadixK};
+        int radices[] = {4, 4, 2, 4, 8};
+        const int nalgorithms = 5;
+
+        if (rank == 0)
+            cout << size << " ranks, " << width << "x" << height << " pixels\n"
+                 << "algorithm     blend  encode  seconds\n";
+
+        for (int blend=0; blend<2; blend++)
+        {
+            vector<float> inz(npixels), outz(npixels);
+            vector<unsigned char> inrgba(npixels*4), outrgba(npixels*4);
+            for (int y=0; y<height; y++)
+                for (int x=0; x<width; x++)
+                    MakePixel(rank, size, x, y, blend, inz[y*width+x],
+                              &inrgba[(y*width+x)*4]);
+
+            for (int a=0; a<nalgorithms; a++)
+            {
+                for (int encode=0; encode<2; encode++)
+                {
+                    eavlCompositor::SetAlgorithm(algorithms[a]);
+                    eavlCompositor::SetRadix(radices[a]);
+                    eavlCompositor::SetBackgroundEncoding(encode);
+                    eavlCompositor::SetBlending(blend);
+
+                    MPI_Barrier(MPI_COMM_WORLD);
+                    double start = MPI_Wtime();
+                    for (int it=0; it<niter; it++)
+                        ParallelZComposite(MPI_COMM_WORLD, npixels,
+                                           &inz[0], &inrgba[0],
+                                           &outz[0], &outrgba[0],
+                                           bg[0], bg[1], bg[2]);
+                    double local = (MPI_Wtime() - start) / niter, seconds;
+                    MPI_Reduce(&local, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                               0, MPI_COMM_WORLD);
+
+                    // rounding to bytes after each blend may differ by
+                    // a little from blending in floating point
+                    float tolerance = blend ? 3.f : 0.5f;
+                    int bad = -1;
+                    for (int i=0; i<npixels && bad<0; i++)
+                    {
+                        float z, rgba[4];
+                        ExpectedPixel(size, i % width, i / width, blend,
+                                      z, rgba);
+                        if (outz[i] != z)
+                            bad = i;
+                        for (int c=0; c<4; c++)
+                            if (fabs(outrgba[i*4+c] - rgba[c]) > tolerance &&
+                                (c == 3 || rgba[3] > 0))
+                                bad = i;
+                    }
+                    if (bad >= 0)
+                    {
+                        cout << "Rank " << rank << ": " << names[a]
+                             << (blend ? " blended" : "")
+                             << (encode ? " encoded" : "")
+                             << " differs at pixel " << bad << endl;
+                        ok = false;
+                    }
+
+                    if (rank == 0)
+                        cout << setw(12) << left << names[a] << right
+                             << setw(7) << (blend ? "yes" : "no")
+                             << setw(8) << (encode ? "yes" : "no")
+                             << "  " << seconds << endl;
+                }
+            }
+        }
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    int allok, myok = ok;
+    MPI_Allreduce(&myok, &allok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    MPI_Finalize();
+    if (!allok)
+    {
+        if (rank == 0)
+            cout << "Verification failed.\n";
+        return 1;
+    }
+    if (rank == 0)
+        cout << "Verified.\n";
+    return 0;
+}
@@ -0,0 +1,301 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlCellComponents.h"
+#include "eavlThreadPool.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Builds the edge, face and node-cell connectivity of an explicit cell
+// set of hexahedra, tetrahedra, wedges, pyramids and 2D cells on a
+// lattice, checks them against a search with std::map that numbers the
+// edges and faces in the order cells first use them, and reports the
+// time of each build.  Also checks that threads asking for the same
+// connectivity at once all get it, built once.
+
+static const char *usage = "testconnectivity [cells per axis]";
+
+static eavlCellSetExplicit *CreateCells(int n, int npts)
+{
+    eavlCellSetExplicit *cells = new eavlCellSetExplicit("cells", 3);
+    eavlExplicitConnectivity conn;
+    int N = n+1;
+    for (int k=0; k<n; k++)
+    for (int j=0; j<n; j++)
+    for (int i=0; i<n; i++)
+    {
+        int p[8];
+        for (int c=0; c<8; c++)
+            p[c] = (i + (c&1)) + N*((j + ((c>>1)&1)) + N*(k + (c>>2)));
+        switch ((i+j+k) % 4)
+        {
+          case 0:
+          {
+            int hex[8] = {p[0],p[1],p[3],p[2],p[4],p[5],p[7],p[6]};
+            conn.AddElement(EAVL_HEX, 8, hex);
+            break;
+          }
+          case 1:
+          {
+            int ring[6] = {1,3,2,6,4,5};
+            for (int t=0; t<6; t++)
+            {
+                int tet[4] = {p[0], p[ring[t]], p[ring[(t+1)%6]], p[7]};
+                conn.AddElement(EAVL_TET, 4, tet);
+            }
+            break;
+          }
+          case 2:
+          {
+            int w0[6] = {p[0],p[1],p[2],p[4],p[5],p[6]};
+            int w1[6] = {p[1],p[3],p[2],p[5],p[7],p[6]};
+            conn.AddElement(EAVL_WEDGE, 6, w0);
+            conn.AddElement(EAVL_WEDGE, 6, w1);
+            break;
+          }
+          default:
+          {
+            int pyr[5] = {p[0],p[1],p[3],p[2],p[7]};
+            int quad[4] = {p[4],p[5],p[7],p[6]};
+            int tri[3] = {p[4],p[5],p[6]};
+            conn.AddElement(EAVL_PYRAMID, 5, pyr);
+            conn.AddElement(EAVL_QUAD, 4, quad);
+            conn.AddElement(EAVL_TRI, 3, tri);
+            break;
+          }
+        }
+    }
+    cells->SetCellNodeConnectivity(conn);
+    cells->SetDSNumPoints(npts);
+    return cells;
+}
+
+static void CheckEdges(eavlCellSetExplicit *cells)
+{
+    map<pair<int,int>,int> ids;
+    int nCells = cells->GetNumCells();
+    for (int i=0; i<nCells && ok; i++)
+    {
+        eavlCell el = cells->GetCellNodes(i);
+        eavlCell ce = cells->GetCellEdges(i);
+        int nedges = 0;
+        signed char (*edges)[2] = NULL;
+        switch (el.type)
+        {
+          case EAVL_TET:     edges = eavlTetEdges;     nedges = 6;  break;
+          case EAVL_PYRAMID: edges = eavlPyramidEdges; nedges = 8;  break;
+          case EAVL_WEDGE:   edges = eavlWedgeEdges;   nedges = 9;  break;
+          case EAVL_HEX:     edges = eavlHexEdges;     nedges = 12; break;
+          case EAVL_TRI:     edges = eavlTriEdges;     nedges = 3;  break;
+          case EAVL_QUAD:    edges = eavlQuadEdges;    nedges = 4;  break;
+          default: break;
+        }
+        Check(ce.numIndices == nedges, "edge count of a cell");
+        for (int j=0; j<nedges && j<ce.numIndices; j++)
+        {
+            int a = el.indices[edges[j][0]], b = el.indices[edges[j][1]];
+            pair<int,int> key(std::min(a,b), std::max(a,b));
+            if (!ids.count(key))
+            {
+                int id = ids.size();
+                ids[key] = id;
+            }
+            int expected = ids[key];
+            if (ce.indices[j] != expected)
+            {
+                Check(false, "edge numbering");
+                break;
+            }
+        }
+    }
+    Check(cells->GetNumEdges() == (int)ids.size(), "number of edges");
+
+    eavlExplicitConnectivity &en = cells->GetConnectivity(EAVL_NODES_OF_EDGES);
+    for (map<pair<int,int>,int>::iterator it = ids.begin(); it != ids.end() && ok; ++it)
+    {
+        int n;
+        int nodes[12];
+        en.GetElementComponents(it->second, n, nodes);
+        Check(n == 2 && nodes[0] == it->first.first &&
+              nodes[1] == it->first.second, "nodes of an edge");
+    }
+}
+
+static void CheckFaces(eavlCellSetExplicit *cells)
+{
+    // keyed by the three lowest nodes; the first cell with a face gives
+    // its node order
+    map<vector<int>,int> ids;
+    vector<vector<int> > faceNodes;
+    int nCells = cells->GetNumCells();
+    for (int i=0; i<nCells && ok; i++)
+    {
+        eavlCell el = cells->GetCellNodes(i);
+        eavlCell cf = cells->GetCellFaces(i);
+        int ntris = 0, nquads = 0;
+        signed char (*tris)[3] = NULL;
+        signed char (*quads)[4] = NULL;
+        switch (el.type)
+        {
+          case EAVL_HEX:     quads = eavlHexQuadFaces; nquads = 6; break;
+          case EAVL_TET:     tris = eavlTetTriangleFaces; ntris = 4; break;
+          case EAVL_PYRAMID: tris = eavlPyramidTriangleFaces; ntris = 4;
+                             quads = eavlPyramidQuadFaces; nquads = 1; break;
+          case EAVL_WEDGE:   tris = eavlWedgeTriangleFaces; ntris = 2;
+                             quads = eavlWedgeQuadFaces; nquads = 3; break;
+          default: break;
+        }
+        Check(cf.numIndices == ntris + nquads, "face count of a cell");
+        for (int f=0; f<ntris+nquads && f<cf.numIndices; f++)
+        {
+            vector<int> nodes;
+            for (int v=0; v<(f < ntris ? 3 : 4); v++)
+                nodes.push_back(el.indices[f < ntris ? tris[f][v] : quads[f-ntris][v]]);
+            vector<int> key(nodes);
+            std::sort(key.begin(), key.end());
+            key.resize(3);
+            int expected;
+            if (ids.count(key))
+                expected = ids[key];
+            else
+            {
+                expected = ids[key] = faceNodes.size();
+                faceNodes.push_back(nodes);
+            }
+            if (cf.indices[f] != expected)
+            {
+                Check(false, "face numbering");
+                break;
+            }
+        }
+    }
+    Check(cells->GetNumFaces() == (int)faceNodes.size(), "number of faces");
+
+    eavlExplicitConnectivity &fn = cells->GetConnectivity(EAVL_NODES_OF_FACES);
+    for (size_t f=0; f<faceNodes.size() && ok; f++)
+    {
+        int n;
+        int nodes[12];
+        fn.GetElementComponents(f, n, nodes);
+        Check(n == (int)faceNodes[f].size() &&
+              std::equal(faceNodes[f].begin(), faceNodes[f].end(), nodes),
+              "nodes of a face");
+    }
+}
+
+static void CheckNodeCells(eavlCellSetExplicit *cells, int npts)
+{
+    vector<vector<int> > cellsOfNodes(npts);
+    int nCells = cells->GetNumCells();
+    for (int i=0; i<nCells; i++)
+    {
+        eavlCell el = cells->GetCellNodes(i);
+        for (int j=0; j<el.numIndices; j++)
+            cellsOfNodes[el.indices[j]].push_back(i);
+    }
+
+    eavlExplicitConnectivity &nc = cells->GetConnectivity(EAVL_CELLS_OF_NODES);
+    Check(nc.GetNumElements() == npts, "number of nodes");
+    for (int p=0; p<npts && ok; p++)
+    {
+        int ci = nc.mapCellToIndex[p];
+        int n = nc.connectivity[ci];
+        Check(nc.shapetype[p] == EAVL_POINT &&
+              n == (int)cellsOfNodes[p].size() &&
+              std::equal(cellsOfNodes[p].begin(), cellsOfNodes[p].end(),
+                         &nc.connectivity[ci+1]),
+              "cells of a node");
+    }
+}
+
+// asks for every connectivity from several threads at once
+struct ConcurrentBuildBody : public eavlParallelForBody
+{
+    eavlCellSetExplicit *cells;
+    vector<long long> counts;
+    ConcurrentBuildBody(eavlCellSetExplicit *c, int n) : cells(c), counts(n) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex i = begin; i < end; ++i)
+        {
+            switch (i % 3)
+            {
+              case 0: counts[i] = cells->GetNumEdges(); break;
+              case 1: counts[i] = cells->GetNumFaces(); break;
+              default: counts[i] = cells->GetConnectivity(EAVL_CELLS_OF_NODES).GetNumElements(); break;
+            }
+        }
+    }
+};
+
+static void CheckConcurrentBuilds(int n, int npts, eavlCellSetExplicit *built)
+{
+    eavlCellSetExplicit *cells = CreateCells(n, npts);
+    const int ncalls = 48;
+    ConcurrentBuildBody body(cells, ncalls);
+    eavlThreadPool::ParallelFor(ncalls, body, 1);
+    long long expected[3] = {built->GetNumEdges(), built->GetNumFaces(), npts};
+    bool same = true;
+    for (int i=0; i<ncalls; i++)
+        same = same && body.counts[i] == expected[i % 3];
+    Check(same, "concurrent builds");
+    Check(cells->GetConnectivity(EAVL_EDGES_OF_CELLS).connectivity.size() ==
+          built->GetConnectivity(EAVL_EDGES_OF_CELLS).connectivity.size(),
+          "concurrent builds: edges built once");
+    delete cells;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 24;
+        if (n < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        // a few nodes past the lattice, used by no cell
+        int npts = (n+1)*(n+1)*(n+1) + 5;
+        eavlCellSetExplicit *cells = CreateCells(n, npts);
+
+        int th = eavlTimer::Start();
+        cells->GetNumEdges();
+        double edgeTime = eavlTimer::Stop(th, "");
+        th = eavlTimer::Start();
+        cells->GetNumFaces();
+        double faceTime = eavlTimer::Stop(th, "");
+        th = eavlTimer::Start();
+        cells->GetConnectivity(EAVL_CELLS_OF_NODES);
+        double nodeCellTime = eavlTimer::Stop(th, "");
+
+        CheckEdges(cells);
+        CheckFaces(cells);
+        CheckNodeCells(cells, npts);
+        CheckConcurrentBuilds(n, npts, cells);
+
+        cout << cells->GetNumCells() << " cells, " << cells->GetNumEdges()
+             << " edges, " << cells->GetNumFaces() << " faces" << endl;
+        cout << "edge connectivity:      " << edgeTime << endl;
+        cout << "face connectivity:      " << faceTime << endl;
+        cout << "node-cell connectivity: " << nodeCellTime << endl;
+        delete cells;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -0,0 +1,152 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlExecutor.h"
+#include "eavlGatherOp.h"
+#include "eavlMapOp.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+// Runs a chain of maps through intermediates marked with
+// eavlExecutor::MarkIntermediate, with and without plan fusion, and
+// checks the results agree and that the intermediates used only inside
+// the fused group were never allocated, while those also used outside
+// it (or not marked) were.
+
+static const char *usage = "testfusion [nvalues]";
+
+struct ScaleFunctor
+{
+    float s;
+    ScaleFunctor(float s_) : s(s_) { }
+    EAVL_FUNCTOR float operator()(float x) { return x * s; }
+};
+
+struct SplitFunctor
+{
+    EAVL_FUNCTOR tuple<float,float> operator()(float x)
+    {
+        return tuple<float,float>(x, x + 1);
+    }
+};
+
+static void RunPlan(int n, const string &mode)
+{
+    eavlFloatArray *x = new eavlFloatArray("x", 1, n);
+    eavlIntArray *half = new eavlIntArray("half", 1, (n+1)/2);
+    for (int i=0; i<n; i++)
+        x->SetValue(i, i % 1000);
+    for (int i=0; i<(n+1)/2; i++)
+        half->SetValue(i, 2*i);
+
+    eavlArray::Allocation later = eavlArray::ALLOCATE_ON_FIRST_USE;
+    eavlFloatArray *scaled = new eavlFloatArray("scaled", 1, n, later);
+    eavlFloatArray *split = new eavlFloatArray("split", 2, n, later);
+    eavlFloatArray *kept = new eavlFloatArray("kept", 1, n, later);
+    eavlFloatArray *unmarked = new eavlFloatArray("unmarked", 1, n, later);
+    eavlFloatArray *sum = new eavlFloatArray("sum", 1, n);
+    eavlFloatArray *gathered = new eavlFloatArray("gathered", 1, (n+1)/2);
+    eavlExecutor::MarkIntermediate(scaled);
+    eavlExecutor::MarkIntermediate(split);
+    eavlExecutor::MarkIntermediate(kept);
+
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(x), eavlOpArgs(scaled), ScaleFunctor(2)),
+        "scale");
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(scaled),
+                      eavlOpArgs(eavlIndexable<eavlFloatArray>(split, 0),
+                                 eavlIndexable<eavlFloatArray>(split, 1)),
+                      SplitFunctor()),
+        "split");
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(eavlIndexable<eavlFloatArray>(split, 0),
+                                 eavlIndexable<eavlFloatArray>(split, 1)),
+                      eavlOpArgs(sum), eavlAddFunctor<float>()),
+        "sum");
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(sum), eavlOpArgs(kept), ScaleFunctor(-1)),
+        "negate");
+    eavlExecutor::AddOperation(
+        new_eavlMapOp(eavlOpArgs(kept), eavlOpArgs(unmarked), ScaleFunctor(3)),
+        "triple");
+    // kept is also read here, outside the fused group
+    eavlExecutor::AddOperation(
+        new_eavlGatherOp(eavlOpArgs(kept), eavlOpArgs(gathered),
+                         eavlOpArgs(half)),
+        "gather every other");
+    eavlExecutor::Go();
+
+    for (int i=0; i<n; i++)
+    {
+        float v = 2 * (i % 1000);
+        if (sum->GetValue(i) != 2*v + 1 ||
+            unmarked->GetValue(i) != -3 * (2*v + 1) ||
+            (i % 2 == 0 && gathered->GetValue(i/2) != -(2*v + 1)))
+        {
+            cout << "Mismatch at " << i << " (" << mode << ")" << endl;
+            ok = false;
+            break;
+        }
+    }
+
+    bool fused = eavlExecutor::GetPlanFusion();
+    Check(scaled->IsHostStorageDeferred() == fused,
+          mode + ": intermediate elided only when fusing");
+    Check(split->IsHostStorageDeferred() == fused,
+          mode + ": multi-component intermediate elided only when fusing");
+    Check(!kept->IsHostStorageDeferred(),
+          mode + ": intermediate read outside the group allocated");
+    Check(!unmarked->IsHostStorageDeferred(),
+          mode + ": unmarked array allocated");
+
+    // elided intermediates are still usable afterwards
+    scaled->SetValue(0, 1);
+    Check(scaled->GetValue(0) == 1 && !scaled->IsHostStorageDeferred(),
+          mode + ": elided intermediate allocated on use");
+
+    delete x;
+    delete half;
+    delete scaled;
+    delete split;
+    delete kept;
+    delete unmarked;
+    delete sum;
+    delete gathered;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int nvalues = (argc > 1) ? atoi(argv[1]) : 100003;
+        if (nvalues < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+        RunPlan(nvalues, "unfused");
+
+        eavlExecutor::SetPlanFusion(true);
+        RunPlan(nvalues, "fused");
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPUThreadPool);
+        RunPlan(nvalues, "fused on the thread pool");
+        eavlExecutor::SetPlanFusion(false);
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
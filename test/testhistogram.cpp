@@ -0,0 +1,212 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlExecutor.h"
+#include "eavlMapOp.h"
+#include "eavlReduceOp_1.h"
+#include "eavlHistogramOp.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Bins random values with eavlHistogramOp on the OpenMP CPU backend and
+// on the thread pool, plain, weighted, and by the magnitude of a vector,
+// and checks the counts against a serial count.  Then compares the time
+// of the single histogram pass with the one map and reduction per bin it
+// replaces in eavlScalarBinFilter.
+
+static const char *usage = "testhistogram [nvalues] [nbins]";
+
+struct InBinFunctor
+{
+    float lo, hi;
+    InBinFunctor(float l, float h) : lo(l), hi(h) { }
+    EAVL_FUNCTOR int operator()(float val)
+    {
+        return (val >= lo) && (val < hi);
+    }
+};
+
+// the bin a serial scan over the edges puts v in
+static int SerialBin(float v, eavlFloatArray *edges)
+{
+    int nbins = edges->GetNumberOfTuples() - 1;
+    for (int b=0; b<nbins; b++)
+    {
+        bool abovelo = (b == 0) || v >= edges->GetValue(b);
+        bool belowhi = (b == nbins-1) || v < edges->GetValue(b+1);
+        if (abovelo && belowhi)
+            return b;
+    }
+    return -1;
+}
+
+static void CheckCounts(eavlArray *values, int comp, eavlArray *weights,
+                        eavlFloatArray *edges, const string &what)
+{
+    int n = values->GetNumberOfTuples();
+    int nc = values->GetNumberOfComponents();
+    int nbins = edges->GetNumberOfTuples() - 1;
+    vector<double> expected(nbins, 0.);
+    for (int i=0; i<n; i++)
+    {
+        float v;
+        if (comp >= 0)
+            v = values->GetComponentAsDouble(i, comp);
+        else
+        {
+            float sum = 0;
+            for (int c=0; c<nc; c++)
+            {
+                float x = values->GetComponentAsDouble(i, c);
+                sum += x*x;
+            }
+            v = sqrtf(sum);
+        }
+        if (v != v)
+            continue;
+        int b = SerialBin(v, edges);
+        expected[b] += weights ? weights->GetComponentAsDouble(i, 0) : 1.;
+    }
+
+    const eavlExecutor::ExecutionMode modes[] =
+        { eavlExecutor::ForceCPU, eavlExecutor::ForceCPUThreadPool };
+    const char *modenames[] = { "cpu", "thread pool" };
+    for (int m=0; m<2; m++)
+    {
+        eavlExecutor::SetExecutionMode(modes[m]);
+        eavlFloatArray *counts = new eavlFloatArray("counts", 1, nbins);
+        eavlExecutor::AddOperation(
+            new eavlHistogramOp(values, comp, edges, counts, weights),
+            "histogram");
+        eavlExecutor::Go();
+        for (int b=0; b<nbins; b++)
+        {
+            double got = counts->GetValue(b);
+            double tol = weights ? 1.e-4 * (fabs(expected[b]) + 1.) : 0.;
+            if (fabs(got - expected[b]) > tol)
+            {
+                cout << what << " (" << modenames[m] << ") bin " << b
+                     << ": got " << got << ", expected " << expected[b] << endl;
+                Check(false, what + " counts");
+                break;
+            }
+        }
+        delete counts;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 1000000;
+        int nbins = (argc > 2) ? atoi(argv[2]) : 256;
+        if (n < 1 || nbins < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        srand(11);
+        eavlFloatArray *values = new eavlFloatArray("values", 1, n);
+        eavlIntArray *ivalues = new eavlIntArray("ivalues", 1, n);
+        eavlFloatArray *vectors = new eavlFloatArray("vectors", 3, n);
+        eavlFloatArray *weights = new eavlFloatArray("weights", 1, n);
+        for (int i=0; i<n; i++)
+        {
+            // a skewed distribution, so some bins get far more values
+            float r = rand() / float(RAND_MAX);
+            values->SetValue(i, 10.f * r * r - 2.f);
+            ivalues->SetValue(i, rand() % 100 - 20);
+            for (int c=0; c<3; c++)
+                vectors->SetComponentFromDouble(i, c, rand() / float(RAND_MAX) - .5f);
+            weights->SetValue(i, rand() / float(RAND_MAX));
+        }
+        // values on the edges, outside them, and a NaN
+        values->SetValue(0, -2.f);
+        values->SetValue(n/2, 8.f);
+        values->SetValue(n-1, 100.f);
+        if (n > 3)
+            values->SetValue(3, sqrtf(-1.f));
+
+        eavlFloatArray *edges = new eavlFloatArray("edges", 1, nbins+1);
+        for (int b=0; b<=nbins; b++)
+            edges->SetValue(b, -2.f + 10.f * float(b) / float(nbins));
+        eavlFloatArray *iedges = new eavlFloatArray("iedges", 1, nbins+1);
+        for (int b=0; b<=nbins; b++)
+            iedges->SetValue(b, -10.f + 80.f * float(b) / float(nbins));
+        eavlFloatArray *medges = new eavlFloatArray("medges", 1, nbins+1);
+        for (int b=0; b<=nbins; b++)
+            medges->SetValue(b, .8f * float(b) / float(nbins));
+
+        CheckCounts(values, 0, NULL, edges, "float values");
+        CheckCounts(ivalues, 0, NULL, iedges, "int values");
+        CheckCounts(values, 0, weights, edges, "weighted values");
+        CheckCounts(vectors, 1, NULL, medges, "vector component");
+        CheckCounts(vectors, eavlHistogramOp::MAGNITUDE, NULL, medges,
+                    "vector magnitude");
+        CheckCounts(vectors, eavlHistogramOp::MAGNITUDE, weights, medges,
+                    "weighted vector magnitude");
+
+        // one pass against a map and a reduction per bin
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+        eavlFloatArray *counts = new eavlFloatArray("counts", 1, nbins);
+        int th = eavlTimer::Start();
+        eavlExecutor::AddOperation(
+            new eavlHistogramOp(values, 0, edges, counts), "histogram");
+        eavlExecutor::Go();
+        double histTime = eavlTimer::Stop(th, "");
+
+        eavlIntArray *inbin = new eavlIntArray("inbin", 1, n);
+        eavlIntArray *bincount = new eavlIntArray("bincount", 1, 1);
+        th = eavlTimer::Start();
+        for (int b=0; b<nbins; b++)
+        {
+            float lo = (b == 0) ? -FLT_MAX : edges->GetValue(b);
+            float hi = (b == nbins-1) ? FLT_MAX : edges->GetValue(b+1);
+            eavlExecutor::AddOperation(
+                new_eavlMapOp(eavlOpArgs(values), eavlOpArgs(inbin),
+                              InBinFunctor(lo, hi)),
+                "flag values in bin");
+            eavlExecutor::AddOperation(
+                new eavlReduceOp_1<eavlAddFunctor<int> >
+                    (inbin, bincount, eavlAddFunctor<int>()),
+                "count values in bin");
+            eavlExecutor::Go();
+            Check(bincount->GetValue(0) == counts->GetValue(b),
+                  "histogram matches per-bin count");
+        }
+        double perBinTime = eavlTimer::Stop(th, "");
+
+        cout << n << " values, " << nbins << " bins" << endl;
+        cout << "single pass histogram: " << histTime << endl;
+        cout << "map and reduce per bin: " << perBinTime << endl;
+
+        delete values;
+        delete ivalues;
+        delete vectors;
+        delete weights;
+        delete edges;
+        delete iedges;
+        delete medges;
+        delete counts;
+        delete inbin;
+        delete bincount;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -4,6 +4,7 @@
 #include "eavlFilter.h"
 #include "eavlDataSet.h"
 #include "eavlTimer.h"
+#include "eavlTrace.h"
 #include "eavlException.h"
 
 #include "eavlImporterFactory.h"
@@ -163,6 +164,46 @@ int main(int argc, char *argv[])
     {   
         eavlInitializeGPU();
 
+        // optional leading flags: "-fuse" enables executor plan fusion,
+        // "-concurrent" runs independent operations concurrently,
+        // "-threadpool" runs CPU operations on the work-stealing pool,
+        // "-trace <file.json>" writes a Chrome trace of the operations
+        const char *tracefile = NULL;
+        while (argc > 1)
+        {
+            if (strcmp(argv[1], "-fuse") == 0)
+            {
+                eavlExecutor::SetPlanFusion(true);
+                argv[1] = argv[0];
+                --argc;
+                ++argv;
+            }
+            else if (strcmp(argv[1], "-concurrent") == 0)
+            {
+                eavlExecutor::SetConcurrentExecution(true);
+                argv[1] = argv[0];
+                --argc;
+                ++argv;
+            }
+            else if (strcmp(argv[1], "-threadpool") == 0)
+            {
+                eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPUThreadPool);
+                argv[1] = argv[0];
+                --argc;
+                ++argv;
+            }
+            else if (strcmp(argv[1], "-trace") == 0 && argc > 2)
+            {
+                tracefile = argv[2];
+                eavlTrace::Enable();
+                argv[2] = argv[0];
+                argc -= 2;
+                argv += 2;
+            }
+            else
+                break;
+        }
+
         if (argc != 4 && argc != 5 &&
             argc != 6 && argc != 7)
             THROW(eavlException,"Incorrect number of arguments");
@@ -254,12 +295,18 @@ int main(int argc, char *argv[])
 
         cout << "\n\n-- summary of data set result --\n";	
         iso->GetOutput()->PrintSummary(cout);
+
+        if (tracefile)
+        {
+            ofstream trace(tracefile);
+            eavlTrace::Dump(trace);
+        }
     }
     catch (const eavlException &e)
     {
         cerr << e.GetErrorText() << endl;
-        cerr << "\nUsage: "<<argv[0]<<" <value> <fieldname> <infile.vtk> [<outfile.vtk>]\n";
-        cerr << "        "<<argv[0]<<" <value> <fieldname> <nx> <ny> <nz> [<outfile.vtk>]\n";
+        cerr << "\nUsage: "<<argv[0]<<" [-fuse] [-concurrent] [-threadpool] [-trace <file.json>] <value> <fieldname> <infile.vtk> [<outfile.vtk>]\n";
+        cerr << "        "<<argv[0]<<" [-fuse] [-concurrent] [-threadpool] [-trace <file.json>] <value> <fieldname> <nx> <ny> <nz> [<outfile.vtk>]\n";
         return 1;
     }
 
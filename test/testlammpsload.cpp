@@ -0,0 +1,284 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlLAMMPSDumpImporter.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <iomanip>
+
+using namespace std;
+
+// Writes a LAMMPS dump of several time steps with scaled coordinates and
+// an extra per-atom variable, and imports time steps from it.  The values
+// must match the atom lines read with istringstream, the way the importer
+// used to parse them.  The first open scans the dump and writes the index
+// next to it; later opens must use the index, and must ignore it when the
+// dump has grown or the index is garbage.  Also checks that unscaled
+// coordinates aren't scaled.  Prints the time to scan and to open with
+// the index, and to read a time step with each parser.
+
+static const char *usage = "testlammpsload [atoms per time step] [time steps]";
+
+static const double boxLo[3] = {-2., 0., 10.};
+static const double boxHi[3] = {48., 25., 60.};
+
+static void WriteTimeStep(ostream &out, int step, int natoms, bool scaled)
+{
+    out << "ITEM: TIMESTEP\n" << step * 100 << "\n"
+        << "ITEM: NUMBER OF ATOMS\n" << natoms << "\n"
+        << "ITEM: BOX BOUNDS pp pp pp\n";
+    for (int d=0; d<3; d++)
+        out << boxLo[d] << " " << boxHi[d] << "\n";
+    if (scaled)
+        out << "ITEM: ATOMS id type xs ys zs vx\n";
+    else
+        out << "ITEM: ATOMS id type x y z\n";
+    out << setprecision(7);
+    for (int a=0; a<natoms; a++)
+    {
+        out << a+1 << " " << (a % 3 == 0 ? 2 : 1);
+        for (int d=0; d<3; d++)
+        {
+            double s = fmod(a * (0.618034 + 0.1 * d) + step * 0.01, 1.);
+            out << " " << (scaled ? s : boxLo[d] + s * (boxHi[d] - boxLo[d]));
+        }
+        if (scaled)
+            out << " " << sin(a * 0.001 + step) * 1.e-3;
+        out << "\n";
+    }
+}
+
+static void WriteDump(const string &filename, int natoms, int nsteps,
+                      bool scaled)
+{
+    ofstream out(filename.c_str(), ios::out | ios::binary);
+    for (int t=0; t<nsteps; t++)
+        WriteTimeStep(out, t, natoms, scaled);
+}
+
+// The atoms of a time step, read with istringstream line by line: one
+// vector per variable.
+static vector<vector<double> > StreamLoad(const string &filename, int step)
+{
+    ifstream in(filename.c_str(), ios::in);
+    char buff[1000];
+    int t = -1, natoms = 0;
+    vector<vector<double> > values;
+    while (in.getline(buff, 1000))
+    {
+        if (strcmp(buff, "ITEM: NUMBER OF ATOMS") == 0)
+        {
+            in.getline(buff, 1000);
+            natoms = atoi(buff);
+        }
+        else if (strncmp(buff, "ITEM: ATOMS", 11) == 0 && ++t == step)
+        {
+            istringstream header(buff + 11);
+            string name;
+            while (header >> name)
+                values.push_back(vector<double>(natoms));
+            for (int a=0; a<natoms; a++)
+            {
+                in.getline(buff, 1000);
+                istringstream sin(buff);
+                for (size_t v=0; v<values.size(); v++)
+                    sin >> values[v][a];
+            }
+            break;
+        }
+    }
+    return values;
+}
+
+static void CheckTimeStep(eavlLAMMPSDumpImporter &importer,
+                          const string &filename, int step, bool scaled,
+                          const string &what)
+{
+    vector<vector<double> > ref = StreamLoad(filename, step);
+    importer.SetDiscreteDim(0, step);
+    eavlDataSet *data = importer.GetMesh("mesh", 0);
+    int n = int(ref[0].size());
+    Check(data->GetNumPoints() == n, what + " number of atoms");
+    if (data->GetNumPoints() != n)
+    {
+        delete data;
+        return;
+    }
+
+    bool same = true;
+    for (int a=0; same && a<n; a++)
+    {
+        for (int d=0; same && d<3; d++)
+        {
+            double v = float(ref[2+d][a]);
+            if (scaled)
+                v = boxLo[d] + (boxHi[d] - boxLo[d]) * v;
+            same = (float(data->GetPoint(a, d)) == float(v));
+        }
+    }
+    Check(same, what + " coordinates");
+
+    const char *names[2] = {"id", "type"};
+    for (int f=0; f<2; f++)
+    {
+        eavlField *field = importer.GetField(names[f], "mesh", 0);
+        eavlArray *arr = field->GetArray();
+        same = (arr->GetNumberOfTuples() == n);
+        for (int a=0; same && a<n; a++)
+            same = (arr->GetComponentAsDouble(a, 0) ==
+                    ref[f][a] - (f == 1 ? 1 : 0));
+        Check(same, what + " " + names[f]);
+        delete field;
+    }
+
+    if (scaled)
+    {
+        eavlField *field = importer.GetField("vx", "mesh", 0);
+        eavlArray *arr = field->GetArray();
+        same = (arr->GetNumberOfTuples() == n);
+        for (int a=0; same && a<n; a++)
+            same = (float(arr->GetComponentAsDouble(a, 0)) == float(ref[5][a]));
+        Check(same, what + " vx");
+        delete field;
+    }
+    delete data;
+}
+
+static bool FileExists(const string &filename)
+{
+    ifstream in(filename.c_str());
+    return bool(in);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int natoms = (argc > 1) ? atoi(argv[1]) : 20000;
+        int nsteps = (argc > 2) ? atoi(argv[2]) : 10;
+        if (natoms < 1 || nsteps < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        const string dump = "testlammpsload.dump";
+        WriteDump(dump, natoms, nsteps, true);
+
+        // no index left over from an earlier run
+        remove((dump + ".eavlidx").c_str());
+
+        // opening also reads the first time step
+        eavlLAMMPSDumpImporter *importer;
+        int th = eavlTimer::Start();
+        importer = new eavlLAMMPSDumpImporter(dump);
+        Check(importer->GetDiscreteDimLengths()[0] == nsteps, "number of time steps");
+        double scanTime = eavlTimer::Stop(th, "");
+        const string index = importer->GetIndexFilename();
+        Check(index == dump + ".eavlidx" && FileExists(index),
+              "index written next to the dump");
+
+        CheckTimeStep(*importer, dump, 0, true, "first step");
+        CheckTimeStep(*importer, dump, nsteps-1, true, "last step");
+        CheckTimeStep(*importer, dump, nsteps/2, true, "middle step");
+        delete importer;
+
+        th = eavlTimer::Start();
+        importer = new eavlLAMMPSDumpImporter(dump);
+        Check(importer->GetDiscreteDimLengths()[0] == nsteps,
+              "number of time steps from the index");
+        double indexTime = eavlTimer::Stop(th, "");
+        CheckTimeStep(*importer, dump, nsteps-1, true, "indexed last step");
+
+        // the time steps really come from the index: one that leaves out
+        // the last step is believed
+        {
+            ifstream in(index.c_str());
+            vector<string> lines;
+            string line;
+            while (getline(in, line))
+                lines.push_back(line);
+            in.close();
+            ofstream out(index.c_str());
+            for (size_t i=0; i+1<lines.size(); i++)
+            {
+                if (i == 4)
+                    out << nsteps-1 << "\n";
+                else
+                    out << lines[i] << "\n";
+            }
+        }
+        {
+            eavlLAMMPSDumpImporter shortened(dump);
+            Check(shortened.GetDiscreteDimLengths()[0] == nsteps-1,
+                  "time steps come from the index");
+        }
+
+        th = eavlTimer::Start();
+        importer->SetDiscreteDim(0, 1);
+        double readTime = eavlTimer::Stop(th, "");
+        th = eavlTimer::Start();
+        StreamLoad(dump, 1);
+        double streamTime = eavlTimer::Stop(th, "");
+        delete importer;
+
+        // a dump that grew after it was indexed
+        {
+            ofstream out(dump.c_str(), ios::out | ios::app | ios::binary);
+            WriteTimeStep(out, nsteps, natoms + 5, true);
+        }
+        importer = new eavlLAMMPSDumpImporter(dump);
+        Check(importer->GetDiscreteDimLengths()[0] == nsteps + 1,
+              "index of a dump that grew is rebuilt");
+        CheckTimeStep(*importer, dump, nsteps, true, "appended step");
+        delete importer;
+
+        // an index that is garbage
+        {
+            ofstream out(index.c_str());
+            out << "eavlLAMMPSDumpIndex 1\n12 34\nnot an index\n";
+        }
+        importer = new eavlLAMMPSDumpImporter(dump);
+        Check(importer->GetDiscreteDimLengths()[0] == nsteps + 1,
+              "garbage index is ignored");
+        CheckTimeStep(*importer, dump, 2, true, "step after a garbage index");
+        delete importer;
+
+        // unscaled coordinates
+        const string unscaled = "testlammpsload-unscaled.dump";
+        WriteDump(unscaled, 100, 2, false);
+        importer = new eavlLAMMPSDumpImporter(unscaled);
+        CheckTimeStep(*importer, unscaled, 1, false, "unscaled");
+        string unscaledIndex = importer->GetIndexFilename();
+        delete importer;
+
+        cout << natoms << " atoms, " << nsteps << " time steps" << endl;
+        cout << "open, scanning the dump: " << scanTime << endl;
+        cout << "open with the index:     " << indexTime << endl;
+        cout << "read a time step:        " << readTime << endl;
+        cout << "  with istringstream:    " << streamTime << endl;
+
+        remove(dump.c_str());
+        remove(index.c_str());
+        remove(unscaled.c_str());
+        remove(unscaledIndex.c_str());
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -0,0 +1,97 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlMemoryPool.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Imitates a filter which creates and destroys the same temporaries on
+// every execution, and checks that after the first execution all of
+// their storage comes from the pool.  Run by hand with a larger size,
+// the timings compare pooled and unpooled executions.
+
+static const char *usage = "testmempool [nvalues] [niterations]";
+
+static double RunTimesteps(int nvalues, int niter)
+{
+    int th = eavlTimer::Start();
+    for (int it = 0; it < niter; it++)
+    {
+        vector<eavlArray*> temps;
+        temps.push_back(new eavlIntArray("hilo", 1, nvalues));
+        temps.push_back(new eavlIntArray("case", 1, nvalues));
+        temps.push_back(new eavlIntArray("numout", 1, nvalues));
+        temps.push_back(new eavlFloatArray("alpha", 1, nvalues / 3 + 1));
+        temps.push_back(new eavlFloatArray("coords", 3, nvalues / 3 + 1));
+        // (the arrays' storage is zero-filled, so every page is touched)
+        for (size_t t = 0; t < temps.size(); t++)
+            delete temps[t];
+    }
+    return eavlTimer::Stop(th, "");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int nvalues = (argc > 1) ? atoi(argv[1]) : 100000;
+        int niter = (argc > 2) ? atoi(argv[2]) : 10;
+        if (nvalues < 1 || niter < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        Check(eavlMemoryPool::GetSizeClassBytes(4096) == 4096 &&
+              eavlMemoryPool::GetSizeClassBytes(4097) == 5120 &&
+              eavlMemoryPool::GetSizeClassBytes(8000) == 8192 &&
+              eavlMemoryPool::GetSizeClassBytes(100) == 100,
+              "size class sizes");
+
+        eavlMemoryPool::SetEnabled(false);
+        double unpooled = RunTimesteps(nvalues, niter);
+
+        eavlMemoryPool::SetEnabled(true);
+        eavlMemoryPool::ResetStatistics();
+        double pooled = RunTimesteps(nvalues, niter);
+        eavlMemoryPoolStatistics s = eavlMemoryPool::GetStatistics();
+        eavlMemoryPool::PrintStatistics(cout);
+
+        cout << "\n" << niter << " timesteps of " << nvalues << " values"
+             << "  unpooled: " << unpooled
+             << "  pooled: " << pooled << endl;
+
+        if ((nvalues / 3 + 1) * sizeof(float) >=
+            eavlMemoryPool::GetMinimumPooledBytes())
+        {
+            // only the first timestep should need new memory
+            if (s.misses != 5 || s.hits != 5 * (niter - 1))
+            {
+                cout << "Expected 5 misses and " << 5 * (niter - 1)
+                     << " hits.\n";
+                ok = false;
+            }
+        }
+        Check(s.bytesInUse == 0, "no pooled bytes still in use");
+
+        eavlMemoryPool::Trim();
+        Check(eavlMemoryPool::GetStatistics().bytesCached == 0,
+              "trim leaves no bytes cached");
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -0,0 +1,184 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlCoordinates.h"
+#include "eavlPointDistanceFieldFilter.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Computes the distance field of random clustered points on a 3D and a
+// 2D mesh with the exact (spatially indexed) and the approximate sweep
+// modes, checks the exact distances and closest points of a sample of
+// nodes against a search over every point, and reports the time of
+// each mode and the error of the approximate one.
+
+static const char *usage = "testpointdistance [npoints] [nodes per axis]";
+
+static eavlDataSet *CreatePoints(int npts)
+{
+    eavlDataSet *data = new eavlDataSet;
+    data->SetNumPoints(npts);
+
+    eavlCoordinatesCartesian *coords = new eavlCoordinatesCartesian(NULL,
+                                              eavlCoordinatesCartesian::X,
+                                              eavlCoordinatesCartesian::Y,
+                                              eavlCoordinatesCartesian::Z);
+    data->AddCoordinateSystem(coords);
+    coords->SetAxis(0,new eavlCoordinateAxisField("xcoord",0));
+    coords->SetAxis(1,new eavlCoordinateAxisField("ycoord",0));
+    coords->SetAxis(2,new eavlCoordinateAxisField("zcoord",0));
+
+    eavlFloatArray *axisValues[3] = {
+        new eavlFloatArray("xcoord",1, npts),
+        new eavlFloatArray("ycoord",1, npts),
+        new eavlFloatArray("zcoord",1, npts)
+    };
+    // points in a few dense clusters, plus some scattered ones, with a
+    // repeated point so closest point ties are exercised
+    srand(5);
+    float centers[4][3] = {{-.5f,-.5f,-.5f}, {.5f,.4f,0.f},
+                           {0.f,.6f,-.6f}, {.3f,-.7f,.7f}};
+    for (int i=0; i<npts; i++)
+    {
+        int c = rand() % 5;
+        for (int d=0; d<3; d++)
+        {
+            float r = rand() / float(RAND_MAX) - .5f;
+            float v = (c < 4) ? centers[c][d] + .2f * r : 2.f * r;
+            axisValues[d]->SetValue(i, v);
+        }
+    }
+    if (npts > 10)
+        for (int d=0; d<3; d++)
+            axisValues[d]->SetValue(npts-1, axisValues[d]->GetValue(7));
+
+    for (int d=0; d<3; d++)
+        data->AddField(new eavlField(1, axisValues[d], eavlField::ASSOC_POINTS));
+    return data;
+}
+
+static eavlDataSet *RunFilter(eavlDataSet *input, int dim, int n, bool exact,
+                              double &time)
+{
+    eavlPointDistanceFieldFilter *df = new eavlPointDistanceFieldFilter();
+    df->SetInput(input);
+    if (dim == 3)
+        df->SetRange3D(n, n, n, -1.2, 1.2, -1.2, 1.2, -1.2, 1.2);
+    else
+        df->SetRange2D(n, n, -1.2, 1.2, -1.2, 1.2);
+    if (exact)
+        df->SetDoExact();
+    df->SetOutputClosestPoint(true);
+    int th = eavlTimer::Start();
+    df->Execute();
+    time = eavlTimer::Stop(th, "");
+    eavlDataSet *result = df->GetOutput();
+    delete df;
+    return result;
+}
+
+static void Compare(eavlDataSet *input, int dim, int n)
+{
+    double exactTime, approxTime;
+    eavlDataSet *exact = RunFilter(input, dim, n, true, exactTime);
+    eavlDataSet *approx = RunFilter(input, dim, n, false, approxTime);
+
+    eavlFloatArray *dist = (eavlFloatArray*)exact->GetField("dist")->GetArray();
+    eavlIntArray *cp = (eavlIntArray*)exact->GetField("cp")->GetArray();
+    eavlFloatArray *adist = (eavlFloatArray*)approx->GetField("dist")->GetArray();
+    int nnodes = exact->GetNumPoints();
+    int npts = input->GetNumPoints();
+
+    vector<double> pts(npts*3, 0.);
+    for (int p=0; p<npts; p++)
+        for (int d=0; d<dim; d++)
+            pts[p*3+d] = input->GetPoint(p, d);
+
+    // check a sample of nodes against every point
+    int nsample = std::min(nnodes, 500);
+    for (int s=0; s<nsample; s++)
+    {
+        int node = (nsample == nnodes) ? s : int((long long)s * 7919 % nnodes);
+        double q[3];
+        for (int d=0; d<3; d++)
+            q[d] = (d < dim) ? float(exact->GetPoint(node, d)) : 0.f;
+        double best = -1;
+        int bestp = -1;
+        for (int p=0; p<npts; p++)
+        {
+            double d2 = 0;
+            for (int d=0; d<dim; d++)
+            {
+                double dd = pts[p*3+d] - q[d];
+                d2 += dd*dd;
+            }
+            if (bestp < 0 || d2 < best)
+            {
+                best = d2;
+                bestp = p;
+            }
+        }
+        if (cp->GetValue(node) != bestp ||
+            dist->GetValue(node) != float(sqrt(best)))
+        {
+            cout << "node " << node << ": closest point " << cp->GetValue(node)
+                 << " at " << dist->GetValue(node) << ", expected " << bestp
+                 << " at " << float(sqrt(best)) << endl;
+            Check(false, "exact distance field");
+            break;
+        }
+    }
+
+    double maxerr = 0;
+    for (int i=0; i<nnodes; i++)
+    {
+        Check(adist->GetValue(i) >= dist->GetValue(i) * (1 - 1.e-5),
+              "approximate distance is never below the exact one");
+        maxerr = std::max(maxerr, double(adist->GetValue(i) - dist->GetValue(i)));
+    }
+
+    cout << dim << "D, " << npts << " points, " << nnodes << " nodes" << endl;
+    cout << "  exact (indexed): " << exactTime << endl;
+    cout << "  approximate:     " << approxTime
+         << "  (max error " << maxerr << ")" << endl;
+
+    delete exact;
+    delete approx;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int npts = (argc > 1) ? atoi(argv[1]) : 100000;
+        int n = (argc > 2) ? atoi(argv[2]) : 64;
+        if (npts < 1 || n < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        eavlDataSet *input = CreatePoints(npts);
+        Compare(input, 3, n);
+        Compare(input, 2, n * 4);
+        delete input;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
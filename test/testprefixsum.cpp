@@ -0,0 +1,120 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlCUDA.h"
+#include "eavlPrefixSumOp_1.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlTestCheck.h"
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+static const char *usage = "testprefixsum [maxElements]";
+
+// Scan the given component of "in" into "out" and check the result
+// against a straightforward reference loop.  Returns the op runtime.
+double RunScan(eavlIntArray *in, int component, eavlIntArray *out,
+               bool inclusive)
+{
+    int n = out->GetNumberOfTuples();
+    eavlArrayWithLinearIndex inIndex(in, component);
+
+    int th = eavlTimer::Start();
+    eavlExecutor::AddOperation(new eavlPrefixSumOp_1(inIndex, out, inclusive),
+                               "prefix sum");
+    eavlExecutor::Go();
+    double runtime = eavlTimer::Stop(th, "");
+
+    int sum = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int value = in->GetTuple(i)[component];
+        if (inclusive)
+            sum += value;
+        if (out->GetValue(i) != sum)
+        {
+            cout<<"Mismatch at "<<i<<": expected "<<sum
+                <<" got "<<out->GetValue(i)<<endl;
+            ok = false;
+            break;
+        }
+        if (!inclusive)
+            sum += value;
+    }
+    return runtime;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if(argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int maxsize = 1 << 22;
+        if (argc == 2)
+            maxsize = atoi(argv[1]);
+        if (maxsize < 1)
+        {
+            maxsize = 1 << 22;
+            cout<<"Invalid size. Using size of "<<maxsize<<".\n";
+        }
+
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        int maxthreads = 1;
+#ifdef HAVE_OPENMP
+        maxthreads = omp_get_max_threads();
+#endif
+        cout<<"Prefix sum with up to "<<maxthreads<<" threads"<<endl;
+
+        for (int size = 1; ; size *= 8)
+        {
+            if (size > maxsize)
+                size = maxsize;
+
+            // scanning one component of a two-component array exercises
+            // the mul/add part of the input indexing
+            eavlIntArray *in = new eavlIntArray("in", 2, size);
+            for (int i = 0; i < size; i++)
+            {
+                int tuple[2] = {rand() % 16, rand() % 16};
+                in->SetTuple(i, tuple);
+            }
+            eavlIntArray *out = new eavlIntArray("out", 1, size);
+            for (int pass = 0; pass < 2; pass++)
+            {
+                bool inclusive = (pass == 0);
+#ifdef HAVE_OPENMP
+                omp_set_num_threads(1);
+#endif
+                double serial = RunScan(in, 1, out, inclusive);
+#ifdef HAVE_OPENMP
+                omp_set_num_threads(maxthreads);
+#endif
+                double parallel = RunScan(in, 1, out, inclusive);
+
+                cout<<(inclusive ? "inclusive" : "exclusive")
+                    <<" n="<<size
+                    <<"  serial: "<<serial
+                    <<"  parallel: "<<parallel<<endl;
+            }
+            delete in;
+            delete out;
+            if (size == maxsize)
+                break;
+        }
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
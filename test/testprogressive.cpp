@@ -0,0 +1,184 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlRayTracerMutator.h"
+#include "eavlTestCheck.h"
+
+#include <cstdio>
+
+using namespace std;
+
+// Renders a scene of triangles and spheres whole, then progressively in
+// batches of rays, in morton and in tile order, and checks that the frame
+// and depth buffers come out the same.  One progressive render is given a
+// time budget so it takes several executes; the others finish in one.
+// Also runs the traversal test on a progressive tracer.
+// Reports the time for the whole frame and for the first execute with the
+// budget.
+
+static const char *usage = "testprogressive [height] [width]";
+
+static eavlRayTracerMutator *CreateTracer(int height, int width)
+{
+    eavlRayTracerMutator *tracer = new eavlRayTracerMutator();
+    tracer->cpu = true;
+
+    // a floor of triangles under rows of spheres
+    eavlRTScene *scene = tracer->scene;
+    for (int i=0; i<20; i++)
+    {
+        for (int j=0; j<20; j++)
+        {
+            eavlVector3 a(-10.f + i, -2.f, -40.f + j);
+            eavlVector3 b(-9.f + i, -2.f, -40.f + j);
+            eavlVector3 c(-10.f + i, -2.f, -39.f + j);
+            eavlVector3 d(-9.f + i, -2.f, -39.f + j);
+            scene->addTriangle(a, b, c);
+            scene->addTriangle(b, d, c);
+        }
+    }
+    for (int s=0; s<200; s++)
+        scene->addSphere(0.3f + 0.1f*(s%5), -6.f + 0.6f*(s%20),
+                         -1.5f + 0.6f*(s/20), -30.f + 2.f*((s*7)%5), 1.f);
+
+    tracer->setResolution(height, width);
+    tracer->setCameraPos(0, 2, -10);
+    tracer->lookAtPos(0, 0, -30);
+    tracer->setUp(0, 1, 0);
+    tracer->setDepth(1);
+    tracer->setLightParams(0, 5, -5, 1, 1, 0, 0);
+    tracer->setBackgroundColor(0.2f, 0.3f, 0.4f);
+    return tracer;
+}
+
+static void Compare(eavlRayTracerMutator *tracer,
+                    const vector<unsigned char> &frame,
+                    const vector<float> &depth, const string &what)
+{
+    eavlByteArray *fb = tracer->getFrameBuffer();
+    bool same = (fb->GetNumberOfTuples() == (int)frame.size());
+    for (int i=0; same && i<(int)frame.size(); i++)
+        same = (fb->GetValue(i) == frame[i]);
+    Check(same, what + " frame buffer");
+
+    eavlFloatArray *zb = tracer->getDepthBuffer(1.f, 1.f, 1.f);
+    same = (zb->GetNumberOfTuples() >= (int)depth.size());
+    for (int i=0; same && i<(int)depth.size(); i++)
+        same = (zb->GetValue(i) == depth[i]);
+    Check(same, what + " depth buffer");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int height = (argc > 1) ? atoi(argv[1]) : 151;
+        int width = (argc > 2) ? atoi(argv[2]) : 203;
+        if (height < 1 || width < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        // the whole frame
+        eavlRayTracerMutator *tracer = CreateTracer(height, width);
+        tracer->Execute();
+        int th = eavlTimer::Start();
+        tracer->Execute();
+        double wholeTime = eavlTimer::Stop(th, "");
+        Check(tracer->isFrameComplete(), "whole frame is complete");
+        vector<unsigned char> frame(height * width * 4);
+        for (int i=0; i<(int)frame.size(); i++)
+            frame[i] = tracer->getFrameBuffer()->GetValue(i);
+        vector<float> depth(height * width);
+        eavlFloatArray *zb = tracer->getDepthBuffer(1.f, 1.f, 1.f);
+        int background = 0;
+        for (int i=0; i<(int)depth.size(); i++)
+        {
+            depth[i] = zb->GetValue(i);
+            if (frame[i*4] == frame[0] && frame[i*4+1] == frame[1] &&
+                frame[i*4+2] == frame[2])
+                background++;
+        }
+        Check(background < height * width, "the scene is in view");
+        delete tracer;
+
+        // batches that don't divide the image, one execute per frame
+        for (int tiles=0; tiles<2; tiles++)
+        {
+            const string order = tiles ? "tile order" : "morton order";
+            tracer = CreateTracer(height, width);
+            if (tiles)
+                tracer->setRayOrder(eavlRayTracerMutator::TileOrder, 16);
+            tracer->setProgressive(true, 997);
+            tracer->Execute();
+            Check(tracer->isFrameComplete(), order + " frame is complete");
+            Compare(tracer, frame, depth, order);
+
+            // a complete frame is left alone
+            tracer->Execute();
+            Check(tracer->isFrameComplete(), order + " frame stays complete");
+            delete tracer;
+        }
+
+        // a time budget too small for the frame
+        tracer = CreateTracer(height, width);
+        tracer->setProgressive(true, 256, 1.e-4f);
+        tracer->Execute();
+        th = eavlTimer::Start();
+        tracer->Execute();
+        double firstTime = eavlTimer::Stop(th, "");
+        int executes = 2;
+        while (!tracer->isFrameComplete() && executes < height * width)
+        {
+            tracer->Execute();
+            executes++;
+        }
+        Check(executes > 2, "time budget splits the frame");
+        Compare(tracer, frame, depth, "time budget");
+
+        // moving the camera starts the frame over
+        tracer->setCameraPos(0, 2, -11);
+        tracer->Execute();
+        Check(!tracer->isFrameComplete(), "camera change restarts the frame");
+        delete tracer;
+
+        // the traversal test traces one batch, but the depth image it
+        // writes (depth.bmp, removed again) covers the whole frame
+        tracer = CreateTracer(height, width);
+        tracer->setProgressive(true, 5000, 0, 1);
+        tracer->traversalTest(1, 2);
+        FILE *bmp = fopen("depth.bmp", "rb");
+        Check(bmp != NULL, "progressive traversal test writes its depth image");
+        if (bmp)
+        {
+            fseek(bmp, 0, SEEK_END);
+            Check(ftell(bmp) >= 54 + 3 * height * width,
+                  "depth image covers the frame");
+            fclose(bmp);
+            remove("depth.bmp");
+        }
+        delete tracer;
+
+        cout << height << "x" << width << " pixels" << endl;
+        cout << "whole frame:             " << wholeTime << endl;
+        cout << "execute with the budget: " << firstTime
+             << " (" << executes << " executes)" << endl;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
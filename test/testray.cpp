@@ -30,6 +30,11 @@ void printUsage()
     cerr<<"           cosnt linear  exponential coeffs Example : -lp 5 3.2 -20 3 1 .3 .7"<<endl;
     cerr<<"     -aa   Anti-Aliasing on                 Example : -aa"<<endl;
     cerr<<"     -cpu  Force CPU execution(GPU Default) "<<endl;
+    cerr<<"     -bbvh Trace CPU rays through the binary BVH instead of the wide one"<<endl;
+    cerr<<"     -bvh  BVH builder: morton, split, binned Example : -bvh binned"<<endl;
+    cerr<<"     -tile Trace rays tile by tile          Example : -tile 16 (tile width in pixels)"<<endl;
+    cerr<<"     -prog Progressive, rays per batch,     "<<endl;
+    cerr<<"           seconds per frame, AO passes     Example : -prog 65536 0.05 4"<<endl;
     cerr<<"     -test test tarversal only              Example : -test 50 100 (warm up and test rounds)"<<endl;
     exit(1);
 }
@@ -237,6 +242,59 @@ int main(int argc, char *argv[])
             {
                 forceCPU=true;
             }
+            else if(strcmp (argv[i],"-tile")==0)
+            {
+                if(argc<=i+1) 
+                {
+                    cerr<<"Needs more values."<<endl;
+                    printUsage();
+                }
+                int t=atoi(argv[++i]);
+                if(t<1)
+                {
+                    cerr<<"Invalid tile size. Must be a non-zero integer."<<endl;
+                    printUsage();
+                }
+                tracer->setRayOrder(eavlRayTracerMutator::TileOrder, t);
+            }
+            else if(strcmp (argv[i],"-prog")==0)
+            {
+                if(argc<=i+3) 
+                {
+                    cerr<<"Needs more values."<<endl;
+                    printUsage();
+                }
+                int rays=atoi(argv[++i]);
+                float budget=atof(argv[++i]);
+                int passes=atoi(argv[++i]);
+                if(rays<1 || budget<0 || passes<1)
+                {
+                    cerr<<"Invalid progressive values."<<endl;
+                    printUsage();
+                }
+                tracer->setProgressive(true, rays, budget, passes);
+            }
+            else if(strcmp (argv[i],"-bbvh")==0)
+            {
+                tracer->setWideBVH(false);
+            }
+            else if(strcmp (argv[i],"-bvh")==0)
+            {
+                if(argc<=i+1) 
+                {
+                    cerr<<"Needs more values."<<endl;
+                    printUsage();
+                }
+                const char *builder=argv[++i];
+                if(strcmp(builder,"morton")==0)      tracer->setBVHBuilder(eavlRayTracerMutator::MortonBuilder);
+                else if(strcmp(builder,"split")==0)  tracer->setBVHBuilder(eavlRayTracerMutator::SplitBuilder);
+                else if(strcmp(builder,"binned")==0) tracer->setBVHBuilder(eavlRayTracerMutator::BinnedBuilder);
+                else
+                {
+                    cerr<<"Invalid BVH builder "<<builder<<endl;
+                    printUsage();
+                }
+            }
             else if(strcmp (argv[i],"-o")==0)
             {
                 outFilename=argv[++i];
@@ -280,10 +338,13 @@ int main(int argc, char *argv[])
         if(!isTest)
         {
             cout<<"Rendering to Framebuffer\n";
-            for(int i=0; i<1;i++)
+            int frames=0;
+            do
             {
                 tracer->Execute();
-            }
+                frames++;
+            } while(!tracer->isFrameComplete());
+            if(frames>1) cout<<"Progressive frame took "<<frames<<" executes"<<endl;
         }
         else 
         {
@@ -0,0 +1,242 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlArrayResidency.h"
+#include "eavlThreadPool.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Exercises array residency on the simulated (host-backed) device, so it
+// runs the same in builds with or without CUDA.
+
+static void CheckTransfers(int toDevice, int toHost, const string &what)
+{
+    int d = eavlTransferLedger::GetNumberOfTransfers(true);
+    int h = eavlTransferLedger::GetNumberOfTransfers(false);
+    if (d != toDevice || h != toHost)
+    {
+        cout << "FAILED: " << what << ": expected " << toDevice << "/" << toHost
+             << " transfers to device/host, got " << d << "/" << h << endl;
+        ok = false;
+    }
+}
+
+static eavlFloatArray *MakeArray(const string &name, int n, float base)
+{
+    eavlFloatArray *a = new eavlFloatArray(name, 1, n);
+    for (int i=0; i<n; i++)
+        a->SetValue(i, base + i);
+    return a;
+}
+
+// stand-in for a device kernel writing through the device pointer
+static void DeviceIncrement(eavlFloatArray *a)
+{
+    float *dev = (float*)a->GetCUDAArray();
+    int n = a->GetNumberOfTuples();
+    for (int i=0; i<n; i++)
+        dev[i] += 1;
+}
+
+static void TestPreferDevice()
+{
+    eavlTransferLedger::Clear();
+    eavlFloatArray *a = MakeArray("a", 100, 0);
+
+    DeviceIncrement(a);
+    CheckTransfers(1, 0, "prefer device: first device use");
+    Check(a->GetValue(5) == 6, "prefer device: device result visible on host");
+    CheckTransfers(1, 1, "prefer device: host read after device write");
+
+    // reading on the host must not invalidate the device copy
+    a->GetCUDAArray();
+    CheckTransfers(1, 1, "prefer device: device use after host read");
+    Check(a->GetValue(7) == 8, "prefer device: host read after device reuse");
+    CheckTransfers(1, 2, "prefer device: host read after device reuse");
+
+    // writing on the host must
+    a->SetValue(0, 42);
+    DeviceIncrement(a);
+    CheckTransfers(2, 2, "prefer device: device use after host write");
+    Check(a->GetValue(0) == 43, "prefer device: host write reached device");
+    Check(eavlArrayResidency::IsResident(a), "prefer device: still resident");
+
+    delete a;
+    Check(eavlArrayResidency::GetDeviceBytesInUse() == 0,
+          "prefer device: memory released on delete");
+}
+
+static void TestPinOnHost()
+{
+    eavlTransferLedger::Clear();
+    eavlPinOnHostPolicy policy(false);
+    eavlArrayResidency::SetPolicy(&policy);
+
+    eavlFloatArray *pinned = MakeArray("pinned", 50, 0);
+    eavlFloatArray *other = MakeArray("other", 50, 0);
+    policy.Pin(pinned);
+
+    DeviceIncrement(pinned);
+    DeviceIncrement(other);
+    Check(pinned->GetValue(1) == 2, "pin on host: pinned result");
+    Check(other->GetValue(1) == 2, "pin on host: unpinned result");
+    Check(!eavlArrayResidency::IsResident(pinned),
+          "pin on host: pinned device copy released after host use");
+    Check(eavlArrayResidency::IsResident(other),
+          "pin on host: unpinned device copy kept");
+
+    delete pinned;
+    delete other;
+    eavlArrayResidency::SetPolicy(NULL);
+}
+
+static void TestMemoryCap()
+{
+    eavlTransferLedger::Clear();
+    const int n = 1000;
+    const long long nbytes = n * sizeof(float);
+    eavlDeviceMemoryCapPolicy policy(2 * nbytes);
+    eavlArrayResidency::SetPolicy(&policy);
+
+    eavlFloatArray *a = MakeArray("a", n, 0);
+    eavlFloatArray *b = MakeArray("b", n, 0);
+    eavlFloatArray *c = MakeArray("c", n, 0);
+
+    DeviceIncrement(a);
+    DeviceIncrement(b);
+    a->GetCUDAArray(); // b is now least recently used
+    DeviceIncrement(c);
+    Check(eavlArrayResidency::GetDeviceBytesInUse() <= 2 * nbytes,
+          "memory cap: device memory stays under the cap");
+    Check(!eavlArrayResidency::IsResident(b), "memory cap: LRU array evicted");
+    Check(eavlArrayResidency::IsResident(a) && eavlArrayResidency::IsResident(c),
+          "memory cap: recently used arrays kept");
+    // the eviction had to bring b's device modifications back to the host
+    CheckTransfers(3, 1, "memory cap: transfers");
+    Check(b->GetValue(10) == 11, "memory cap: evicted values preserved");
+    CheckTransfers(3, 1, "memory cap: host read of evicted array");
+
+    // arrays used by the current operation are never evicted
+    eavlArrayResidency::BeginOperation("three arrays");
+    DeviceIncrement(a);
+    DeviceIncrement(b);
+    DeviceIncrement(c);
+    Check(eavlArrayResidency::GetNumberOfResidentArrays() == 3,
+          "memory cap: operation arrays protected");
+    eavlArrayResidency::EndOperation();
+    Check(eavlArrayResidency::GetDeviceBytesHighWater() == 3 * nbytes,
+          "memory cap: high water mark");
+
+    eavlTransferLedger::Dump(cout);
+
+    delete a;
+    delete b;
+    delete c;
+    eavlArrayResidency::SetPolicy(NULL);
+}
+
+static void TestCallSites()
+{
+    eavlTransferLedger::Clear();
+    eavlFloatArray *a = MakeArray("a", 10, 0);
+    {
+        eavlTransferSite site("outer caller");
+        {
+            eavlTransferSite inner("inner caller");
+            DeviceIncrement(a);
+        }
+        Check(a->GetValue(0) == 1, "call sites: result");
+        eavlArrayResidency::BeginOperation("some op");
+        a->SetValue(0, 0);
+        a->GetCUDAArray();
+        eavlArrayResidency::EndOperation();
+    }
+
+    vector<eavlTransferLedger::Entry> e = eavlTransferLedger::GetEntries();
+    Check(e.size() == 3, "call sites: one entry per site");
+    if (e.size() == 3)
+    {
+        Check(e[0].site == "inner caller" && e[0].toDevice &&
+              e[0].method == "GetCUDAArray",
+              "call sites: innermost caller recorded");
+        Check(e[1].site == "outer caller" && !e[1].toDevice &&
+              e[1].method == "GetValue",
+              "call sites: enclosing caller recorded");
+        Check(e[2].site == "some op" && e[2].toDevice,
+              "call sites: operation recorded over callers");
+    }
+    delete a;
+}
+
+struct ConcurrentBody : public eavlParallelForBody
+{
+    vector<eavlFloatArray*> &arrays;
+    ConcurrentBody(vector<eavlFloatArray*> &a) : arrays(a) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        for (eavlIndex i = begin; i < end; ++i)
+        {
+            eavlArrayResidency::BeginOperation("concurrent op");
+            DeviceIncrement(arrays[i]);
+            arrays[i]->GetValue(0);
+            eavlArrayResidency::EndOperation();
+        }
+    }
+};
+
+static void TestConcurrent()
+{
+    eavlTransferLedger::Clear();
+    const int narrays = 64;
+    const int n = 1000;
+    eavlDeviceMemoryCapPolicy policy(8 * n * sizeof(float));
+    eavlArrayResidency::SetPolicy(&policy);
+
+    vector<eavlFloatArray*> arrays;
+    for (int i=0; i<narrays; i++)
+        arrays.push_back(MakeArray("concurrent", n, i));
+    ConcurrentBody body(arrays);
+    eavlThreadPool::ParallelFor(narrays, body, 1);
+
+    bool right = true;
+    for (int i=0; i<narrays; i++)
+        right = right && arrays[i]->GetValue(n-1) == i + n;
+    Check(right, "concurrent: results");
+    vector<eavlTransferLedger::Entry> e = eavlTransferLedger::GetEntries();
+    bool attributed = true;
+    for (size_t i=0; i<e.size(); i++)
+        attributed = attributed && e[i].site == "concurrent op";
+    Check(attributed, "concurrent: transfers attributed to operations");
+    Check(eavlTransferLedger::GetNumberOfTransfers(true) == narrays &&
+          eavlTransferLedger::GetNumberOfTransfers(false) == narrays,
+          "concurrent: transfer counts");
+
+    for (int i=0; i<narrays; i++)
+        delete arrays[i];
+    eavlArrayResidency::SetPolicy(NULL);
+}
+
+int main(int, char *[])
+{
+    try
+    {
+        eavlArrayResidency::SetSimulatedDevice(true);
+        TestPreferDevice();
+        TestPinOnHost();
+        TestMemoryCap();
+        TestCallSites();
+        TestConcurrent();
+        Check(eavlArrayResidency::GetNumberOfResidentArrays() == 0,
+              "all device copies released");
+        eavlArrayResidency::SetSimulatedDevice(false);
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -0,0 +1,225 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlExecutor.h"
+#include "eavlReduceOp_1.h"
+#include "eavlSnapshotExporter.h"
+#include "eavlImporterFactory.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace std;
+
+// Writes a rectilinear data set with float, int and byte fields and an
+// explicit cell set as a snapshot, opens it again through the importer
+// factory, and checks that the structure matches, that the fields wrap
+// page-aligned values in the mapped file, and that operations run on
+// them.  Also checks that files which aren't snapshots, or are of a
+// newer version, are refused, and compares the time to open the
+// snapshot with the time to deserialize the same data set from a
+// stream.
+
+static const char *usage = "testsnapshot [nodes per axis]";
+
+static eavlDataSet *CreateData(int n)
+{
+    eavlDataSet *data = new eavlDataSet;
+    vector<vector<double> > coords(3);
+    vector<string> coordNames(3);
+    for (int d=0; d<3; d++)
+    {
+        for (int i=0; i<n; i++)
+            coords[d].push_back(double(i) / (n-1));
+        coordNames[d] = string(1, char('x' + d));
+    }
+    AddRectilinearMesh(data, coords, coordNames, true, "cells");
+
+    int npts = data->GetNumPoints();
+    eavlFloatArray *pressure = new eavlFloatArray("pressure", 1, npts);
+    eavlFloatArray *velocity = new eavlFloatArray("velocity", 3, npts);
+    eavlByteArray *flags = new eavlByteArray("flags", 1, npts);
+    for (int i=0; i<npts; i++)
+    {
+        pressure->SetValue(i, sinf(i * .001f) * 10.f);
+        for (int c=0; c<3; c++)
+            velocity->SetComponentFromDouble(i, c, (i % 97) * (c + 1));
+        flags->SetValue(i, i % 7);
+    }
+    int ncells = data->GetCellSet(0)->GetNumCells();
+    eavlIntArray *ids = new eavlIntArray("ids", 1, ncells);
+    for (int i=0; i<ncells; i++)
+        ids->SetValue(i, ncells - i);
+    data->AddField(new eavlField(1, pressure, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(1, velocity, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(1, flags, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(0, ids, eavlField::ASSOC_CELL_SET, "cells"));
+
+    // a few triangles, so an explicit cell set goes through the snapshot
+    eavlCellSetExplicit *tris = new eavlCellSetExplicit("tris", 2);
+    eavlExplicitConnectivity conn;
+    for (int i=0; i<10; i++)
+    {
+        int tri[3] = {i, i+1, i+n};
+        conn.AddElement(EAVL_TRI, 3, tri);
+    }
+    tris->SetCellNodeConnectivity(conn);
+    data->AddCellSet(tris);
+    return data;
+}
+
+static string Summary(eavlDataSet *data)
+{
+    ostringstream out;
+    data->PrintSummary(out);
+    return out.str();
+}
+
+static void CheckSnapshot(eavlDataSet *data, eavlDataSet *opened)
+{
+    Check(Summary(data) == Summary(opened), "data set summary");
+    Check(opened->GetNumFields() == data->GetNumFields(), "number of fields");
+    for (int i=0; i<data->GetNumFields() && i<opened->GetNumFields(); i++)
+    {
+        eavlArray *a = data->GetField(i)->GetArray();
+        eavlArray *b = opened->GetField(i)->GetArray();
+        size_t nbytes = size_t(a->GetNumberOfTuples()) *
+            a->GetNumberOfComponents() *
+            (string(a->GetBasicType()) == "byte" ? 1 : 4);
+        Check(b->GetNumberOfTuples() == a->GetNumberOfTuples() &&
+              memcmp(a->GetHostArray(), b->GetHostArray(), nbytes) == 0,
+              a->GetName() + " values");
+        Check(size_t(b->GetHostArray()) % 4096 == 0,
+              a->GetName() + " is mapped at a page boundary");
+    }
+
+    // operations read the mapped values like any other array
+    eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+    eavlFloatArray *max = new eavlFloatArray("max", 1, 1);
+    eavlExecutor::AddOperation(
+        new eavlReduceOp_1<eavlMaxFunctor<float> >
+            (opened->GetField("pressure")->GetArray(), max,
+             eavlMaxFunctor<float>()),
+        "max pressure");
+    eavlExecutor::Go();
+    float expected = -FLT_MAX;
+    eavlFloatArray *pressure = (eavlFloatArray*)data->GetField("pressure")->GetArray();
+    for (int i=0; i<pressure->GetNumberOfTuples(); i++)
+        expected = std::max(expected, pressure->GetValue(i));
+    Check(max->GetValue(0) == expected, "reduction over a mapped field");
+    delete max;
+}
+
+static void CheckRefused(const string &filename, const string &what)
+{
+    bool refused = false;
+    try
+    {
+        eavlImporter *importer = eavlImporterFactory::GetImporterForFile(filename);
+        delete importer;
+    }
+    catch (const eavlException &)
+    {
+        refused = true;
+    }
+    Check(refused, what);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 100;
+        if (n < 12)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        eavlDataSet *data = CreateData(n);
+
+        int th = eavlTimer::Start();
+        {
+            ofstream out("snapshot.eavl", ios::out | ios::binary);
+            eavlSnapshotExporter exporter(data);
+            exporter.Export(out);
+        }
+        double writeTime = eavlTimer::Stop(th, "");
+        {
+            ofstream out("snapshot.dat", ios::out | ios::binary);
+            eavlStream s(out);
+            data->serialize(s);
+        }
+
+        th = eavlTimer::Start();
+        eavlImporter *importer = eavlImporterFactory::GetImporterForFile("snapshot.eavl");
+        eavlDataSet *opened = importer->GetMesh("mesh", 0);
+        double openTime = eavlTimer::Stop(th, "");
+        Check(importer->GetCellSetList("mesh").size() == 2, "cell set list");
+
+        th = eavlTimer::Start();
+        eavlDataSet *streamed = new eavlDataSet;
+        {
+            ifstream in("snapshot.dat", ios::in | ios::binary);
+            eavlStream s(in);
+            streamed->deserialize(s);
+        }
+        double streamTime = eavlTimer::Stop(th, "");
+
+        CheckSnapshot(data, opened);
+
+        eavlField *ids = importer->GetField("ids", "mesh", 0);
+        Check(ids->GetAssocCellSet() == "cells" &&
+              ids->GetArray()->GetHostArray() ==
+                  opened->GetField("ids")->GetArray()->GetHostArray(),
+              "field from GetField wraps the same values");
+        delete ids;
+
+        delete opened;
+        delete importer;
+        delete streamed;
+
+        // a file that isn't a snapshot, and one of a newer version
+        {
+            ofstream out("notasnapshot.eavl", ios::out | ios::binary);
+            out << "# vtk DataFile Version 3.0" << endl;
+        }
+        CheckRefused("notasnapshot.eavl", "refuse a file that isn't a snapshot");
+        {
+            fstream f("snapshot.eavl", ios::in | ios::out | ios::binary);
+            eavlSnapshotHeader header;
+            f.read((char*)&header, sizeof(header));
+            header.version = eavlSnapshotHeader::CurrentVersion + 1;
+            f.seekp(0);
+            f.write((const char*)&header, sizeof(header));
+        }
+        CheckRefused("snapshot.eavl", "refuse a snapshot of a newer version");
+
+        cout << data->GetNumPoints() << " points" << endl;
+        cout << "write snapshot:          " << writeTime << endl;
+        cout << "open snapshot:           " << openTime << endl;
+        cout << "deserialize from stream: " << streamTime << endl;
+
+        delete data;
+        remove("snapshot.eavl");
+        remove("snapshot.dat");
+        remove("notasnapshot.eavl");
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -0,0 +1,288 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlArray.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlExecutor.h"
+#include "eavlMapOp.h"
+#include "eavlSourceTopologyMapOp.h"
+#include "eavlReduceOp_1.h"
+#include "eavlRadixSortOp.h"
+#include "eavlThreadPool.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+using namespace std;
+
+// Runs a cell-centered topology map, a reduction, and a sort on an
+// explicit cell set of hexahedra, pyramids and tetrahedra, once with the
+// OpenMP CPU backend and once on the work-stealing thread pool, checks
+// that both give the same results, and reports the timings.  The cells
+// are grouped by shape, as in meshes built by appending blocks of each
+// shape, so a static partition of the cells gives some threads far more
+// work than others.
+
+static const char *usage = "testthreadpool [ncells] [niterations]";
+
+// work per cell grows with its number of nodes
+struct NodeWorkFunctor
+{
+    template <class IN>
+    EAVL_FUNCTOR float operator()(int shapeType, int n, int ids[], const IN inputs)
+    {
+        float result = 0.f;
+        for (int i=0; i<n; i++)
+        {
+            float x = collect(ids[i], inputs);
+            for (int j=0; j<n*8; j++)
+                x = sqrtf(x * x + 1.f) - 0.5f;
+            result += x;
+        }
+        return result;
+    }
+};
+
+struct ToKeyFunctor
+{
+    EAVL_FUNCTOR int operator()(float x) { return int(x * 1000.f) & 0xffffff; }
+};
+
+static eavlCellSetExplicit *CreateMixedCells(int ncells, int npts)
+{
+    eavlCellSetExplicit *cells = new eavlCellSetExplicit("cells", 3);
+    eavlExplicitConnectivity conn;
+    int ids[8];
+    for (int c=0; c<ncells; c++)
+    {
+        // a block of hexahedra, then pyramids, then tetrahedra
+        int n;
+        eavlCellShape shape;
+        if (c < ncells / 3)
+        {
+            n = 8;
+            shape = EAVL_HEX;
+        }
+        else if (c < 2 * ncells / 3)
+        {
+            n = 5;
+            shape = EAVL_PYRAMID;
+        }
+        else
+        {
+            n = 4;
+            shape = EAVL_TET;
+        }
+        for (int i=0; i<n; i++)
+            ids[i] = (c * 3 + i * 7) % npts;
+        conn.AddElement(shape, n, ids);
+    }
+    cells->SetCellNodeConnectivity(conn);
+    return cells;
+}
+
+struct Results
+{
+    double mapTime;
+    double reduceTime;
+    double sortTime;
+    vector<float> values;
+    float total;
+    vector<int> keys;
+};
+
+static void RunOps(eavlCellSetExplicit *cells, eavlFloatArray *nodal,
+                   int niter, Results &r)
+{
+    int ncells = cells->GetNumCells();
+    eavlFloatArray *cellvals = new eavlFloatArray("cellvals", 1, ncells);
+    eavlFloatArray *total = new eavlFloatArray("total", 1, 1);
+    eavlIntArray *keys = new eavlIntArray("keys", 1, ncells);
+    eavlIntArray *order = new eavlIntArray("order", 1, ncells);
+
+    r.mapTime = r.reduceTime = r.sortTime = 0;
+    for (int it=0; it<niter; it++)
+    {
+        int th = eavlTimer::Start();
+        eavlExecutor::AddOperation(
+            new_eavlSourceTopologyMapOp(cells, EAVL_NODES_OF_CELLS,
+                                        eavlOpArgs(nodal),
+                                        eavlOpArgs(cellvals),
+                                        NodeWorkFunctor()),
+            "per-cell work");
+        eavlExecutor::Go();
+        r.mapTime += eavlTimer::Stop(th, "");
+
+        th = eavlTimer::Start();
+        eavlExecutor::AddOperation(
+            new eavlReduceOp_1<eavlAddFunctor<float> >
+                (cellvals, total, eavlAddFunctor<float>()),
+            "sum");
+        eavlExecutor::Go();
+        r.reduceTime += eavlTimer::Stop(th, "");
+
+        eavlExecutor::AddOperation(
+            new_eavlMapOp(eavlOpArgs(cellvals), eavlOpArgs(keys),
+                          ToKeyFunctor()),
+            "make keys");
+        eavlExecutor::Go();
+        th = eavlTimer::Start();
+        eavlExecutor::AddOperation(
+            new_eavlRadixSortOp(eavlOpArgs(keys), eavlOpArgs(order), true),
+            "sort");
+        eavlExecutor::Go();
+        r.sortTime += eavlTimer::Stop(th, "");
+    }
+
+    // equal keys may be ordered differently by each backend, so check
+    // the sorted keys and that the order leads back to them
+    r.values.resize(ncells);
+    r.keys.resize(ncells);
+    for (int i=0; i<ncells; i++)
+    {
+        r.values[i] = cellvals->GetValue(i);
+        r.keys[i] = keys->GetValue(i);
+    }
+    for (int i=0; i<ncells; i++)
+    {
+        int o = order->GetValue(i);
+        if ((i > 0 && r.keys[i-1] > r.keys[i]) || o < 0 || o >= ncells ||
+            ToKeyFunctor()(r.values[o]) != r.keys[i])
+        {
+            cout << "Bad sort at " << i << endl;
+            ok = false;
+            break;
+        }
+    }
+    r.total = total->GetValue(0);
+
+    delete cellvals;
+    delete total;
+    delete keys;
+    delete order;
+}
+
+// sums its range into per-chunk slots, and can start an inner loop
+struct SumBody : public eavlParallelForBody
+{
+    int grain;
+    vector<long long> &sums;
+    bool nested;
+    SumBody(int g, vector<long long> &s, bool n)
+        : grain(g), sums(s), nested(n) { }
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        long long sum = 0;
+        for (int i=begin; i<end; i++)
+            sum += i;
+        if (nested)
+        {
+            vector<long long> inner(10);
+            SumBody body(10, inner, false);
+            eavlThreadPool::ParallelFor(100, body, 10);
+            for (int i=0; i<10; i++)
+                sum += inner[i];
+        }
+        sums[begin / grain] = sum;
+    }
+};
+
+struct ThrowingBody : public eavlParallelForBody
+{
+    virtual void Run(eavlIndex begin, eavlIndex end)
+    {
+        if (begin <= 500 && 500 < end)
+            THROW(eavlException, "expected failure");
+    }
+};
+
+static void CheckParallelFor()
+{
+    for (int nested=0; nested<2; nested++)
+    {
+        int n = 100000, grain = 1000;
+        vector<long long> sums(n / grain, -1);
+        SumBody body(grain, sums, nested);
+        eavlThreadPool::ParallelFor(n, body, grain);
+        long long sum = 0;
+        for (size_t c=0; c<sums.size(); c++)
+            sum += sums[c] - (nested ? 4950 : 0);
+        Check(sum == (long long)n * (n-1) / 2,
+              nested ? "nested ParallelFor" : "ParallelFor");
+    }
+
+    ThrowingBody thrower;
+    bool threw = false;
+    try
+    {
+        eavlThreadPool::ParallelFor(10000, thrower, 100);
+    }
+    catch (const eavlException &)
+    {
+        threw = true;
+    }
+    Check(threw, "error thrown from ParallelFor");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int ncells = (argc > 1) ? atoi(argv[1]) : 30000;
+        int niter = (argc > 2) ? atoi(argv[2]) : 2;
+        if (ncells < 3 || niter < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        CheckParallelFor();
+
+        int npts = ncells / 2 + 8;
+        eavlCellSetExplicit *cells = CreateMixedCells(ncells, npts);
+        eavlFloatArray *nodal = new eavlFloatArray("nodal", 1, npts);
+        for (int i=0; i<npts; i++)
+            nodal->SetValue(i, float(i % 1000) / 100.f);
+
+        cout << ncells << " mixed hex/pyramid/tet cells, "
+             << eavlThreadPool::GetNumberOfThreads()
+             << " pool threads" << endl;
+
+        Results omp, pool;
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+        RunOps(cells, nodal, niter, omp);
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPUThreadPool);
+        RunOps(cells, nodal, niter, pool);
+
+        Check(omp.values == pool.values, "topology map results");
+        Check(fabs(omp.total - pool.total) <= 1.e-4 * fabs(omp.total),
+              "reduced total");
+        Check(omp.keys == pool.keys, "sorted keys");
+
+        cout << "              static      pool   speedup" << endl;
+        cout << "topology map  " << setw(8) << omp.mapTime << "  "
+             << setw(8) << pool.mapTime << "  "
+             << setw(8) << omp.mapTime / pool.mapTime << endl;
+        cout << "reduce        " << setw(8) << omp.reduceTime << "  "
+             << setw(8) << pool.reduceTime << "  "
+             << setw(8) << omp.reduceTime / pool.reduceTime << endl;
+        cout << "radix sort    " << setw(8) << omp.sortTime << "  "
+             << setw(8) << pool.sortTime << "  "
+             << setw(8) << omp.sortTime / pool.sortTime << endl;
+
+        delete nodal;
+        delete cells;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
@@ -47,6 +47,16 @@ int main(int argc, char *argv[])
         eavlExecutor::SetExecutionMode(eavlExecutor::PreferGPU);
         eavlInitializeGPU();
 
+        // with -compact, threshold into a new data set holding only the
+        // points the cells use
+        bool compact = false;
+        if (argc > 1 && string(argv[1]) == "-compact")
+        {
+            compact = true;
+            argc--;
+            argv++;
+        }
+
         if (argc != 5 && argc != 6)
             THROW(eavlException,"Incorrect number of arguments");
 
@@ -54,23 +64,42 @@ int main(int argc, char *argv[])
         eavlDataSet *data = ReadWholeFile(argv[1]);
 
         eavlField *f = data->GetField(argv[2]);
-        if (f->GetAssociation() != eavlField::ASSOC_CELL_SET)
-            THROW(eavlException, "Wanted a cell-centered field.");
+        string cellsetname;
+        if (f->GetAssociation() == eavlField::ASSOC_CELL_SET)
+            cellsetname = f->GetAssocCellSet();
+        else if (f->GetAssociation() == eavlField::ASSOC_POINTS &&
+                 data->GetNumCellSets() > 0)
+            cellsetname = data->GetCellSet(0)->GetName();
+        else
+            THROW(eavlException, "Wanted a cell-centered or point-centered field.");
 
-        string cellsetname = f->GetAssocCellSet();
         int cellsetindex = data->GetCellSetIndex(cellsetname);
 
-        eavlThresholdMutator *thresh = new eavlThresholdMutator;
-        thresh->SetDataSet(data);
-        thresh->SetField(argv[2]);
-        thresh->SetRange(strtod(argv[3],NULL), strtod(argv[4],NULL));
-        thresh->SetCellSet(data->GetCellSet(cellsetindex)->GetName());
-        thresh->Execute();
+        eavlDataSet *result = data;
+        if (compact)
+        {
+            eavlThresholdFilter *thresh = new eavlThresholdFilter;
+            thresh->SetInput(data);
+            thresh->SetField(argv[2]);
+            thresh->SetRange(strtod(argv[3],NULL), strtod(argv[4],NULL));
+            thresh->SetCellSet(data->GetCellSet(cellsetindex)->GetName());
+            thresh->Execute();
+            result = thresh->GetOutput();
+        }
+        else
+        {
+            eavlThresholdMutator *thresh = new eavlThresholdMutator;
+            thresh->SetDataSet(data);
+            thresh->SetField(argv[2]);
+            thresh->SetRange(strtod(argv[3],NULL), strtod(argv[4],NULL));
+            thresh->SetCellSet(data->GetCellSet(cellsetindex)->GetName());
+            thresh->Execute();
+        }
 
         if (argc == 6)
         {
-            cerr << "\n\n-- done with surface normal, writing to file --\n";	
-            WriteToVTKFile(data, argv[5], data->GetNumCellSets()-1);
+            cerr << "\n\n-- done with threshold, writing to file --\n";	
+            WriteToVTKFile(result, argv[5], result->GetNumCellSets()-1);
         }
         else
         {
@@ -79,12 +108,12 @@ int main(int argc, char *argv[])
 
 
         cout << "\n\n-- summary of data set result --\n";	
-        data->PrintSummary(cout);
+        result->PrintSummary(cout);
     }
     catch (const eavlException &e)
     {
         cerr << e.GetErrorText() << endl;
-        cerr << "\nUsage: "<<argv[0]<<" <infile.vtk> <fieldname> <low> <hi> [<outfile.vtk>]\n";
+        cerr << "\nUsage: "<<argv[0]<<" [-compact] <infile.vtk> <fieldname> <low> <hi> [<outfile.vtk>]\n";
         return 1;
     }
 
@@ -0,0 +1,309 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlVTKExporter.h"
+#include "eavlVTKXMLExporter.h"
+#include "eavlVTKImporter.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+// Exports a rectilinear data set with float, int and byte fields, and an
+// explicit cell set of the same points, as legacy BINARY files, imports
+// them again and checks the values are exactly the originals.  Then
+// exports both cell sets as VTK XML files with raw and, given zlib,
+// compressed appended data, decodes arrays from the appended data and
+// compares them with the originals.  Prints the time each export takes
+// next to an ASCII export.
+
+static const char *usage = "testvtkexport [nodes per axis]";
+
+static eavlDataSet *CreateData(int n)
+{
+    eavlDataSet *data = new eavlDataSet;
+    vector<vector<double> > coords(3);
+    vector<string> coordNames(3);
+    for (int d=0; d<3; d++)
+    {
+        for (int i=0; i<n; i++)
+            coords[d].push_back(double(i) / (n-1) * (d+1));
+        coordNames[d] = string(1, char('x' + d));
+    }
+    AddRectilinearMesh(data, coords, coordNames, true, "cells");
+
+    int npts = data->GetNumPoints();
+    eavlFloatArray *pressure = new eavlFloatArray("pressure", 1, npts);
+    eavlFloatArray *velocity = new eavlFloatArray("velocity", 3, npts);
+    eavlByteArray *flags = new eavlByteArray("flags", 1, npts);
+    for (int i=0; i<npts; i++)
+    {
+        pressure->SetValue(i, sinf(i * .001f) * 10.f);
+        for (int c=0; c<3; c++)
+            velocity->SetComponentFromDouble(i, c, cosf(i * .01f) * (c + 1));
+        flags->SetValue(i, i % 7);
+    }
+    int ncells = data->GetCellSet(0)->GetNumCells();
+    eavlIntArray *ids = new eavlIntArray("ids", 1, ncells);
+    for (int i=0; i<ncells; i++)
+        ids->SetValue(i, ncells - i);
+    eavlFloatArray *time = new eavlFloatArray("time", 1, 1);
+    time->SetValue(0, 0.125f);
+    data->AddField(new eavlField(1, pressure, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(1, velocity, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(1, flags, eavlField::ASSOC_POINTS));
+    data->AddField(new eavlField(0, ids, eavlField::ASSOC_CELL_SET, "cells"));
+    data->AddField(new eavlField(0, time, eavlField::ASSOC_WHOLEMESH));
+
+    // triangles over the bottom face, for unstructured output
+    eavlCellSetExplicit *tris = new eavlCellSetExplicit("tris", 2);
+    eavlExplicitConnectivity conn;
+    for (int j=0; j<n-1; j++)
+    {
+        for (int i=0; i<n-1; i++)
+        {
+            int p = j*n + i;
+            int tri0[3] = {p, p+1, p+n};
+            int tri1[3] = {p+1, p+n+1, p+n};
+            conn.AddElement(EAVL_TRI, 3, tri0);
+            conn.AddElement(EAVL_TRI, 3, tri1);
+        }
+    }
+    tris->SetCellNodeConnectivity(conn);
+    data->AddCellSet(tris);
+    return data;
+}
+
+static double Export(eavlVTKExporter &exporter, const string &filename)
+{
+    int th = eavlTimer::Start();
+    ofstream out(filename.c_str(), ios::out | ios::binary);
+    exporter.Export(out);
+    out.close();
+    return eavlTimer::Stop(th, "");
+}
+
+static void CheckLegacyField(eavlVTKImporter &importer, eavlArray *orig)
+{
+    eavlField *f = importer.GetField(orig->GetName(), "mesh", 0);
+    Check(f != NULL, string("binary ") + orig->GetName() + " present");
+    if (!f)
+        return;
+    eavlArray *a = f->GetArray();
+    int nc = orig->GetNumberOfComponents();
+    bool same = (a->GetNumberOfTuples() == orig->GetNumberOfTuples() &&
+                 a->GetNumberOfComponents() == nc);
+    for (int i=0; same && i<a->GetNumberOfTuples(); i++)
+        for (int c=0; same && c<nc; c++)
+            same = (a->GetComponentAsDouble(i, c) ==
+                    float(orig->GetComponentAsDouble(i, c)));
+    Check(same, string("binary ") + orig->GetName() + " values");
+}
+
+static void CheckLegacy(eavlDataSet *data)
+{
+    eavlVTKImporter rect("testvtkexport-rect.vtk");
+    eavlDataSet *imported = rect.GetMesh("mesh", 0);
+    Check(imported->GetNumPoints() == data->GetNumPoints(),
+          "binary rectilinear number of points");
+    bool same = true;
+    for (int i=0; same && i<data->GetNumPoints(); i++)
+        for (int d=0; same && d<3; d++)
+            same = (imported->GetPoint(i, d) == float(data->GetPoint(i, d)));
+    Check(same, "binary rectilinear coordinates");
+    const char *names[5] = {"pressure", "velocity", "flags", "ids", "time"};
+    for (int i=0; i<5; i++)
+        CheckLegacyField(rect, data->GetField(names[i])->GetArray());
+    delete imported;
+
+    eavlVTKImporter tris("testvtkexport-tris.vtk");
+    imported = tris.GetMesh("mesh", 0);
+    eavlCellSet *orig = data->GetCellSet(1);
+    Check(imported->GetNumCellSets() == 1 &&
+          imported->GetCellSet(0)->GetNumCells() == orig->GetNumCells(),
+          "binary unstructured number of cells");
+    same = imported->GetNumCellSets() == 1;
+    for (int c=0; same && c<orig->GetNumCells(); c++)
+    {
+        eavlCell a = imported->GetCellSet(0)->GetCellNodes(c);
+        eavlCell b = orig->GetCellNodes(c);
+        same = (a.type == b.type && a.numIndices == b.numIndices);
+        for (int i=0; same && i<a.numIndices; i++)
+            same = (a.indices[i] == b.indices[i]);
+    }
+    Check(same, "binary unstructured connectivity");
+    delete imported;
+}
+
+static string ReadFile(const string &filename)
+{
+    ifstream in(filename.c_str(), ios::in | ios::binary);
+    return string((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+}
+
+// the bytes of a named array in raw appended data
+static string AppendedArray(const string &file, const string &name,
+                            bool compressed)
+{
+    size_t element = file.find("Name=\"" + name + "\"");
+    size_t appended = file.find("<AppendedData encoding=\"raw\">");
+    if (element == string::npos || appended == string::npos)
+        return "";
+    size_t offset = strtoul(file.c_str() + file.find("offset=\"", element) + 8,
+                            NULL, 10);
+    const char *p = file.data() + file.find('_', appended) + 1 + offset;
+
+    unsigned long long header[3];
+    if (!compressed)
+    {
+        memcpy(header, p, 8);
+        return string(p + 8, header[0]);
+    }
+
+    string values;
+#ifdef HAVE_ZLIB
+    memcpy(header, p, 24);
+    vector<unsigned long long> sizes(header[0]);
+    if (header[0] > 0)
+        memcpy(&sizes[0], p + 24, header[0] * 8);
+    const char *block = p + 24 + header[0] * 8;
+    for (size_t i=0; i<header[0]; i++)
+    {
+        uLongf n = (i == header[0]-1 && header[2] > 0) ? header[2] : header[1];
+        string v(n, '\0');
+        if (uncompress((Bytef*)&v[0], &n, (const Bytef*)block, sizes[i]) != Z_OK)
+            return "";
+        values += v.substr(0, n);
+        block += sizes[i];
+    }
+#endif
+    return values;
+}
+
+static void CheckXML(eavlDataSet *data, const string &filename, bool compressed)
+{
+    string file = ReadFile(filename);
+    string what = filename + " ";
+    const char *names[5] = {"pressure", "velocity", "flags", "ids", "time"};
+    for (int i=0; i<5; i++)
+    {
+        eavlArray *a = data->GetField(names[i])->GetArray();
+        size_t nbytes = size_t(a->GetNumberOfTuples()) *
+            a->GetNumberOfComponents() *
+            (string(a->GetBasicType()) == "byte" ? 1 : 4);
+        string values = AppendedArray(file, names[i], compressed);
+        Check(values.size() == nbytes &&
+              memcmp(values.data(), a->GetHostArray(), nbytes) == 0,
+              what + names[i] + " values");
+    }
+
+    string x = AppendedArray(file, "x_coordinates", compressed);
+    bool same = (x.size() == size_t(data->GetField("x")->GetArray()->GetNumberOfTuples()) * 4);
+    for (size_t i=0; same && i<x.size()/4; i++)
+        same = (((const float*)x.data())[i] ==
+                float(data->GetField("x")->GetArray()->GetComponentAsDouble(i, 0)));
+    Check(same, what + "x coordinates");
+}
+
+static void CheckXMLCells(eavlDataSet *data, const string &filename,
+                          bool compressed)
+{
+    string file = ReadFile(filename);
+    string conn = AppendedArray(file, "connectivity", compressed);
+    string offsets = AppendedArray(file, "offsets", compressed);
+    eavlCellSet *cs = data->GetCellSet(1);
+    bool same = (conn.size() == size_t(cs->GetNumCells()) * 3 * sizeof(int) &&
+                 offsets.size() == size_t(cs->GetNumCells()) * sizeof(long long));
+    for (int c=0; same && c<cs->GetNumCells(); c++)
+    {
+        eavlCell cell = cs->GetCellNodes(c);
+        same = (((const long long*)offsets.data())[c] == (c+1) * 3);
+        for (int i=0; same && i<3; i++)
+            same = (((const int*)conn.data())[c*3+i] == cell.indices[i]);
+    }
+    Check(same, filename + " connectivity");
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 50;
+        if (n < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        eavlDataSet *data = CreateData(n);
+
+        eavlVTKExporter ascii(data, 0);
+        double asciiTime = Export(ascii, "testvtkexport-ascii.vtk");
+
+        eavlVTKExporter binary(data, 0);
+        binary.SetBinary(true);
+        double binaryTime = Export(binary, "testvtkexport-rect.vtk");
+        eavlVTKExporter binaryTris(data, 1);
+        binaryTris.SetBinary(true);
+        Export(binaryTris, "testvtkexport-tris.vtk");
+        CheckLegacy(data);
+
+        eavlVTKXMLExporter xml(data, 0);
+        Check(xml.GetFileExtension() == ".vtr", "rectilinear XML extension");
+        double xmlTime = Export(xml, "testvtkexport.vtr");
+        CheckXML(data, "testvtkexport.vtr", false);
+        eavlVTKXMLExporter xmlTris(data, 1);
+        Check(xmlTris.GetFileExtension() == ".vtu", "unstructured XML extension");
+        Export(xmlTris, "testvtkexport.vtu");
+        CheckXMLCells(data, "testvtkexport.vtu", false);
+
+#ifdef HAVE_ZLIB
+        eavlVTKXMLExporter zlib(data, 0, 1);
+        double zlibTime = Export(zlib, "testvtkexport-zlib.vtr");
+        CheckXML(data, "testvtkexport-zlib.vtr", true);
+        eavlVTKXMLExporter zlibTris(data, 1, 1);
+        Export(zlibTris, "testvtkexport-zlib.vtu");
+        CheckXMLCells(data, "testvtkexport-zlib.vtu", true);
+#endif
+
+        cout << data->GetNumPoints() << " points" << endl;
+        cout << "legacy ascii:  " << asciiTime << endl;
+        cout << "legacy binary: " << binaryTime << endl;
+        cout << "xml raw:       " << xmlTime << endl;
+#ifdef HAVE_ZLIB
+        cout << "xml zlib:      " << zlibTime << endl;
+#endif
+
+        delete data;
+        remove("testvtkexport-ascii.vtk");
+        remove("testvtkexport-rect.vtk");
+        remove("testvtkexport-tris.vtk");
+        remove("testvtkexport.vtr");
+        remove("testvtkexport.vtu");
+        remove("testvtkexport-zlib.vtr");
+        remove("testvtkexport-zlib.vtu");
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
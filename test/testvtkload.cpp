@@ -0,0 +1,351 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlDataSet.h"
+#include "eavlCellSetExplicit.h"
+#include "eavlVTKImporter.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlTestCheck.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <iomanip>
+
+using namespace std;
+
+// Writes the same hexahedral unstructured grid as ASCII and as big-endian
+// BINARY legacy VTK files, with double, short, bit and int arrays, and
+// imports both.  The ASCII file is also read value by value with stream
+// extraction, the way the importer used to parse it; the imported values
+// must match those exactly, and the binary import must match the ASCII
+// one.  Prints the load time of each.
+
+static const char *usage = "testvtkload [nodes per axis]";
+
+static bool hostIsLittleEndian()
+{
+    unsigned int one = 1;
+    return *(unsigned char*)&one == 1;
+}
+
+template <class T>
+static void WriteBigEndian(ostream &out, T v)
+{
+    char b[sizeof(T)];
+    memcpy(b, &v, sizeof(T));
+    if (hostIsLittleEndian())
+        reverse(b, b + sizeof(T));
+    out.write(b, sizeof(T));
+}
+
+// the values of the data set, made up from node and cell indices
+static double Coord(int n, int p, int d)
+{
+    int ijk[3] = {p % n, (p / n) % n, p / (n * n)};
+    return ijk[d] * (0.5 / (d + 1));
+}
+static double Pressure(int p)     { return sin(p * 0.001) * 1000.; }
+static short Velocity(int p, int c)
+{
+    return (c == 0) ? short(p % 100 - 50) : (c == 1) ? short(p % 7) :
+                                            short(-(p % 300));
+}
+static bool Flag(int p)           { return p % 3 == 0; }
+static int Id(int c)              { return c * 3 - 7; }
+
+static void WriteFile(const string &filename, int n, bool binary)
+{
+    ofstream out(filename.c_str(), ios::out | ios::binary);
+    out << setprecision(17);
+    int npts = n * n * n;
+    int ncells = (n-1) * (n-1) * (n-1);
+
+    out << "# vtk DataFile Version 3.0\n"
+        << "testvtkload\n"
+        << (binary ? "BINARY\n" : "ASCII\n")
+        << "DATASET UNSTRUCTURED_GRID\n"
+        << "POINTS " << npts << " float\n";
+    for (int p=0; p<npts; p++)
+    {
+        for (int d=0; d<3; d++)
+        {
+            if (binary)
+                WriteBigEndian(out, float(Coord(n, p, d)));
+            else
+                out << Coord(n, p, d) << (d < 2 ? " " : "\n");
+        }
+    }
+    out << "\n";
+
+    out << "CELLS " << ncells << " " << ncells * 9 << "\n";
+    for (int k=0; k<n-1; k++)
+    for (int j=0; j<n-1; j++)
+    for (int i=0; i<n-1; i++)
+    {
+        int p = (k * n + j) * n + i;
+        int hex[9] = {8, p, p+1, p+n+1, p+n,
+                      p+n*n, p+n*n+1, p+n*n+n+1, p+n*n+n};
+        for (int v=0; v<9; v++)
+        {
+            if (binary)
+                WriteBigEndian(out, hex[v]);
+            else
+                out << hex[v] << (v < 8 ? " " : "\n");
+        }
+    }
+    out << "\n";
+
+    out << "CELL_TYPES " << ncells << "\n";
+    for (int c=0; c<ncells; c++)
+    {
+        if (binary)
+            WriteBigEndian(out, int(12));
+        else
+            out << 12 << "\n";
+    }
+    out << "\n";
+
+    out << "CELL_DATA " << ncells << "\n"
+        << "SCALARS ids int\n"
+        << "LOOKUP_TABLE default\n";
+    for (int c=0; c<ncells; c++)
+    {
+        if (binary)
+            WriteBigEndian(out, Id(c));
+        else
+            out << Id(c) << "\n";
+    }
+    out << "\n";
+
+    out << "POINT_DATA " << npts << "\n"
+        << "SCALARS pressure double\n"
+        << "LOOKUP_TABLE default\n";
+    for (int p=0; p<npts; p++)
+    {
+        if (binary)
+            WriteBigEndian(out, Pressure(p));
+        else
+            out << Pressure(p) << "\n";
+    }
+    out << "\n";
+
+    out << "VECTORS velocity short\n";
+    for (int p=0; p<npts; p++)
+    {
+        for (int c=0; c<3; c++)
+        {
+            if (binary)
+                WriteBigEndian(out, Velocity(p, c));
+            else
+                out << Velocity(p, c) << (c < 2 ? " " : "\n");
+        }
+    }
+    out << "\n";
+
+    out << "SCALARS flags bit\n"
+        << "LOOKUP_TABLE default\n";
+    if (binary)
+    {
+        for (int p=0; p<npts; p+=8)
+        {
+            unsigned char b = 0;
+            for (int i=0; i<8 && p+i<npts; i++)
+                if (Flag(p+i))
+                    b |= (unsigned char)(0x80 >> i);
+            out.write((const char*)&b, 1);
+        }
+    }
+    else
+    {
+        for (int p=0; p<npts; p++)
+            out << (Flag(p) ? 1 : 0) << "\n";
+    }
+    out << "\n";
+}
+
+// Read every section of the ASCII file with stream extraction, as the
+// importer did before it parsed from memory.
+static map<string, vector<double> > StreamLoad(const string &filename)
+{
+    map<string, vector<double> > sections;
+    ifstream in(filename.c_str(), ios::in);
+    string line;
+    for (int i=0; i<4; i++)
+        getline(in, line);
+
+    string s;
+    int n = 0;
+    while (in >> s)
+    {
+        int count = 0;
+        string name = s;
+        if (s == "POINTS")
+        {
+            string type;
+            in >> n >> type;
+            count = 3 * n;
+        }
+        else if (s == "CELLS")
+        {
+            int ncells;
+            in >> ncells >> count;
+        }
+        else if (s == "CELL_TYPES")
+        {
+            in >> count;
+        }
+        else if (s == "CELL_DATA" || s == "POINT_DATA")
+        {
+            in >> n;
+            continue;
+        }
+        else if (s == "SCALARS" || s == "VECTORS")
+        {
+            string type;
+            in >> name >> type;
+            getline(in, line);
+            if (s == "SCALARS")
+                getline(in, line); // lookup table
+            count = (s == "VECTORS") ? 3 * n : n;
+        }
+        else
+        {
+            THROW(eavlException, "Unexpected section " + s);
+        }
+
+        vector<double> &v = sections[name];
+        v.resize(count);
+        for (int i=0; i<count; i++)
+            in >> v[i];
+    }
+    return sections;
+}
+
+static void CheckField(eavlVTKImporter &importer, const string &name,
+                       const vector<double> &expected, const string &what)
+{
+    eavlField *f = importer.GetField(name, "mesh", 0);
+    Check(f != NULL, what + " " + name + " present");
+    if (!f)
+        return;
+    eavlArray *a = f->GetArray();
+    int nc = a->GetNumberOfComponents();
+    bool same = (a->GetNumberOfTuples() * nc == (eavlIndex)expected.size());
+    for (eavlIndex i=0; same && i<a->GetNumberOfTuples(); i++)
+        for (int c=0; same && c<nc; c++)
+            same = (float(a->GetComponentAsDouble(i, c)) ==
+                    float(expected[i * nc + c]));
+    Check(same, what + " " + name + " values");
+}
+
+static void CheckImport(eavlVTKImporter &importer,
+                        map<string, vector<double> > &ref, int n,
+                        const string &what)
+{
+    eavlDataSet *data = importer.GetMesh("mesh", 0);
+    Check(data->GetNumPoints() == n * n * n, what + " number of points");
+    Check(data->GetNumCellSets() == 1, what + " one cell set");
+    if (data->GetNumCellSets() != 1)
+        return;
+
+    vector<double> &points = ref["POINTS"];
+    const char *axes[3] = {"xcoord", "ycoord", "zcoord"};
+    for (int d=0; d<3; d++)
+    {
+        eavlArray *a = data->GetField(axes[d])->GetArray();
+        bool same = a->GetNumberOfTuples() == n * n * n;
+        for (eavlIndex i=0; same && i<a->GetNumberOfTuples(); i++)
+            same = (float(a->GetComponentAsDouble(i, 0)) ==
+                    float(points[i * 3 + d]));
+        Check(same, what + " " + axes[d] + " values");
+    }
+
+    eavlCellSet *cells = data->GetCellSet(0);
+    vector<double> &conn = ref["CELLS"];
+    bool same = cells->GetNumCells() * 9 == (int)conn.size();
+    for (int c=0; same && c<cells->GetNumCells(); c++)
+    {
+        eavlCell cell = cells->GetCellNodes(c);
+        same = (cell.type == EAVL_HEX && cell.numIndices == conn[c * 9]);
+        for (int i=0; same && i<cell.numIndices; i++)
+            same = (cell.indices[i] == conn[c * 9 + 1 + i]);
+    }
+    Check(same, what + " connectivity");
+
+    CheckField(importer, "ids", ref["ids"], what);
+    CheckField(importer, "pressure", ref["pressure"], what);
+    CheckField(importer, "velocity", ref["velocity"], what);
+    CheckField(importer, "flags", ref["flags"], what);
+    delete data;
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 2)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int n = (argc > 1) ? atoi(argv[1]) : 30;
+        if (n < 2)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+
+        WriteFile("testvtkload-ascii.vtk", n, false);
+        WriteFile("testvtkload-binary.vtk", n, true);
+
+        int th = eavlTimer::Start();
+        map<string, vector<double> > ref = StreamLoad("testvtkload-ascii.vtk");
+        double streamTime = eavlTimer::Stop(th, "");
+
+        th = eavlTimer::Start();
+        eavlVTKImporter *ascii = new eavlVTKImporter("testvtkload-ascii.vtk");
+        double asciiTime = eavlTimer::Stop(th, "");
+        CheckImport(*ascii, ref, n, "ascii");
+        delete ascii;
+
+        th = eavlTimer::Start();
+        eavlVTKImporter *binary = new eavlVTKImporter("testvtkload-binary.vtk");
+        double binaryTime = eavlTimer::Stop(th, "");
+        CheckImport(*binary, ref, n, "binary");
+        delete binary;
+
+        // a file cut off in the middle of its values is an error
+        {
+            ifstream in("testvtkload-binary.vtk", ios::in | ios::binary);
+            string contents((istreambuf_iterator<char>(in)),
+                            istreambuf_iterator<char>());
+            bool refused = false;
+            try
+            {
+                eavlVTKImporter truncated(contents.c_str(), contents.size() / 2);
+            }
+            catch (const eavlException &)
+            {
+                refused = true;
+            }
+            Check(refused, "refuse a truncated binary file");
+        }
+
+        cout << n * n * n << " points" << endl;
+        cout << "ascii, stream extraction: " << streamTime << endl;
+        cout << "ascii import:             " << asciiTime << endl;
+        cout << "binary import:            " << binaryTime << endl;
+
+        remove("testvtkload-ascii.vtk");
+        remove("testvtkload-binary.vtk");
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}
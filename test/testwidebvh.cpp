@@ -0,0 +1,366 @@
+// Copyright 2010-2014 UT-Battelle, LLC.  See LICENSE.txt for more information.
+#include "eavl.h"
+#include "eavlExecutor.h"
+#include "eavlTimer.h"
+#include "eavlException.h"
+#include "eavlVector4.h"
+#include "MortonBVHBuilder.h"
+#include "SplitBVH.h"
+#include "eavlWideBVH.h"
+#include "eavlTestCheck.h"
+
+#include <cstdio>
+#include <iomanip>
+
+using namespace std;
+
+// Builds BVHs over random triangles with the Morton and split builders,
+// collapses them into wide BVHs, and checks that every leaf of the binary
+// BVH is reached exactly once from the wide one, and that rays find the
+// same closest hits and occlusion in both, and the same closest hits as
+// testing every triangle.  Reports the time to collapse each BVH and to
+// trace the rays through the binary and the wide BVH.
+
+static const char *usage = "testwidebvh [ntriangles] [nrays]";
+
+static void Build(float *verts, int ntris, bool fast,
+                  float *&inner, int &innerSize, float *&leaf, int &leafSize)
+{
+    if (fast)
+    {
+        MortonBVHBuilder *mortonBVH = new MortonBVHBuilder(verts, ntris, TRIANGLE);
+        mortonBVH->build();
+        inner = mortonBVH->getInnerNodes(innerSize);
+        leaf = mortonBVH->getLeafNodes(leafSize);
+        delete mortonBVH;
+    }
+    else
+    {
+        SplitBVH *sbvh = new SplitBVH(verts, ntris, TRIANGLE);
+        sbvh->getFlatArray(innerSize, leafSize, inner, leaf);
+        delete sbvh;
+    }
+}
+
+struct Ray
+{
+    float o[3];
+    float d[3];
+};
+
+// Tests a ray against one triangle, packed as the ray tracer packs them:
+// nine coordinates then three scalars.
+static bool HitTriangle(const float *tri, const Ray &ray, float &dist)
+{
+    float e1[3], e2[3], p[3], t[3], q[3];
+    for (int c=0; c<3; c++)
+    {
+        e1[c] = tri[3+c] - tri[c];
+        e2[c] = tri[6+c] - tri[c];
+        t[c] = ray.o[c] - tri[c];
+    }
+    p[0] = ray.d[1]*e2[2] - ray.d[2]*e2[1];
+    p[1] = ray.d[2]*e2[0] - ray.d[0]*e2[2];
+    p[2] = ray.d[0]*e2[1] - ray.d[1]*e2[0];
+    float dot = e1[0]*p[0] + e1[1]*p[1] + e1[2]*p[2];
+    if (dot == 0.f)
+        return false;
+    dot = 1.f / dot;
+    float u = (t[0]*p[0] + t[1]*p[1] + t[2]*p[2]) * dot;
+    if (u < 0.f || u > 1.f)
+        return false;
+    q[0] = t[1]*e1[2] - t[2]*e1[1];
+    q[1] = t[2]*e1[0] - t[0]*e1[2];
+    q[2] = t[0]*e1[1] - t[1]*e1[0];
+    float v = (ray.d[0]*q[0] + ray.d[1]*q[1] + ray.d[2]*q[2]) * dot;
+    if (v < 0.f || u + v > 1.f)
+        return false;
+    dist = (e2[0]*q[0] + e2[1]*q[1] + e2[2]*q[2]) * dot;
+    return dist > 0.f;
+}
+
+// Tests a ray against the triangles of a leaf, the way the ray tracer's
+// leaf tests are called by both traversals.
+struct LeafTest
+{
+    const float *verts;
+    const float *leafNodes;
+    Ray          ray;
+    bool         occlusion;
+    int          minIndex;
+
+    bool operator()(int leaf, float &minDistance)
+    {
+        int n = (int)leafNodes[leaf];
+        for (int i=1; i<=n; i++)
+        {
+            int t = (int)leafNodes[leaf + i];
+            float dist;
+            if (HitTriangle(verts + t*12, ray, dist) && dist < minDistance)
+            {
+                minDistance = dist;
+                minIndex = t;
+                if (occlusion)
+                    return true;
+            }
+        }
+        return false;
+    }
+};
+
+// The ray tracer's binary traversal, with the leaf tests left to LeafTest.
+static void TraverseBinary(const float *inner, LeafTest &leaf, float &minDistance)
+{
+    float inv[3], odir[3];
+    for (int c=0; c<3; c++)
+    {
+        float f = (fabs(leaf.ray.d[c]) < 1e-8f) ? 1e-8f : leaf.ray.d[c];
+        inv[c] = 1.f / f;
+        odir[c] = leaf.ray.o[c] * inv[c];
+    }
+    int todo[64];
+    int stackptr = 0;
+    todo[0] = -1000000000;
+    int current = 0;
+    while (current != -1000000000)
+    {
+        if (current > -1)
+        {
+            const float *n = inner + current*4;
+            float tmin[2], tmax[2];
+            for (int k=0; k<2; k++)
+            {
+                const float *b = n + k*6;
+                float lo = 0.f, hi = minDistance;
+                for (int c=0; c<3; c++)
+                {
+                    float t0 = b[c] * inv[c] - odir[c];
+                    float t1 = b[c+3] * inv[c] - odir[c];
+                    lo = max(lo, min(t0, t1));
+                    hi = min(hi, max(t0, t1));
+                }
+                tmin[k] = lo;
+                tmax[k] = hi;
+            }
+            bool hit0 = tmax[0] >= tmin[0], hit1 = tmax[1] >= tmin[1];
+            if (!hit0 && !hit1)
+            {
+                current = todo[stackptr--];
+            }
+            else
+            {
+                int left = (int)n[12], right = (int)n[13];
+                current = hit0 ? left : right;
+                if (hit0 && hit1)
+                {
+                    if (tmin[0] > tmin[1])
+                    {
+                        current = right;
+                        todo[++stackptr] = left;
+                    }
+                    else
+                        todo[++stackptr] = right;
+                }
+            }
+        }
+        if (current < 0 && current != -1000000000)
+        {
+            if (leaf(-current - 1, minDistance))
+                return;
+            current = todo[stackptr--];
+        }
+    }
+}
+
+// Every leaf reached from the wide BVH, and how many times.
+static void CountLeaves(const eavlWideBVH &wide, vector<int> &visits)
+{
+    for (int i=0; i<wide.GetNumNodes(); i++)
+    {
+        const eavlWideBVH::Node &node = wide.GetNode(i);
+        for (int c=0; c<node.numChildren; c++)
+            if (node.children[c] < 0)
+                visits[-node.children[c] - 1]++;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        if (argc > 3)
+        {
+            PrintUsage(usage);
+            exit(0);
+        }
+        int ntris = (argc > 1) ? atoi(argv[1]) : 20000;
+        int nrays = (argc > 2) ? atoi(argv[2]) : 100000;
+        if (ntris < 2 || nrays < 1)
+        {
+            PrintUsage(usage);
+            return 1;
+        }
+        eavlExecutor::SetExecutionMode(eavlExecutor::ForceCPU);
+
+        // small triangles scattered through a unit cube
+        float *verts = new float[ntris * 12];
+        srand(11);
+        for (int t=0; t<ntris; t++)
+        {
+            float center[3];
+            for (int c=0; c<3; c++)
+                center[c] = rand() / float(RAND_MAX);
+            for (int i=0; i<9; i++)
+                verts[t*12 + i] = center[i%3] + 0.03f * rand() / float(RAND_MAX);
+            for (int i=9; i<12; i++)
+                verts[t*12 + i] = 0.f;
+        }
+
+        // rays from around the cube towards points inside it
+        vector<Ray> rays(nrays);
+        for (int r=0; r<nrays; r++)
+        {
+            float len2 = 0;
+            for (int c=0; c<3; c++)
+            {
+                rays[r].o[c] = -1.f + 3.f * rand() / float(RAND_MAX);
+                rays[r].d[c] = rand() / float(RAND_MAX) - rays[r].o[c];
+                len2 += rays[r].d[c] * rays[r].d[c];
+            }
+            for (int c=0; c<3; c++)
+                rays[r].d[c] /= sqrt(len2);
+        }
+
+        cout << ntris << " triangles, " << nrays << " rays, "
+             << eavlWideBVH::width << "-wide nodes" << endl;
+        cout << "builder  collapse time  binary trace  wide trace" << endl;
+        for (int fast=1; fast>=0; fast--)
+        {
+            const string name = fast ? "morton" : "split ";
+            float *inner = NULL, *leafNodes = NULL;
+            int innerSize = 0, leafSize = 0;
+            Build(verts, ntris, fast, inner, innerSize, leafNodes, leafSize);
+
+            int th = eavlTimer::Start();
+            eavlWideBVH wide(inner, innerSize);
+            double collapseTime = eavlTimer::Stop(th, "");
+            Check(wide.GetNumNodes() > 0 &&
+                  wide.GetNumNodes() < innerSize / 16,
+                  name + " wide BVH has fewer nodes");
+
+            // the same leaves, each reached once
+            vector<int> binaryLeaves(leafSize, 0), wideLeaves(leafSize, 0);
+            for (int i=0; i<innerSize/16; i++)
+                for (int k=12; k<14; k++)
+                    if (inner[i*16 + k] < 0)
+                        binaryLeaves[-(int)inner[i*16 + k] - 1]++;
+            CountLeaves(wide, wideLeaves);
+            Check(binaryLeaves == wideLeaves, name + " wide BVH has every leaf");
+
+            LeafTest leaf;
+            leaf.verts = verts;
+            leaf.leafNodes = leafNodes;
+
+            vector<int>   binaryHit(nrays), wideHit(nrays);
+            vector<float> binaryDist(nrays), wideDist(nrays);
+            th = eavlTimer::Start();
+            for (int r=0; r<nrays; r++)
+            {
+                leaf.ray = rays[r];
+                leaf.occlusion = false;
+                leaf.minIndex = -1;
+                binaryDist[r] = 1.e6f;
+                TraverseBinary(inner, leaf, binaryDist[r]);
+                binaryHit[r] = leaf.minIndex;
+            }
+            double binaryTime = eavlTimer::Stop(th, "");
+            th = eavlTimer::Start();
+            for (int r=0; r<nrays; r++)
+            {
+                leaf.ray = rays[r];
+                leaf.occlusion = false;
+                leaf.minIndex = -1;
+                wideDist[r] = 1.e6f;
+                wide.Traverse(rays[r].o[0], rays[r].o[1], rays[r].o[2],
+                              rays[r].d[0], rays[r].d[1], rays[r].d[2],
+                              leaf, wideDist[r]);
+                wideHit[r] = leaf.minIndex;
+            }
+            double wideTime = eavlTimer::Stop(th, "");
+
+            int hits = 0;
+            bool same = true;
+            for (int r=0; r<nrays; r++)
+            {
+                if (binaryHit[r] >= 0)
+                    hits++;
+                if (wideDist[r] != binaryDist[r] ||
+                    (wideHit[r] < 0) != (binaryHit[r] < 0))
+                    same = false;
+            }
+            Check(hits > nrays / 10, name + " rays hit triangles");
+            Check(same, name + " wide and binary closest hits match");
+
+            // against every triangle, for some of the rays
+            same = true;
+            for (int r=0; r<nrays && r<500; r++)
+            {
+                float minDist = 1.e6f;
+                for (int t=0; t<ntris; t++)
+                {
+                    float dist;
+                    if (HitTriangle(verts + t*12, rays[r], dist) && dist < minDist)
+                        minDist = dist;
+                }
+                if (minDist != wideDist[r])
+                    same = false;
+            }
+            Check(same, name + " wide closest hits match all triangles");
+
+            // occlusion rays stop at the first hit closer than the limit
+            same = true;
+            for (int r=0; r<nrays; r++)
+            {
+                leaf.ray = rays[r];
+                leaf.occlusion = true;
+                leaf.minIndex = -1;
+                float dist = 1.2f;
+                wide.Traverse(rays[r].o[0], rays[r].o[1], rays[r].o[2],
+                              rays[r].d[0], rays[r].d[1], rays[r].d[2],
+                              leaf, dist);
+                if ((leaf.minIndex >= 0) != (binaryHit[r] >= 0 && binaryDist[r] < 1.2f))
+                    same = false;
+            }
+            Check(same, name + " wide occlusion matches");
+
+            cout << name << "  " << setw(13) << collapseTime
+                 << "  " << setw(12) << binaryTime
+                 << "  " << setw(10) << wideTime << endl;
+            delete[] inner;
+            delete[] leafNodes;
+        }
+
+        // a BVH with no inner nodes traces nothing
+        eavlWideBVH empty(NULL, 0);
+        LeafTest leaf;
+        leaf.verts = verts;
+        leaf.leafNodes = NULL;
+        leaf.ray = rays[0];
+        leaf.occlusion = false;
+        leaf.minIndex = -1;
+        float dist = 1.e6f;
+        empty.Traverse(0.f, 0.f, 0.f, 1.f, 0.f, 0.f, leaf, dist);
+        Check(empty.GetNumNodes() == 0 && leaf.minIndex == -1,
+              "empty wide BVH");
+
+        delete[] verts;
+    }
+    catch (const eavlException &e)
+    {
+        cerr << e.GetErrorText() << endl;
+        PrintUsage(usage);
+        return 1;
+    }
+
+    return VerificationResult();
+}